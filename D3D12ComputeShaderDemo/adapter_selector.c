@@ -0,0 +1,187 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "adapter_selector.h"
+
+enum
+{
+    // The bit position of each part of the score, from the most significant one
+    ADAPTER_SCORE_WAVE_OPS_SHIFT = 62,
+    ADAPTER_SCORE_MEMORY_SHIFT = 16,
+    ADAPTER_SCORE_SHADER_MODEL_SHIFT = 8,
+
+    // The memory part is counted in MB
+    ADAPTER_SCORE_MEMORY_UNIT = 1024 * 1024
+};
+
+// The max weighted memory size in MB, so that the memory part never reaches the wave operation bit
+#define ADAPTER_SCORE_MAX_MEMORY    ((UINT64_C(1) << (ADAPTER_SCORE_WAVE_OPS_SHIFT - ADAPTER_SCORE_MEMORY_SHIFT)) - 1)
+
+static bool EqualsIgnoreCase(const char* str1, const char* str2)
+{
+    for (; *str1 != '\0' && *str2 != '\0'; ++str1, ++str2)
+    {
+        if (tolower((unsigned char)*str1) != tolower((unsigned char)*str2)) return false;
+    }
+    return *str1 == *str2;
+}
+
+// Parse a whole decimal, or hexadecimal with the 0x prefix, number
+static bool ParseNumber(const char* text, uint64_t* pValue)
+{
+    if (*text == '\0' || *text == '-' || *text == '+' || isspace((unsigned char)*text)) return false;
+
+    char* end = NULL;
+    const unsigned long long value = strtoull(text, &end, 0);
+    if (*end != '\0') return false;
+
+    *pValue = (uint64_t)value;
+    return true;
+}
+
+static bool ParseVendor(const char* text, uint32_t* pVendorId)
+{
+    const struct { const char* name; uint32_t vendorId; } vendors[] = {
+        { "amd", ADAPTER_VENDOR_ID_AMD },
+        { "nvidia", ADAPTER_VENDOR_ID_NVIDIA },
+        { "intel", ADAPTER_VENDOR_ID_INTEL },
+        { "qualcomm", ADAPTER_VENDOR_ID_QUALCOMM }
+    };
+
+    for (size_t i = 0; i < sizeof(vendors) / sizeof(vendors[0]); ++i)
+    {
+        if (EqualsIgnoreCase(text, vendors[i].name))
+        {
+            *pVendorId = vendors[i].vendorId;
+            return true;
+        }
+    }
+
+    uint64_t vendorId = 0;
+    if (!ParseNumber(text, &vendorId) || vendorId > UINT32_MAX) return false;
+
+    *pVendorId = (uint32_t)vendorId;
+    return true;
+}
+
+static bool ParseLuid(const char* text, uint64_t* pLuid)
+{
+    // <high>:<low>, just as the two parts of the LUID structure
+    const char* separator = strchr(text, ':');
+    if (separator == NULL) return ParseNumber(text, pLuid);
+
+    char highPart[32] = { '\0' };
+    const size_t highLength = (size_t)(separator - text);
+    if (highLength >= sizeof(highPart)) return false;
+    memcpy(highPart, text, highLength);
+
+    uint64_t high = 0, low = 0;
+    if (!ParseNumber(highPart, &high) || !ParseNumber(separator + 1, &low)) return false;
+    if (high > UINT32_MAX || low > UINT32_MAX) return false;
+
+    *pLuid = (high << 32) | low;
+    return true;
+}
+
+bool ParseAdapterSelection(const char* text, AdapterSelection* pSelection)
+{
+    if (text == NULL || *text == '\0') return false;
+
+    AdapterSelection selection = { .mode = ADAPTER_SELECT_BEST };
+    uint64_t index = 0;
+
+    if (EqualsIgnoreCase(text, "best")) {
+        // Nothing to parse
+    }
+    else if (strncmp(text, "index:", strlen("index:")) == 0 || ParseNumber(text, &index))
+    {
+        const char* number = strchr(text, ':') != NULL ? strchr(text, ':') + 1 : text;
+        if (!ParseNumber(number, &index) || index > UINT32_MAX) return false;
+
+        selection.mode = ADAPTER_SELECT_INDEX;
+        selection.index = (uint32_t)index;
+    }
+    else if (strncmp(text, "luid:", strlen("luid:")) == 0)
+    {
+        selection.mode = ADAPTER_SELECT_LUID;
+        if (!ParseLuid(text + strlen("luid:"), &selection.luid)) return false;
+    }
+    else if (strncmp(text, "vendor:", strlen("vendor:")) == 0)
+    {
+        selection.mode = ADAPTER_SELECT_VENDOR;
+        if (!ParseVendor(text + strlen("vendor:"), &selection.vendorId)) return false;
+    }
+    else {
+        return false;
+    }
+
+    *pSelection = selection;
+    return true;
+}
+
+bool AdapterSelectionNeedsCapabilities(const AdapterSelection* selection)
+{
+    return selection->mode == ADAPTER_SELECT_BEST || selection->mode == ADAPTER_SELECT_VENDOR;
+}
+
+int64_t ScoreAdapter(const AdapterInfo* adapter)
+{
+    if (adapter->isSoftware || !adapter->isSupported) return -1;
+
+    // An integrated adapter only owns a small dedicated part of the system memory, and shares the rest with the host
+    uint64_t memory = adapter->dedicatedVideoMemory / ADAPTER_SCORE_MEMORY_UNIT +
+                    adapter->dedicatedSystemMemory / ADAPTER_SCORE_MEMORY_UNIT / 2 +
+                    adapter->sharedSystemMemory / ADAPTER_SCORE_MEMORY_UNIT / 8;
+    if (memory > ADAPTER_SCORE_MAX_MEMORY) {
+        memory = ADAPTER_SCORE_MAX_MEMORY;
+    }
+
+    uint64_t score = (adapter->supportsWaveOps ? UINT64_C(1) : UINT64_C(0)) << ADAPTER_SCORE_WAVE_OPS_SHIFT;
+    score |= memory << ADAPTER_SCORE_MEMORY_SHIFT;
+    score |= (uint64_t)(adapter->shaderModel & 0xff) << ADAPTER_SCORE_SHADER_MODEL_SHIFT;
+    score |= (uint64_t)((adapter->featureLevel >> 8) & 0xff);
+
+    return (int64_t)score;
+}
+
+int SelectAdapter(const AdapterInfo adapters[], uint32_t adapterCount, const AdapterSelection* selection)
+{
+    switch (selection->mode)
+    {
+    case ADAPTER_SELECT_INDEX:
+        return selection->index < adapterCount ? (int)selection->index : -1;
+
+    case ADAPTER_SELECT_LUID:
+        for (uint32_t i = 0; i < adapterCount; ++i)
+        {
+            if (adapters[i].luid == selection->luid) return (int)i;
+        }
+        return -1;
+
+    case ADAPTER_SELECT_BEST:
+    case ADAPTER_SELECT_VENDOR:
+    default:
+        break;
+    }
+
+    int bestIndex = -1;
+    int64_t bestScore = -1;
+    for (uint32_t i = 0; i < adapterCount; ++i)
+    {
+        if (selection->mode == ADAPTER_SELECT_VENDOR && adapters[i].vendorId != selection->vendorId) continue;
+
+        // A later adapter has to be strictly better to win
+        const int64_t score = ScoreAdapter(&adapters[i]);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestIndex = (int)i;
+        }
+    }
+
+    return bestIndex;
+}
+
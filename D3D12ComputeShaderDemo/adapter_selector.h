@@ -0,0 +1,92 @@
+#ifndef ADAPTER_SELECTOR_H
+#define ADAPTER_SELECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum
+{
+    // The PCI vendor IDs accepted by name in an adapter selection
+    ADAPTER_VENDOR_ID_AMD = 0x1002,
+    ADAPTER_VENDOR_ID_NVIDIA = 0x10de,
+    ADAPTER_VENDOR_ID_INTEL = 0x8086,
+    ADAPTER_VENDOR_ID_QUALCOMM = 0x5143
+};
+
+// How an adapter is picked out of the enumerated ones
+typedef enum AdapterSelectionMode
+{
+    // The usable hardware adapter with the highest score
+    ADAPTER_SELECT_BEST,
+
+    // The adapter at the specified enumeration index
+    ADAPTER_SELECT_INDEX,
+
+    // The adapter with the specified locally unique identifier
+    ADAPTER_SELECT_LUID,
+
+    // The usable hardware adapter of the specified vendor with the highest score
+    ADAPTER_SELECT_VENDOR
+} AdapterSelectionMode;
+
+typedef struct AdapterSelection
+{
+    AdapterSelectionMode mode;
+
+    // The parameter of the selection mode
+    union
+    {
+        uint32_t index;
+        uint64_t luid;
+        uint32_t vendorId;
+    };
+} AdapterSelection;
+
+// The description and the probed capabilities of one enumerated adapter, free of any DXGI type,
+// so that the selection can be exercised with synthetic adapters
+typedef struct AdapterInfo
+{
+    uint32_t vendorId;
+    uint32_t deviceId;
+
+    // `AdapterLuid` of DXGI_ADAPTER_DESC1 as (HighPart << 32) | LowPart
+    uint64_t luid;
+
+    uint64_t dedicatedVideoMemory;
+    uint64_t dedicatedSystemMemory;
+    uint64_t sharedSystemMemory;
+
+    // A software rasterizer such as WARP
+    bool isSoftware;
+
+    // Whether a device of the minimum feature level required by the demo could be created.
+    // The capabilities below are only valid if it is true.
+    bool isSupported;
+
+    // The max D3D_FEATURE_LEVEL value, e.g. 0xc100 for 12.1
+    uint32_t featureLevel;
+
+    // The highest D3D_SHADER_MODEL value, e.g. 0x60 for 6.0
+    uint32_t shaderModel;
+
+    bool supportsWaveOps;
+} AdapterInfo;
+
+// Parse a selection such as "best", "3", "index:3", "luid:0x1234abcd", "luid:<high>:<low>", "vendor:0x10de" or "vendor:nvidia".
+// Returns false if the text is not a valid selection.
+extern bool ParseAdapterSelection(const char* text, AdapterSelection* pSelection);
+
+// Whether the selection needs the probed capabilities of the adapters, i.e. it scores them
+extern bool AdapterSelectionNeedsCapabilities(const AdapterSelection* selection);
+
+// The score of an adapter for the "best" selection, or a negative value if it must not be picked automatically.
+// Wave operation support comes first, since it selects the faster kernel. Then comes the local memory,
+// where the dedicated video memory weighs most, and the shader model and the feature level break the ties.
+extern int64_t ScoreAdapter(const AdapterInfo* adapter);
+
+// Pick the adapter of `selection` out of `adapterCount` adapters.
+// Returns its index, or -1 if no adapter matches. Equal scores resolve to the lowest index, so the result is deterministic.
+extern int SelectAdapter(const AdapterInfo adapters[], uint32_t adapterCount, const AdapterSelection* selection);
+
+#endif // ADAPTER_SELECTOR_H
+
@@ -0,0 +1,154 @@
+#ifndef COMPUTE_BACKEND_H
+#define COMPUTE_BACKEND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "compute_reference.h"
+#include "cpu_kernels.h"
+#include "reduction_layout.h"
+
+enum
+{
+    // The thread count of each thread group of `CSMain`, i.e. [numthreads(1024, 1, 1)]
+    COMPUTE_GROUP_THREAD_COUNT = 1024,
+
+    // The max number of jobs that a backend can have in flight at the same time
+    COMPUTE_MAX_IN_FLIGHT_JOB_COUNT = 3,
+
+    // The summary records of the on-device verification: the destination buffer, and the group sums of each pass
+    COMPUTE_MAX_VERIFICATION_SUMMARY_COUNT = 1 + MAX_REDUCTION_PASS_COUNT
+};
+
+// How the CPU execution engine runs `CSMain`
+typedef enum CPUKernelMode
+{
+    // The C port of the kernel, vectorized with the selected instruction set (cpu_kernels.c)
+    CPU_KERNEL_NATIVE,
+
+    // The C port of the kernel that emulates the selected group reduction step by step
+    CPU_KERNEL_REFERENCE,
+
+    // The compiled kernel (shaders/compute.cso) executed by the SM5 bytecode interpreter
+    CPU_KERNEL_BYTECODE,
+
+    // The compiled kernel lowered by the shader compiler, whose operations run over whole thread groups
+    CPU_KERNEL_COMPILED
+} CPUKernelMode;
+
+// A point on the monotonic submission timeline of a backend.
+// Every dispatch gets a new ticket that is greater than all the tickets handed out before, and 0 is never a valid ticket.
+typedef uint64_t ComputeTicket;
+
+// A read-only view of the results of the last dispatch, which points into the memory owned by the backend.
+// It stays valid until it is passed to `ReleaseResults`.
+typedef struct ComputeResultView
+{
+    // The contents of the destination buffer (u0, `elemCount` elements)
+    const int* dstResult;
+
+    // The contents of the whole read-write buffer (u1, `ReductionLayout::totalElementCount` elements,
+    // or `BatchLayout::totalElementCount` elements of a batch)
+    const int* rwResult;
+
+    // The `summaryCount` summary records of the on-device verification.
+    // When the verification runs on the device, only these are read back and the two buffers above are NULL.
+    const VerificationSummary* summaries;
+    uint32_t summaryCount;
+} ComputeResultView;
+
+// The compute backend interface.
+// The orchestration code (buffer preparation, dispatch and verification) only talks to this table,
+// so the same job can be executed on a D3D12 device or on the CPU execution engine.
+typedef struct ComputeBackend
+{
+    // The readable name of the backend
+    const char* name;
+
+    // The number of jobs that can be dispatched before the oldest one has to be synchronized and read.
+    // It is at most COMPUTE_MAX_IN_FLIGHT_JOB_COUNT.
+    uint32_t inFlightJobCount;
+
+    // Initialize the device, the pipeline and the command submission objects
+    bool (*Init)(void);
+
+    // Create the source buffer, the destination buffer and the read-write buffer for `elemCount` input elements.
+    // `srcData` initializes the SRV buffer (t0) and `rwData` initializes the first `elemCount` elements of the second UAV buffer (u1).
+    // The read-write buffer is laid out by `BuildReductionLayout`, so it also holds the partial sums of every reduction pass.
+    // `constantValue` is the `g_constant` member of the constant buffer (b0).
+    // It is called once before each dispatch. The buffers of the earlier jobs are reused while `elemCount` is unchanged,
+    // in which case only the new contents are uploaded.
+    bool (*CreateBuffers)(const int srcData[], const int rwData[], size_t elemCount, int constantValue);
+
+    // Create the buffers of a batch of `jobCount` independent jobs, which `Dispatch` executes with a single dispatch of
+    // shaders/compute_batch.hlsl instead of the passes of `CSMain`.
+    // `srcData` and `rwData` hold the packed inputs of all the jobs, and `jobs` is the job descriptor table laid out by `BuildBatchLayout`.
+    // Each job writes its segment of the destination buffer, and its group sums after the packed inputs in the read-write buffer.
+    // The results are read as the ones of any other job, and are always verified on the host.
+    bool (*CreateBatchBuffers)(const int srcData[], const int rwData[], const BatchJob jobs[], uint32_t jobCount, const BatchLayout* layout);
+
+    // Execute all the passes of `CSMain` over the buffers without waiting for them.
+    // `pTicket` receives the ticket of the submission.
+    bool (*Dispatch)(ComputeTicket* pTicket);
+
+    // Wait until the submission of `ticket` and all the submissions before it have completed
+    bool (*Sync)(ComputeTicket ticket);
+
+    // Map the results of the job of `ticket` after it has been synchronized, without copying them.
+    // The results of a job can be read once, and are dropped if they have not been read before
+    // `inFlightJobCount` more jobs are dispatched.
+    bool (*ReadResults)(ComputeTicket ticket, ComputeResultView* pView);
+
+    // Hand the memory of a result view back to the backend
+    void (*ReleaseResults)(ComputeResultView* pView);
+
+    // Release all the resources owned by the backend
+    void (*Release)(void);
+} ComputeBackend;
+
+#ifdef _WIN32
+// The Direct3D 12 backend
+extern const ComputeBackend* GetD3D12ComputeBackend(void);
+
+// Select the adapter that the D3D12 backend is initialized on, e.g. "best", "1", "luid:<high>:<low>" or "vendor:nvidia".
+// It takes precedence over the `D3D12_ADAPTER` environment variable. The text must outlive the backend initialization.
+extern void SetD3D12AdapterSelection(const char* selection);
+
+// Verify the results with shaders/verify.hlsl on the device, and only read back the summary records
+extern void SetD3D12DeviceVerification(bool enabled);
+
+// Allow the bindless kernels, which fetch their buffers from ResourceDescriptorHeap, on the devices that support Shader Model 6.6.
+// They are allowed by default. Otherwise the buffers are bound through the root signature generated from the reflection.
+extern void SetD3D12BindlessResources(bool enabled);
+
+// Run the grid-stride kernel (shaders/compute_stride.hlsl), whose `residentGroupCount` groups loop over the groups of each pass,
+// instead of dispatching one group per 1024 elements. 0 sizes the resident groups to the SIMD lane count of the adapter.
+// The grid-stride kernel is not used when the results are verified on the device.
+extern void SetD3D12GridStride(bool enabled, uint32_t residentGroupCount);
+
+// Run the raw-buffer kernel (shaders/compute_raw.hlsl), which accesses the buffers through ByteAddressBuffer with 128-bit loads and stores.
+// The grid-stride kernel takes precedence, and the raw-buffer kernel is not used when the results are verified on the device.
+extern void SetD3D12RawBuffers(bool enabled);
+#endif // _WIN32
+
+// The multithreaded CPU execution engine backend
+extern const ComputeBackend* GetCPUComputeBackend(void);
+
+// Select the group reduction emulated by the reference kernel of the CPU execution engine.
+// `waveLaneCount` is the emulated wave size of COMPUTE_REDUCTION_WAVE (0 means the default size).
+extern void SetCPUEngineReductionMode(ComputeReductionMode mode, uint32_t waveLaneCount);
+
+// Select how the CPU execution engine runs `CSMain`.
+// `laneCount` is the number of threads that the bytecode interpreter executes per SIMD step (4, 8 or 16, 0 means the default).
+extern void SetCPUEngineKernelMode(CPUKernelMode mode, uint32_t laneCount);
+
+// Select the instruction set of the native kernel of the CPU execution engine.
+// The widest one that the processor supports is used if it is not selected, or if the selected one is not supported.
+extern void SetCPUEngineKernelISA(CPUKernelISA isa);
+
+// Summarize the results with the CPU references of the on-device verification, and only hand out the summary records
+extern void SetCPUEngineDeviceVerification(bool enabled);
+
+#endif // COMPUTE_BACKEND_H
+
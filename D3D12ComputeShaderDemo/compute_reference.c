@@ -0,0 +1,93 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "compute_reference.h"
+
+int ReferenceGroupSumTree(int sharedBuffer[], size_t elemCount)
+{
+    // for (uint stride = 512; stride > 0; stride >>= 1)
+    for (size_t stride = elemCount / 2; stride > 0; stride >>= 1)
+    {
+        // if (groupIndex < stride) sharedBuffer[groupIndex] += sharedBuffer[groupIndex + stride];
+        for (size_t i = 0; i < stride; ++i) {
+            sharedBuffer[i] = (int)((uint32_t)sharedBuffer[i] + (uint32_t)sharedBuffer[i + stride]);
+        }
+    }
+
+    return elemCount > 0 ? sharedBuffer[0] : 0;
+}
+
+int ReferenceGroupSumWave(const int values[], size_t elemCount, uint32_t waveLaneCount)
+{
+    if (waveLaneCount == 0) {
+        waveLaneCount = 1;
+    }
+
+    // groupSum = 0
+    uint32_t groupSum = 0;
+
+    for (size_t waveBase = 0; waveBase < elemCount; waveBase += waveLaneCount)
+    {
+        // WaveActiveSum(rwBuffer[globalIndex])
+        uint32_t waveSum = 0;
+        for (size_t lane = 0; lane < waveLaneCount && waveBase + lane < elemCount; ++lane) {
+            waveSum += (uint32_t)values[waveBase + lane];
+        }
+
+        // if (WaveIsFirstLane()) InterlockedAdd(groupSum, waveSum)
+        groupSum += waveSum;
+    }
+
+    return (int)groupSum;
+}
+
+uint32_t ReferenceVerificationHash(uint32_t index, uint32_t value)
+{
+    // The finalizer of MurmurHash3 over the value mixed with the scaled index, so that equal values at different indices do not cancel out
+    uint32_t hash = value ^ (index * 0x9E3779B9u);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+void ReferenceElementSummary(const int actual[], const int expected[], size_t count, int constantValue, VerificationSummary* pSummary)
+{
+    *pSummary = (VerificationSummary){ .checkedCount = (uint32_t)count, .firstMismatch = UINT32_MAX };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        // if (actual != asuint(srcBuffer[globalIndex] + g_constant))
+        if ((uint32_t)actual[i] != (uint32_t)expected[i] + (uint32_t)constantValue)
+        {
+            ++pSummary->mismatchCount;
+            pSummary->firstMismatch = pSummary->firstMismatch == UINT32_MAX ? (uint32_t)i : pSummary->firstMismatch;
+        }
+        pSummary->checksum ^= ReferenceVerificationHash((uint32_t)i, (uint32_t)actual[i]);
+    }
+}
+
+void ReferenceGroupSumSummary(const int sums[], const int values[], size_t valueCount, size_t groupSize, VerificationSummary* pSummary)
+{
+    const size_t groupCount = (valueCount + groupSize - 1) / groupSize;
+    *pSummary = (VerificationSummary){ .checkedCount = (uint32_t)groupCount, .firstMismatch = UINT32_MAX };
+
+    for (size_t g = 0; g < groupCount; ++g)
+    {
+        // InterlockedAdd(groupSum, rwBuffer[g_inputOffset + globalIndex])
+        uint32_t groupSum = 0;
+        for (size_t i = g * groupSize; i < valueCount && i < (g + 1) * groupSize; ++i) {
+            groupSum += (uint32_t)values[i];
+        }
+
+        if ((uint32_t)sums[g] != groupSum)
+        {
+            ++pSummary->mismatchCount;
+            pSummary->firstMismatch = pSummary->firstMismatch == UINT32_MAX ? (uint32_t)g : pSummary->firstMismatch;
+        }
+        pSummary->checksum ^= ReferenceVerificationHash((uint32_t)g, (uint32_t)sums[g]);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef COMPUTE_REFERENCE_H
+#define COMPUTE_REFERENCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// The reduction strategies of the group sum in `CSMain`
+typedef enum ComputeReductionMode
+{
+    // Log-step group-shared memory tree (shaders/compute.hlsl)
+    COMPUTE_REDUCTION_TREE,
+
+    // WaveActiveSum plus a cross-wave group-shared accumulation (shaders/compute_wave.hlsl)
+    COMPUTE_REDUCTION_WAVE
+} ComputeReductionMode;
+
+enum
+{
+    // The number of 32-bit words of a VerificationSummary record
+    VERIFICATION_SUMMARY_WORD_COUNT = 4
+};
+
+// The summary record of one check of the on-device verification (shaders/verify.hlsl).
+// The device only writes these records, so they are all the host reads back instead of the result buffers.
+typedef struct VerificationSummary
+{
+    uint32_t checkedCount;
+    uint32_t mismatchCount;
+
+    // The index of the first mismatching element, or UINT32_MAX if there is none
+    uint32_t firstMismatch;
+
+    // The XOR of `ReferenceVerificationHash` of every checked element, which is independent of the order of the checks
+    uint32_t checksum;
+} VerificationSummary;
+
+// CPU references of the group reductions.
+// All the additions wrap around in 32-bit two's complement just as the HLSL int addition,
+// so the results are bit-exact with the GPU kernels regardless of the summation order.
+
+// Reduce `elemCount` (a power of 2) elements of `sharedBuffer` in place with the log-step tree of shaders/compute.hlsl.
+// The sum ends up in sharedBuffer[0] and is also returned.
+extern int ReferenceGroupSumTree(int sharedBuffer[], size_t elemCount);
+
+// Reduce `elemCount` elements with the wave reduction of shaders/compute_wave.hlsl,
+// where the threads are packed into waves of `waveLaneCount` lanes.
+extern int ReferenceGroupSumWave(const int values[], size_t elemCount, uint32_t waveLaneCount);
+
+// CPU references of the summaries of the on-device verification, bit-exact with shaders/verify.hlsl.
+
+// The hash of the element `value` at `index` that is folded into the checksum of a summary (VerificationHash)
+extern uint32_t ReferenceVerificationHash(uint32_t index, uint32_t value);
+
+// Summarize the check actual[i] == expected[i] + constantValue of `count` elements
+extern void ReferenceElementSummary(const int actual[], const int expected[], size_t count, int constantValue, VerificationSummary* pSummary);
+
+// Summarize the check that each element of `sums` is the wrapping sum of its group of `groupSize` elements of `values[0, valueCount)`.
+// The elements of the summary are the groups.
+extern void ReferenceGroupSumSummary(const int sums[], const int values[], size_t valueCount, size_t groupSize, VerificationSummary* pSummary);
+
+#endif // COMPUTE_REFERENCE_H
+
@@ -0,0 +1,551 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compute_backend.h"
+#include "compute_reference.h"
+#include "cpu_kernels.h"
+#include "reduction_layout.h"
+#include "shader_asset.h"
+#include "shader_compiler.h"
+#include "shader_interpreter.h"
+#include "shader_reflection.h"
+#include "thread_pool.h"
+
+enum
+{
+    // The emulated wave lane count reported as `g_minWaveLanes` by the CPU engine
+    CPU_EMULATED_WAVE_LANES = 32,
+
+    // The default number of threads that the bytecode interpreter executes per SIMD step
+    CPU_INTERPRETER_LANE_COUNT = 8
+};
+
+// The bindings of one pass executed by the bytecode interpreter
+typedef struct BytecodePass
+{
+    ShaderBindings bindings;
+    DispatchGrid grid;
+} BytecodePass;
+
+// The worker thread pool. Each worker owns the group-shared memory of the thread group it is executing.
+static ThreadPool* s_threadPool;
+
+// The source buffer (t0)
+static int* s_srcBuffer;
+
+// The destination buffer (u0)
+static int* s_dstBuffer;
+
+// The read-write buffer (u1), including the partial sums of all the reduction passes
+static int* s_rwBuffer;
+
+// The input element count that the buffers above have been allocated for
+static size_t s_bufferElemCount;
+
+// The element count of the read-write buffer
+static size_t s_rwBufferElemCount;
+
+// The pass layout of the hierarchical group sum
+static ReductionLayout s_layout;
+
+// The constant buffer records (b0) of all the passes
+static ReductionPassConstants s_passConstants[MAX_REDUCTION_PASS_COUNT];
+
+// The emulated reduction strategy of the group sum
+static ComputeReductionMode s_reductionMode = COMPUTE_REDUCTION_TREE;
+
+// The emulated wave lane count of the wave reduction
+static uint32_t s_waveLaneCount = CPU_EMULATED_WAVE_LANES;
+
+// The instruction set of the native kernel, or CPU_KERNEL_ISA_COUNT for the widest one that the processor supports
+static CPUKernelISA s_kernelISA = CPU_KERNEL_ISA_COUNT;
+
+// The vectorized operations of the native kernel
+static const CPUKernels* s_kernels;
+
+// Indicate whether the native kernel writes the destination buffer with non-temporal stores
+static bool s_isStreaming;
+
+// Indicate whether only the summary records of the verification are handed out
+static bool s_verifyOnDevice;
+
+// The summary records of the last dispatch, written when `s_verifyOnDevice` is set
+static VerificationSummary s_summaries[COMPUTE_MAX_VERIFICATION_SUMMARY_COUNT];
+
+// The ticket of the last dispatch
+static ComputeTicket s_lastTicket;
+
+// Indicate how `CSMain` is executed
+static CPUKernelMode s_kernelMode = CPU_KERNEL_NATIVE;
+
+// The number of threads that the bytecode interpreter executes per SIMD step
+static uint32_t s_interpreterLaneCount = CPU_INTERPRETER_LANE_COUNT;
+
+// The mapped shader archive, or NULL if there is none
+static ShaderAssetFile* s_shaderArchive;
+
+// The mapped compiled shader object that the interpreted kernel is decoded from when it is not taken from the shader archive
+static ShaderAssetFile* s_shaderFile;
+
+// The decoded compute shader of CPU_KERNEL_BYTECODE
+static ShaderProgram* s_shaderProgram;
+
+// The compute shader of CPU_KERNEL_COMPILED
+static CompiledShader* s_compiledShader;
+
+// The bindings of all the passes of CPU_KERNEL_BYTECODE and CPU_KERNEL_COMPILED
+static BytecodePass s_bytecodePasses[MAX_REDUCTION_PASS_COUNT];
+
+// The job descriptor table of the current batch, or no job if the buffers hold a single job
+static BatchJob* s_batchJobs;
+static uint32_t s_batchJobCount;
+
+// The number of jobs that `s_batchJobs` has room for
+static uint32_t s_batchJobCapacity;
+
+// The layout of the read-write buffer of the current batch
+static BatchLayout s_batchLayout;
+
+// Execute one thread group of `CSMain` with the vectorized kernels. `userData` points to the constant buffer record of the current pass.
+// The group sum wraps around just as both of the GPU reductions, so it is summed in one sweep without the group-shared memory,
+// and the first pass adds the constant in the same sweep.
+static void ExecuteNativeGroup(void* userData, size_t groupIndex, unsigned workerIndex, void* workerScratch)
+{
+    (void)workerIndex;
+    (void)workerScratch;
+
+    const ReductionPassConstants* constants = userData;
+    const size_t groupBase = groupIndex * COMPUTE_GROUP_THREAD_COUNT;
+    const size_t count = constants->elementCount - groupBase < COMPUTE_GROUP_THREAD_COUNT ?
+                        constants->elementCount - groupBase : COMPUTE_GROUP_THREAD_COUNT;
+    const int* const input = s_rwBuffer + constants->inputOffset + groupBase;
+
+    s_rwBuffer[constants->outputOffset + groupIndex] = constants->passIndex == 0 ?
+        s_kernels->AddConstantAndSum(s_dstBuffer + groupBase, s_srcBuffer + groupBase, input, count, constants->constantValue, s_isStreaming) :
+        s_kernels->Sum(input, count);
+}
+
+// Execute one thread group of shaders/compute_batch.hlsl with the vectorized kernels.
+// The group belongs to a single job, and sums its part of the job while adding the constant of the job, just as the first pass of `CSMain`.
+static void ExecuteBatchGroup(void* userData, size_t groupIndex, unsigned workerIndex, void* workerScratch)
+{
+    (void)userData;
+    (void)workerIndex;
+    (void)workerScratch;
+
+    const BatchJob* job = &s_batchJobs[FindBatchJob(s_batchJobs, s_batchJobCount, groupIndex)];
+    const size_t jobBase = (groupIndex - job->firstGroup) * COMPUTE_GROUP_THREAD_COUNT;
+    const size_t count = job->elementCount - jobBase < COMPUTE_GROUP_THREAD_COUNT ? job->elementCount - jobBase : COMPUTE_GROUP_THREAD_COUNT;
+    const size_t base = job->inputOffset + jobBase;
+
+    s_rwBuffer[s_batchLayout.inputElementCount + groupIndex] =
+        s_kernels->AddConstantAndSum(s_dstBuffer + base, s_srcBuffer + base, s_rwBuffer + base, count, job->constantValue, s_isStreaming);
+}
+
+// Execute one thread group of the C port of `CSMain`. `userData` points to the constant buffer record of the current pass.
+// The phases separated by `GroupMemoryBarrierWithGroupSync` are executed one after another for all the threads of the group.
+static void ExecuteReferenceGroup(void* userData, size_t groupIndex, unsigned workerIndex, void* workerScratch)
+{
+    (void)workerIndex;
+
+    const ReductionPassConstants* constants = userData;
+    int* const sharedBuffer = workerScratch;
+    const size_t groupBase = groupIndex * COMPUTE_GROUP_THREAD_COUNT;
+    const size_t elementCount = constants->elementCount;
+    const int* const input = s_rwBuffer + constants->inputOffset;
+
+    // Phase 0: dstBuffer[globalIndex] = srcBuffer[globalIndex] + g_constant in the first pass,
+    // and sharedBuffer[groupIndex] = rwBuffer[g_inputOffset + globalIndex]
+    if (constants->passIndex == 0)
+    {
+        const uint32_t constantValue = (uint32_t)constants->constantValue;
+        for (size_t localIndex = 0; localIndex < COMPUTE_GROUP_THREAD_COUNT && groupBase + localIndex < elementCount; ++localIndex)
+        {
+            const size_t globalIndex = groupBase + localIndex;
+            s_dstBuffer[globalIndex] = (int)((uint32_t)s_srcBuffer[globalIndex] + constantValue);
+        }
+    }
+
+    for (size_t localIndex = 0; localIndex < COMPUTE_GROUP_THREAD_COUNT; ++localIndex)
+    {
+        const size_t globalIndex = groupBase + localIndex;
+        sharedBuffer[localIndex] = globalIndex < elementCount ? input[globalIndex] : 0;
+    }
+
+    // Phase 1...: reduce the group-shared memory just as the selected kernel does
+    s_rwBuffer[constants->outputOffset + groupIndex] = s_reductionMode == COMPUTE_REDUCTION_WAVE ?
+                                ReferenceGroupSumWave(sharedBuffer, COMPUTE_GROUP_THREAD_COUNT, s_waveLaneCount) :
+                                ReferenceGroupSumTree(sharedBuffer, COMPUTE_GROUP_THREAD_COUNT);
+}
+
+// Execute one thread group of the compiled `CSMain` with the bytecode interpreter or as a compiled shader.
+// `userData` points to the bindings of the current pass.
+// The linear group index is mapped back onto the dispatch grid, just as the groups of the D3D12 dispatch.
+static void ExecuteBytecodeGroup(void* userData, size_t groupIndex, unsigned workerIndex, void* workerScratch)
+{
+    (void)workerIndex;
+
+    const BytecodePass* pass = userData;
+    const uint32_t groupID[3] = {
+        (uint32_t)(groupIndex % pass->grid.x),
+        (uint32_t)(groupIndex / pass->grid.x % pass->grid.y),
+        (uint32_t)(groupIndex / ((size_t)pass->grid.x * pass->grid.y))
+    };
+    if (s_compiledShader != NULL) {
+        ExecuteCompiledThreadGroup(s_compiledShader, &pass->bindings, groupID, workerScratch);
+    }
+    else {
+        ExecuteShaderThreadGroup(s_shaderProgram, &pass->bindings, groupID, workerScratch);
+    }
+}
+
+// Decode the tree reduction kernel from the shader archive if it has an up-to-date copy, or else from shaders/compute.cso.
+// Returns false if the kernel does not match the layout of the pass constants or the buffers of the host code.
+static bool LoadBytecodeKernel(void)
+{
+    ShaderBytecode bytecode = { 0 };
+    s_shaderArchive = OpenShaderAssetFile(SHADER_ARCHIVE_PATH);
+    if (!LoadShaderKernel(s_shaderArchive, SHADER_KERNEL_COMPUTE, &s_shaderFile, &bytecode)) return false;
+
+    // The constants of every pass are bound to b0 as a ReductionPassConstants record
+    ShaderReflection reflection;
+    if (!ReflectShader(bytecode.data, bytecode.size, &reflection))
+    {
+        fprintf(stderr, "The compute shader cannot be reflected!\n");
+        return false;
+    }
+    if (!CheckReductionPassConstantsLayout(&reflection)) return false;
+
+    // The buffers are laid out for groups of COMPUTE_GROUP_THREAD_COUNT threads
+    uint32_t threadGroupSize[3];
+    if (s_kernelMode == CPU_KERNEL_COMPILED)
+    {
+        s_compiledShader = AcquireCompiledShader(bytecode.data, bytecode.size);
+        if (s_compiledShader == NULL)
+        {
+            fprintf(stderr, "The compute shader cannot be compiled for the CPU engine!\n");
+            return false;
+        }
+        GetCompiledShaderThreadGroupSize(s_compiledShader, threadGroupSize);
+    }
+    else
+    {
+        s_shaderProgram = CreateShaderProgram(bytecode.data, bytecode.size, s_interpreterLaneCount);
+        if (s_shaderProgram == NULL)
+        {
+            fprintf(stderr, "The compute shader cannot be executed by the bytecode interpreter!\n");
+            return false;
+        }
+        GetShaderProgramThreadGroupSize(s_shaderProgram, threadGroupSize);
+    }
+    if (threadGroupSize[0] * threadGroupSize[1] * threadGroupSize[2] != COMPUTE_GROUP_THREAD_COUNT)
+    {
+        fprintf(stderr, "The thread group size %u x %u x %u of the compute shader is not supported!\n",
+                threadGroupSize[0], threadGroupSize[1], threadGroupSize[2]);
+        return false;
+    }
+
+    return true;
+}
+
+static void FreeBuffers(void)
+{
+    free(s_srcBuffer);
+    s_srcBuffer = NULL;
+    free(s_dstBuffer);
+    s_dstBuffer = NULL;
+    free(s_rwBuffer);
+    s_rwBuffer = NULL;
+    s_bufferElemCount = 0;
+    s_rwBufferElemCount = 0;
+}
+
+// Allocate the buffers for `elemCount` input elements and a read-write buffer of `rwElemCount` elements.
+// The buffers of the previous job are reused as long as their sizes are unchanged.
+static bool AllocateBuffers(size_t elemCount, size_t rwElemCount)
+{
+    if (s_srcBuffer != NULL && elemCount == s_bufferElemCount && rwElemCount == s_rwBufferElemCount) return true;
+
+    FreeBuffers();
+
+    s_srcBuffer = malloc(elemCount * sizeof(int));
+    s_dstBuffer = calloc(elemCount, sizeof(int));
+    s_rwBuffer = calloc(rwElemCount, sizeof(int));
+    if (s_srcBuffer == NULL || s_dstBuffer == NULL || s_rwBuffer == NULL)
+    {
+        fprintf(stderr, "Lack of memory for CPU engine buffers...\n");
+        return false;
+    }
+    s_bufferElemCount = elemCount;
+    s_rwBufferElemCount = rwElemCount;
+
+    return true;
+}
+
+static bool CPUInit(void)
+{
+    // The reference kernel emulates the group-shared memory, and the native one needs no scratch memory
+    size_t scratchSize = s_kernelMode == CPU_KERNEL_REFERENCE ? COMPUTE_GROUP_THREAD_COUNT * sizeof(int) : 0;
+    if (s_kernelMode == CPU_KERNEL_NATIVE)
+    {
+        s_kernels = GetCPUKernels(s_kernelISA);
+        if (s_kernels == NULL)
+        {
+            if (s_kernelISA != CPU_KERNEL_ISA_COUNT) {
+                puts("WARNING: The selected instruction set is not supported. So the widest supported one will be used!");
+            }
+            s_kernels = GetCPUKernels(GetBestCPUKernelISA());
+        }
+    }
+    else if (s_kernelMode != CPU_KERNEL_REFERENCE)
+    {
+        if (!LoadBytecodeKernel()) return false;
+
+        // The scratch memory of each worker holds the registers and the group-shared memory of a whole thread group
+        scratchSize = s_compiledShader != NULL ? GetCompiledShaderScratchSize(s_compiledShader) : GetShaderProgramScratchSize(s_shaderProgram);
+    }
+
+    s_threadPool = CreateThreadPool(0, scratchSize);
+    if (s_threadPool == NULL)
+    {
+        fprintf(stderr, "Failed to create the CPU engine thread pool!\n");
+        return false;
+    }
+
+    printf("CPU execution engine with %u worker threads\n", ThreadPoolGetWorkerCount(s_threadPool));
+    if (s_kernelMode == CPU_KERNEL_NATIVE) {
+        printf("The native kernel runs the %s code path\n", s_kernels->name);
+    }
+    else if (s_kernelMode == CPU_KERNEL_BYTECODE) {
+        printf("The compiled kernel is interpreted %u lanes at a time\n", s_interpreterLaneCount);
+    }
+    else if (s_kernelMode == CPU_KERNEL_COMPILED) {
+        printf("The compiled kernel runs whole thread groups in %u phases as %s\n", GetCompiledShaderPhaseCount(s_compiledShader),
+               GetCompiledShaderTargetName(s_compiledShader));
+    }
+    puts("\n================================================\n");
+
+    return true;
+}
+
+static bool CPUCreateBuffers(const int srcData[], const int rwData[], size_t elemCount, int constantValue)
+{
+    if (!BuildReductionLayout(elemCount, COMPUTE_GROUP_THREAD_COUNT, &s_layout))
+    {
+        fprintf(stderr, "The element count %zu exceeds the addressable range of the kernels!\n", elemCount);
+        return false;
+    }
+
+    const size_t bufferSize = elemCount * sizeof(int);
+    if (!AllocateBuffers(elemCount, (size_t)s_layout.totalElementCount)) return false;
+    s_batchJobCount = 0;
+
+    // The destination buffer is not read back by the engine, so it does not need to stay in the caches when it exceeds them
+    s_isStreaming = bufferSize >= CPU_KERNEL_STREAMING_THRESHOLD;
+
+    memcpy(s_srcBuffer, srcData, bufferSize);
+    memcpy(s_rwBuffer, rwData, bufferSize);
+
+    for (uint32_t i = 0; i < s_layout.passCount; ++i) {
+        FillReductionPassConstants(&s_layout, i, constantValue, s_waveLaneCount, &s_passConstants[i]);
+
+        // The bytecode kernels address the buffers through the bindings of its registers
+        s_bytecodePasses[i] = (BytecodePass){
+            .bindings = {
+                .constantBuffers[0] = { &s_passConstants[i], sizeof(s_passConstants[i]) },
+                .resources[0] = { s_srcBuffer, bufferSize },
+                .uavs[0] = { s_dstBuffer, bufferSize },
+                .uavs[1] = { s_rwBuffer, (size_t)s_layout.totalElementCount * sizeof(int) }
+            },
+            .grid = s_layout.passes[i].grid
+        };
+    }
+
+    return true;
+}
+
+// The batches always run on the vectorized kernels, whatever the kernel mode is:
+// the results do not depend on the reduction, since the group sums wrap around.
+static bool CPUCreateBatchBuffers(const int srcData[], const int rwData[], const BatchJob jobs[], uint32_t jobCount, const BatchLayout* layout)
+{
+    if (s_verifyOnDevice)
+    {
+        fprintf(stderr, "The batches are only verified on the host!\n");
+        return false;
+    }
+
+    const size_t bufferSize = (size_t)layout->inputElementCount * sizeof(int);
+    if (!AllocateBuffers((size_t)layout->inputElementCount, (size_t)layout->totalElementCount)) return false;
+
+    if (jobCount > s_batchJobCapacity)
+    {
+        BatchJob* batchJobs = realloc(s_batchJobs, jobCount * sizeof(*jobs));
+        if (batchJobs == NULL)
+        {
+            fprintf(stderr, "Lack of memory for the job descriptor table...\n");
+            return false;
+        }
+        s_batchJobs = batchJobs;
+        s_batchJobCapacity = jobCount;
+    }
+
+    if (s_kernels == NULL) {
+        s_kernels = GetCPUKernels(GetBestCPUKernelISA());
+    }
+    s_isStreaming = bufferSize >= CPU_KERNEL_STREAMING_THRESHOLD;
+
+    memcpy(s_srcBuffer, srcData, bufferSize);
+    memcpy(s_rwBuffer, rwData, bufferSize);
+    memcpy(s_batchJobs, jobs, jobCount * sizeof(*jobs));
+    s_batchJobCount = jobCount;
+    s_batchLayout = *layout;
+
+    return true;
+}
+
+static bool CPUDispatch(ComputeTicket* pTicket)
+{
+    // A thread group never spans two jobs, so all the groups of a batch run at once
+    if (s_batchJobCount > 0)
+    {
+        ThreadPoolRun(s_threadPool, ExecuteBatchGroup, NULL, (size_t)s_batchLayout.groupCount);
+
+        *pTicket = ++s_lastTicket;
+        return true;
+    }
+
+    // Each pass consumes the partial sums of the previous one, so the passes are serialized
+    // just as the UAV barriers between the dispatches of the D3D12 backend.
+    // The bytecode kernels run every group of the grid, and ignore the ones beyond the group count themselves.
+    for (uint32_t i = 0; i < s_layout.passCount; ++i)
+    {
+        if (s_kernelMode == CPU_KERNEL_BYTECODE || s_kernelMode == CPU_KERNEL_COMPILED)
+        {
+            const DispatchGrid* grid = &s_layout.passes[i].grid;
+            ThreadPoolRun(s_threadPool, ExecuteBytecodeGroup, &s_bytecodePasses[i], (size_t)grid->x * grid->y * grid->z);
+        }
+        else
+        {
+            ThreadPoolRun(s_threadPool, s_kernelMode == CPU_KERNEL_NATIVE ? ExecuteNativeGroup : ExecuteReferenceGroup,
+                          &s_passConstants[i], (size_t)s_layout.passes[i].groupCount);
+        }
+    }
+
+    // The engine runs on the host, so the results are summarized by the CPU references of shaders/verify.hlsl
+    if (s_verifyOnDevice)
+    {
+        ReferenceElementSummary(s_dstBuffer, s_srcBuffer, s_bufferElemCount, s_passConstants[0].constantValue, &s_summaries[0]);
+        for (uint32_t i = 0; i < s_layout.passCount; ++i)
+        {
+            const ReductionPass* pass = &s_layout.passes[i];
+            ReferenceGroupSumSummary(&s_rwBuffer[pass->outputOffset], &s_rwBuffer[pass->inputOffset], (size_t)pass->elementCount,
+                                    COMPUTE_GROUP_THREAD_COUNT, &s_summaries[1 + i]);
+        }
+    }
+
+    *pTicket = ++s_lastTicket;
+    return true;
+}
+
+static bool CPUSync(ComputeTicket ticket)
+{
+    // `CPUDispatch` is synchronous, so every ticket it has handed out is already complete
+    return ticket <= s_lastTicket;
+}
+
+static bool CPUReadResults(ComputeTicket ticket, ComputeResultView* pView)
+{
+    // The host buffers only hold the results of the last dispatch
+    if (ticket != s_lastTicket || s_dstBuffer == NULL || s_rwBuffer == NULL) return false;
+
+    if (s_verifyOnDevice)
+    {
+        pView->summaries = s_summaries;
+        pView->summaryCount = 1 + s_layout.passCount;
+        return true;
+    }
+
+    // The engine writes the host buffers directly, so they are handed out as they are
+    pView->dstResult = s_dstBuffer;
+    pView->rwResult = s_rwBuffer;
+    return true;
+}
+
+static void CPUReleaseResults(ComputeResultView* pView)
+{
+    *pView = (ComputeResultView){ 0 };
+}
+
+static void CPURelease(void)
+{
+    if (s_threadPool != NULL)
+    {
+        DestroyThreadPool(s_threadPool);
+        s_threadPool = NULL;
+    }
+
+    FreeBuffers();
+    free(s_batchJobs);
+    s_batchJobs = NULL;
+    s_batchJobCount = 0;
+    s_batchJobCapacity = 0;
+    s_batchLayout = (BatchLayout){ 0 };
+
+    DestroyShaderProgram(s_shaderProgram);
+    s_shaderProgram = NULL;
+    ReleaseCompiledShader(s_compiledShader);
+    s_compiledShader = NULL;
+    CloseShaderAssetFile(s_shaderFile);
+    s_shaderFile = NULL;
+    CloseShaderAssetFile(s_shaderArchive);
+    s_shaderArchive = NULL;
+
+    memset(&s_layout, 0, sizeof(s_layout));
+    memset(s_bytecodePasses, 0, sizeof(s_bytecodePasses));
+    s_kernels = NULL;
+    s_lastTicket = 0;
+}
+
+void SetCPUEngineReductionMode(ComputeReductionMode mode, uint32_t waveLaneCount)
+{
+    s_reductionMode = mode;
+    s_waveLaneCount = waveLaneCount > 0 ? waveLaneCount : CPU_EMULATED_WAVE_LANES;
+}
+
+void SetCPUEngineKernelMode(CPUKernelMode mode, uint32_t laneCount)
+{
+    s_kernelMode = mode;
+    s_interpreterLaneCount = laneCount > 0 ? laneCount : CPU_INTERPRETER_LANE_COUNT;
+}
+
+void SetCPUEngineKernelISA(CPUKernelISA isa)
+{
+    s_kernelISA = isa;
+}
+
+void SetCPUEngineDeviceVerification(bool enabled)
+{
+    s_verifyOnDevice = enabled;
+}
+
+const ComputeBackend* GetCPUComputeBackend(void)
+{
+    static const ComputeBackend backend = {
+        .name = "CPU",
+        // The next job overwrites the buffers that the results are read from
+        .inFlightJobCount = 1,
+        .Init = CPUInit,
+        .CreateBuffers = CPUCreateBuffers,
+        .CreateBatchBuffers = CPUCreateBatchBuffers,
+        .Dispatch = CPUDispatch,
+        .Sync = CPUSync,
+        .ReadResults = CPUReadResults,
+        .ReleaseResults = CPUReleaseResults,
+        .Release = CPURelease
+    };
+    return &backend;
+}
+
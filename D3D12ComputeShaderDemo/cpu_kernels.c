@@ -0,0 +1,573 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_KERNELS_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#include <immintrin.h>
+// The AVX2 and AVX-512 kernels are compiled for their instruction set whatever the target of the build is,
+// and only called when the processor supports it
+#define TARGET_AVX2     __attribute__((target("avx2")))
+#define TARGET_AVX512   __attribute__((target("avx512f")))
+#endif // _MSC_VER
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define CPU_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+#include "cpu_kernels.h"
+#include "compute_reference.h"
+
+enum
+{
+    // The unit of the non-temporal stores
+    CACHE_LINE_SIZE = 64
+};
+
+static const char* const s_isaNames[CPU_KERNEL_ISA_COUNT] = { "scalar", "avx2", "avx512", "neon" };
+
+static uint32_t SumRange(const int values[], size_t begin, size_t end)
+{
+    uint32_t sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+        sum += (uint32_t)values[i];
+    }
+    return sum;
+}
+
+static uint32_t AddConstantAndSumRange(int dst[], const int src[], const int values[], size_t begin, size_t end, int constantValue)
+{
+    uint32_t sum = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        dst[i] = (int)((uint32_t)src[i] + (uint32_t)constantValue);
+        sum += (uint32_t)values[i];
+    }
+    return sum;
+}
+
+static int SumScalar(const int values[], size_t count)
+{
+    return (int)SumRange(values, 0, count);
+}
+
+static int AddConstantAndSumScalar(int dst[], const int src[], const int values[], size_t count, int constantValue, bool isStreaming)
+{
+    // Portable C has no non-temporal stores
+    (void)isStreaming;
+
+    return (int)AddConstantAndSumRange(dst, src, values, 0, count, constantValue);
+}
+
+static size_t CountMismatchesRange(const int actual[], const int expected[], size_t begin, size_t end, int constantValue, uint32_t* pSum)
+{
+    size_t mismatchCount = 0;
+    uint32_t sum = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        mismatchCount += (uint32_t)actual[i] != (uint32_t)expected[i] + (uint32_t)constantValue ? 1 : 0;
+        sum += (uint32_t)actual[i];
+    }
+    *pSum += sum;
+    return mismatchCount;
+}
+
+static size_t CountMismatchesScalar(const int actual[], const int expected[], size_t count, int constantValue, uint32_t* pSum)
+{
+    *pSum = 0;
+    return CountMismatchesRange(actual, expected, 0, count, constantValue, pSum);
+}
+
+// The number of elements before the first `alignment`-byte aligned element of `dst`, at most `count`
+static size_t GetAlignmentHead(const int dst[], size_t count, size_t alignment)
+{
+    const size_t head = ((alignment - (uintptr_t)dst % alignment) % alignment) / sizeof(int);
+    return head < count ? head : count;
+}
+
+#ifdef CPU_KERNELS_X86
+TARGET_AVX2 static uint32_t ReduceAVX2(__m256i v)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+TARGET_AVX2 static int SumAVX2(const int values[], size_t count)
+{
+    // 4 independent accumulators hide the latency of the additions
+    __m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+    __m256i sum2 = _mm256_setzero_si256(), sum3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        sum0 = _mm256_add_epi32(sum0, _mm256_loadu_si256((const __m256i*)(values + i)));
+        sum1 = _mm256_add_epi32(sum1, _mm256_loadu_si256((const __m256i*)(values + i + 8)));
+        sum2 = _mm256_add_epi32(sum2, _mm256_loadu_si256((const __m256i*)(values + i + 16)));
+        sum3 = _mm256_add_epi32(sum3, _mm256_loadu_si256((const __m256i*)(values + i + 24)));
+    }
+    for (; i + 8 <= count; i += 8) {
+        sum0 = _mm256_add_epi32(sum0, _mm256_loadu_si256((const __m256i*)(values + i)));
+    }
+
+    const __m256i sum = _mm256_add_epi32(_mm256_add_epi32(sum0, sum1), _mm256_add_epi32(sum2, sum3));
+    return (int)(ReduceAVX2(sum) + SumRange(values, i, count));
+}
+
+TARGET_AVX2 static int AddConstantAndSumAVX2(int dst[], const int src[], const int values[], size_t count, int constantValue, bool isStreaming)
+{
+    // The non-temporal stores need aligned addresses, so the elements before the first aligned one are added separately.
+    // Each iteration writes a whole cache line, so that the write-combining buffers are flushed as full lines.
+    size_t i = isStreaming ? GetAlignmentHead(dst, count, CACHE_LINE_SIZE) : 0;
+    uint32_t sum = AddConstantAndSumRange(dst, src, values, 0, i, constantValue);
+
+    const __m256i constant = _mm256_set1_epi32(constantValue);
+    __m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i result0 = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(src + i)), constant);
+        const __m256i result1 = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(src + i + 8)), constant);
+        if (isStreaming)
+        {
+            _mm256_stream_si256((__m256i*)(dst + i), result0);
+            _mm256_stream_si256((__m256i*)(dst + i + 8), result1);
+        }
+        else
+        {
+            _mm256_storeu_si256((__m256i*)(dst + i), result0);
+            _mm256_storeu_si256((__m256i*)(dst + i + 8), result1);
+        }
+        sum0 = _mm256_add_epi32(sum0, _mm256_loadu_si256((const __m256i*)(values + i)));
+        sum1 = _mm256_add_epi32(sum1, _mm256_loadu_si256((const __m256i*)(values + i + 8)));
+    }
+    if (isStreaming) {
+        _mm_sfence();
+    }
+
+    sum += ReduceAVX2(_mm256_add_epi32(sum0, sum1));
+    return (int)(sum + AddConstantAndSumRange(dst, src, values, i, count, constantValue));
+}
+
+// The AVX-512 horizontal sum intrinsic adds up signed integers, which may overflow, so it is reduced as two AVX2 halves
+TARGET_AVX2 static size_t CountMismatchesAVX2(const int actual[], const int expected[], size_t count, int constantValue, uint32_t* pSum)
+{
+    // The equal lanes are counted by subtracting the all-ones compare masks
+    const __m256i constant = _mm256_set1_epi32(constantValue);
+    __m256i equalCount = _mm256_setzero_si256(), sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i values = _mm256_loadu_si256((const __m256i*)(actual + i));
+        const __m256i expectedValues = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(expected + i)), constant);
+        equalCount = _mm256_sub_epi32(equalCount, _mm256_cmpeq_epi32(values, expectedValues));
+        sum = _mm256_add_epi32(sum, values);
+    }
+
+    *pSum = ReduceAVX2(sum);
+    return i - ReduceAVX2(equalCount) + CountMismatchesRange(actual, expected, i, count, constantValue, pSum);
+}
+
+TARGET_AVX512 static uint32_t ReduceAVX512(__m512i v)
+{
+    return ReduceAVX2(_mm256_add_epi32(_mm512_castsi512_si256(v), _mm512_extracti64x4_epi64(v, 1)));
+}
+
+TARGET_AVX512 static int SumAVX512(const int values[], size_t count)
+{
+    __m512i sum0 = _mm512_setzero_si512(), sum1 = _mm512_setzero_si512();
+    __m512i sum2 = _mm512_setzero_si512(), sum3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+        sum0 = _mm512_add_epi32(sum0, _mm512_loadu_si512(values + i));
+        sum1 = _mm512_add_epi32(sum1, _mm512_loadu_si512(values + i + 16));
+        sum2 = _mm512_add_epi32(sum2, _mm512_loadu_si512(values + i + 32));
+        sum3 = _mm512_add_epi32(sum3, _mm512_loadu_si512(values + i + 48));
+    }
+    for (; i + 16 <= count; i += 16) {
+        sum0 = _mm512_add_epi32(sum0, _mm512_loadu_si512(values + i));
+    }
+
+    const __m512i sum = _mm512_add_epi32(_mm512_add_epi32(sum0, sum1), _mm512_add_epi32(sum2, sum3));
+    return (int)(ReduceAVX512(sum) + SumRange(values, i, count));
+}
+
+TARGET_AVX512 static int AddConstantAndSumAVX512(int dst[], const int src[], const int values[], size_t count, int constantValue, bool isStreaming)
+{
+    size_t i = isStreaming ? GetAlignmentHead(dst, count, CACHE_LINE_SIZE) : 0;
+    uint32_t sum = AddConstantAndSumRange(dst, src, values, 0, i, constantValue);
+
+    const __m512i constant = _mm512_set1_epi32(constantValue);
+    __m512i sum0 = _mm512_setzero_si512(), sum1 = _mm512_setzero_si512();
+    for (; i + 32 <= count; i += 32)
+    {
+        const __m512i result0 = _mm512_add_epi32(_mm512_loadu_si512(src + i), constant);
+        const __m512i result1 = _mm512_add_epi32(_mm512_loadu_si512(src + i + 16), constant);
+        if (isStreaming)
+        {
+            _mm512_stream_si512((void*)(dst + i), result0);
+            _mm512_stream_si512((void*)(dst + i + 16), result1);
+        }
+        else
+        {
+            _mm512_storeu_si512(dst + i, result0);
+            _mm512_storeu_si512(dst + i + 16, result1);
+        }
+        sum0 = _mm512_add_epi32(sum0, _mm512_loadu_si512(values + i));
+        sum1 = _mm512_add_epi32(sum1, _mm512_loadu_si512(values + i + 16));
+    }
+    if (isStreaming) {
+        _mm_sfence();
+    }
+
+    sum += ReduceAVX512(_mm512_add_epi32(sum0, sum1));
+    return (int)(sum + AddConstantAndSumRange(dst, src, values, i, count, constantValue));
+}
+
+TARGET_AVX512 static size_t CountMismatchesAVX512(const int actual[], const int expected[], size_t count, int constantValue, uint32_t* pSum)
+{
+    // The lanes of the mismatches are counted up under the compare masks
+    const __m512i constant = _mm512_set1_epi32(constantValue);
+    const __m512i one = _mm512_set1_epi32(1);
+    __m512i mismatchCount = _mm512_setzero_si512(), sum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m512i values = _mm512_loadu_si512(actual + i);
+        const __m512i expectedValues = _mm512_add_epi32(_mm512_loadu_si512(expected + i), constant);
+        mismatchCount = _mm512_mask_add_epi32(mismatchCount, _mm512_cmpneq_epi32_mask(values, expectedValues), mismatchCount, one);
+        sum = _mm512_add_epi32(sum, values);
+    }
+
+    *pSum = ReduceAVX512(sum);
+    return ReduceAVX512(mismatchCount) + CountMismatchesRange(actual, expected, i, count, constantValue, pSum);
+}
+
+static void GetX86Features(bool* pHasAVX2, bool* pHasAVX512)
+{
+#ifdef _MSC_VER
+    // The OS must also save the YMM (and ZMM) registers on context switches
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+    if (maxLeaf < 7 || !hasOSXSave)
+    {
+        *pHasAVX2 = *pHasAVX512 = false;
+        return;
+    }
+
+    const uint64_t xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    *pHasAVX2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+    *pHasAVX512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+#else
+    // It also checks the OS support of the registers
+    __builtin_cpu_init();
+    *pHasAVX2 = __builtin_cpu_supports("avx2") != 0;
+    *pHasAVX512 = __builtin_cpu_supports("avx512f") != 0;
+#endif // _MSC_VER
+}
+#endif // CPU_KERNELS_X86
+
+#ifdef CPU_KERNELS_NEON
+static int SumNEON(const int values[], size_t count)
+{
+    uint32x4_t sum0 = vdupq_n_u32(0), sum1 = vdupq_n_u32(0);
+    uint32x4_t sum2 = vdupq_n_u32(0), sum3 = vdupq_n_u32(0);
+    const uint32_t* input = (const uint32_t*)values;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        sum0 = vaddq_u32(sum0, vld1q_u32(input + i));
+        sum1 = vaddq_u32(sum1, vld1q_u32(input + i + 4));
+        sum2 = vaddq_u32(sum2, vld1q_u32(input + i + 8));
+        sum3 = vaddq_u32(sum3, vld1q_u32(input + i + 12));
+    }
+    for (; i + 4 <= count; i += 4) {
+        sum0 = vaddq_u32(sum0, vld1q_u32(input + i));
+    }
+
+    const uint32x4_t sum = vaddq_u32(vaddq_u32(sum0, sum1), vaddq_u32(sum2, sum3));
+    return (int)(vaddvq_u32(sum) + SumRange(values, i, count));
+}
+
+static size_t CountMismatchesNEON(const int actual[], const int expected[], size_t count, int constantValue, uint32_t* pSum)
+{
+    // The equal lanes are counted by subtracting the all-ones compare masks
+    const uint32x4_t constant = vdupq_n_u32((uint32_t)constantValue);
+    uint32x4_t equalCount = vdupq_n_u32(0), sum = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t values = vld1q_u32((const uint32_t*)(actual + i));
+        const uint32x4_t expectedValues = vaddq_u32(vld1q_u32((const uint32_t*)(expected + i)), constant);
+        equalCount = vsubq_u32(equalCount, vceqq_u32(values, expectedValues));
+        sum = vaddq_u32(sum, values);
+    }
+
+    *pSum = vaddvq_u32(sum);
+    return i - vaddvq_u32(equalCount) + CountMismatchesRange(actual, expected, i, count, constantValue, pSum);
+}
+
+static int AddConstantAndSumNEON(int dst[], const int src[], const int values[], size_t count, int constantValue, bool isStreaming)
+{
+    // NEON has no non-temporal store intrinsic (STNP is only reachable from assembly), so all the stores are regular ones
+    (void)isStreaming;
+
+    const uint32x4_t constant = vdupq_n_u32((uint32_t)constantValue);
+    uint32x4_t sum0 = vdupq_n_u32(0), sum1 = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u32((uint32_t*)(dst + i), vaddq_u32(vld1q_u32((const uint32_t*)(src + i)), constant));
+        vst1q_u32((uint32_t*)(dst + i + 4), vaddq_u32(vld1q_u32((const uint32_t*)(src + i + 4)), constant));
+        sum0 = vaddq_u32(sum0, vld1q_u32((const uint32_t*)(values + i)));
+        sum1 = vaddq_u32(sum1, vld1q_u32((const uint32_t*)(values + i + 4)));
+    }
+
+    const uint32_t sum = vaddvq_u32(vaddq_u32(sum0, sum1));
+    return (int)(sum + AddConstantAndSumRange(dst, src, values, i, count, constantValue));
+}
+#endif // CPU_KERNELS_NEON
+
+const CPUKernels* GetCPUKernels(CPUKernelISA isa)
+{
+    static const CPUKernels scalarKernels = {
+        .name = "portable C",
+        .Sum = SumScalar,
+        .AddConstantAndSum = AddConstantAndSumScalar,
+        .CountMismatches = CountMismatchesScalar
+    };
+
+    switch (isa)
+    {
+    case CPU_KERNEL_ISA_SCALAR:
+        return &scalarKernels;
+
+#ifdef CPU_KERNELS_X86
+    case CPU_KERNEL_ISA_AVX2:
+    case CPU_KERNEL_ISA_AVX512:
+    {
+        static const CPUKernels avx2Kernels = {
+            .name = "AVX2",
+            .Sum = SumAVX2,
+            .AddConstantAndSum = AddConstantAndSumAVX2,
+            .CountMismatches = CountMismatchesAVX2
+        };
+        static const CPUKernels avx512Kernels = {
+            .name = "AVX-512",
+            .Sum = SumAVX512,
+            .AddConstantAndSum = AddConstantAndSumAVX512,
+            .CountMismatches = CountMismatchesAVX512
+        };
+
+        bool hasAVX2, hasAVX512;
+        GetX86Features(&hasAVX2, &hasAVX512);
+        if (isa == CPU_KERNEL_ISA_AVX2) return hasAVX2 ? &avx2Kernels : NULL;
+        return hasAVX512 ? &avx512Kernels : NULL;
+    }
+#endif // CPU_KERNELS_X86
+
+#ifdef CPU_KERNELS_NEON
+    case CPU_KERNEL_ISA_NEON:
+    {
+        // NEON is part of the ARM64 baseline
+        static const CPUKernels neonKernels = {
+            .name = "NEON",
+            .Sum = SumNEON,
+            .AddConstantAndSum = AddConstantAndSumNEON,
+            .CountMismatches = CountMismatchesNEON
+        };
+        return &neonKernels;
+    }
+#endif // CPU_KERNELS_NEON
+
+    default:
+        return NULL;
+    }
+}
+
+CPUKernelISA GetBestCPUKernelISA(void)
+{
+    for (int isa = CPU_KERNEL_ISA_COUNT - 1; isa > CPU_KERNEL_ISA_SCALAR; --isa) {
+        if (GetCPUKernels((CPUKernelISA)isa) != NULL) return (CPUKernelISA)isa;
+    }
+    return CPU_KERNEL_ISA_SCALAR;
+}
+
+bool FindCPUKernelISA(const char* name, CPUKernelISA* pISA)
+{
+    for (int isa = 0; isa < CPU_KERNEL_ISA_COUNT; ++isa)
+    {
+        if (strcmp(name, s_isaNames[isa]) == 0)
+        {
+            *pISA = (CPUKernelISA)isa;
+            return true;
+        }
+    }
+    return false;
+}
+
+static double GetTimeInSeconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// The buffers of the kernel benchmark
+typedef struct KernelBenchmark
+{
+    const int* src;
+    const int* values;
+    int* dst;
+    int* sums;
+    const int* expectedSums;
+    size_t elemCount;
+    size_t groupSize;
+    size_t groupCount;
+    int constantValue;
+    bool isStreaming;
+} KernelBenchmark;
+
+// Run the fused first pass or the sum over all the groups, and return the elapsed time
+static double RunKernelPass(const KernelBenchmark* benchmark, const CPUKernels* kernels, bool isFused)
+{
+    const double beginTime = GetTimeInSeconds();
+    for (size_t g = 0; g < benchmark->groupCount; ++g)
+    {
+        const size_t first = g * benchmark->groupSize;
+        const size_t count = benchmark->elemCount - first < benchmark->groupSize ? benchmark->elemCount - first : benchmark->groupSize;
+        benchmark->sums[g] = isFused ?
+            kernels->AddConstantAndSum(benchmark->dst + first, benchmark->src + first, benchmark->values + first, count,
+                                        benchmark->constantValue, benchmark->isStreaming) :
+            kernels->Sum(benchmark->values + first, count);
+    }
+    return GetTimeInSeconds() - beginTime;
+}
+
+// Check the group sums against the CPU reference, and the destination elements after the fused pass
+static bool CheckKernelPass(const KernelBenchmark* benchmark, bool isFused)
+{
+    for (size_t i = 0; isFused && i < benchmark->elemCount; ++i)
+    {
+        if (benchmark->dst[i] != (int)((uint32_t)benchmark->src[i] + (uint32_t)benchmark->constantValue))
+        {
+            printf("%zu index elements are not equal!\n", i);
+            return false;
+        }
+    }
+    for (size_t g = 0; g < benchmark->groupCount; ++g)
+    {
+        if (benchmark->sums[g] != benchmark->expectedSums[g])
+        {
+            printf("Group %zu: %d (%d) are not equal!\n", g, benchmark->sums[g], benchmark->expectedSums[g]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BenchmarkCPUKernels(size_t elemCount, size_t groupSize, uint32_t iterationCount)
+{
+    const int constantValue = 1;
+    const size_t groupCount = (elemCount + groupSize - 1) / groupSize;
+    int* src = malloc(elemCount * sizeof(int));
+    int* values = malloc(elemCount * sizeof(int));
+    int* dst = malloc(elemCount * sizeof(int));
+    int* sums = malloc(groupCount * sizeof(int));
+    int* expectedSums = malloc(groupCount * sizeof(int));
+    int* sharedBuffer = malloc(groupSize * sizeof(int));
+
+    bool succeeded = false;
+    do
+    {
+        if (src == NULL || values == NULL || dst == NULL || sums == NULL || expectedSums == NULL || sharedBuffer == NULL)
+        {
+            fprintf(stderr, "Lack of memory for the kernel benchmark buffers...\n");
+            break;
+        }
+
+        // Each element of `values` is the 1-based index of the group it belongs to, just as the second source buffer of the job
+        for (size_t i = 0; i < elemCount; ++i)
+        {
+            src[i] = (int)(i + 1);
+            values[i] = (int)(i / groupSize + 1);
+        }
+
+        // The expected sums come from the tree reduction of shaders/compute.hlsl, over groups padded with zeros
+        for (size_t g = 0; g < groupCount; ++g)
+        {
+            const size_t first = g * groupSize;
+            const size_t count = elemCount - first < groupSize ? elemCount - first : groupSize;
+            memcpy(sharedBuffer, values + first, count * sizeof(int));
+            memset(sharedBuffer + count, 0, (groupSize - count) * sizeof(int));
+            expectedSums[g] = ReferenceGroupSumTree(sharedBuffer, groupSize);
+        }
+
+        const KernelBenchmark benchmark = {
+            .src = src,
+            .values = values,
+            .dst = dst,
+            .sums = sums,
+            .expectedSums = expectedSums,
+            .elemCount = elemCount,
+            .groupSize = groupSize,
+            .groupCount = groupCount,
+            .constantValue = constantValue,
+            .isStreaming = elemCount * sizeof(int) >= CPU_KERNEL_STREAMING_THRESHOLD
+        };
+        printf("Benchmarking the CPU kernels over %zu elements in groups of %zu on one thread%s...\n",
+            elemCount, groupSize, benchmark.isStreaming ? " with non-temporal stores" : "");
+
+        succeeded = true;
+        for (int isa = 0; isa < CPU_KERNEL_ISA_COUNT; ++isa)
+        {
+            const CPUKernels* kernels = GetCPUKernels((CPUKernelISA)isa);
+            if (kernels == NULL) continue;
+
+            // The first run of each pass is checked, and also warms the buffers up
+            RunKernelPass(&benchmark, kernels, true);
+            succeeded = CheckKernelPass(&benchmark, true);
+            RunKernelPass(&benchmark, kernels, false);
+            succeeded = succeeded && CheckKernelPass(&benchmark, false);
+            if (!succeeded)
+            {
+                printf("The %s kernels are wrong!\n", kernels->name);
+                break;
+            }
+
+            double fusedTime = 0.0, sumTime = 0.0;
+            for (uint32_t i = 0; i < iterationCount; ++i)
+            {
+                fusedTime += RunKernelPass(&benchmark, kernels, true);
+                sumTime += RunKernelPass(&benchmark, kernels, false);
+            }
+
+            // The fused pass reads `src` and `values` and writes `dst`, while the sum only reads `values`
+            const double bytes = (double)elemCount * sizeof(int) * iterationCount;
+            printf("%-8s add + sum: %7.2f GB/s, sum: %7.2f GB/s\n", kernels->name, 3.0 * bytes / fusedTime * 1e-9, bytes / sumTime * 1e-9);
+        }
+    }
+    while (false);
+
+    free(src);
+    free(values);
+    free(dst);
+    free(sums);
+    free(expectedSums);
+    free(sharedBuffer);
+
+    return succeeded;
+}
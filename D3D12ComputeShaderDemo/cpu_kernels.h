@@ -0,0 +1,68 @@
+#ifndef CPU_KERNELS_H
+#define CPU_KERNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The output size from which the kernels write with non-temporal stores,
+    // so that an output that does not fit in the last-level cache does not evict the inputs
+    CPU_KERNEL_STREAMING_THRESHOLD = 16 * 1024 * 1024
+};
+
+// The instruction sets that the vectorized kernels are implemented with
+typedef enum CPUKernelISA
+{
+    // Portable C, vectorized by the compiler for the baseline of the target
+    CPU_KERNEL_ISA_SCALAR,
+
+    // x86 AVX2, 8 elements per instruction
+    CPU_KERNEL_ISA_AVX2,
+
+    // x86 AVX-512F, 16 elements per instruction
+    CPU_KERNEL_ISA_AVX512,
+
+    // ARM64 NEON (Advanced SIMD), 4 elements per instruction
+    CPU_KERNEL_ISA_NEON,
+
+    CPU_KERNEL_ISA_COUNT
+} CPUKernelISA;
+
+// The C implementations of the two operations of `CSMain`.
+// All the additions wrap around in 32-bit two's complement just as the HLSL int addition,
+// so the sums are bit-exact with both of the group reductions of the GPU kernels.
+typedef struct CPUKernels
+{
+    // The readable name of the instruction set
+    const char* name;
+
+    // Return the sum of `values[0, count)`
+    int (*Sum)(const int values[], size_t count);
+
+    // The first pass of `CSMain` fused into a single sweep: dst[i] = src[i] + constantValue,
+    // and return the sum of `values[0, count)`.
+    // `isStreaming` writes `dst` with non-temporal stores, which are ordered before the return.
+    int (*AddConstantAndSum)(int dst[], const int src[], const int values[], size_t count, int constantValue, bool isStreaming);
+
+    // Return the number of the elements where actual[i] != expected[i] + constantValue, with `count` less than 2^32.
+    // `pSum` receives the sum of `actual[0, count)`.
+    size_t (*CountMismatches)(const int actual[], const int expected[], size_t count, int constantValue, uint32_t* pSum);
+} CPUKernels;
+
+// Get the kernels of `isa`, or NULL if neither the build nor the current processor supports them
+extern const CPUKernels* GetCPUKernels(CPUKernelISA isa);
+
+// Get the widest instruction set that the current processor supports
+extern CPUKernelISA GetBestCPUKernelISA(void);
+
+// Find an instruction set by its name, e.g. "avx2". Returns false if the name is unknown.
+extern bool FindCPUKernelISA(const char* name, CPUKernelISA* pISA);
+
+// Measure the throughput of the kernels of every supported instruction set on one thread,
+// over `elemCount` elements in groups of `groupSize` (a power of 2), and print it in GB/s.
+// The results of each of them are checked against the CPU references of the group reductions.
+extern bool BenchmarkCPUKernels(size_t elemCount, size_t groupSize, uint32_t iterationCount);
+
+#endif // CPU_KERNELS_H
@@ -0,0 +1,2715 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdalign.h>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <d3dcompiler.h>
+#include <dxgi1_4.h>
+
+#include "compute_backend.h"
+#include "adapter_selector.h"
+#include "d3d12_heap_arena.h"
+#include "d3d12_readback_pool.h"
+#include "pipeline_cache.h"
+#include "shader_asset.h"
+#include "shader_reflection.h"
+#include "root_signature_layout.h"
+#include "queue_scheduler.h"
+#include "ring_allocator.h"
+#include "reduction_layout.h"
+#include "resource_state_tracker.h"
+#include "d3d12_descriptor_allocator.h"
+
+enum
+{
+    // Max number of hardware adapter count
+    MAX_HARDWARE_ADAPTER_COUNT = 16,
+
+    // The size of the upload ring shared by all the host-to-device transfers
+    UPLOAD_RING_SIZE = 16 * 1024 * 1024,
+
+    // The max size of one upload copy, so that a large transfer never needs the whole ring at once
+    UPLOAD_CHUNK_SIZE = UPLOAD_RING_SIZE / 4,
+
+    // The max size of the descriptor table of the kernels: room for the SRV of the source buffer and the UAVs of the two destination buffers.
+    // Only the buffers that the root signature puts into a descriptor table, or that a bindless kernel indexes, have a descriptor.
+    KERNEL_TABLE_DESCRIPTOR_COUNT = 3,
+
+    // The descriptors of the shader-visible ring that the descriptor tables of the jobs are copied into
+    DESCRIPTOR_RING_SIZE = 4096,
+
+    // The size of the constants of one pass in 32-bit values, which are inlined as root constants if the root signature allows
+    PASS_CONSTANTS_DWORD_COUNT = sizeof(ReductionPassConstants) / sizeof(uint32_t),
+
+    // The size of the ring of the pass constants that are bound as root CBVs instead
+    CONSTANT_RING_SIZE = 256 * 1024,
+
+    // The resident threads per SIMD lane of the grid-stride kernel, i.e. enough waves in flight to hide the memory latency
+    GRID_STRIDE_THREADS_PER_LANE = 8,
+
+    // The resident group count of the grid-stride kernel when the device does not report its lane count
+    GRID_STRIDE_DEFAULT_GROUP_COUNT = 256,
+
+    // The size of the constants of a batch in 32-bit values, which are always inlined as root constants
+    BATCH_CONSTANTS_DWORD_COUNT = sizeof(BatchConstants) / sizeof(uint32_t),
+
+    // The max length of the file paths built by the backend
+    MAX_FILE_PATH_LENGTH = 512
+};
+
+// The buffers that the kernels bind
+typedef enum KernelBuffer
+{
+    // b0, the constants of the current pass, in root constants or else a root CBV
+    KERNEL_BUFFER_CONSTANTS,
+
+    // t0, the source buffer
+    KERNEL_BUFFER_SOURCE,
+
+    // u0, the destination buffer
+    KERNEL_BUFFER_DESTINATION,
+
+    // u1, the second destination buffer
+    KERNEL_BUFFER_DESTINATION2,
+
+    KERNEL_BUFFER_COUNT
+} KernelBuffer;
+
+// The buffers that the batch kernel binds. They are all bound in the root arguments.
+typedef enum BatchBuffer
+{
+    // b0, the constants of the batch
+    BATCH_BUFFER_CONSTANTS,
+
+    // t0, the packed inputs
+    BATCH_BUFFER_SOURCE,
+
+    // t1, the job descriptor table
+    BATCH_BUFFER_JOBS,
+
+    // u0, the destination buffer
+    BATCH_BUFFER_DESTINATION,
+
+    // u1, the second destination buffer
+    BATCH_BUFFER_DESTINATION2,
+
+    BATCH_BUFFER_COUNT
+} BatchBuffer;
+
+// Where a buffer of the kernels is bound in the root signature
+typedef struct KernelBufferBinding
+{
+    // Indicate whether the kernel declares the buffer at all
+    bool isBound;
+
+    // Indicate whether the buffer is a root descriptor, or else a descriptor of a descriptor table
+    bool isRootDescriptor;
+
+    uint32_t parameterIndex;
+
+    // The position of the descriptor of the buffer in the descriptor table,
+    // or of its descriptor heap index in the root constants of a bindless kernel
+    uint32_t tableOffset;
+
+    // Indicate whether the kernel declares the buffer as a (RW)ByteAddressBuffer, whose descriptor is a raw view
+    bool isRawBuffer;
+} KernelBufferBinding;
+
+// The per-job objects of one of the jobs that can be in flight at the same time.
+// Each slot owns the device buffers of its job, so the uploads of job k+1 can overlap the kernels of job k
+// and the read-back of job k-1 on the other queues.
+typedef struct InFlightSlot
+{
+    // The command allocator object of each queue
+    ID3D12CommandAllocator* allocators[COMPUTE_QUEUE_TYPE_COUNT];
+
+    // The destination buffer object with unordered access view type
+    ID3D12Resource* dstDataBuffer;
+
+    // The source buffer object with shader source view type
+    ID3D12Resource* srcDataBuffer;
+
+    // The second destination buffer object with unordered access view type
+    ID3D12Resource* dst2Buffer;
+
+    // The constants of each pass, which are set in the root arguments of its dispatch
+    ReductionPassConstants passConstants[MAX_REDUCTION_PASS_COUNT];
+
+    // The persistent descriptors of the buffers that the root signature puts into a descriptor table
+    D3D12StagedDescriptor descriptors[KERNEL_BUFFER_COUNT];
+
+    // The pass layout of the hierarchical group sum over the second destination buffer.
+    // A batch has no reduction pass, and only the element counts of its buffers are set.
+    ReductionLayout layout;
+
+    // The element count of the second destination buffer
+    uint64_t rwElementCount;
+
+    // The job descriptor table of a batch, with room for `jobCapacity` jobs
+    ID3D12Resource* jobBuffer;
+    uint32_t jobCapacity;
+
+    // The job count of the batch of the slot, or 0 if the slot holds a single job
+    uint32_t batchJobCount;
+
+    // The constants and the grid of the single dispatch of the batch
+    BatchConstants batchConstants;
+    DispatchGrid batchGrid;
+
+    // The read-back buffer that fetches the result from the destination buffer,
+    // or the summary records if the results are verified on the device
+    ReadbackSlice readBackSlice;
+
+    // The read-back buffer that fetches the result from the second destination buffer
+    ReadbackSlice readBackSlice2;
+} InFlightSlot;
+
+// The factory used to create D3D12 devices
+static IDXGIFactory4* s_factory;
+
+// The compatible D3D12 device object
+static ID3D12Device *s_device;
+
+// The root signature for compute pipeline state object
+static ID3D12RootSignature *s_computeRootSignature;
+
+// The compute pipeline state object
+static ID3D12PipelineState *s_computeState;
+
+// The pipeline state object of the on-device verification, which shares `s_computeRootSignature`
+static ID3D12PipelineState* s_verifyState;
+
+// The persistent descriptors of the buffers, and the shader-visible ring that the descriptor tables are copied into
+static D3D12DescriptorAllocator* s_descriptorAllocator;
+
+// The arena that sub-allocates all the buffer objects from a few large heaps
+static D3D12HeapArena* s_heapArena;
+
+// The persistently mapped upload buffer shared by all the host-to-device transfers
+static ID3D12Resource* s_uploadRingBuffer;
+
+// The host address of `s_uploadRingBuffer`
+static uint8_t* s_uploadRingData;
+
+// The sub-allocator of `s_uploadRingBuffer`
+static RingAllocator s_uploadRing;
+
+// The persistently mapped upload buffer of the pass constants that do not fit into root constants, which are bound as root CBVs.
+// Its space is reclaimed once the kernels of the job have completed. It is only created for such kernels.
+static ID3D12Resource* s_constantRingBuffer;
+
+// The host address of `s_constantRingBuffer`
+static uint8_t* s_constantRingData;
+
+// The sub-allocator of `s_constantRingBuffer`
+static RingAllocator s_constantRing;
+
+// The command queue object of each queue type
+static ID3D12CommandQueue* s_commandQueues[COMPUTE_QUEUE_TYPE_COUNT];
+
+// The command list object of each queue type
+static ID3D12GraphicsCommandList* s_commandLists[COMPUTE_QUEUE_TYPE_COUNT];
+
+// The buffer states of each command list while it is recorded
+static ResourceStateTracker s_stateTrackers[COMPUTE_QUEUE_TYPE_COUNT];
+
+// Indicate whether each command list is open for recording
+static bool s_commandListOpen[COMPUTE_QUEUE_TYPE_COUNT];
+
+// The fence object signaled by each queue
+static ID3D12Fence* s_fences[COMPUTE_QUEUE_TYPE_COUNT];
+
+// Win32 API event handle
+static HANDLE s_hEvent;
+
+// Chain the upload, compute and read-back stages of the jobs across the queues.
+// Every fence has a monotonic timeline, and the values of the read-back fence are the tickets of the jobs.
+static QueueScheduler s_scheduler;
+
+// Indicate whether the specified D3D device supports root signature version 1.1 or not
+static bool s_supportSignatureVersion1_1;
+
+// Indicate whether the specified D3D device supports HLSL 6.0 wave operations or not
+static bool s_supportWaveOps;
+
+// The minimum wave lane count of the specified D3D device
+static UINT s_minWaveLanes = 64;
+
+// The total SIMD lane count of the specified D3D device, or 0 if the driver does not report it
+static UINT s_totalLaneCount;
+
+// Indicate whether the specified D3D device supports the SM 6.6 ResourceDescriptorHeap indexing or not
+static bool s_supportBindless;
+
+// Indicate whether the bindless kernels may be used on a device that supports them
+static bool s_allowBindless = true;
+
+// Indicate whether the grid-stride kernel is requested, and its resident group count (0 sizes it to the adapter)
+static bool s_allowGridStride;
+static uint32_t s_requestedResidentGroupCount;
+
+// Indicate whether the selected kernel is the grid-stride one, which runs `s_residentGroupCount` groups per pass
+static bool s_isGridStride;
+static uint32_t s_residentGroupCount;
+
+// Indicate whether the raw-buffer kernel is requested, and whether it is the selected kernel
+static bool s_allowRawBuffers;
+static bool s_isRawBufferKernel;
+
+// The group reduction strategy used by the compute pipeline state object
+static ComputeReductionMode s_reductionMode = COMPUTE_REDUCTION_TREE;
+
+// The pool of the persistently mapped read-back buffers
+static D3D12ReadbackPool* s_readbackPool;
+
+// The command recording, buffer and read-back objects of each job in flight
+static InFlightSlot s_inFlightSlots[COMPUTE_MAX_IN_FLIGHT_JOB_COUNT];
+
+// The slot that the current job is recorded in
+static uint32_t s_currentSlot;
+
+// Indicate whether the heap arena statistics should be printed by the next dispatch
+static bool s_printHeapArenaStats;
+
+// The adapter selection set on the command line, or NULL to use the `D3D12_ADAPTER` environment variable
+static const char* s_adapterSelection;
+
+// The bytecode of the selected compute shader, which points into the mapping of its shader asset file
+static D3D12_SHADER_BYTECODE s_computeShader;
+
+// The reflection of `s_computeShader`
+static ShaderReflection s_computeReflection;
+
+// The root signature generated from `s_computeReflection`
+static RootSignatureLayout s_rootSignatureLayout;
+
+// The root parameters of the buffers of the kernels
+static KernelBufferBinding s_kernelBufferBindings[KERNEL_BUFFER_COUNT];
+
+// The mapped shader archive, or NULL if there is none
+static ShaderAssetFile* s_shaderArchive;
+
+// The mapped compiled shader object of the compute shader when it is not found in the shader archive
+static ShaderAssetFile* s_shaderObjectFile;
+
+// The key of the pipeline cache file, i.e. the selected adapter, its driver and the compute shader
+static PipelineCacheKey s_pipelineCacheKey;
+
+// The root signature and pipeline state blobs loaded from the pipeline cache file, or built in this run
+static PipelineCacheEntry s_pipelineCache;
+
+// Indicate whether `s_pipelineCache` holds blobs that the cache file does not have yet
+static bool s_pipelineCacheDirty;
+
+// The path of the pipeline cache file, empty if the cache is disabled
+static char s_pipelineCachePath[MAX_FILE_PATH_LENGTH];
+
+// Indicate whether the results are verified by shaders/verify.hlsl, so that only its summary records are read back
+static bool s_verifyOnDevice;
+
+// The mapped compiled shader object of the verification shader when it is not found in the shader archive
+static ShaderAssetFile* s_verifyShaderFile;
+
+// The root signature and the pipeline state object of shaders/compute_batch.hlsl, created by the first batch
+static ID3D12RootSignature* s_batchRootSignature;
+static ID3D12PipelineState* s_batchState;
+
+// The root signature layout of the batch kernel, and the root parameter of each of its buffers
+static RootSignatureLayout s_batchRootSignatureLayout;
+static uint32_t s_batchParameterIndices[BATCH_BUFFER_COUNT];
+
+// The mapped compiled shader object of the batch kernel when it is not found in the shader archive
+static ShaderAssetFile* s_batchShaderFile;
+
+
+static void TransWStrToString(char dstBuf[], const WCHAR srcBuf[])
+{
+    if (dstBuf == NULL || srcBuf == NULL) return;
+
+    const int len = WideCharToMultiByte(CP_UTF8, 0, srcBuf, -1, NULL, 0, NULL, NULL);
+    WideCharToMultiByte(CP_UTF8, 0, srcBuf, -1, dstBuf, len, NULL, NULL);
+    dstBuf[len] = '\0';
+}
+
+// Map the validated `kernel` from the shader archive if it has an up-to-date copy of it,
+// or else from its own compiled shader object file into `*ppObjectFile`, which replaces the file it held before.
+// The bytecode is not copied.
+static D3D12_SHADER_BYTECODE LoadCompiledShaderObject(ShaderKernel kernel, ShaderAssetFile** ppObjectFile)
+{
+    D3D12_SHADER_BYTECODE result = { 0 };
+    ShaderBytecode bytecode = { 0 };
+
+    if (LoadShaderKernel(s_shaderArchive, kernel, ppObjectFile, &bytecode))
+    {
+        result.pShaderBytecode = bytecode.data;
+        result.BytecodeLength = bytecode.size;
+    }
+    return result;
+}
+
+static bool QueryDeviceSupportedMaxFeatureLevel(void)
+{
+    const D3D_FEATURE_LEVEL requestedLevels[] = {
+        D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_11_1,
+        D3D_FEATURE_LEVEL_12_0, D3D_FEATURE_LEVEL_12_1, D3D_FEATURE_LEVEL_12_2
+    };
+    D3D12_FEATURE_DATA_FEATURE_LEVELS featureLevels = {
+        .NumFeatureLevels = sizeof(requestedLevels) / sizeof(requestedLevels[0]),
+        .pFeatureLevelsRequested = requestedLevels
+    };
+
+    auto const hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_FEATURE_LEVELS, &featureLevels, sizeof(featureLevels));
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_FEATURE_LEVELS` failed: %ld\n", hRes);
+        return false;
+    }
+
+    const D3D_FEATURE_LEVEL maxFeatureLevel = featureLevels.MaxSupportedFeatureLevel;
+
+    char strBuf[32] = { '\0' };
+    switch (maxFeatureLevel)
+    {
+    case D3D_FEATURE_LEVEL_1_0_CORE:
+        strcpy_s(strBuf, sizeof(strBuf), "1.0 core");
+        break;
+
+    case D3D_FEATURE_LEVEL_9_1:
+        strcpy_s(strBuf, sizeof(strBuf), "9.1");
+        break;
+
+    case D3D_FEATURE_LEVEL_9_2:
+        strcpy_s(strBuf, sizeof(strBuf), "9.2");
+        break;
+
+    case D3D_FEATURE_LEVEL_9_3:
+        strcpy_s(strBuf, sizeof(strBuf), "9.3");
+        break;
+
+    case D3D_FEATURE_LEVEL_10_0:
+        strcpy_s(strBuf, sizeof(strBuf), "10.0");
+        break;
+
+    case D3D_FEATURE_LEVEL_10_1:
+        strcpy_s(strBuf, sizeof(strBuf), "10.1");
+        break;
+
+    case D3D_FEATURE_LEVEL_11_0:
+        strcpy_s(strBuf, sizeof(strBuf), "11.0");
+        break;
+
+    case D3D_FEATURE_LEVEL_11_1:
+        strcpy_s(strBuf, sizeof(strBuf), "11.1");
+        break;
+
+    case D3D_FEATURE_LEVEL_12_0:
+        strcpy_s(strBuf, sizeof(strBuf), "12.0");
+        break;
+
+    case D3D_FEATURE_LEVEL_12_1:
+        strcpy_s(strBuf, sizeof(strBuf), "12.1");
+        break;
+
+    case D3D_FEATURE_LEVEL_12_2:
+        strcpy_s(strBuf, sizeof(strBuf), "12.2");
+        break;
+
+    default:
+        break;
+    }
+
+    printf("Current device supports max feature level: %s\n", strBuf);
+    return true;
+}
+
+// Describe `adapter` for the adapter selection without printing anything.
+// With `probeCapabilities`, a temporary device is created to query the capabilities that the adapter is scored by.
+static void GetAdapterInfo(IDXGIAdapter1* adapter, bool probeCapabilities, AdapterInfo* pInfo)
+{
+    *pInfo = (AdapterInfo){ 0 };
+
+    DXGI_ADAPTER_DESC1 adapterDesc = { 0 };
+    HRESULT hRes = adapter->lpVtbl->GetDesc1(adapter, &adapterDesc);
+    if (FAILED(hRes)) return;
+
+    pInfo->vendorId = adapterDesc.VendorId;
+    pInfo->deviceId = adapterDesc.DeviceId;
+    pInfo->luid = ((uint64_t)(uint32_t)adapterDesc.AdapterLuid.HighPart << 32) | adapterDesc.AdapterLuid.LowPart;
+    pInfo->dedicatedVideoMemory = adapterDesc.DedicatedVideoMemory;
+    pInfo->dedicatedSystemMemory = adapterDesc.DedicatedSystemMemory;
+    pInfo->sharedSystemMemory = adapterDesc.SharedSystemMemory;
+    pInfo->isSoftware = (adapterDesc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) != 0;
+
+    if (!probeCapabilities)
+    {
+        // An explicit selection is checked by the creation of the device itself
+        pInfo->isSupported = true;
+        return;
+    }
+
+    ID3D12Device* device = NULL;
+    hRes = D3D12CreateDevice((IUnknown*)adapter, D3D_FEATURE_LEVEL_12_0, &IID_ID3D12Device, (void**)&device);
+    if (FAILED(hRes)) return;
+
+    pInfo->isSupported = true;
+    pInfo->featureLevel = D3D_FEATURE_LEVEL_12_0;
+
+    const D3D_FEATURE_LEVEL requestedLevels[] = { D3D_FEATURE_LEVEL_12_0, D3D_FEATURE_LEVEL_12_1, D3D_FEATURE_LEVEL_12_2 };
+    D3D12_FEATURE_DATA_FEATURE_LEVELS featureLevels = {
+        .NumFeatureLevels = sizeof(requestedLevels) / sizeof(requestedLevels[0]),
+        .pFeatureLevelsRequested = requestedLevels
+    };
+    hRes = device->lpVtbl->CheckFeatureSupport(device, D3D12_FEATURE_FEATURE_LEVELS, &featureLevels, sizeof(featureLevels));
+    if (SUCCEEDED(hRes)) {
+        pInfo->featureLevel = (uint32_t)featureLevels.MaxSupportedFeatureLevel;
+    }
+
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { .HighestShaderModel = D3D_HIGHEST_SHADER_MODEL };
+    hRes = device->lpVtbl->CheckFeatureSupport(device, D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel));
+    if (SUCCEEDED(hRes)) {
+        pInfo->shaderModel = (uint32_t)shaderModel.HighestShaderModel;
+    }
+
+    // Wave operations also require Shader Model 6.0
+    D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = { 0 };
+    hRes = device->lpVtbl->CheckFeatureSupport(device, D3D12_FEATURE_D3D12_OPTIONS1, &options1, sizeof(options1));
+    pInfo->supportsWaveOps = SUCCEEDED(hRes) && options1.WaveOps && pInfo->shaderModel >= D3D_SHADER_MODEL_6_0;
+
+    device->lpVtbl->Release(device);
+}
+
+static bool CreateD3D12Device(void)
+{
+    HRESULT hRes = S_OK;
+
+#if defined(DEBUG) || defined(_DEBUG)
+    // In debug mode
+    ID3D12Debug* debugController = NULL;
+    hRes = D3D12GetDebugInterface(&IID_ID3D12Debug, (void**)&debugController);
+    if (SUCCEEDED(hRes)) {
+        debugController->lpVtbl->EnableDebugLayer(debugController);
+    }
+    else {
+        printf("WARNING: Failed to enable debug layer: %ld\n", hRes);
+    }
+#endif // defined(DEBUG) || defined(_DEBUG)
+
+    hRes = CreateDXGIFactory1(&IID_IDXGIFactory4, (void**)&s_factory);
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "CreateDXGIFactory1 failed: %ld\n", hRes);
+        return false;
+    }
+
+    AdapterSelection selection = { .mode = ADAPTER_SELECT_BEST };
+    const char* selectionText = s_adapterSelection != NULL ? s_adapterSelection : getenv("D3D12_ADAPTER");
+    if (selectionText != NULL && !ParseAdapterSelection(selectionText, &selection)) {
+        printf("WARNING: Invalid adapter selection `%s` is ignored. So the best adapter will be used!\n", selectionText);
+    }
+
+    // Enumerate the adapters (video cards)
+    IDXGIAdapter1* hardwareAdapters[MAX_HARDWARE_ADAPTER_COUNT] = { 0 };
+    AdapterInfo adapterInfos[MAX_HARDWARE_ADAPTER_COUNT] = { 0 };
+    UINT foundAdapterCount;
+    for (foundAdapterCount = 0; foundAdapterCount < MAX_HARDWARE_ADAPTER_COUNT; ++foundAdapterCount)
+    {
+        hRes = s_factory->lpVtbl->EnumAdapters1(s_factory, foundAdapterCount, &hardwareAdapters[foundAdapterCount]);
+        if (FAILED(hRes))
+        {
+            if (hRes != DXGI_ERROR_NOT_FOUND) {
+                printf("WARNING: Some error occurred during enumerating adapters: %ld\n", hRes);
+            }
+            break;
+        }
+    }
+    if (foundAdapterCount == 0)
+    {
+        fprintf(stderr, "There are no Direct3D capable adapters found on the current platform...\n");
+        return false;
+    }
+
+    // Only the scored selections need a device of each adapter
+    const bool probeCapabilities = AdapterSelectionNeedsCapabilities(&selection);
+    for (UINT i = 0; i < foundAdapterCount; ++i) {
+        GetAdapterInfo(hardwareAdapters[i], probeCapabilities, &adapterInfos[i]);
+    }
+
+    const int selectedAdapterIndex = SelectAdapter(adapterInfos, foundAdapterCount, &selection);
+
+    DXGI_ADAPTER_DESC1 adapterDesc = { 0 };
+    hRes = selectedAdapterIndex < 0 ? E_FAIL :
+        hardwareAdapters[selectedAdapterIndex]->lpVtbl->GetDesc1(hardwareAdapters[selectedAdapterIndex], &adapterDesc);
+    if (SUCCEEDED(hRes))
+    {
+        hRes = D3D12CreateDevice((IUnknown*)hardwareAdapters[selectedAdapterIndex], D3D_FEATURE_LEVEL_12_0, &IID_ID3D12Device, (void**)&s_device);
+        if (FAILED(hRes)) {
+            fprintf(stderr, "D3D12CreateDevice failed: %ld\n", hRes);
+        }
+
+        // The cached pipelines are only valid for the same driver build
+        LARGE_INTEGER driverVersion = { 0 };
+        IDXGIAdapter1* adapter = hardwareAdapters[selectedAdapterIndex];
+        if (SUCCEEDED(adapter->lpVtbl->CheckInterfaceSupport(adapter, &IID_IDXGIDevice, &driverVersion))) {
+            s_pipelineCacheKey.driverVersion = (uint64_t)driverVersion.QuadPart;
+        }
+        s_pipelineCacheKey.adapterLuid = adapterInfos[selectedAdapterIndex].luid;
+    }
+    else if (selectedAdapterIndex < 0) {
+        fprintf(stderr, "None of the %u adapters matches the adapter selection `%s`!\n", foundAdapterCount, selectionText != NULL ? selectionText : "best");
+    }
+    else {
+        fprintf(stderr, "hardwareAdapters[%d] GetDesc1 failed: %ld\n", selectedAdapterIndex, hRes);
+    }
+
+    for (UINT i = 0; i < foundAdapterCount; ++i) {
+        hardwareAdapters[i]->lpVtbl->Release(hardwareAdapters[i]);
+    }
+    if (FAILED(hRes)) return false;
+
+    char strBuf[512] = { '\0' };
+    TransWStrToString(strBuf, adapterDesc.Description);
+
+    printf("Using adapter[%d] of %u: %s\n", selectedAdapterIndex, foundAdapterCount, strBuf);
+    printf("Adapter LUID: luid:0x%08lx:0x%08lx\n", (unsigned long)adapterDesc.AdapterLuid.HighPart, (unsigned long)adapterDesc.AdapterLuid.LowPart);
+    printf("Dedicated Video Memory: %.1f GB\n", (double)(adapterDesc.DedicatedVideoMemory) / (1024.0 * 1024.0 * 1024.0));
+    printf("Dedicated System Memory: %.1f GB\n", (double)(adapterDesc.DedicatedSystemMemory) / (1024.0 * 1024.0 * 1024.0));
+    printf("Shared System Memory: %.1f GB\n", (double)(adapterDesc.SharedSystemMemory) / (1024.0 * 1024.0 * 1024.0));
+
+    if(!QueryDeviceSupportedMaxFeatureLevel()) return false;
+
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { .HighestShaderModel = D3D_HIGHEST_SHADER_MODEL };
+    hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel));
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_SHADER_MODEL` failed: %ld\n", hRes);
+        return false;
+    }
+
+    s_pipelineCacheKey.shaderModel = (uint32_t)shaderModel.HighestShaderModel;
+
+    const int minor = shaderModel.HighestShaderModel & 0x0f;
+    const int major = shaderModel.HighestShaderModel >> 4;
+    printf("Current device support highest shader model: %d.%d\n", major, minor);
+
+    D3D12_FEATURE_DATA_ROOT_SIGNATURE rootSignature = { .HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1 };
+    hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_ROOT_SIGNATURE, &rootSignature, sizeof(rootSignature));
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_DATA_ROOT_SIGNATURE` failed: %ld\n", hRes);
+        return false;
+    }
+
+    const char* signatureVersion = "1.0";
+    switch (rootSignature.HighestVersion)
+    {
+    case D3D_ROOT_SIGNATURE_VERSION_1_0:
+    default:
+        s_supportSignatureVersion1_1 = false;
+        break;
+
+    case D3D_ROOT_SIGNATURE_VERSION_1_1:
+        signatureVersion = "1.1";
+        s_supportSignatureVersion1_1 = true;
+        break;
+    }
+    printf("Current device supports highest root signature version: %s\n", signatureVersion);
+
+    s_pipelineCacheKey.rootSignatureVersion = (uint32_t)(s_supportSignatureVersion1_1 ? D3D_ROOT_SIGNATURE_VERSION_1_1 : D3D_ROOT_SIGNATURE_VERSION_1_0);
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = { 0 };
+    hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_D3D12_OPTIONS1, &options1, sizeof(options1));
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_D3D12_OPTIONS1` failed: %ld\n", hRes);
+        return false;
+    }
+    s_totalLaneCount = options1.TotalLaneCount;
+
+    // Wave operations also require Shader Model 6.0
+    if (options1.WaveOps && shaderModel.HighestShaderModel >= D3D_SHADER_MODEL_6_0)
+    {
+        puts("Current GPU supports HLSL 6.0 wave operations!!");
+        printf("The minimum wave lane count is: %u\n", options1.WaveLaneCountMin);
+
+        s_supportWaveOps = true;
+        s_minWaveLanes = options1.WaveLaneCountMin;
+    }
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = { 0 };
+    hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_D3D12_OPTIONS` failed: %ld\n", hRes);
+        return false;
+    }
+
+    // The dynamic resources of Shader Model 6.6 also require the resource binding tier 3 and root signature version 1.1
+    if (shaderModel.HighestShaderModel >= D3D_SHADER_MODEL_6_6 && options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3 &&
+        s_supportSignatureVersion1_1)
+    {
+        puts("Current GPU supports HLSL 6.6 ResourceDescriptorHeap indexing!!");
+        s_supportBindless = true;
+    }
+
+    puts("\n================================================\n");
+
+    return true;
+}
+
+// Reflect `s_computeShader` into `s_computeReflection`.
+// Returns false if the kernel does not fit the thread group size of the host code or the layout of the pass constants.
+// The groups of the grid-stride and raw-buffer kernels may be smaller, as long as the 1024-element groups of a pass divide evenly
+// among their threads.
+static bool ReflectKernelShader(void)
+{
+    if (!ReflectShader(s_computeShader.pShaderBytecode, s_computeShader.BytecodeLength, &s_computeReflection))
+    {
+        fprintf(stderr, "The compute shader cannot be reflected!\n");
+        return false;
+    }
+
+    // The constants of each pass are filled from ReductionPassConstants
+    if (!CheckReductionPassConstantsLayout(&s_computeReflection)) return false;
+
+    const uint32_t* groupSize = s_computeReflection.threadGroupSize;
+    const uint32_t threadCount = groupSize[0] * groupSize[1] * groupSize[2];
+    const bool isSupported = s_isGridStride || s_isRawBufferKernel ? threadCount > 0 && COMPUTE_GROUP_THREAD_COUNT % threadCount == 0 :
+                                                                    threadCount == COMPUTE_GROUP_THREAD_COUNT;
+    if (!isSupported)
+    {
+        fprintf(stderr, "The compute shader has %u x %u x %u threads per group instead of %d!\n",
+                groupSize[0], groupSize[1], groupSize[2], COMPUTE_GROUP_THREAD_COUNT);
+        return false;
+    }
+
+    return true;
+}
+
+// Reflect `s_computeShader`, generate its root signature layout, and find where each buffer of the kernels is bound.
+// Returns false if the kernel does not fit the buffers and the thread group size of the host code.
+static bool ReflectComputeShader(void)
+{
+    static const struct { ShaderBindingType type; uint32_t registerIndex; } kernelRegisters[KERNEL_BUFFER_COUNT] = {
+        [KERNEL_BUFFER_CONSTANTS] = { SHADER_BINDING_CBV, 0 },
+        [KERNEL_BUFFER_SOURCE] = { SHADER_BINDING_SRV, 0 },
+        [KERNEL_BUFFER_DESTINATION] = { SHADER_BINDING_UAV, 0 },
+        [KERNEL_BUFFER_DESTINATION2] = { SHADER_BINDING_UAV, 1 }
+    };
+    static const char registerPrefixes[SHADER_BINDING_TYPE_COUNT] = { 'b', 't', 'u', 's' };
+
+    if (!ReflectKernelShader()) return false;
+
+    // The host code only creates the buffers of the kernels
+    for (uint32_t i = 0; i < s_computeReflection.bindingCount; ++i)
+    {
+        const ShaderBinding* binding = &s_computeReflection.bindings[i];
+        bool isKnown = false;
+        for (int b = 0; b < KERNEL_BUFFER_COUNT && !isKnown; ++b)
+        {
+            isKnown = binding->type == kernelRegisters[b].type && binding->registerIndex == kernelRegisters[b].registerIndex &&
+                    binding->registerSpace == 0 && binding->bindCount == 1;
+        }
+        if (!isKnown)
+        {
+            fprintf(stderr, "The compute shader binds `%s` to the unknown register %c%u, space%u!\n", binding->name,
+                    registerPrefixes[binding->type], binding->registerIndex, binding->registerSpace);
+            return false;
+        }
+    }
+
+    if (!BuildRootSignatureLayout(&s_computeReflection, &s_rootSignatureLayout))
+    {
+        fprintf(stderr, "The bindings of the compute shader do not fit into a root signature!\n");
+        return false;
+    }
+
+    // The constants of each pass are set in the root arguments if they fit, and else bound as a root CBV
+    InlineRootConstants(&s_rootSignatureLayout, 0, 0, PASS_CONSTANTS_DWORD_COUNT);
+
+    for (int b = 0; b < KERNEL_BUFFER_COUNT; ++b)
+    {
+        KernelBufferBinding* bufferBinding = &s_kernelBufferBindings[b];
+        *bufferBinding = (KernelBufferBinding){ 0 };
+        bufferBinding->isBound = FindRootSignatureBinding(&s_rootSignatureLayout, kernelRegisters[b].type, kernelRegisters[b].registerIndex, 0,
+                                                        &bufferBinding->parameterIndex, &bufferBinding->tableOffset);
+        if (!bufferBinding->isBound) continue;
+
+        // The raw buffers need raw views, which address the buffer in bytes
+        const ShaderBinding* shaderBinding = FindShaderBinding(&s_computeReflection, kernelRegisters[b].type, kernelRegisters[b].registerIndex, 0);
+        bufferBinding->isRawBuffer = shaderBinding != NULL &&
+                                    (shaderBinding->inputType == D3D_SIT_BYTEADDRESS || shaderBinding->inputType == D3D_SIT_UAV_RWBYTEADDRESS);
+
+        bufferBinding->isRootDescriptor = s_rootSignatureLayout.parameters[bufferBinding->parameterIndex].type != ROOT_PARAMETER_DESCRIPTOR_TABLE;
+        if (!bufferBinding->isRootDescriptor && (b == KERNEL_BUFFER_CONSTANTS || bufferBinding->tableOffset >= KERNEL_TABLE_DESCRIPTOR_COUNT))
+        {
+            // The constants of each pass are bound by their address, and the table has at most KERNEL_TABLE_DESCRIPTOR_COUNT descriptors
+            fprintf(stderr, "The compute shader needs a descriptor table layout that is not supported!\n");
+            return false;
+        }
+    }
+
+    printf("Root signature of the compute shader: %u parameters, %u DWORDs\n", s_rootSignatureLayout.parameterCount, s_rootSignatureLayout.dwordCount);
+    return true;
+}
+
+// Reflect the bindless `s_computeShader`, and check that it only binds the constants of the shared bindless root signature.
+// The kernel fetches the source and destination buffers from ResourceDescriptorHeap with the indices in the root constants,
+// which are in the order of KernelBuffer.
+static bool ReflectBindlessComputeShader(void)
+{
+    if (!ReflectKernelShader()) return false;
+
+    RootSignatureLayout layout;
+    BuildBindlessRootSignatureLayout(KERNEL_TABLE_DESCRIPTOR_COUNT, &layout);
+    InlineRootConstants(&layout, 0, 0, PASS_CONSTANTS_DWORD_COUNT);
+
+    uint32_t constantsParameter, indicesParameter, tableOffset;
+    if (!FindRootSignatureBinding(&layout, SHADER_BINDING_CBV, 0, 0, &constantsParameter, &tableOffset) ||
+        !FindRootSignatureBinding(&layout, SHADER_BINDING_CBV, 1, 0, &indicesParameter, &tableOffset)) return false;
+
+    for (uint32_t i = 0; i < s_computeReflection.bindingCount; ++i)
+    {
+        const ShaderBinding* binding = &s_computeReflection.bindings[i];
+        uint32_t parameterIndex;
+        if (binding->bindCount != 1 ||
+            !FindRootSignatureBinding(&layout, binding->type, binding->registerIndex, binding->registerSpace, &parameterIndex, &tableOffset))
+        {
+            fprintf(stderr, "The bindless compute shader binds `%s`, which the bindless root signature does not have!\n", binding->name);
+            return false;
+        }
+    }
+
+    s_rootSignatureLayout = layout;
+    s_kernelBufferBindings[KERNEL_BUFFER_CONSTANTS] = (KernelBufferBinding){
+        .isBound = true,
+        .isRootDescriptor = true,
+        .parameterIndex = constantsParameter
+    };
+    for (int b = KERNEL_BUFFER_SOURCE; b < KERNEL_BUFFER_COUNT; ++b)
+    {
+        s_kernelBufferBindings[b] = (KernelBufferBinding){
+            .isBound = true,
+            .isRootDescriptor = false,
+            .parameterIndex = indicesParameter,
+            .tableOffset = (uint32_t)(b - KERNEL_BUFFER_SOURCE)
+        };
+    }
+
+    printf("Root signature of the compute shader: bindless, %u parameters, %u DWORDs\n", s_rootSignatureLayout.parameterCount,
+            s_rootSignatureLayout.dwordCount);
+    return true;
+}
+
+// The D3D12_DESCRIPTOR_RANGE_TYPE of each register class
+static const D3D12_DESCRIPTOR_RANGE_TYPE s_descriptorRangeTypes[SHADER_BINDING_TYPE_COUNT] = {
+    [SHADER_BINDING_CBV] = D3D12_DESCRIPTOR_RANGE_TYPE_CBV,
+    [SHADER_BINDING_SRV] = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+    [SHADER_BINDING_UAV] = D3D12_DESCRIPTOR_RANGE_TYPE_UAV,
+    [SHADER_BINDING_SAMPLER] = D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER
+};
+
+// The D3D12_ROOT_PARAMETER_TYPE of each kind of root parameter
+static const D3D12_ROOT_PARAMETER_TYPE s_rootParameterTypes[] = {
+    [ROOT_PARAMETER_DESCRIPTOR_TABLE] = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
+    [ROOT_PARAMETER_CBV] = D3D12_ROOT_PARAMETER_TYPE_CBV,
+    [ROOT_PARAMETER_SRV] = D3D12_ROOT_PARAMETER_TYPE_SRV,
+    [ROOT_PARAMETER_UAV] = D3D12_ROOT_PARAMETER_TYPE_UAV,
+    [ROOT_PARAMETER_CONSTANTS] = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS
+};
+
+// Serialize the root signature of `layout` and create it into `*ppRootSignature`.
+// The serialized root signature of `CSMain` is kept in `s_pipelineCache` if `isCached` is set,
+// so that the next runs can skip the serialization.
+static bool SerializeAndCreateRootSignature(const RootSignatureLayout* layout, ID3D12RootSignature** ppRootSignature, bool isCached)
+{
+    // The bindless kernels index the CBV/SRV/UAV heap directly
+    const D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags = D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS |
+                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS |
+                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_AMPLIFICATION_SHADER_ROOT_ACCESS |
+                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_MESH_SHADER_ROOT_ACCESS |
+                                    (layout->isDescriptorHeapIndexed ? D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED : 0);
+
+    ID3DBlob* errorBlob = NULL;
+    ID3DBlob* signature = NULL;
+    HRESULT hRes = S_OK;
+    if (s_supportSignatureVersion1_1)
+    {
+        // The inputs are uploaded before each dispatch and stay unchanged while it runs, but the kernels write the outputs
+        D3D12_DESCRIPTOR_RANGE1 ranges[ROOT_SIGNATURE_MAX_RANGE_COUNT];
+        for (uint32_t i = 0; i < layout->rangeCount; ++i)
+        {
+            const RootDescriptorRange* range = &layout->ranges[i];
+            ranges[i] = (D3D12_DESCRIPTOR_RANGE1){
+                .RangeType = s_descriptorRangeTypes[range->type],
+                .NumDescriptors = range->descriptorCount != 0 ? range->descriptorCount : UINT_MAX,
+                .BaseShaderRegister = range->baseRegister,
+                .RegisterSpace = range->registerSpace,
+                .Flags = range->type == SHADER_BINDING_SAMPLER ? D3D12_DESCRIPTOR_RANGE_FLAG_NONE :
+                        range->type == SHADER_BINDING_UAV ? D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE : D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC,
+                .OffsetInDescriptorsFromTableStart = range->tableOffset
+            };
+        }
+
+        D3D12_ROOT_PARAMETER1 rootParameters[ROOT_SIGNATURE_MAX_PARAMETER_COUNT];
+        for (uint32_t i = 0; i < layout->parameterCount; ++i)
+        {
+            const RootParameterLayout* parameter = &layout->parameters[i];
+            rootParameters[i] = (D3D12_ROOT_PARAMETER1){
+                .ParameterType = s_rootParameterTypes[parameter->type],
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
+            };
+            if (parameter->type == ROOT_PARAMETER_DESCRIPTOR_TABLE)
+            {
+                rootParameters[i].DescriptorTable = (D3D12_ROOT_DESCRIPTOR_TABLE1){
+                    .NumDescriptorRanges = parameter->rangeCount,
+                    .pDescriptorRanges = &ranges[parameter->firstRange]
+                };
+            }
+            else if (parameter->type == ROOT_PARAMETER_CONSTANTS)
+            {
+                rootParameters[i].Constants = (D3D12_ROOT_CONSTANTS){
+                    .ShaderRegister = parameter->shaderRegister,
+                    .RegisterSpace = parameter->registerSpace,
+                    .Num32BitValues = parameter->constantCount
+                };
+            }
+            else
+            {
+                rootParameters[i].Descriptor = (D3D12_ROOT_DESCRIPTOR1){
+                    .ShaderRegister = parameter->shaderRegister,
+                    .RegisterSpace = parameter->registerSpace,
+                    .Flags = parameter->type == ROOT_PARAMETER_UAV ? D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE : D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC
+                };
+            }
+        }
+
+        const D3D12_VERSIONED_ROOT_SIGNATURE_DESC computeRootSignatureDesc = {
+            .Version = D3D_ROOT_SIGNATURE_VERSION_1_1,
+            .Desc_1_1 = {
+                .NumParameters = layout->parameterCount,
+                .pParameters = rootParameters,
+                .NumStaticSamplers = 0,
+                .pStaticSamplers = NULL,
+                .Flags = rootSignatureFlags
+            }
+        };
+
+        hRes = D3D12SerializeVersionedRootSignature(&computeRootSignatureDesc, &signature, &errorBlob);
+    }
+    else
+    {
+        // D3D_ROOT_SIGNATURE_VERSION_1_0 situation
+        D3D12_DESCRIPTOR_RANGE ranges[ROOT_SIGNATURE_MAX_RANGE_COUNT];
+        for (uint32_t i = 0; i < layout->rangeCount; ++i)
+        {
+            const RootDescriptorRange* range = &layout->ranges[i];
+            ranges[i] = (D3D12_DESCRIPTOR_RANGE){
+                .RangeType = s_descriptorRangeTypes[range->type],
+                .NumDescriptors = range->descriptorCount != 0 ? range->descriptorCount : UINT_MAX,
+                .BaseShaderRegister = range->baseRegister,
+                .RegisterSpace = range->registerSpace,
+                .OffsetInDescriptorsFromTableStart = range->tableOffset
+            };
+        }
+
+        D3D12_ROOT_PARAMETER rootParameters[ROOT_SIGNATURE_MAX_PARAMETER_COUNT];
+        for (uint32_t i = 0; i < layout->parameterCount; ++i)
+        {
+            const RootParameterLayout* parameter = &layout->parameters[i];
+            rootParameters[i] = (D3D12_ROOT_PARAMETER){
+                .ParameterType = s_rootParameterTypes[parameter->type],
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
+            };
+            if (parameter->type == ROOT_PARAMETER_DESCRIPTOR_TABLE)
+            {
+                rootParameters[i].DescriptorTable = (D3D12_ROOT_DESCRIPTOR_TABLE){
+                    .NumDescriptorRanges = parameter->rangeCount,
+                    .pDescriptorRanges = &ranges[parameter->firstRange]
+                };
+            }
+            else if (parameter->type == ROOT_PARAMETER_CONSTANTS)
+            {
+                rootParameters[i].Constants = (D3D12_ROOT_CONSTANTS){
+                    .ShaderRegister = parameter->shaderRegister,
+                    .RegisterSpace = parameter->registerSpace,
+                    .Num32BitValues = parameter->constantCount
+                };
+            }
+            else
+            {
+                rootParameters[i].Descriptor = (D3D12_ROOT_DESCRIPTOR){
+                    .ShaderRegister = parameter->shaderRegister,
+                    .RegisterSpace = parameter->registerSpace
+                };
+            }
+        }
+
+        const D3D12_ROOT_SIGNATURE_DESC computeRootSignatureDesc = {
+            .NumParameters = layout->parameterCount,
+            .pParameters = rootParameters,
+            .NumStaticSamplers = 0,
+            .Flags = rootSignatureFlags
+        };
+
+        hRes = D3D12SerializeRootSignature(&computeRootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &errorBlob);
+    }
+
+    do
+    {
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "D3D12SerializeVersionedRootSignature failed: %ld\n", hRes);
+            break;
+        }
+
+        const size_t signatureSize = signature->lpVtbl->GetBufferSize(signature);
+        hRes = s_device->lpVtbl->CreateRootSignature(s_device, 0, signature->lpVtbl->GetBufferPointer(signature),
+            signatureSize, &IID_ID3D12RootSignature, ppRootSignature);
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "CreateRootSignature failed: %ld\n", hRes);
+            break;
+        }
+        if (!isCached) break;
+
+        free(s_pipelineCache.rootSignature);
+        s_pipelineCache.rootSignature = malloc(signatureSize);
+        s_pipelineCache.rootSignatureSize = s_pipelineCache.rootSignature != NULL ? signatureSize : 0;
+        if (s_pipelineCache.rootSignature != NULL)
+        {
+            memcpy(s_pipelineCache.rootSignature, signature->lpVtbl->GetBufferPointer(signature), signatureSize);
+            s_pipelineCacheDirty = true;
+        }
+    }
+    while (false);
+
+    if (errorBlob != NULL) {
+        errorBlob->lpVtbl->Release(errorBlob);
+    }
+    if (signature != NULL) {
+        signature->lpVtbl->Release(signature);
+    }
+
+    return SUCCEEDED(hRes);
+}
+
+// Create the root signature from the pipeline cache if it has one, or else serialize it
+static bool CreateRootSignature(void)
+{
+    HRESULT hRes = E_FAIL;
+    if (s_pipelineCache.rootSignature != NULL)
+    {
+        // A blob that cannot be deserialized is replaced by a newly serialized one
+        hRes = s_device->lpVtbl->CreateRootSignature(s_device, 0, s_pipelineCache.rootSignature, s_pipelineCache.rootSignatureSize,
+                                                    &IID_ID3D12RootSignature, &s_computeRootSignature);
+    }
+
+    if (FAILED(hRes))
+    {
+        s_computeRootSignature = NULL;
+        if (!SerializeAndCreateRootSignature(&s_rootSignatureLayout, &s_computeRootSignature, true)) return false;
+    }
+
+    // This setting is optional.
+    hRes = s_computeRootSignature->lpVtbl->SetName(s_computeRootSignature, L"s_computeRootSignature");
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "s_computeRootSignature setName failed: %ld\n", hRes);
+        return false;
+    }
+
+    return true;
+}
+
+// Submit the recorded commands and wait for their completion, so that the upload ring space they hold can be reused
+static bool FlushUploads(void);
+
+// Wait on the host until the fence of `queue` has reached `value`
+static bool WaitForFence(ComputeQueueType queue, UINT64 value);
+
+// The D3D12_RESOURCE_STATES of a combination of ResourceState flags
+static D3D12_RESOURCE_STATES GetD3D12ResourceStates(uint32_t states)
+{
+    static const struct { ResourceState state; D3D12_RESOURCE_STATES d3d12State; } stateMap[] = {
+        { RESOURCE_STATE_CONSTANT_BUFFER, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER },
+        { RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS },
+        { RESOURCE_STATE_SHADER_RESOURCE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE },
+        { RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST },
+        { RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE }
+    };
+
+    D3D12_RESOURCE_STATES d3d12States = D3D12_RESOURCE_STATE_COMMON;
+    for (size_t i = 0; i < sizeof(stateMap) / sizeof(stateMap[0]); ++i)
+    {
+        if ((states & stateMap[i].state) != 0) {
+            d3d12States |= stateMap[i].d3d12State;
+        }
+    }
+    return d3d12States;
+}
+
+// Declare that the next command recorded for `queue` accesses `resource` in `state`
+static bool TrackBufferUse(ComputeQueueType queue, ID3D12Resource* resource, uint32_t state)
+{
+    if (TrackResourceUse(&s_stateTrackers[queue], resource, state)) return true;
+
+    fprintf(stderr, "Too many buffers are used by one command list!\n");
+    return false;
+}
+
+// Declare that the next command recorded for `queue` depends on the unordered accesses to `resource` recorded so far
+static bool TrackBufferDependency(ComputeQueueType queue, ID3D12Resource* resource)
+{
+    if (TrackUnorderedAccessDependency(&s_stateTrackers[queue], resource)) return true;
+
+    fprintf(stderr, "Too many buffers are used by one command list!\n");
+    return false;
+}
+
+// Record all the barriers that the state tracker of `queue` has queued since the last command with a single call
+static void FlushResourceBarriers(ComputeQueueType queue)
+{
+    static const D3D12_RESOURCE_BARRIER_FLAGS splitFlags[] = {
+        [RESOURCE_BARRIER_SPLIT_NONE] = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+        [RESOURCE_BARRIER_SPLIT_BEGIN_ONLY] = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY,
+        [RESOURCE_BARRIER_SPLIT_END_ONLY] = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY
+    };
+
+    const ResourceBarrierDesc* barriers = NULL;
+    const uint32_t barrierCount = TakeResourceBarriers(&s_stateTrackers[queue], &barriers);
+    if (barrierCount == 0) return;
+
+    D3D12_RESOURCE_BARRIER d3d12Barriers[RESOURCE_STATE_TRACKER_MAX_BARRIER_COUNT];
+    for (uint32_t i = 0; i < barrierCount; ++i)
+    {
+        const ResourceBarrierDesc* barrier = &barriers[i];
+        ID3D12Resource* resource = (ID3D12Resource*)barrier->resource;
+        if (barrier->type == RESOURCE_BARRIER_UAV)
+        {
+            d3d12Barriers[i] = (D3D12_RESOURCE_BARRIER){
+                .Type = D3D12_RESOURCE_BARRIER_TYPE_UAV,
+                .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                .UAV = { .pResource = resource }
+            };
+        }
+        else
+        {
+            d3d12Barriers[i] = (D3D12_RESOURCE_BARRIER){
+                .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                .Flags = splitFlags[barrier->split],
+                .Transition = {
+                    .pResource = resource,
+                    .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                    .StateBefore = GetD3D12ResourceStates(barrier->stateBefore),
+                    .StateAfter = GetD3D12ResourceStates(barrier->stateAfter)
+                }
+            };
+        }
+    }
+
+    ID3D12GraphicsCommandList* commandList = s_commandLists[queue];
+    commandList->lpVtbl->ResourceBarrier(commandList, barrierCount, d3d12Barriers);
+}
+
+// Updates subresources, all the subresource arrays should be populated.
+// This function is the C-style implementation translated from C++ style inline function in the D3DX12 library.
+// The host data is staged in the upload ring. Large transfers are split into chunks,
+// and the commands recorded so far are flushed whenever the ring is full.
+// The copies are recorded for the upload copy queue. A buffer is implicitly promoted from the common state to the copy
+// destination state there, and decays back to the common state when the submission completes,
+// so the state tracker generates no barrier for them.
+static bool WriteDeviceResourceAndSync(
+    _In_ ID3D12GraphicsCommandList* commandList,
+    _In_ ID3D12Resource* pDestinationDeviceResource,
+    size_t dstOffset,
+    _In_ const void* pSrcData,
+    size_t dataSize)
+{
+    const uint8_t* srcData = pSrcData;
+    for (size_t copiedSize = 0; copiedSize < dataSize; )
+    {
+        const size_t chunkSize = dataSize - copiedSize < UPLOAD_CHUNK_SIZE ? dataSize - copiedSize : UPLOAD_CHUNK_SIZE;
+
+        // The ring offsets are 256-byte aligned so that a slice can also be bound as a constant buffer view
+        uint64_t ringOffset = 0;
+        bool allocated = RingAllocate(&s_uploadRing, chunkSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, &ringOffset);
+        if (!allocated)
+        {
+            // Reclaim the space of the uploads that have completed in the meantime
+            ID3D12Fence* uploadFence = s_fences[COMPUTE_QUEUE_UPLOAD];
+            RingRetire(&s_uploadRing, uploadFence->lpVtbl->GetCompletedValue(uploadFence));
+            allocated = RingAllocate(&s_uploadRing, chunkSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, &ringOffset);
+        }
+        if (!allocated)
+        {
+            if (!FlushUploads()) return false;
+            continue;
+        }
+
+        // A flush above starts a new command list, so the use is declared for each chunk
+        if (!TrackBufferUse(COMPUTE_QUEUE_UPLOAD, pDestinationDeviceResource, RESOURCE_STATE_COPY_DEST)) return false;
+        FlushResourceBarriers(COMPUTE_QUEUE_UPLOAD);
+
+        memcpy(s_uploadRingData + ringOffset, srcData + copiedSize, chunkSize);
+        commandList->lpVtbl->CopyBufferRegion(commandList, pDestinationDeviceResource, (UINT64)(dstOffset + copiedSize),
+                                            s_uploadRingBuffer, ringOffset, chunkSize);
+        copiedSize += chunkSize;
+    }
+
+    return true;
+}
+
+// The pooled read-back buffers may be larger than the source buffers, so only `dataSize1` and `dataSize2` bytes are copied.
+// The copies are recorded for the read-back copy queue. The source buffers have decayed to the common state
+// when the compute submission completed, and are implicitly promoted to the copy source state.
+static bool SyncAndReadDeviceResources(
+    _In_ ID3D12GraphicsCommandList* commandList,
+    _In_ ID3D12Resource* pReadbackHostResource1,
+    _In_ ID3D12Resource* pSourceDeviceResource1,
+    size_t dataSize1,
+    _In_ ID3D12Resource* pReadbackHostResource2,
+    _In_ ID3D12Resource* pSourceDeviceResource2,
+    size_t dataSize2)
+{
+    if (!TrackBufferUse(COMPUTE_QUEUE_READBACK, pSourceDeviceResource1, RESOURCE_STATE_COPY_SOURCE) ||
+        !TrackBufferUse(COMPUTE_QUEUE_READBACK, pSourceDeviceResource2, RESOURCE_STATE_COPY_SOURCE)) return false;
+    FlushResourceBarriers(COMPUTE_QUEUE_READBACK);
+
+    commandList->lpVtbl->CopyBufferRegion(commandList, pReadbackHostResource1, 0, pSourceDeviceResource1, 0, dataSize1);
+    commandList->lpVtbl->CopyBufferRegion(commandList, pReadbackHostResource2, 0, pSourceDeviceResource2, 0, dataSize2);
+    return true;
+}
+
+// Allocate the persistent descriptor of `kernelBuffer` in the in-flight slot `slotIndex`.
+// `*ppDescriptor` receives NULL if the buffer needs no descriptor, i.e. the kernel does not declare it or reaches it
+// through a root descriptor. Returns false if the descriptor cannot be allocated.
+static bool AllocateKernelBufferDescriptor(UINT slotIndex, KernelBuffer kernelBuffer, D3D12StagedDescriptor** ppDescriptor)
+{
+    *ppDescriptor = NULL;
+    const KernelBufferBinding* binding = &s_kernelBufferBindings[kernelBuffer];
+    if (!binding->isBound || binding->isRootDescriptor) return true;
+
+    D3D12StagedDescriptor* descriptor = &s_inFlightSlots[slotIndex].descriptors[kernelBuffer];
+    if (!DescriptorAllocatorAllocate(s_descriptorAllocator, descriptor)) return false;
+
+    *ppDescriptor = descriptor;
+    return true;
+}
+
+// Create the write-only Shader Resource View buffer object of `kernelBuffer` in the in-flight slot `slotIndex`
+static ID3D12Resource* CreateSRVBuffer(size_t dataSize, UINT elemCount, UINT elemSize, UINT slotIndex, KernelBuffer kernelBuffer)
+{
+    // Create the SRV buffer. It is initialized by the uploads of each job.
+    ID3D12Resource* resultBuffer = HeapArenaCreateBuffer(s_heapArena, D3D12_HEAP_TYPE_DEFAULT, dataSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COMMON);
+    if (resultBuffer == NULL)
+    {
+        fprintf(stderr, "Failed to create the SRV buffer!\n");
+        return NULL;
+    }
+
+    // Setup the SRV descriptor. A raw view addresses the buffer in 32-bit words, without a structure stride.
+    const bool isRawBuffer = s_kernelBufferBindings[kernelBuffer].isRawBuffer;
+    const D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {
+        .Format = isRawBuffer ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN,
+        .ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
+        .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
+        .Buffer = {
+            .FirstElement = 0,
+            .NumElements = isRawBuffer ? (UINT)(elemCount * elemSize / sizeof(uint32_t)) : elemCount,
+            .StructureByteStride = isRawBuffer ? 0 : elemSize,
+            .Flags = isRawBuffer ? D3D12_BUFFER_SRV_FLAG_RAW : D3D12_BUFFER_SRV_FLAG_NONE
+        }
+    };
+
+    // Create the SRV for the buffer in its persistent descriptor, if it is bound through a descriptor table
+    D3D12StagedDescriptor* descriptor = NULL;
+    if (!AllocateKernelBufferDescriptor(slotIndex, kernelBuffer, &descriptor))
+    {
+        HeapArenaReleaseBuffer(s_heapArena, resultBuffer);
+        return NULL;
+    }
+    if (descriptor != NULL) {
+        s_device->lpVtbl->CreateShaderResourceView(s_device, resultBuffer, &srvDesc, descriptor->handle);
+    }
+
+    return resultBuffer;
+}
+
+// Create an Unordered Access View buffer object of `kernelBuffer` in the in-flight slot `slotIndex`
+static ID3D12Resource* CreateUAVBuffer(size_t dataSize, UINT elemCount, UINT elemSize, UINT slotIndex, KernelBuffer kernelBuffer)
+{
+    // Create the UAV buffer. It is promoted to the unordered access state by the first dispatch.
+    ID3D12Resource* resultBuffer = HeapArenaCreateBuffer(s_heapArena, D3D12_HEAP_TYPE_DEFAULT, dataSize,
+                                                        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COMMON);
+    if (resultBuffer == NULL)
+    {
+        fprintf(stderr, "Failed to create the UAV buffer!\n");
+        return NULL;
+    }
+
+    // Setup the UAV descriptor. A raw view addresses the buffer in 32-bit words, without a structure stride.
+    const bool isRawBuffer = s_kernelBufferBindings[kernelBuffer].isRawBuffer;
+    const D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {
+        .Format = isRawBuffer ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN,
+        .ViewDimension = D3D12_UAV_DIMENSION_BUFFER,
+        .Buffer = {
+            .FirstElement = 0,
+            .NumElements = isRawBuffer ? (UINT)(elemCount * elemSize / sizeof(uint32_t)) : elemCount,
+            .StructureByteStride = isRawBuffer ? 0 : elemSize,
+            .CounterOffsetInBytes = 0,
+            .Flags = isRawBuffer ? D3D12_BUFFER_UAV_FLAG_RAW : D3D12_BUFFER_UAV_FLAG_NONE
+        }
+    };
+
+    D3D12StagedDescriptor* descriptor = NULL;
+    if (!AllocateKernelBufferDescriptor(slotIndex, kernelBuffer, &descriptor))
+    {
+        HeapArenaReleaseBuffer(s_heapArena, resultBuffer);
+        return NULL;
+    }
+    if (descriptor != NULL) {
+        s_device->lpVtbl->CreateUnorderedAccessView(s_device, resultBuffer, NULL, &uavDesc, descriptor->handle);
+    }
+
+    return resultBuffer;
+}
+
+// Load the compute shader into `s_computeShader`.
+// Prefer the wave-intrinsic reduction kernel if the device supports wave operations.
+static bool LoadComputeShader(void)
+{
+    // The kernels are mapped from the archive when they are packed and the archive is up to date
+    s_shaderArchive = OpenShaderAssetFile(SHADER_ARCHIVE_PATH);
+
+    // The grid-stride kernel is only used on request. The verification shader runs one group per 1024 elements,
+    // so it cannot share the constants of the grid-stride passes.
+    if (s_allowGridStride && s_verifyOnDevice) {
+        puts("WARNING: The grid-stride kernel cannot be verified on the device. So one group per 1024 elements will be dispatched!");
+    }
+    else if (s_allowGridStride)
+    {
+        s_isGridStride = true;
+        s_computeShader = LoadCompiledShaderObject(SHADER_KERNEL_COMPUTE_STRIDE, &s_shaderObjectFile);
+        if (s_computeShader.pShaderBytecode == NULL || s_computeShader.BytecodeLength == 0 || !ReflectComputeShader())
+        {
+            s_isGridStride = false;
+            puts("WARNING: The grid-stride kernel is not available. So one group per 1024 elements will be dispatched!");
+        }
+    }
+    if (s_isGridStride)
+    {
+        // Enough resident threads for every SIMD lane of the adapter, within the 1D dispatch limit
+        const uint32_t* groupSize = s_computeReflection.threadGroupSize;
+        const uint64_t residentGroupCount = s_requestedResidentGroupCount > 0 ? s_requestedResidentGroupCount :
+            s_totalLaneCount > 0 ? (uint64_t)s_totalLaneCount * GRID_STRIDE_THREADS_PER_LANE / (groupSize[0] * groupSize[1] * groupSize[2]) :
+            GRID_STRIDE_DEFAULT_GROUP_COUNT;
+        s_residentGroupCount = residentGroupCount == 0 ? 1 :
+            residentGroupCount > MAX_DISPATCH_GROUPS_PER_DIMENSION ? MAX_DISPATCH_GROUPS_PER_DIMENSION : (uint32_t)residentGroupCount;
+        printf("Grid-stride kernel: %u resident groups of %u threads per pass (%u SIMD lanes)\n", s_residentGroupCount,
+            groupSize[0] * groupSize[1] * groupSize[2], s_totalLaneCount);
+    }
+
+    // The raw-buffer kernel is only used on request, and the grid-stride kernel takes precedence.
+    // The verification shader reads the buffers through structured views, so it cannot share raw views in a descriptor table.
+    if (s_allowRawBuffers && !s_isGridStride && s_verifyOnDevice) {
+        puts("WARNING: The raw-buffer kernel cannot be verified on the device. So the structured buffers will be used!");
+    }
+    else if (s_allowRawBuffers && !s_isGridStride)
+    {
+        s_isRawBufferKernel = true;
+        s_computeShader = LoadCompiledShaderObject(SHADER_KERNEL_COMPUTE_RAW, &s_shaderObjectFile);
+        if (s_computeShader.pShaderBytecode == NULL || s_computeShader.BytecodeLength == 0 || !ReflectComputeShader())
+        {
+            s_isRawBufferKernel = false;
+            puts("WARNING: The raw-buffer kernel is not available. So the structured buffers will be used!");
+        }
+    }
+    const bool isVariantSelected = s_isGridStride || s_isRawBufferKernel;
+
+    // The bindless kernel is the wave-intrinsic reduction with the buffers fetched from ResourceDescriptorHeap
+    if (!isVariantSelected && s_supportBindless && s_supportWaveOps && s_allowBindless)
+    {
+        s_computeShader = LoadCompiledShaderObject(SHADER_KERNEL_COMPUTE_BINDLESS, &s_shaderObjectFile);
+        if (s_computeShader.pShaderBytecode != NULL && s_computeShader.BytecodeLength > 0 && ReflectBindlessComputeShader()) {
+            s_reductionMode = COMPUTE_REDUCTION_WAVE;
+        }
+        else {
+            puts("WARNING: The bindless kernel is not available. So the buffers will be bound through the root signature!");
+        }
+    }
+    if (!isVariantSelected && s_supportWaveOps && !s_rootSignatureLayout.isDescriptorHeapIndexed)
+    {
+        s_computeShader = LoadCompiledShaderObject(SHADER_KERNEL_COMPUTE_WAVE, &s_shaderObjectFile);
+        if (s_computeShader.pShaderBytecode != NULL && s_computeShader.BytecodeLength > 0 && ReflectComputeShader()) {
+            s_reductionMode = COMPUTE_REDUCTION_WAVE;
+        }
+        else {
+            puts("WARNING: The wave reduction kernel is not available. So the group-shared memory tree reduction will be used!");
+        }
+    }
+    if (!isVariantSelected && s_reductionMode == COMPUTE_REDUCTION_TREE)
+    {
+        s_computeShader = LoadCompiledShaderObject(SHADER_KERNEL_COMPUTE, &s_shaderObjectFile);
+        if (s_computeShader.pShaderBytecode == NULL || s_computeShader.BytecodeLength == 0 || !ReflectComputeShader()) return false;
+    }
+
+    printf("Group sum reduction mode: %s\n", s_reductionMode == COMPUTE_REDUCTION_WAVE ? "wave intrinsics" : "group-shared memory tree");
+    printf("Resource binding mode: %s\n", s_rootSignatureLayout.isDescriptorHeapIndexed ? "bindless" : "root signature of the reflection");
+    if (s_isRawBufferKernel) {
+        puts("The element-wise addition and the reduction input use 128-bit raw buffer accesses");
+    }
+
+    s_pipelineCacheKey.shaderHash = HashPipelineCacheBytes(s_computeShader.pShaderBytecode, s_computeShader.BytecodeLength);
+    return true;
+}
+
+// Load the pipeline cache file of the selected adapter into `s_pipelineCache`.
+// The cache directory is given by the `D3D12_PIPELINE_CACHE_DIR` environment variable (the current directory by default),
+// and an empty directory disables the cache. A missing, corrupted or stale file is silently ignored.
+static void LoadD3D12PipelineCache(void)
+{
+    const char* cacheDir = getenv("D3D12_PIPELINE_CACHE_DIR");
+    if (cacheDir == NULL) {
+        cacheDir = ".";
+    }
+    if (*cacheDir == '\0') return;
+
+    const int pathLength = snprintf(s_pipelineCachePath, sizeof(s_pipelineCachePath), "%s/d3d12_pipeline_%016llx.cache",
+                                    cacheDir, (unsigned long long)s_pipelineCacheKey.adapterLuid);
+    if (pathLength < 0 || pathLength >= (int)sizeof(s_pipelineCachePath))
+    {
+        s_pipelineCachePath[0] = '\0';
+        return;
+    }
+
+    if (LoadPipelineCache(s_pipelineCachePath, &s_pipelineCacheKey, &s_pipelineCache)) {
+        printf("Loaded the pipeline cache `%s`\n", s_pipelineCachePath);
+    }
+}
+
+// Store the blobs built in this run into the pipeline cache file
+static void StoreD3D12PipelineCache(void)
+{
+    if (!s_pipelineCacheDirty || s_pipelineCachePath[0] == '\0') return;
+
+    if (StorePipelineCache(s_pipelineCachePath, &s_pipelineCacheKey, &s_pipelineCache)) {
+        printf("Stored the pipeline cache `%s`\n", s_pipelineCachePath);
+    }
+    s_pipelineCacheDirty = false;
+}
+
+// Create the compute pipeline state object.
+// The cached blob of the pipeline cache lets the driver skip the compilation of the shader.
+// A blob rejected by the driver is dropped, and the blob of the newly compiled pipeline state is kept instead.
+static bool CreateComputePipelineStateObject(void)
+{
+    // Describe and create the compute pipeline state object (PSO).
+    D3D12_COMPUTE_PIPELINE_STATE_DESC computePsoDesc = {
+        .pRootSignature = s_computeRootSignature,
+        .CS = s_computeShader,
+        .NodeMask = 0,
+        .CachedPSO = {.pCachedBlob = s_pipelineCache.pipelineState, .CachedBlobSizeInBytes = s_pipelineCache.pipelineStateSize },
+        .Flags = D3D12_PIPELINE_STATE_FLAG_NONE
+    };
+    HRESULT hr = s_device->lpVtbl->CreateComputePipelineState(s_device, &computePsoDesc, &IID_ID3D12PipelineState, (void**)&s_computeState);
+    if (FAILED(hr) && s_pipelineCache.pipelineState != NULL)
+    {
+        // Typically D3D12_ERROR_DRIVER_VERSION_MISMATCH or D3D12_ERROR_ADAPTER_NOT_FOUND
+        free(s_pipelineCache.pipelineState);
+        s_pipelineCache.pipelineState = NULL;
+        s_pipelineCache.pipelineStateSize = 0;
+
+        computePsoDesc.CachedPSO = (D3D12_CACHED_PIPELINE_STATE){ .pCachedBlob = NULL, .CachedBlobSizeInBytes = 0 };
+        hr = s_device->lpVtbl->CreateComputePipelineState(s_device, &computePsoDesc, &IID_ID3D12PipelineState, (void**)&s_computeState);
+    }
+    if (FAILED(hr)) return false;
+
+    if (s_pipelineCache.pipelineState == NULL)
+    {
+        ID3DBlob* cachedBlob = NULL;
+        hr = s_computeState->lpVtbl->GetCachedBlob(s_computeState, &cachedBlob);
+        if (SUCCEEDED(hr))
+        {
+            const size_t blobSize = cachedBlob->lpVtbl->GetBufferSize(cachedBlob);
+            s_pipelineCache.pipelineState = malloc(blobSize);
+            if (s_pipelineCache.pipelineState != NULL)
+            {
+                memcpy(s_pipelineCache.pipelineState, cachedBlob->lpVtbl->GetBufferPointer(cachedBlob), blobSize);
+                s_pipelineCache.pipelineStateSize = blobSize;
+                s_pipelineCacheDirty = true;
+            }
+            cachedBlob->lpVtbl->Release(cachedBlob);
+        }
+    }
+
+    return true;
+}
+
+// Create the root signature and the compute pipeline state object, through the pipeline cache
+static bool CreateComputePipeline(void)
+{
+    if (!LoadComputeShader()) return false;
+
+    LoadD3D12PipelineCache();
+    const bool fromCache = s_pipelineCache.rootSignature != NULL;
+
+    if (!CreateRootSignature() || !CreateComputePipelineStateObject())
+    {
+        if (!fromCache) return false;
+
+        // The cached root signature does not fit the shader any more, so the pipeline is built from scratch
+        if (s_computeRootSignature != NULL)
+        {
+            s_computeRootSignature->lpVtbl->Release(s_computeRootSignature);
+            s_computeRootSignature = NULL;
+        }
+        FreePipelineCacheEntry(&s_pipelineCache);
+
+        if (!CreateRootSignature() || !CreateComputePipelineStateObject()) return false;
+    }
+
+    StoreD3D12PipelineCache();
+    return true;
+}
+
+// Create the pipeline state object of the verification shader.
+// It runs with the root signature of the compute shader, so it may only bind the buffers that the compute shader binds.
+// The bindless kernels are verified by the bindless variant.
+static bool CreateVerificationPipeline(void)
+{
+    const ShaderKernel kernel = s_rootSignatureLayout.isDescriptorHeapIndexed ? SHADER_KERNEL_VERIFY_BINDLESS : SHADER_KERNEL_VERIFY;
+    const D3D12_SHADER_BYTECODE verifyShader = LoadCompiledShaderObject(kernel, &s_verifyShaderFile);
+    if (verifyShader.pShaderBytecode == NULL || verifyShader.BytecodeLength == 0) return false;
+
+    ShaderReflection reflection;
+    if (!ReflectShader(verifyShader.pShaderBytecode, verifyShader.BytecodeLength, &reflection))
+    {
+        fprintf(stderr, "The verification shader cannot be reflected!\n");
+        return false;
+    }
+    if (!CheckReductionPassConstantsLayout(&reflection)) return false;
+
+    // It runs over the grids of the reduction passes
+    const uint32_t* groupSize = reflection.threadGroupSize;
+    if (groupSize[0] * groupSize[1] * groupSize[2] != COMPUTE_GROUP_THREAD_COUNT)
+    {
+        fprintf(stderr, "The verification shader has %u x %u x %u threads per group instead of %d!\n",
+                groupSize[0], groupSize[1], groupSize[2], COMPUTE_GROUP_THREAD_COUNT);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < reflection.bindingCount; ++i)
+    {
+        const ShaderBinding* binding = &reflection.bindings[i];
+        uint32_t parameterIndex, tableOffset;
+        if (binding->bindCount != 1 ||
+            !FindRootSignatureBinding(&s_rootSignatureLayout, binding->type, binding->registerIndex, binding->registerSpace, &parameterIndex, &tableOffset))
+        {
+            fprintf(stderr, "The verification shader binds `%s`, which the root signature of the compute shader does not have!\n", binding->name);
+            return false;
+        }
+    }
+
+    const D3D12_COMPUTE_PIPELINE_STATE_DESC verifyPsoDesc = {
+        .pRootSignature = s_computeRootSignature,
+        .CS = verifyShader,
+        .NodeMask = 0,
+        .Flags = D3D12_PIPELINE_STATE_FLAG_NONE
+    };
+    HRESULT hr = s_device->lpVtbl->CreateComputePipelineState(s_device, &verifyPsoDesc, &IID_ID3D12PipelineState, (void**)&s_verifyState);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "CreateComputePipelineState of the verification shader failed: %ld\n", hr);
+        return false;
+    }
+
+    puts("The results are verified on the device, and only the summary records are read back");
+    return true;
+}
+
+// Create the root signature and the pipeline state object of the batch kernel, shaders/compute_batch.hlsl.
+// All its buffers are bound in the root arguments, so the batches need no descriptor table.
+// It is only created by the first batch, and bypasses the pipeline cache, which holds the pipeline of `CSMain`.
+static bool CreateBatchPipeline(void)
+{
+    static const struct { ShaderBindingType type; uint32_t registerIndex; } batchRegisters[BATCH_BUFFER_COUNT] = {
+        [BATCH_BUFFER_CONSTANTS] = { SHADER_BINDING_CBV, 0 },
+        [BATCH_BUFFER_SOURCE] = { SHADER_BINDING_SRV, 0 },
+        [BATCH_BUFFER_JOBS] = { SHADER_BINDING_SRV, 1 },
+        [BATCH_BUFFER_DESTINATION] = { SHADER_BINDING_UAV, 0 },
+        [BATCH_BUFFER_DESTINATION2] = { SHADER_BINDING_UAV, 1 }
+    };
+
+    const D3D12_SHADER_BYTECODE batchShader = LoadCompiledShaderObject(SHADER_KERNEL_COMPUTE_BATCH, &s_batchShaderFile);
+    if (batchShader.pShaderBytecode == NULL || batchShader.BytecodeLength == 0) return false;
+
+    ShaderReflection reflection;
+    if (!ReflectShader(batchShader.pShaderBytecode, batchShader.BytecodeLength, &reflection))
+    {
+        fprintf(stderr, "The batch kernel cannot be reflected!\n");
+        return false;
+    }
+
+    const uint32_t* groupSize = reflection.threadGroupSize;
+    if (groupSize[0] * groupSize[1] * groupSize[2] != COMPUTE_GROUP_THREAD_COUNT)
+    {
+        fprintf(stderr, "The batch kernel has %u x %u x %u threads per group instead of %d!\n",
+                groupSize[0], groupSize[1], groupSize[2], COMPUTE_GROUP_THREAD_COUNT);
+        return false;
+    }
+
+    if (!BuildRootSignatureLayout(&reflection, &s_batchRootSignatureLayout) ||
+        !InlineRootConstants(&s_batchRootSignatureLayout, 0, 0, BATCH_CONSTANTS_DWORD_COUNT) ||
+        s_batchRootSignatureLayout.parameterCount != BATCH_BUFFER_COUNT)
+    {
+        fprintf(stderr, "The batch kernel does not bind exactly its buffers in the root arguments!\n");
+        return false;
+    }
+
+    for (int b = 0; b < BATCH_BUFFER_COUNT; ++b)
+    {
+        uint32_t tableOffset;
+        if (!FindRootSignatureBinding(&s_batchRootSignatureLayout, batchRegisters[b].type, batchRegisters[b].registerIndex, 0,
+                                    &s_batchParameterIndices[b], &tableOffset) ||
+            s_batchRootSignatureLayout.parameters[s_batchParameterIndices[b]].type == ROOT_PARAMETER_DESCRIPTOR_TABLE)
+        {
+            fprintf(stderr, "The batch kernel does not bind exactly its buffers in the root arguments!\n");
+            return false;
+        }
+    }
+
+    if (!SerializeAndCreateRootSignature(&s_batchRootSignatureLayout, &s_batchRootSignature, false)) return false;
+
+    const D3D12_COMPUTE_PIPELINE_STATE_DESC batchPsoDesc = {
+        .pRootSignature = s_batchRootSignature,
+        .CS = batchShader,
+        .NodeMask = 0,
+        .Flags = D3D12_PIPELINE_STATE_FLAG_NONE
+    };
+    HRESULT hr = s_device->lpVtbl->CreateComputePipelineState(s_device, &batchPsoDesc, &IID_ID3D12PipelineState, (void**)&s_batchState);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "CreateComputePipelineState of the batch kernel failed: %ld\n", hr);
+        return false;
+    }
+
+    printf("Root signature of the batch kernel: %u parameters, %u DWORDs\n", s_batchRootSignatureLayout.parameterCount,
+            s_batchRootSignatureLayout.dwordCount);
+    return true;
+}
+
+// Initialize the command queues, the command allocators of every in-flight slot and the command lists
+static bool InitComputeCommands(void)
+{
+    // The transfers are executed by the copy engines, and the kernels by a compute queue
+    const D3D12_COMMAND_LIST_TYPE listTypes[COMPUTE_QUEUE_TYPE_COUNT] = {
+        [COMPUTE_QUEUE_UPLOAD] = D3D12_COMMAND_LIST_TYPE_COPY,
+        [COMPUTE_QUEUE_COMPUTE] = D3D12_COMMAND_LIST_TYPE_COMPUTE,
+        [COMPUTE_QUEUE_READBACK] = D3D12_COMMAND_LIST_TYPE_COPY
+    };
+
+    for (int q = 0; q < COMPUTE_QUEUE_TYPE_COUNT; ++q)
+    {
+        const D3D12_COMMAND_QUEUE_DESC queueDesc = {
+            .Type = listTypes[q],
+            .Priority = 0,
+            .Flags = D3D12_COMMAND_QUEUE_FLAG_NONE,
+            .NodeMask = 0
+        };
+        HRESULT hRes = s_device->lpVtbl->CreateCommandQueue(s_device, &queueDesc, &IID_ID3D12CommandQueue, (void**)&s_commandQueues[q]);
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "CreateCommandQueue failed: %ld\n", hRes);
+            return false;
+        }
+
+        for (int i = 0; i < COMPUTE_MAX_IN_FLIGHT_JOB_COUNT; ++i)
+        {
+            hRes = s_device->lpVtbl->CreateCommandAllocator(s_device, listTypes[q], &IID_ID3D12CommandAllocator, (void**)&s_inFlightSlots[i].allocators[q]);
+            if (FAILED(hRes))
+            {
+                fprintf(stderr, "CreateCommandAllocator failed: %ld\n", hRes);
+                return false;
+            }
+        }
+
+        hRes = s_device->lpVtbl->CreateCommandList(s_device, 0, listTypes[q], s_inFlightSlots[0].allocators[q], NULL, &IID_ID3D12CommandList, (void**)&s_commandLists[q]);
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "CreateCommandList failed: %ld\n", hRes);
+            return false;
+        }
+
+        // The command lists are opened on demand by `BeginCommands`
+        hRes = s_commandLists[q]->lpVtbl->Close(s_commandLists[q]);
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "Close the command list failed: %ld\n", hRes);
+            return false;
+        }
+    }
+
+    s_currentSlot = 0;
+    return true;
+}
+
+// Release the buffer objects of an in-flight slot. The device must not use them any more.
+static void ReleaseSlotBuffers(InFlightSlot* slot)
+{
+    if (slot->srcDataBuffer != NULL)
+    {
+        HeapArenaReleaseBuffer(s_heapArena, slot->srcDataBuffer);
+        slot->srcDataBuffer = NULL;
+    }
+
+    if (slot->dstDataBuffer != NULL)
+    {
+        HeapArenaReleaseBuffer(s_heapArena, slot->dstDataBuffer);
+        slot->dstDataBuffer = NULL;
+    }
+
+    if (slot->dst2Buffer != NULL)
+    {
+        HeapArenaReleaseBuffer(s_heapArena, slot->dst2Buffer);
+        slot->dst2Buffer = NULL;
+    }
+
+    if (slot->jobBuffer != NULL)
+    {
+        HeapArenaReleaseBuffer(s_heapArena, slot->jobBuffer);
+        slot->jobBuffer = NULL;
+    }
+    slot->jobCapacity = 0;
+
+    // The descriptor tables copied from the descriptors live in the ring until their kernels complete
+    for (int b = 0; b < KERNEL_BUFFER_COUNT; ++b) {
+        DescriptorAllocatorFree(s_descriptorAllocator, &slot->descriptors[b]);
+    }
+
+    slot->layout = (ReductionLayout){ 0 };
+    slot->rwElementCount = 0;
+}
+
+// Create the source buffer object and the destination buffer objects of the current slot for `inputElementCount` input elements,
+// and a second destination buffer of `rwElementCount` elements.
+// The buffer objects of the slot are kept if their sizes are unchanged.
+static bool CreateSlotBuffers(uint64_t inputElementCount, uint64_t rwElementCount)
+{
+    InFlightSlot* slot = &s_inFlightSlots[s_currentSlot];
+    if (slot->srcDataBuffer != NULL && inputElementCount == slot->layout.inputElementCount && rwElementCount == slot->rwElementCount) return true;
+
+    // The buffers of the slot are released below, so the device must have finished the previous job of the slot
+    if (!WaitForFence(COMPUTE_QUEUE_READBACK, s_scheduler.slots[s_currentSlot].fenceValues[COMPUTE_QUEUE_READBACK])) return false;
+    ReleaseSlotBuffers(slot);
+
+    const size_t bufferSize = (size_t)inputElementCount * sizeof(int);
+    const size_t rwBufferSize = (size_t)rwElementCount * sizeof(int);
+    slot->srcDataBuffer = CreateSRVBuffer(bufferSize, (UINT)inputElementCount, (UINT)sizeof(int), s_currentSlot, KERNEL_BUFFER_SOURCE);
+    slot->dstDataBuffer = CreateUAVBuffer(bufferSize, (UINT)inputElementCount, (UINT)sizeof(int), s_currentSlot, KERNEL_BUFFER_DESTINATION);
+    slot->dst2Buffer = CreateUAVBuffer(rwBufferSize, (UINT)rwElementCount, (UINT)sizeof(int), s_currentSlot, KERNEL_BUFFER_DESTINATION2);
+    if (slot->srcDataBuffer == NULL || slot->dstDataBuffer == NULL || slot->dst2Buffer == NULL) return false;
+
+    slot->layout.inputElementCount = inputElementCount;
+    slot->rwElementCount = rwElementCount;
+    s_printHeapArenaStats = true;
+    return true;
+}
+
+// Create the source buffer object and the destination buffer objects of the current slot,
+// and record the uploads of the job for the upload queue.
+// The buffer objects of the slot are kept if the element count is unchanged, and only their contents are uploaded.
+static bool CreateBuffers(const int srcData[], const int rwData[], size_t elemCount, int constantValue)
+{
+    ReductionLayout layout;
+    if (!BuildReductionLayout(elemCount, COMPUTE_GROUP_THREAD_COUNT, &layout))
+    {
+        fprintf(stderr, "The element count %zu exceeds the addressable range of the kernels!\n", elemCount);
+        return false;
+    }
+
+    // The resident groups of the grid-stride kernel loop over the groups of each pass
+    if (s_isGridStride) {
+        LimitReductionGrids(&layout, s_residentGroupCount);
+    }
+
+    const size_t bufferSize = elemCount * sizeof(*srcData);
+
+    // The second destination buffer holds the input elements followed by the partial sums of each pass,
+    // and then the summary records of the verification if it runs on the device
+    const uint64_t summaryWordCount = s_verifyOnDevice ? (1 + layout.passCount) * VERIFICATION_SUMMARY_WORD_COUNT : 0;
+    const uint64_t rwElementCount = layout.totalElementCount + summaryWordCount;
+    if (rwElementCount > UINT32_MAX)
+    {
+        fprintf(stderr, "The element count %zu exceeds the addressable range of the verification!\n", elemCount);
+        return false;
+    }
+
+    // The raw-buffer kernel addresses the second destination buffer in bytes with 32-bit offsets
+    if (s_isRawBufferKernel && rwElementCount > UINT32_MAX / sizeof(int))
+    {
+        fprintf(stderr, "The element count %zu exceeds the byte-addressable range of the raw-buffer kernel!\n", elemCount);
+        return false;
+    }
+
+    // Every summary record starts empty: { checkedCount = 0, mismatchCount = 0, firstMismatch = UINT32_MAX, checksum = 0 }
+    VerificationSummary summaries[COMPUTE_MAX_VERIFICATION_SUMMARY_COUNT];
+    for (uint32_t i = 0; i < COMPUTE_MAX_VERIFICATION_SUMMARY_COUNT; ++i) {
+        summaries[i] = (VerificationSummary){ .firstMismatch = UINT32_MAX };
+    }
+
+    if (!CreateSlotBuffers(elemCount, rwElementCount)) return false;
+
+    InFlightSlot* slot = &s_inFlightSlots[s_currentSlot];
+    slot->layout = layout;
+    slot->batchJobCount = 0;
+
+    // The constants stay on the host until the dispatches are recorded, so a new constant value costs no transfer
+    for (uint32_t i = 0; i < layout.passCount; ++i) {
+        FillReductionPassConstants(&layout, i, constantValue, s_minWaveLanes, &slot->passConstants[i]);
+    }
+
+    // Only the input part of the second destination buffer is initialized.
+    // The scheduler orders these copies after the previous job of the slot.
+    ID3D12GraphicsCommandList* uploadList = s_commandLists[COMPUTE_QUEUE_UPLOAD];
+    return WriteDeviceResourceAndSync(uploadList, slot->srcDataBuffer, 0U, srcData, bufferSize) &&
+        WriteDeviceResourceAndSync(uploadList, slot->dst2Buffer, 0U, rwData, bufferSize) &&
+        (summaryWordCount == 0 ||
+            WriteDeviceResourceAndSync(uploadList, slot->dst2Buffer, (size_t)layout.totalElementCount * sizeof(int), summaries,
+                                        (size_t)summaryWordCount * sizeof(uint32_t)));
+}
+
+// Create the buffer objects of a batch in the current slot, and record the uploads of the packed inputs and the job descriptor table.
+// The buffer objects of the slot are kept if their sizes are unchanged, and the job descriptor table is only grown.
+static bool CreateBatchBuffers(const int srcData[], const int rwData[], const BatchJob jobs[], uint32_t jobCount, const BatchLayout* layout)
+{
+    if (!CreateSlotBuffers(layout->inputElementCount, layout->totalElementCount)) return false;
+
+    InFlightSlot* slot = &s_inFlightSlots[s_currentSlot];
+    const size_t jobTableSize = (size_t)jobCount * sizeof(*jobs);
+    if (jobCount > slot->jobCapacity)
+    {
+        // The table is released below, so the device must have finished the previous job of the slot
+        if (!WaitForFence(COMPUTE_QUEUE_READBACK, s_scheduler.slots[s_currentSlot].fenceValues[COMPUTE_QUEUE_READBACK])) return false;
+        if (slot->jobBuffer != NULL) {
+            HeapArenaReleaseBuffer(s_heapArena, slot->jobBuffer);
+        }
+        slot->jobCapacity = 0;
+
+        // The kernel reads the table through a root SRV, so it needs no view
+        slot->jobBuffer = HeapArenaCreateBuffer(s_heapArena, D3D12_HEAP_TYPE_DEFAULT, jobTableSize, D3D12_RESOURCE_FLAG_NONE,
+                                                D3D12_RESOURCE_STATE_COMMON);
+        if (slot->jobBuffer == NULL)
+        {
+            fprintf(stderr, "Failed to create the job descriptor table buffer!\n");
+            return false;
+        }
+        slot->jobCapacity = jobCount;
+        s_printHeapArenaStats = true;
+    }
+
+    slot->layout = (ReductionLayout){ .inputElementCount = layout->inputElementCount, .totalElementCount = layout->totalElementCount };
+    slot->batchJobCount = jobCount;
+    slot->batchGrid = layout->grid;
+    FillBatchConstants(layout, jobCount, &slot->batchConstants);
+
+    // The whole batch is staged with three copies, however many jobs it has
+    const size_t bufferSize = (size_t)layout->inputElementCount * sizeof(*srcData);
+    ID3D12GraphicsCommandList* uploadList = s_commandLists[COMPUTE_QUEUE_UPLOAD];
+    return WriteDeviceResourceAndSync(uploadList, slot->srcDataBuffer, 0U, srcData, bufferSize) &&
+        WriteDeviceResourceAndSync(uploadList, slot->dst2Buffer, 0U, rwData, bufferSize) &&
+        WriteDeviceResourceAndSync(uploadList, slot->jobBuffer, 0U, jobs, jobTableSize);
+}
+
+// Submit the command list of `queue`. This is the `Execute` operation of `s_scheduler`.
+static bool ExecuteQueueCommands(void* userData, ComputeQueueType queue, uint32_t slot)
+{
+    (void)userData;
+    (void)slot;
+
+    ID3D12GraphicsCommandList* commandList = s_commandLists[queue];
+    HRESULT hRes = commandList->lpVtbl->Close(commandList);
+    s_commandListOpen[queue] = false;
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "Close the command list failed: %ld\n", hRes);
+        return false;
+    }
+
+    ID3D12CommandQueue* commandQueue = s_commandQueues[queue];
+    commandQueue->lpVtbl->ExecuteCommandLists(commandQueue, 1, (ID3D12CommandList* const []) { (ID3D12CommandList*)commandList });
+    return true;
+}
+
+// This is the `Signal` operation of `s_scheduler`
+static bool SignalQueue(void* userData, ComputeQueueType queue, uint64_t value)
+{
+    (void)userData;
+
+    // Add an instruction to the command queue to set a new fence point.  Because we 
+    // are on the GPU timeline, the new fence point won't be set until the GPU finishes
+    // processing all the commands prior to this Signal().
+    ID3D12CommandQueue* commandQueue = s_commandQueues[queue];
+    HRESULT hRes = commandQueue->lpVtbl->Signal(commandQueue, s_fences[queue], value);
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "Signal failed: %ld\n", hRes);
+        return false;
+    }
+
+    return true;
+}
+
+// This is the `Wait` operation of `s_scheduler`
+static bool WaitQueue(void* userData, ComputeQueueType queue, ComputeQueueType fenceQueue, uint64_t value)
+{
+    (void)userData;
+
+    // The queue waits on the GPU timeline, so the host is not blocked
+    ID3D12CommandQueue* commandQueue = s_commandQueues[queue];
+    HRESULT hRes = commandQueue->lpVtbl->Wait(commandQueue, s_fences[fenceQueue], value);
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "Wait failed: %ld\n", hRes);
+        return false;
+    }
+
+    return true;
+}
+
+// Create an ID3D12Fence fence object for each queue, the Win32 s_hEvent handle and the scheduler over the queues
+static bool CreateFenceAndEvent(void)
+{
+    for (int q = 0; q < COMPUTE_QUEUE_TYPE_COUNT; ++q)
+    {
+        HRESULT hRes = s_device->lpVtbl->CreateFence(s_device, 0, D3D12_FENCE_FLAG_NONE, &IID_ID3D12Fence, (void**)&s_fences[q]);
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "CreateFence failed: %ld\n", hRes);
+            return false;
+        }
+    }
+
+    s_hEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+    if (s_hEvent == NULL)
+    {
+        const DWORD err = GetLastError();
+        fprintf(stderr, "Failed to create event handle: %u\n", err);
+        return false;
+    }
+
+    const QueueSchedulerOps schedulerOps = {
+        .userData = NULL,
+        .Execute = ExecuteQueueCommands,
+        .Signal = SignalQueue,
+        .Wait = WaitQueue
+    };
+    return InitQueueScheduler(&s_scheduler, &schedulerOps, COMPUTE_MAX_IN_FLIGHT_JOB_COUNT);
+}
+
+// Wait on the host until the fence of `queue` has reached `value`,
+// and reclaim the upload ring space of all the completed uploads, and the descriptor tables and the constant records of all the completed kernels
+static bool WaitForFence(ComputeQueueType queue, UINT64 value)
+{
+    ID3D12Fence* fence = s_fences[queue];
+    if (fence->lpVtbl->GetCompletedValue(fence) < value)
+    {
+        // Fire event when GPU hits the fence point.
+        HRESULT hRes = fence->lpVtbl->SetEventOnCompletion(fence, value, s_hEvent);
+        if (FAILED(hRes))
+        {
+            fprintf(stderr, "Set event failed: %ld\n", hRes);
+            return false;
+        }
+
+        // Wait until the GPU hits current fence event is fired.
+        WaitForSingleObject(s_hEvent, INFINITE);
+    }
+
+    ID3D12Fence* uploadFence = s_fences[COMPUTE_QUEUE_UPLOAD];
+    RingRetire(&s_uploadRing, uploadFence->lpVtbl->GetCompletedValue(uploadFence));
+
+    ID3D12Fence* computeFence = s_fences[COMPUTE_QUEUE_COMPUTE];
+    const UINT64 completedComputeValue = computeFence->lpVtbl->GetCompletedValue(computeFence);
+    DescriptorAllocatorRetire(s_descriptorAllocator, completedComputeValue);
+    RingRetire(&s_constantRing, completedComputeValue);
+    return true;
+}
+
+// Open the command list of `queue` for recording in the current slot if it has been submitted
+static bool BeginCommands(ComputeQueueType queue)
+{
+    if (s_commandListOpen[queue]) return true;
+
+    // Reuse the memory associated with command recording.
+    // We can only reset when the associated command lists have finished execution on the GPU,
+    // so only the last submission of the queue in this slot is waited for.
+    if (!WaitForFence(queue, s_scheduler.slots[s_currentSlot].fenceValues[queue])) return false;
+
+    ID3D12CommandAllocator* allocator = s_inFlightSlots[s_currentSlot].allocators[queue];
+    HRESULT hRes = allocator->lpVtbl->Reset(allocator);
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "Reset the command allocator failed: %ld\n", hRes);
+        return false;
+    }
+
+    // A command list can be reset after it has been added to the command queue via ExecuteCommandList.
+    // Reusing the command list reuses memory.
+    ID3D12GraphicsCommandList* commandList = s_commandLists[queue];
+    hRes = commandList->lpVtbl->Reset(commandList, allocator, queue == COMPUTE_QUEUE_COMPUTE ? s_computeState : NULL);
+    if (FAILED(hRes))
+    {
+        fprintf(stderr, "Reset the command list failed: %ld\n", hRes);
+        return false;
+    }
+
+    // All the buffers have decayed to the common state at the end of the previous submission
+    ResetResourceStateTracker(&s_stateTrackers[queue]);
+
+    s_commandListOpen[queue] = true;
+    return true;
+}
+
+// Submit the recorded uploads of the current slot to the upload queue
+static bool SubmitUploads(void)
+{
+    const uint64_t fenceValue = QueueSchedulerSubmitUploads(&s_scheduler, s_currentSlot);
+    if (fenceValue == 0) return false;
+
+    // The upload ring space consumed by the submission is reclaimed once the upload fence reaches its value
+    if (!RingFinishSubmission(&s_uploadRing, fenceValue))
+    {
+        // Too many submissions are pending, so wait for all of them
+        if (!WaitForFence(COMPUTE_QUEUE_UPLOAD, fenceValue) || !RingFinishSubmission(&s_uploadRing, fenceValue)) return false;
+    }
+
+    return true;
+}
+
+// Submit the recorded uploads and continue recording on the same command list
+static bool FlushUploads(void)
+{
+    if (!SubmitUploads()) return false;
+
+    // The recording continues in the same slot, so this waits for the submission
+    // and the upload ring space it holds can be reused
+    return BeginCommands(COMPUTE_QUEUE_UPLOAD);
+}
+
+// Create a persistently mapped upload buffer of `size` bytes, and get its host address in `ppData`
+static ID3D12Resource* CreateMappedUploadBuffer(size_t size, uint8_t** ppData)
+{
+    ID3D12Resource* buffer = HeapArenaCreateBuffer(s_heapArena, D3D12_HEAP_TYPE_UPLOAD, size, D3D12_RESOURCE_FLAG_NONE,
+                                                D3D12_RESOURCE_STATE_GENERIC_READ);
+    if (buffer == NULL) return NULL;
+
+    // An upload heap resource can stay mapped for its whole lifetime. The host never reads it back.
+    const D3D12_RANGE readRange = { 0, 0 };
+    HRESULT hr = buffer->lpVtbl->Map(buffer, 0, &readRange, (void**)ppData);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Map of an upload buffer failed: %ld\n", hr);
+        HeapArenaReleaseBuffer(s_heapArena, buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+// Create the persistently mapped upload ring
+static bool CreateUploadRing(void)
+{
+    s_uploadRingBuffer = CreateMappedUploadBuffer(UPLOAD_RING_SIZE, &s_uploadRingData);
+    if (s_uploadRingBuffer == NULL)
+    {
+        fprintf(stderr, "Failed to create s_uploadRingBuffer!\n");
+        return false;
+    }
+
+    InitRingAllocator(&s_uploadRing, UPLOAD_RING_SIZE);
+    return true;
+}
+
+// Indicate whether the kernels read the constants of each pass through a root CBV, i.e. they do not fit into root constants
+static bool PassConstantsNeedBuffer(void)
+{
+    const KernelBufferBinding* binding = &s_kernelBufferBindings[KERNEL_BUFFER_CONSTANTS];
+    return binding->isBound && s_rootSignatureLayout.parameters[binding->parameterIndex].type == ROOT_PARAMETER_CBV;
+}
+
+// Create the persistently mapped ring of the pass constants bound as root CBVs
+static bool CreateConstantRing(void)
+{
+    s_constantRingBuffer = CreateMappedUploadBuffer(CONSTANT_RING_SIZE, &s_constantRingData);
+    if (s_constantRingBuffer == NULL)
+    {
+        fprintf(stderr, "Failed to create s_constantRingBuffer!\n");
+        return false;
+    }
+
+    InitRingAllocator(&s_constantRing, CONSTANT_RING_SIZE);
+    return true;
+}
+
+// Initialize the D3D12 device, the compute pipeline and the command submission objects
+static bool D3D12Init(void)
+{
+    if (!CreateD3D12Device()) return false;
+
+    s_heapArena = CreateD3D12HeapArena(s_device, 0);
+    if (s_heapArena == NULL)
+    {
+        fprintf(stderr, "Failed to create the heap arena!\n");
+        return false;
+    }
+
+    if (!CreateUploadRing()) return false;
+
+    s_readbackPool = CreateD3D12ReadbackPool(s_heapArena);
+    if (s_readbackPool == NULL)
+    {
+        fprintf(stderr, "Failed to create the read-back pool!\n");
+        return false;
+    }
+
+    s_descriptorAllocator = CreateD3D12DescriptorAllocator(s_device, DESCRIPTOR_RING_SIZE);
+    if (s_descriptorAllocator == NULL)
+    {
+        fprintf(stderr, "Failed to create the descriptor allocator!\n");
+        return false;
+    }
+
+    if (!CreateComputePipeline()) return false;
+
+    if (s_verifyOnDevice && !CreateVerificationPipeline()) return false;
+
+    if (PassConstantsNeedBuffer() && !CreateConstantRing()) return false;
+
+    if (!InitComputeCommands())
+    {
+        puts("InitComputeCommands failed!");
+        return false;
+    }
+
+    return CreateFenceAndEvent();
+}
+
+// Record the uploads of a job. They are submitted to the upload queue by `D3D12Dispatch`.
+static bool D3D12CreateBuffers(const int srcData[], const int rwData[], size_t elemCount, int constantValue)
+{
+    if (!BeginCommands(COMPUTE_QUEUE_UPLOAD)) return false;
+
+    if (!CreateBuffers(srcData, rwData, elemCount, constantValue))
+    {
+        puts("CreateBuuffers failed!");
+        return false;
+    }
+
+    return true;
+}
+
+// Record the uploads of a batch. They are submitted to the upload queue by `D3D12Dispatch`.
+static bool D3D12CreateBatchBuffers(const int srcData[], const int rwData[], const BatchJob jobs[], uint32_t jobCount, const BatchLayout* layout)
+{
+    if (s_verifyOnDevice)
+    {
+        fprintf(stderr, "The batches are only verified on the host!\n");
+        return false;
+    }
+
+    if (s_batchState == NULL && !CreateBatchPipeline()) return false;
+
+    if (!BeginCommands(COMPUTE_QUEUE_UPLOAD)) return false;
+
+    return CreateBatchBuffers(srcData, rwData, jobs, jobCount, layout);
+}
+
+// Return the read-back buffers of a slot whose results have not been handed out to the pool
+static void ReleaseSlotResults(InFlightSlot* slot)
+{
+    if (slot->readBackSlice.data != NULL) {
+        ReadbackPoolRelease(s_readbackPool, slot->readBackSlice.data);
+    }
+    if (slot->readBackSlice2.data != NULL) {
+        ReadbackPoolRelease(s_readbackPool, slot->readBackSlice2.data);
+    }
+
+    slot->readBackSlice = (ReadbackSlice){ 0 };
+    slot->readBackSlice2 = (ReadbackSlice){ 0 };
+}
+
+// Print the occupancy of the heap arena
+static void PrintHeapArenaStats(void)
+{
+    const struct { D3D12_HEAP_TYPE type; const char* name; } heapTypes[] = {
+        { D3D12_HEAP_TYPE_DEFAULT, "default" },
+        { D3D12_HEAP_TYPE_UPLOAD, "upload" },
+        { D3D12_HEAP_TYPE_READBACK, "read-back" }
+    };
+
+    for (size_t i = 0; i < sizeof(heapTypes) / sizeof(heapTypes[0]); ++i)
+    {
+        D3D12HeapArenaStats stats;
+        HeapArenaGetStats(s_heapArena, heapTypes[i].type, &stats);
+        if (stats.heapCount == 0) continue;
+
+        printf("Heap arena (%s): %u buffers in %u heaps, %llu / %llu bytes used (%llu requested), fragmentation %.1f%%\n",
+            heapTypes[i].name, stats.allocationCount, stats.heapCount, stats.usedBytes, stats.reservedBytes, stats.requestedBytes,
+            stats.fragmentation * 100.0);
+    }
+}
+
+// Record one dispatch per reduction pass of `slot` with the constants of the pass, with the pipeline state that is set.
+// Each reduction pass consumes the partial sums of the previous one, and the verification consumes the results of all of them.
+// The verification passes only accumulate into the summary records, so they do not depend on each other.
+static bool RecordPassDispatches(ID3D12GraphicsCommandList* computeList, const InFlightSlot* slot, D3D12_GPU_VIRTUAL_ADDRESS constantsAddress,
+                                bool isVerification)
+{
+    const KernelBufferBinding* constantsBinding = &s_kernelBufferBindings[KERNEL_BUFFER_CONSTANTS];
+    const RootParameterLayout* constantsParameter = &s_rootSignatureLayout.parameters[constantsBinding->parameterIndex];
+    for (uint32_t i = 0; i < slot->layout.passCount; ++i)
+    {
+        if (!isVerification && i > 0 && !TrackBufferDependency(COMPUTE_QUEUE_COMPUTE, slot->dst2Buffer)) return false;
+        if (isVerification && i == 0 && (!TrackBufferDependency(COMPUTE_QUEUE_COMPUTE, slot->dstDataBuffer) ||
+                                        !TrackBufferDependency(COMPUTE_QUEUE_COMPUTE, slot->dst2Buffer))) return false;
+        if (!TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->srcDataBuffer, RESOURCE_STATE_SHADER_RESOURCE) ||
+            !TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->dstDataBuffer, RESOURCE_STATE_UNORDERED_ACCESS) ||
+            !TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->dst2Buffer, RESOURCE_STATE_UNORDERED_ACCESS)) return false;
+        FlushResourceBarriers(COMPUTE_QUEUE_COMPUTE);
+
+        if (constantsBinding->isBound && constantsParameter->type == ROOT_PARAMETER_CONSTANTS)
+        {
+            computeList->lpVtbl->SetComputeRoot32BitConstants(computeList, constantsBinding->parameterIndex, constantsParameter->constantCount,
+                                                            &slot->passConstants[i], 0);
+        }
+        else if (constantsBinding->isBound)
+        {
+            computeList->lpVtbl->SetComputeRootConstantBufferView(computeList, constantsBinding->parameterIndex,
+                                                                constantsAddress + (UINT64)i * REDUCTION_PASS_CONSTANTS_STRIDE);
+        }
+
+        // Dispatch the GPU threads
+        const DispatchGrid grid = slot->layout.passes[i].grid;
+        computeList->lpVtbl->Dispatch(computeList, grid.x, grid.y, grid.z);
+    }
+
+    return true;
+}
+
+// Copy the persistent descriptors of the buffers of `slot` into a descriptor table of the shader-visible ring,
+// in the order of their positions in the table
+static bool CopyKernelDescriptorTable(const InFlightSlot* slot, D3D12_GPU_DESCRIPTOR_HANDLE* pTable)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE descriptors[KERNEL_TABLE_DESCRIPTOR_COUNT];
+    uint32_t descriptorCount = 0;
+    for (int b = 0; b < KERNEL_BUFFER_COUNT; ++b)
+    {
+        const KernelBufferBinding* binding = &s_kernelBufferBindings[b];
+        if (!binding->isBound || binding->isRootDescriptor) continue;
+
+        descriptors[binding->tableOffset] = slot->descriptors[b].handle;
+        if (binding->tableOffset + 1 > descriptorCount) descriptorCount = binding->tableOffset + 1;
+    }
+
+    if (DescriptorAllocatorCopyTable(s_descriptorAllocator, descriptors, descriptorCount, pTable)) return true;
+
+    // The ring is full, so wait for all the submitted kernels to release their tables
+    if (!WaitForFence(COMPUTE_QUEUE_COMPUTE, s_scheduler.fenceValues[COMPUTE_QUEUE_COMPUTE])) return false;
+    if (DescriptorAllocatorCopyTable(s_descriptorAllocator, descriptors, descriptorCount, pTable)) return true;
+
+    fprintf(stderr, "The descriptor table does not fit into the shader visible descriptor heap!\n");
+    return false;
+}
+
+// Write the constants of the passes of `slot` into the constant ring, one 256-byte aligned record per pass,
+// and get the GPU address of the first record
+static bool WritePassConstants(const InFlightSlot* slot, D3D12_GPU_VIRTUAL_ADDRESS* pAddress)
+{
+    const size_t size = (size_t)slot->layout.passCount * REDUCTION_PASS_CONSTANTS_STRIDE;
+    uint64_t ringOffset = 0;
+    if (!RingAllocate(&s_constantRing, size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, &ringOffset))
+    {
+        // The ring is full, so wait for all the submitted kernels to release their constants
+        if (!WaitForFence(COMPUTE_QUEUE_COMPUTE, s_scheduler.fenceValues[COMPUTE_QUEUE_COMPUTE]) ||
+            !RingAllocate(&s_constantRing, size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, &ringOffset))
+        {
+            fprintf(stderr, "The pass constants do not fit into the constant ring!\n");
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < slot->layout.passCount; ++i) {
+        memcpy(s_constantRingData + ringOffset + (size_t)i * REDUCTION_PASS_CONSTANTS_STRIDE, &slot->passConstants[i], sizeof(slot->passConstants[i]));
+    }
+
+    *pAddress = s_constantRingBuffer->lpVtbl->GetGPUVirtualAddress(s_constantRingBuffer) + ringOffset;
+    return true;
+}
+
+// Record the passes of `CSMain` for `slot` with the bindings of its root signature, and the verification passes if it runs on the device
+static bool RecordKernelDispatches(ID3D12GraphicsCommandList* computeList, const InFlightSlot* slot)
+{
+    // The descriptors of the slot are copied into the shader-visible heap unless all the buffers are root descriptors.
+    // The heap is set before the root signature, as a directly indexed heap requires.
+    bool usesDescriptorHeap = false;
+    for (int b = 0; b < KERNEL_BUFFER_COUNT; ++b) {
+        usesDescriptorHeap = usesDescriptorHeap || (s_kernelBufferBindings[b].isBound && !s_kernelBufferBindings[b].isRootDescriptor);
+    }
+    D3D12_GPU_DESCRIPTOR_HANDLE tableHandle = { 0 };
+    if (usesDescriptorHeap)
+    {
+        if (!CopyKernelDescriptorTable(slot, &tableHandle)) return false;
+
+        ID3D12DescriptorHeap* ppHeaps[] = { DescriptorAllocatorGetShaderVisibleHeap(s_descriptorAllocator) };
+        computeList->lpVtbl->SetDescriptorHeaps(computeList, sizeof(ppHeaps) / sizeof(ppHeaps[0]), ppHeaps);
+    }
+
+    computeList->lpVtbl->SetComputeRootSignature(computeList, s_computeRootSignature);
+
+    // The buffers are bound where the root signature generated from the reflection of the kernel puts them
+    ID3D12Resource* const kernelBuffers[KERNEL_BUFFER_COUNT] = {
+        [KERNEL_BUFFER_SOURCE] = slot->srcDataBuffer,
+        [KERNEL_BUFFER_DESTINATION] = slot->dstDataBuffer,
+        [KERNEL_BUFFER_DESTINATION2] = slot->dst2Buffer
+    };
+    for (int b = KERNEL_BUFFER_SOURCE; b < KERNEL_BUFFER_COUNT; ++b)
+    {
+        const KernelBufferBinding* binding = &s_kernelBufferBindings[b];
+        if (!binding->isBound || !binding->isRootDescriptor) continue;
+
+        const D3D12_GPU_VIRTUAL_ADDRESS address = kernelBuffers[b]->lpVtbl->GetGPUVirtualAddress(kernelBuffers[b]);
+        if (s_rootSignatureLayout.parameters[binding->parameterIndex].type == ROOT_PARAMETER_SRV) {
+            computeList->lpVtbl->SetComputeRootShaderResourceView(computeList, binding->parameterIndex, address);
+        }
+        else {
+            computeList->lpVtbl->SetComputeRootUnorderedAccessView(computeList, binding->parameterIndex, address);
+        }
+    }
+
+    if (s_rootSignatureLayout.isDescriptorHeapIndexed)
+    {
+        // A bindless kernel receives the heap indices of the copied descriptors as root constants, in a single call
+        const uint32_t firstIndex = DescriptorAllocatorGetHeapIndex(s_descriptorAllocator, tableHandle);
+        UINT heapIndices[KERNEL_TABLE_DESCRIPTOR_COUNT];
+        for (uint32_t i = 0; i < KERNEL_TABLE_DESCRIPTOR_COUNT; ++i) {
+            heapIndices[i] = firstIndex + i;
+        }
+        computeList->lpVtbl->SetComputeRoot32BitConstants(computeList, s_kernelBufferBindings[KERNEL_BUFFER_SOURCE].parameterIndex,
+                                                        KERNEL_TABLE_DESCRIPTOR_COUNT, heapIndices, 0);
+    }
+    else
+    {
+        // The descriptor tables all start at the copy of the descriptors of the slot
+        for (uint32_t i = 0; i < s_rootSignatureLayout.parameterCount; ++i)
+        {
+            if (s_rootSignatureLayout.parameters[i].type == ROOT_PARAMETER_DESCRIPTOR_TABLE) {
+                computeList->lpVtbl->SetComputeRootDescriptorTable(computeList, i, tableHandle);
+            }
+        }
+    }
+
+    D3D12_GPU_VIRTUAL_ADDRESS constantsAddress = 0;
+    if (PassConstantsNeedBuffer() && !WritePassConstants(slot, &constantsAddress)) return false;
+
+    // The state tracker only generates the UAV barriers between the dependent dispatches:
+    // all the buffers are implicitly promoted from the common state on their first use
+    if (!RecordPassDispatches(computeList, slot, constantsAddress, false)) return false;
+
+    if (s_verifyOnDevice)
+    {
+        computeList->lpVtbl->SetPipelineState(computeList, s_verifyState);
+        if (!RecordPassDispatches(computeList, slot, constantsAddress, true)) return false;
+    }
+
+    return true;
+}
+
+// Record the single dispatch of the batch of `slot`. All the jobs of the batch run in the same grid.
+static bool RecordBatchDispatch(ID3D12GraphicsCommandList* computeList, const InFlightSlot* slot)
+{
+    if (!TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->srcDataBuffer, RESOURCE_STATE_SHADER_RESOURCE) ||
+        !TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->jobBuffer, RESOURCE_STATE_SHADER_RESOURCE) ||
+        !TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->dstDataBuffer, RESOURCE_STATE_UNORDERED_ACCESS) ||
+        !TrackBufferUse(COMPUTE_QUEUE_COMPUTE, slot->dst2Buffer, RESOURCE_STATE_UNORDERED_ACCESS)) return false;
+    FlushResourceBarriers(COMPUTE_QUEUE_COMPUTE);
+
+    computeList->lpVtbl->SetPipelineState(computeList, s_batchState);
+    computeList->lpVtbl->SetComputeRootSignature(computeList, s_batchRootSignature);
+
+    computeList->lpVtbl->SetComputeRoot32BitConstants(computeList, s_batchParameterIndices[BATCH_BUFFER_CONSTANTS], BATCH_CONSTANTS_DWORD_COUNT,
+                                                    &slot->batchConstants, 0);
+    computeList->lpVtbl->SetComputeRootShaderResourceView(computeList, s_batchParameterIndices[BATCH_BUFFER_SOURCE],
+                                                        slot->srcDataBuffer->lpVtbl->GetGPUVirtualAddress(slot->srcDataBuffer));
+    computeList->lpVtbl->SetComputeRootShaderResourceView(computeList, s_batchParameterIndices[BATCH_BUFFER_JOBS],
+                                                        slot->jobBuffer->lpVtbl->GetGPUVirtualAddress(slot->jobBuffer));
+    computeList->lpVtbl->SetComputeRootUnorderedAccessView(computeList, s_batchParameterIndices[BATCH_BUFFER_DESTINATION],
+                                                        slot->dstDataBuffer->lpVtbl->GetGPUVirtualAddress(slot->dstDataBuffer));
+    computeList->lpVtbl->SetComputeRootUnorderedAccessView(computeList, s_batchParameterIndices[BATCH_BUFFER_DESTINATION2],
+                                                        slot->dst2Buffer->lpVtbl->GetGPUVirtualAddress(slot->dst2Buffer));
+
+    computeList->lpVtbl->Dispatch(computeList, slot->batchGrid.x, slot->batchGrid.y, slot->batchGrid.z);
+    return true;
+}
+
+// Submit the uploads of the job, and record and submit the compute operation and the read-back copies.
+// The scheduler chains them across the upload, compute and read-back queues.
+static bool D3D12Dispatch(ComputeTicket* pTicket)
+{
+    InFlightSlot* slot = &s_inFlightSlots[s_currentSlot];
+    if (slot->srcDataBuffer == NULL)
+    {
+        fprintf(stderr, "The buffers of the job have not been created!\n");
+        return false;
+    }
+
+    const ReductionLayout* layout = &slot->layout;
+    const size_t dstSize = (size_t)layout->inputElementCount * sizeof(int);
+    const size_t rwSize = (size_t)layout->totalElementCount * sizeof(int);
+    const size_t summarySize = (1 + layout->passCount) * sizeof(VerificationSummary);
+
+    // The uploads recorded by `D3D12CreateBuffers` start as soon as the previous job of the slot allows
+    if (s_commandListOpen[COMPUTE_QUEUE_UPLOAD] && !SubmitUploads()) return false;
+
+    // The results of the job that used the slot before are dropped if they have never been read
+    ReleaseSlotResults(slot);
+
+    // Acquire the read-back buffers that will fetch the results from the UAV buffer objects.
+    // The buffers stay mapped and are recycled once the results have been released.
+    ID3D12Fence* readbackFence = s_fences[COMPUTE_QUEUE_READBACK];
+    const UINT64 completedFenceValue = readbackFence->lpVtbl->GetCompletedValue(readbackFence);
+    if (s_verifyOnDevice)
+    {
+        if (!ReadbackPoolAcquire(s_readbackPool, summarySize, completedFenceValue, &slot->readBackSlice)) return false;
+    }
+    else
+    {
+        if (!ReadbackPoolAcquire(s_readbackPool, dstSize, completedFenceValue, &slot->readBackSlice)) return false;
+        if (!ReadbackPoolAcquire(s_readbackPool, rwSize, completedFenceValue, &slot->readBackSlice2)) return false;
+    }
+
+    // The occupancy only changes when the buffers have been recreated
+    if (s_printHeapArenaStats)
+    {
+        PrintHeapArenaStats();
+        s_printHeapArenaStats = false;
+    }
+
+    if (!BeginCommands(COMPUTE_QUEUE_COMPUTE)) return false;
+    ID3D12GraphicsCommandList* computeList = s_commandLists[COMPUTE_QUEUE_COMPUTE];
+
+    const bool isRecorded = slot->batchJobCount > 0 ? RecordBatchDispatch(computeList, slot) : RecordKernelDispatches(computeList, slot);
+    if (!isRecorded) return false;
+
+    // Transfer the dst buffers, or only the summary records, to readback buffers on the read-back queue
+    if (!BeginCommands(COMPUTE_QUEUE_READBACK)) return false;
+    ID3D12GraphicsCommandList* readbackList = s_commandLists[COMPUTE_QUEUE_READBACK];
+    if (s_verifyOnDevice)
+    {
+        if (!TrackBufferUse(COMPUTE_QUEUE_READBACK, slot->dst2Buffer, RESOURCE_STATE_COPY_SOURCE)) return false;
+        FlushResourceBarriers(COMPUTE_QUEUE_READBACK);
+        readbackList->lpVtbl->CopyBufferRegion(readbackList, slot->readBackSlice.buffer, 0, slot->dst2Buffer,
+                                            (UINT64)layout->totalElementCount * sizeof(int), summarySize);
+    }
+    else
+    {
+        if (!SyncAndReadDeviceResources(readbackList, slot->readBackSlice.buffer, slot->dstDataBuffer, dstSize,
+                                        slot->readBackSlice2.buffer, slot->dst2Buffer, rwSize)) return false;
+    }
+
+    const UINT64 ticket = QueueSchedulerSubmitJob(&s_scheduler, s_currentSlot);
+    if (ticket == 0) return false;
+
+    // The descriptor table and the constant records of the job are recycled once its kernels have completed
+    const UINT64 computeFenceValue = s_scheduler.slots[s_currentSlot].fenceValues[COMPUTE_QUEUE_COMPUTE];
+    if (!DescriptorAllocatorFinishSubmission(s_descriptorAllocator, computeFenceValue) ||
+        !RingFinishSubmission(&s_constantRing, computeFenceValue))
+    {
+        // Too many submissions are pending, so wait for all of them
+        if (!WaitForFence(COMPUTE_QUEUE_COMPUTE, computeFenceValue) ||
+            !DescriptorAllocatorFinishSubmission(s_descriptorAllocator, computeFenceValue) ||
+            !RingFinishSubmission(&s_constantRing, computeFenceValue)) return false;
+    }
+
+    // The read-back buffers are not recycled before the copies into them have completed
+    ReadbackPoolSubmit(s_readbackPool, &slot->readBackSlice, ticket);
+    if (!s_verifyOnDevice) {
+        ReadbackPoolSubmit(s_readbackPool, &slot->readBackSlice2, ticket);
+    }
+
+    // The next job is recorded in the next slot
+    s_currentSlot = (s_currentSlot + 1) % COMPUTE_MAX_IN_FLIGHT_JOB_COUNT;
+
+    *pTicket = ticket;
+    return true;
+}
+
+// Wait for the compute operation of `ticket` completed
+static bool D3D12Sync(ComputeTicket ticket)
+{
+    if (ticket == 0 || ticket > s_scheduler.fenceValues[COMPUTE_QUEUE_READBACK]) return false;
+
+    return WaitForFence(COMPUTE_QUEUE_READBACK, ticket);
+}
+
+// Hand out the persistently mapped read-back buffers of the job of `ticket` directly
+static bool D3D12ReadResults(ComputeTicket ticket, ComputeResultView* pView)
+{
+    // The results can only be read after the job has completed
+    ID3D12Fence* readbackFence = s_fences[COMPUTE_QUEUE_READBACK];
+    if (ticket == 0 || readbackFence->lpVtbl->GetCompletedValue(readbackFence) < ticket) return false;
+
+    for (int i = 0; i < COMPUTE_MAX_IN_FLIGHT_JOB_COUNT; ++i)
+    {
+        InFlightSlot* slot = &s_inFlightSlots[i];
+        if (s_scheduler.slots[i].fenceValues[COMPUTE_QUEUE_READBACK] != ticket || slot->readBackSlice.data == NULL ||
+            (!s_verifyOnDevice && slot->readBackSlice2.data == NULL)) continue;
+
+        if (s_verifyOnDevice)
+        {
+            pView->summaries = slot->readBackSlice.data;
+            pView->summaryCount = 1 + slot->layout.passCount;
+        }
+        else
+        {
+            pView->dstResult = slot->readBackSlice.data;
+            pView->rwResult = slot->readBackSlice2.data;
+        }
+
+        // The view owns the read-back buffers from now on
+        slot->readBackSlice = (ReadbackSlice){ 0 };
+        slot->readBackSlice2 = (ReadbackSlice){ 0 };
+        return true;
+    }
+
+    fprintf(stderr, "The results of ticket %llu are not available!\n", (unsigned long long)ticket);
+    return false;
+}
+
+// Return the read-back buffers of the view to the pool
+static void D3D12ReleaseResults(ComputeResultView* pView)
+{
+    if (pView->dstResult != NULL) {
+        ReadbackPoolRelease(s_readbackPool, pView->dstResult);
+    }
+    if (pView->rwResult != NULL) {
+        ReadbackPoolRelease(s_readbackPool, pView->rwResult);
+    }
+    if (pView->summaries != NULL) {
+        ReadbackPoolRelease(s_readbackPool, pView->summaries);
+    }
+
+    *pView = (ComputeResultView){ 0 };
+}
+
+// Release all the resources
+static void D3D12Release(void)
+{
+    // Wait for all the submissions before releasing the objects they use
+    if (s_hEvent != NULL)
+    {
+        for (int q = 0; q < COMPUTE_QUEUE_TYPE_COUNT; ++q) {
+            WaitForFence((ComputeQueueType)q, s_scheduler.fenceValues[q]);
+        }
+    }
+
+    if (s_hEvent != NULL)
+    {
+        CloseHandle(s_hEvent);
+        s_hEvent = NULL;
+    }
+    for (int q = 0; q < COMPUTE_QUEUE_TYPE_COUNT; ++q)
+    {
+        if (s_fences[q] != NULL)
+        {
+            s_fences[q]->lpVtbl->Release(s_fences[q]);
+            s_fences[q] = NULL;
+        }
+    }
+
+    for (int i = 0; i < COMPUTE_MAX_IN_FLIGHT_JOB_COUNT; ++i) {
+        ReleaseSlotBuffers(&s_inFlightSlots[i]);
+    }
+
+    // The slots have returned their descriptors
+    if (s_descriptorAllocator != NULL)
+    {
+        DestroyD3D12DescriptorAllocator(s_descriptorAllocator);
+        s_descriptorAllocator = NULL;
+    }
+
+    if (s_uploadRingBuffer != NULL)
+    {
+        s_uploadRingBuffer->lpVtbl->Unmap(s_uploadRingBuffer, 0, NULL);
+        HeapArenaReleaseBuffer(s_heapArena, s_uploadRingBuffer);
+        s_uploadRingBuffer = NULL;
+        s_uploadRingData = NULL;
+    }
+
+    if (s_constantRingBuffer != NULL)
+    {
+        s_constantRingBuffer->lpVtbl->Unmap(s_constantRingBuffer, 0, NULL);
+        HeapArenaReleaseBuffer(s_heapArena, s_constantRingBuffer);
+        s_constantRingBuffer = NULL;
+        s_constantRingData = NULL;
+    }
+
+    if (s_readbackPool != NULL)
+    {
+        DestroyD3D12ReadbackPool(s_readbackPool);
+        s_readbackPool = NULL;
+    }
+
+    // All the placed buffers have been released, so their heaps can be released now
+    if (s_heapArena != NULL)
+    {
+        DestroyD3D12HeapArena(s_heapArena);
+        s_heapArena = NULL;
+    }
+
+    for (int i = 0; i < COMPUTE_MAX_IN_FLIGHT_JOB_COUNT; ++i)
+    {
+        for (int q = 0; q < COMPUTE_QUEUE_TYPE_COUNT; ++q)
+        {
+            ID3D12CommandAllocator* allocator = s_inFlightSlots[i].allocators[q];
+            if (allocator != NULL) {
+                allocator->lpVtbl->Release(allocator);
+            }
+        }
+        s_inFlightSlots[i] = (InFlightSlot){ 0 };
+    }
+    s_currentSlot = 0;
+
+    for (int q = 0; q < COMPUTE_QUEUE_TYPE_COUNT; ++q)
+    {
+        if (s_commandLists[q] != NULL)
+        {
+            s_commandLists[q]->lpVtbl->Release(s_commandLists[q]);
+            s_commandLists[q] = NULL;
+        }
+
+        if (s_commandQueues[q] != NULL)
+        {
+            s_commandQueues[q]->lpVtbl->Release(s_commandQueues[q]);
+            s_commandQueues[q] = NULL;
+        }
+        s_commandListOpen[q] = false;
+    }
+
+    if (s_computeState != NULL)
+    {
+        s_computeState->lpVtbl->Release(s_computeState);
+        s_computeState = NULL;
+    }
+
+    if (s_verifyState != NULL)
+    {
+        s_verifyState->lpVtbl->Release(s_verifyState);
+        s_verifyState = NULL;
+    }
+
+    if (s_batchState != NULL)
+    {
+        s_batchState->lpVtbl->Release(s_batchState);
+        s_batchState = NULL;
+    }
+
+    if (s_batchRootSignature != NULL)
+    {
+        s_batchRootSignature->lpVtbl->Release(s_batchRootSignature);
+        s_batchRootSignature = NULL;
+    }
+
+    if (s_computeRootSignature != NULL)
+    {
+        s_computeRootSignature->lpVtbl->Release(s_computeRootSignature);
+        s_computeRootSignature = NULL;
+    }
+
+    s_computeShader = (D3D12_SHADER_BYTECODE){ 0 };
+    memset(&s_computeReflection, 0, sizeof(s_computeReflection));
+    memset(&s_rootSignatureLayout, 0, sizeof(s_rootSignatureLayout));
+    memset(s_kernelBufferBindings, 0, sizeof(s_kernelBufferBindings));
+    CloseShaderAssetFile(s_shaderObjectFile);
+    s_shaderObjectFile = NULL;
+    CloseShaderAssetFile(s_verifyShaderFile);
+    s_verifyShaderFile = NULL;
+    CloseShaderAssetFile(s_batchShaderFile);
+    s_batchShaderFile = NULL;
+    memset(&s_batchRootSignatureLayout, 0, sizeof(s_batchRootSignatureLayout));
+    memset(s_batchParameterIndices, 0, sizeof(s_batchParameterIndices));
+    CloseShaderAssetFile(s_shaderArchive);
+    s_shaderArchive = NULL;
+    FreePipelineCacheEntry(&s_pipelineCache);
+    s_pipelineCacheKey = (PipelineCacheKey){ 0 };
+    s_pipelineCacheDirty = false;
+    s_pipelineCachePath[0] = '\0';
+
+    if (s_device != NULL)
+    {
+        s_device->lpVtbl->Release(s_device);
+        s_device = NULL;
+    }
+    if (s_factory != NULL)
+    {
+        s_factory->lpVtbl->Release(s_factory);
+        s_factory = NULL;
+    }
+    s_scheduler = (QueueScheduler){ 0 };
+    s_printHeapArenaStats = false;
+    s_isGridStride = false;
+    s_residentGroupCount = 0;
+    s_isRawBufferKernel = false;
+}
+
+void SetD3D12AdapterSelection(const char* selection)
+{
+    s_adapterSelection = selection;
+}
+
+void SetD3D12DeviceVerification(bool enabled)
+{
+    s_verifyOnDevice = enabled;
+}
+
+void SetD3D12BindlessResources(bool enabled)
+{
+    s_allowBindless = enabled;
+}
+
+void SetD3D12GridStride(bool enabled, uint32_t residentGroupCount)
+{
+    s_allowGridStride = enabled;
+    s_requestedResidentGroupCount = residentGroupCount;
+}
+
+void SetD3D12RawBuffers(bool enabled)
+{
+    s_allowRawBuffers = enabled;
+}
+
+const ComputeBackend* GetD3D12ComputeBackend(void)
+{
+    static const ComputeBackend backend = {
+        .name = "D3D12",
+        .inFlightJobCount = COMPUTE_MAX_IN_FLIGHT_JOB_COUNT,
+        .Init = D3D12Init,
+        .CreateBuffers = D3D12CreateBuffers,
+        .CreateBatchBuffers = D3D12CreateBatchBuffers,
+        .Dispatch = D3D12Dispatch,
+        .Sync = D3D12Sync,
+        .ReadResults = D3D12ReadResults,
+        .ReleaseResults = D3D12ReleaseResults,
+        .Release = D3D12Release
+    };
+    return &backend;
+}
+
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <Windows.h>
+#include <d3d12.h>
+
+#include "d3d12_descriptor_allocator.h"
+#include "ring_allocator.h"
+
+struct D3D12DescriptorAllocator
+{
+    ID3D12Device* device;
+    UINT descriptorSize;
+
+    // The CPU-only staging heaps and the CPU handles of their first descriptors
+    uint32_t stagingHeapCount;
+    ID3D12DescriptorHeap* stagingHeaps[DESCRIPTOR_MAX_STAGING_HEAP_COUNT];
+    D3D12_CPU_DESCRIPTOR_HANDLE stagingHeapStarts[DESCRIPTOR_MAX_STAGING_HEAP_COUNT];
+
+    // The stack of the indices of the free persistent descriptors, with room for all the descriptors of the staging heaps
+    uint32_t* freeIndices;
+    uint32_t freeCount;
+
+    // The shader-visible heap, which is entirely used as the ring of the descriptor tables
+    ID3D12DescriptorHeap* shaderVisibleHeap;
+    D3D12_CPU_DESCRIPTOR_HANDLE ringCPUStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE ringGPUStart;
+    RingAllocator ring;
+};
+
+// Add a staging heap and put all its descriptors on the free list
+static bool AddStagingHeap(D3D12DescriptorAllocator* allocator)
+{
+    if (allocator->stagingHeapCount == DESCRIPTOR_MAX_STAGING_HEAP_COUNT)
+    {
+        fprintf(stderr, "All the %d descriptors of the staging heaps are in use!\n", DESCRIPTOR_MAX_STAGING_HEAP_COUNT * DESCRIPTOR_STAGING_HEAP_SIZE);
+        return false;
+    }
+
+    const uint32_t heapIndex = allocator->stagingHeapCount;
+    uint32_t* freeIndices = realloc(allocator->freeIndices, (size_t)(heapIndex + 1) * DESCRIPTOR_STAGING_HEAP_SIZE * sizeof(*freeIndices));
+    if (freeIndices == NULL)
+    {
+        fprintf(stderr, "Lack of memory for the descriptor free list...\n");
+        return false;
+    }
+    allocator->freeIndices = freeIndices;
+
+    const D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {
+        .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+        .NumDescriptors = DESCRIPTOR_STAGING_HEAP_SIZE,
+        .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
+        .NodeMask = 0
+    };
+    ID3D12DescriptorHeap* heap = NULL;
+    HRESULT hr = allocator->device->lpVtbl->CreateDescriptorHeap(allocator->device, &heapDesc, &IID_ID3D12DescriptorHeap, (void**)&heap);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to create a staging descriptor heap: %ld\n", hr);
+        return false;
+    }
+
+    allocator->stagingHeaps[heapIndex] = heap;
+    heap->lpVtbl->GetCPUDescriptorHandleForHeapStart(heap, &allocator->stagingHeapStarts[heapIndex]);
+    ++allocator->stagingHeapCount;
+
+    // The lowest indices are on the top of the stack
+    for (uint32_t i = DESCRIPTOR_STAGING_HEAP_SIZE; i > 0; --i) {
+        allocator->freeIndices[allocator->freeCount++] = heapIndex * DESCRIPTOR_STAGING_HEAP_SIZE + i - 1;
+    }
+
+    return true;
+}
+
+D3D12DescriptorAllocator* CreateD3D12DescriptorAllocator(ID3D12Device* device, uint32_t ringSize)
+{
+    D3D12DescriptorAllocator* allocator = calloc(1, sizeof(*allocator));
+    if (allocator == NULL) return NULL;
+
+    allocator->device = device;
+    allocator->descriptorSize = device->lpVtbl->GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    const D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {
+        .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+        .NumDescriptors = ringSize,
+        .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
+        .NodeMask = 0
+    };
+    HRESULT hr = device->lpVtbl->CreateDescriptorHeap(device, &heapDesc, &IID_ID3D12DescriptorHeap, (void**)&allocator->shaderVisibleHeap);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to create the shader visible descriptor heap: %ld\n", hr);
+        DestroyD3D12DescriptorAllocator(allocator);
+        return NULL;
+    }
+
+    // This setting is optional.
+    allocator->shaderVisibleHeap->lpVtbl->SetName(allocator->shaderVisibleHeap, L"shaderVisibleHeap");
+
+    allocator->shaderVisibleHeap->lpVtbl->GetCPUDescriptorHandleForHeapStart(allocator->shaderVisibleHeap, &allocator->ringCPUStart);
+    allocator->shaderVisibleHeap->lpVtbl->GetGPUDescriptorHandleForHeapStart(allocator->shaderVisibleHeap, &allocator->ringGPUStart);
+    InitRingAllocator(&allocator->ring, ringSize);
+
+    return allocator;
+}
+
+bool DescriptorAllocatorAllocate(D3D12DescriptorAllocator* allocator, D3D12StagedDescriptor* pDescriptor)
+{
+    if (allocator->freeCount == 0 && !AddStagingHeap(allocator)) return false;
+
+    const uint32_t index = allocator->freeIndices[--allocator->freeCount];
+    D3D12_CPU_DESCRIPTOR_HANDLE handle = allocator->stagingHeapStarts[index / DESCRIPTOR_STAGING_HEAP_SIZE];
+    handle.ptr += (SIZE_T)(index % DESCRIPTOR_STAGING_HEAP_SIZE) * allocator->descriptorSize;
+
+    *pDescriptor = (D3D12StagedDescriptor){ .handle = handle, .index = index };
+    return true;
+}
+
+void DescriptorAllocatorFree(D3D12DescriptorAllocator* allocator, D3D12StagedDescriptor* pDescriptor)
+{
+    if (pDescriptor->handle.ptr == 0) return;
+
+    allocator->freeIndices[allocator->freeCount++] = pDescriptor->index;
+    *pDescriptor = (D3D12StagedDescriptor){ 0 };
+}
+
+bool DescriptorAllocatorCopyTable(D3D12DescriptorAllocator* allocator, const D3D12_CPU_DESCRIPTOR_HANDLE descriptors[], uint32_t count,
+                                D3D12_GPU_DESCRIPTOR_HANDLE* pTable)
+{
+    // A table never wraps around the end of the ring
+    uint64_t offset = 0;
+    if (!RingAllocate(&allocator->ring, count, 1, &offset)) return false;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const D3D12_CPU_DESCRIPTOR_HANDLE destination = { .ptr = allocator->ringCPUStart.ptr + (SIZE_T)(offset + i) * allocator->descriptorSize };
+        allocator->device->lpVtbl->CopyDescriptorsSimple(allocator->device, 1, destination, descriptors[i],
+                                                        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+
+    pTable->ptr = allocator->ringGPUStart.ptr + offset * allocator->descriptorSize;
+    return true;
+}
+
+uint32_t DescriptorAllocatorGetHeapIndex(const D3D12DescriptorAllocator* allocator, D3D12_GPU_DESCRIPTOR_HANDLE table)
+{
+    return (uint32_t)((table.ptr - allocator->ringGPUStart.ptr) / allocator->descriptorSize);
+}
+
+bool DescriptorAllocatorFinishSubmission(D3D12DescriptorAllocator* allocator, uint64_t fenceValue)
+{
+    return RingFinishSubmission(&allocator->ring, fenceValue);
+}
+
+void DescriptorAllocatorRetire(D3D12DescriptorAllocator* allocator, uint64_t completedFenceValue)
+{
+    RingRetire(&allocator->ring, completedFenceValue);
+}
+
+ID3D12DescriptorHeap* DescriptorAllocatorGetShaderVisibleHeap(const D3D12DescriptorAllocator* allocator)
+{
+    return allocator->shaderVisibleHeap;
+}
+
+void DestroyD3D12DescriptorAllocator(D3D12DescriptorAllocator* allocator)
+{
+    if (allocator == NULL) return;
+
+    for (uint32_t i = 0; i < allocator->stagingHeapCount; ++i) {
+        allocator->stagingHeaps[i]->lpVtbl->Release(allocator->stagingHeaps[i]);
+    }
+    if (allocator->shaderVisibleHeap != NULL) {
+        allocator->shaderVisibleHeap->lpVtbl->Release(allocator->shaderVisibleHeap);
+    }
+
+    free(allocator->freeIndices);
+    free(allocator);
+}
@@ -0,0 +1,64 @@
+#ifndef D3D12_DESCRIPTOR_ALLOCATOR_H
+#define D3D12_DESCRIPTOR_ALLOCATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <d3d12.h>
+
+enum
+{
+    // The descriptors of each CPU-only staging heap. A new staging heap is added whenever all of them are in use.
+    DESCRIPTOR_STAGING_HEAP_SIZE = 1024,
+
+    // The max number of staging heaps
+    DESCRIPTOR_MAX_STAGING_HEAP_COUNT = 64
+};
+
+// The CBV/SRV/UAV descriptors of the buffers.
+// Each buffer owns a persistent descriptor in a CPU-only staging heap, allocated from a free list.
+// The staging heaps are never shader visible, so they grow by adding heaps without invalidating any descriptor.
+// Before each dispatch, the descriptor tables are copied with CopyDescriptorsSimple into a linear ring of the single
+// shader-visible heap, whose space is reclaimed once the fence value of the submission that used it completes.
+typedef struct D3D12DescriptorAllocator D3D12DescriptorAllocator;
+
+// A persistent descriptor of a staging heap. A zeroed one is not allocated.
+typedef struct D3D12StagedDescriptor
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle;
+
+    // The position of the descriptor across all the staging heaps
+    uint32_t index;
+} D3D12StagedDescriptor;
+
+// `ringSize` is the descriptor count of the shader-visible heap
+extern D3D12DescriptorAllocator* CreateD3D12DescriptorAllocator(ID3D12Device* device, uint32_t ringSize);
+
+// Allocate a persistent descriptor. Returns false if all the staging heaps are full and no more heap can be added.
+extern bool DescriptorAllocatorAllocate(D3D12DescriptorAllocator* allocator, D3D12StagedDescriptor* pDescriptor);
+
+// Return a persistent descriptor to the free list, and zero it. The descriptor tables copied from it before stay valid.
+extern void DescriptorAllocatorFree(D3D12DescriptorAllocator* allocator, D3D12StagedDescriptor* pDescriptor);
+
+// Copy `count` persistent descriptors into consecutive descriptors of the shader-visible ring,
+// and get the GPU handle of the first one. Returns false if the ring has no space left until older submissions complete.
+extern bool DescriptorAllocatorCopyTable(D3D12DescriptorAllocator* allocator, const D3D12_CPU_DESCRIPTOR_HANDLE descriptors[], uint32_t count,
+                                        D3D12_GPU_DESCRIPTOR_HANDLE* pTable);
+
+// The index of the first descriptor of `table` in the shader-visible heap, by which ResourceDescriptorHeap reaches it
+extern uint32_t DescriptorAllocatorGetHeapIndex(const D3D12DescriptorAllocator* allocator, D3D12_GPU_DESCRIPTOR_HANDLE table);
+
+// Tag the ring space of the tables copied since the last call with `fenceValue`, the value signaled after they are consumed.
+// Returns false if there are too many pending submissions.
+extern bool DescriptorAllocatorFinishSubmission(D3D12DescriptorAllocator* allocator, uint64_t fenceValue);
+
+// Reclaim the ring space of all the submissions whose fence values are not greater than `completedFenceValue`
+extern void DescriptorAllocatorRetire(D3D12DescriptorAllocator* allocator, uint64_t completedFenceValue);
+
+// The shader-visible heap that the tables are copied into, which is set on the command lists
+extern ID3D12DescriptorHeap* DescriptorAllocatorGetShaderVisibleHeap(const D3D12DescriptorAllocator* allocator);
+
+// All the heaps are released regardless of whether their descriptors are still allocated
+extern void DestroyD3D12DescriptorAllocator(D3D12DescriptorAllocator* allocator);
+
+#endif // D3D12_DESCRIPTOR_ALLOCATOR_H
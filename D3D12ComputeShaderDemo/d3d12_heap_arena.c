@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <Windows.h>
+#include <d3d12.h>
+
+#include "d3d12_heap_arena.h"
+#include "heap_allocator.h"
+
+enum
+{
+    // The default, upload and read-back heap types
+    HEAP_ARENA_POOL_COUNT = 3
+};
+
+// One ID3D12Heap and the buddy allocator of its range
+typedef struct ArenaHeap
+{
+    ID3D12Heap* heap;
+    BuddyAllocator* allocator;
+} ArenaHeap;
+
+// All the heaps of one heap type
+typedef struct ArenaPool
+{
+    D3D12_HEAP_TYPE heapType;
+    uint32_t heapCount;
+    ArenaHeap heaps[HEAP_ARENA_MAX_HEAP_COUNT];
+    uint64_t requestedBytes;
+} ArenaPool;
+
+// The placement of one live buffer
+typedef struct ArenaAllocation
+{
+    ID3D12Resource* buffer;
+    uint32_t poolIndex;
+    uint32_t heapIndex;
+    uint64_t offset;
+    uint64_t requestedSize;
+} ArenaAllocation;
+
+struct D3D12HeapArena
+{
+    ID3D12Device* device;
+    uint64_t heapSize;
+    ArenaPool pools[HEAP_ARENA_POOL_COUNT];
+
+    // The live buffers, so that a buffer can be released without the caller keeping its placement
+    ArenaAllocation* allocations;
+    size_t allocationCount;
+    size_t allocationCapacity;
+};
+
+static ArenaPool* GetPool(D3D12HeapArena* arena, D3D12_HEAP_TYPE heapType)
+{
+    switch (heapType)
+    {
+    case D3D12_HEAP_TYPE_DEFAULT:
+        return &arena->pools[0];
+    case D3D12_HEAP_TYPE_UPLOAD:
+        return &arena->pools[1];
+    case D3D12_HEAP_TYPE_READBACK:
+        return &arena->pools[2];
+    default:
+        return NULL;
+    }
+}
+
+// Reserve a new heap that can hold at least `minSize` bytes
+static ArenaHeap* AddHeap(D3D12HeapArena* arena, ArenaPool* pool, uint64_t minSize)
+{
+    if (pool->heapCount == HEAP_ARENA_MAX_HEAP_COUNT)
+    {
+        fprintf(stderr, "The heap arena has run out of heap slots!\n");
+        return NULL;
+    }
+
+    // Oversized buffers get a dedicated heap
+    uint64_t heapSize = arena->heapSize;
+    while (heapSize < minSize) {
+        heapSize <<= 1;
+    }
+
+    const D3D12_HEAP_DESC heapDesc = {
+        .SizeInBytes = heapSize,
+        .Properties = {
+            .Type = pool->heapType,
+            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+            .CreationNodeMask = 1,
+            .VisibleNodeMask = 1
+        },
+        .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+        // Buffer-only heaps are supported by resource heap tier 1
+        .Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+    };
+
+    ArenaHeap* arenaHeap = &pool->heaps[pool->heapCount];
+    HRESULT hr = arena->device->lpVtbl->CreateHeap(arena->device, &heapDesc, &IID_ID3D12Heap, (void**)&arenaHeap->heap);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "CreateHeap failed: %ld\n", hr);
+        return NULL;
+    }
+
+    arenaHeap->allocator = CreateBuddyAllocator(heapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    if (arenaHeap->allocator == NULL)
+    {
+        arenaHeap->heap->lpVtbl->Release(arenaHeap->heap);
+        arenaHeap->heap = NULL;
+        return NULL;
+    }
+
+    ++pool->heapCount;
+    return arenaHeap;
+}
+
+static bool RecordAllocation(D3D12HeapArena* arena, const ArenaAllocation* allocation)
+{
+    if (arena->allocationCount == arena->allocationCapacity)
+    {
+        const size_t newCapacity = arena->allocationCapacity == 0 ? 16 : arena->allocationCapacity * 2;
+        ArenaAllocation* allocations = realloc(arena->allocations, newCapacity * sizeof(*allocations));
+        if (allocations == NULL) return false;
+
+        arena->allocations = allocations;
+        arena->allocationCapacity = newCapacity;
+    }
+
+    arena->allocations[arena->allocationCount++] = *allocation;
+    return true;
+}
+
+D3D12HeapArena* CreateD3D12HeapArena(ID3D12Device* device, uint64_t heapSize)
+{
+    if (heapSize == 0) {
+        heapSize = HEAP_ARENA_DEFAULT_HEAP_SIZE;
+    }
+    if ((heapSize & (heapSize - 1)) != 0 || heapSize < D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) return NULL;
+
+    D3D12HeapArena* arena = calloc(1, sizeof(*arena));
+    if (arena == NULL) return NULL;
+
+    device->lpVtbl->AddRef(device);
+    arena->device = device;
+    arena->heapSize = heapSize;
+    arena->pools[0].heapType = D3D12_HEAP_TYPE_DEFAULT;
+    arena->pools[1].heapType = D3D12_HEAP_TYPE_UPLOAD;
+    arena->pools[2].heapType = D3D12_HEAP_TYPE_READBACK;
+
+    return arena;
+}
+
+ID3D12Resource* HeapArenaCreateBuffer(D3D12HeapArena* arena, D3D12_HEAP_TYPE heapType, uint64_t size,
+                                    D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState)
+{
+    ArenaPool* pool = GetPool(arena, heapType);
+    if (pool == NULL || size == 0) return NULL;
+
+    const D3D12_RESOURCE_DESC resourceDesc = {
+        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+        .Alignment = 0,
+        .Width = size,
+        .Height = 1,
+        .DepthOrArraySize = 1,
+        .MipLevels = 1,
+        .Format = DXGI_FORMAT_UNKNOWN,
+        .SampleDesc = {.Count = 1, .Quality = 0 },
+        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+        .Flags = flags
+    };
+
+    D3D12_RESOURCE_ALLOCATION_INFO allocationInfo;
+    arena->device->lpVtbl->GetResourceAllocationInfo(arena->device, &allocationInfo, 0, 1, &resourceDesc);
+
+    // Try the existing heaps first, and only reserve a new one when none of them has a large enough free block
+    ArenaAllocation allocation = { .poolIndex = (uint32_t)(pool - arena->pools), .requestedSize = size };
+    bool allocated = false;
+    for (uint32_t i = 0; i < pool->heapCount && !allocated; ++i)
+    {
+        allocated = BuddyAllocate(pool->heaps[i].allocator, allocationInfo.SizeInBytes, allocationInfo.Alignment, &allocation.offset);
+        allocation.heapIndex = i;
+    }
+    if (!allocated)
+    {
+        const ArenaHeap* newHeap = AddHeap(arena, pool, allocationInfo.SizeInBytes);
+        if (newHeap == NULL) return NULL;
+
+        allocation.heapIndex = pool->heapCount - 1;
+        if (!BuddyAllocate(newHeap->allocator, allocationInfo.SizeInBytes, allocationInfo.Alignment, &allocation.offset)) return NULL;
+    }
+
+    ArenaHeap* arenaHeap = &pool->heaps[allocation.heapIndex];
+    HRESULT hr = arena->device->lpVtbl->CreatePlacedResource(arena->device, arenaHeap->heap, allocation.offset, &resourceDesc,
+                                                        initialState, NULL, &IID_ID3D12Resource, (void**)&allocation.buffer);
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "CreatePlacedResource failed: %ld\n", hr);
+        BuddyFree(arenaHeap->allocator, allocation.offset);
+        return NULL;
+    }
+
+    if (!RecordAllocation(arena, &allocation))
+    {
+        fprintf(stderr, "Lack of memory for heap arena allocation records...\n");
+        allocation.buffer->lpVtbl->Release(allocation.buffer);
+        BuddyFree(arenaHeap->allocator, allocation.offset);
+        return NULL;
+    }
+
+    pool->requestedBytes += size;
+    return allocation.buffer;
+}
+
+void HeapArenaReleaseBuffer(D3D12HeapArena* arena, ID3D12Resource* buffer)
+{
+    if (arena == NULL || buffer == NULL) return;
+
+    for (size_t i = 0; i < arena->allocationCount; ++i)
+    {
+        ArenaAllocation* allocation = &arena->allocations[i];
+        if (allocation->buffer != buffer) continue;
+
+        ArenaPool* pool = &arena->pools[allocation->poolIndex];
+        buffer->lpVtbl->Release(buffer);
+        BuddyFree(pool->heaps[allocation->heapIndex].allocator, allocation->offset);
+        pool->requestedBytes -= allocation->requestedSize;
+
+        // The order of the records does not matter
+        *allocation = arena->allocations[--arena->allocationCount];
+        return;
+    }
+
+    fprintf(stderr, "The buffer is not allocated by the heap arena!\n");
+}
+
+void HeapArenaGetStats(const D3D12HeapArena* arena, D3D12_HEAP_TYPE heapType, D3D12HeapArenaStats* pStats)
+{
+    *pStats = (D3D12HeapArenaStats){ 0 };
+
+    const ArenaPool* pool = GetPool((D3D12HeapArena*)arena, heapType);
+    if (pool == NULL) return;
+
+    pStats->heapCount = pool->heapCount;
+    pStats->requestedBytes = pool->requestedBytes;
+    for (uint32_t i = 0; i < pool->heapCount; ++i)
+    {
+        BuddyAllocatorStats heapStats;
+        BuddyGetStats(pool->heaps[i].allocator, &heapStats);
+
+        pStats->reservedBytes += heapStats.capacity;
+        pStats->usedBytes += heapStats.usedBytes;
+        pStats->allocationCount += heapStats.allocationCount;
+        if (heapStats.largestFreeBlock > pStats->largestFreeBlock) {
+            pStats->largestFreeBlock = heapStats.largestFreeBlock;
+        }
+    }
+
+    const uint64_t freeBytes = pStats->reservedBytes - pStats->usedBytes;
+    pStats->fragmentation = freeBytes == 0 ? 0.0 : 1.0 - (double)pStats->largestFreeBlock / (double)freeBytes;
+}
+
+void DestroyD3D12HeapArena(D3D12HeapArena* arena)
+{
+    if (arena == NULL) return;
+
+    if (arena->allocationCount > 0) {
+        fprintf(stderr, "WARNING: %zu buffers are still alive when the heap arena is destroyed!\n", arena->allocationCount);
+    }
+
+    for (uint32_t i = 0; i < HEAP_ARENA_POOL_COUNT; ++i)
+    {
+        ArenaPool* pool = &arena->pools[i];
+        for (uint32_t j = 0; j < pool->heapCount; ++j)
+        {
+            pool->heaps[j].heap->lpVtbl->Release(pool->heaps[j].heap);
+            DestroyBuddyAllocator(pool->heaps[j].allocator);
+        }
+    }
+
+    arena->device->lpVtbl->Release(arena->device);
+    free(arena->allocations);
+    free(arena);
+}
+
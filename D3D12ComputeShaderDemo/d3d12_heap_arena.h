@@ -0,0 +1,64 @@
+#ifndef D3D12_HEAP_ARENA_H
+#define D3D12_HEAP_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <d3d12.h>
+
+enum
+{
+    // The default size of each ID3D12Heap reserved by the arena
+    HEAP_ARENA_DEFAULT_HEAP_SIZE = 64 * 1024 * 1024,
+
+    // The max number of ID3D12Heap objects of each heap type
+    HEAP_ARENA_MAX_HEAP_COUNT = 32
+};
+
+// An arena that reserves large ID3D12Heap objects for the default, upload and read-back heap types,
+// and sub-allocates placed buffers from them with a buddy allocator (heap_allocator.h).
+typedef struct D3D12HeapArena D3D12HeapArena;
+
+// The occupancy of all the heaps of one heap type
+typedef struct D3D12HeapArenaStats
+{
+    // The number of ID3D12Heap objects
+    uint32_t heapCount;
+
+    // The total size of the ID3D12Heap objects
+    uint64_t reservedBytes;
+
+    // The bytes occupied by the placed buffers, including the rounding up to the buddy block sizes
+    uint64_t usedBytes;
+
+    // The bytes requested by the placed buffers
+    uint64_t requestedBytes;
+
+    // The number of live placed buffers
+    uint32_t allocationCount;
+
+    // The largest free block of all the heaps
+    uint64_t largestFreeBlock;
+
+    // 1 - largestFreeBlock / free bytes of all the heaps
+    double fragmentation;
+} D3D12HeapArenaStats;
+
+// Create the arena. `heapSize` (0 for HEAP_ARENA_DEFAULT_HEAP_SIZE) must be a power of 2.
+extern D3D12HeapArena* CreateD3D12HeapArena(ID3D12Device* device, uint64_t heapSize);
+
+// Create a placed buffer of `size` bytes on a heap of `heapType`.
+// Returns NULL on failure.
+extern ID3D12Resource* HeapArenaCreateBuffer(D3D12HeapArena* arena, D3D12_HEAP_TYPE heapType, uint64_t size,
+                                            D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState);
+
+// Release a buffer created by `HeapArenaCreateBuffer` and return its memory to the arena
+extern void HeapArenaReleaseBuffer(D3D12HeapArena* arena, ID3D12Resource* buffer);
+
+extern void HeapArenaGetStats(const D3D12HeapArena* arena, D3D12_HEAP_TYPE heapType, D3D12HeapArenaStats* pStats);
+
+// All the buffers created by the arena must have been released
+extern void DestroyD3D12HeapArena(D3D12HeapArena* arena);
+
+#endif // D3D12_HEAP_ARENA_H
+
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <Windows.h>
+#include <d3d12.h>
+
+#include "d3d12_readback_pool.h"
+
+// One pooled read-back buffer
+typedef struct ReadbackEntry
+{
+    ReadbackSlice slice;
+
+    // The fence value at which the last copy into the buffer completes
+    uint64_t fenceValue;
+
+    // Acquired and not yet released by the host
+    bool acquired;
+} ReadbackEntry;
+
+struct D3D12ReadbackPool
+{
+    D3D12HeapArena* arena;
+    uint32_t entryCount;
+    ReadbackEntry entries[READBACK_POOL_MAX_BUFFER_COUNT];
+};
+
+static ReadbackEntry* FindEntry(D3D12ReadbackPool* pool, const void* data)
+{
+    for (uint32_t i = 0; i < pool->entryCount; ++i)
+    {
+        if (pool->entries[i].slice.data == data) return &pool->entries[i];
+    }
+    return NULL;
+}
+
+static void ReleaseEntryBuffer(D3D12ReadbackPool* pool, ReadbackEntry* entry)
+{
+    ID3D12Resource* buffer = entry->slice.buffer;
+    buffer->lpVtbl->Unmap(buffer, 0, NULL);
+    HeapArenaReleaseBuffer(pool->arena, buffer);
+    entry->slice = (ReadbackSlice){ 0 };
+}
+
+D3D12ReadbackPool* CreateD3D12ReadbackPool(D3D12HeapArena* arena)
+{
+    D3D12ReadbackPool* pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) return NULL;
+
+    pool->arena = arena;
+    return pool;
+}
+
+bool ReadbackPoolAcquire(D3D12ReadbackPool* pool, uint64_t size, uint64_t completedFenceValue, ReadbackSlice* pSlice)
+{
+    // Reuse the smallest idle buffer that is large enough
+    ReadbackEntry* bestEntry = NULL;
+    ReadbackEntry* idleEntry = NULL;
+    for (uint32_t i = 0; i < pool->entryCount; ++i)
+    {
+        ReadbackEntry* entry = &pool->entries[i];
+        if (entry->acquired || entry->fenceValue > completedFenceValue) continue;
+
+        idleEntry = entry;
+        if (entry->slice.size >= size && (bestEntry == NULL || entry->slice.size < bestEntry->slice.size)) {
+            bestEntry = entry;
+        }
+    }
+
+    if (bestEntry == NULL)
+    {
+        // Replace an idle buffer that is too small when the pool is full
+        if (pool->entryCount < READBACK_POOL_MAX_BUFFER_COUNT) {
+            bestEntry = &pool->entries[pool->entryCount++];
+        }
+        else if (idleEntry != NULL)
+        {
+            ReleaseEntryBuffer(pool, idleEntry);
+            bestEntry = idleEntry;
+        }
+        else
+        {
+            fprintf(stderr, "All the read-back buffers are in use!\n");
+            return false;
+        }
+
+        ID3D12Resource* buffer = HeapArenaCreateBuffer(pool->arena, D3D12_HEAP_TYPE_READBACK, size,
+                                                    D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+        if (buffer == NULL)
+        {
+            *bestEntry = pool->entries[--pool->entryCount];
+            return false;
+        }
+
+        // Read-back heaps are cache coherent, so the buffer can stay mapped while the device writes into it.
+        // The host only reads it after the fence of the copy has completed.
+        void* data = NULL;
+        const D3D12_RANGE readRange = { 0, (SIZE_T)size };
+        HRESULT hr = buffer->lpVtbl->Map(buffer, 0, &readRange, &data);
+        if (FAILED(hr))
+        {
+            fprintf(stderr, "Map the read-back buffer failed: %ld\n", hr);
+            HeapArenaReleaseBuffer(pool->arena, buffer);
+            *bestEntry = pool->entries[--pool->entryCount];
+            return false;
+        }
+
+        *bestEntry = (ReadbackEntry){ .slice = { .buffer = buffer, .data = data, .size = size } };
+    }
+
+    bestEntry->acquired = true;
+    *pSlice = bestEntry->slice;
+    return true;
+}
+
+void ReadbackPoolSubmit(D3D12ReadbackPool* pool, const ReadbackSlice* slice, uint64_t fenceValue)
+{
+    ReadbackEntry* entry = FindEntry(pool, slice->data);
+    if (entry != NULL) {
+        entry->fenceValue = fenceValue;
+    }
+}
+
+void ReadbackPoolRelease(D3D12ReadbackPool* pool, const void* data)
+{
+    ReadbackEntry* entry = FindEntry(pool, data);
+    if (entry != NULL) {
+        entry->acquired = false;
+    }
+}
+
+void DestroyD3D12ReadbackPool(D3D12ReadbackPool* pool)
+{
+    if (pool == NULL) return;
+
+    for (uint32_t i = 0; i < pool->entryCount; ++i) {
+        ReleaseEntryBuffer(pool, &pool->entries[i]);
+    }
+    free(pool);
+}
+
@@ -0,0 +1,49 @@
+#ifndef D3D12_READBACK_POOL_H
+#define D3D12_READBACK_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <d3d12.h>
+
+#include "d3d12_heap_arena.h"
+
+enum
+{
+    // The max number of read-back buffers kept by the pool
+    READBACK_POOL_MAX_BUFFER_COUNT = 16
+};
+
+// A pool of persistently mapped read-back buffers.
+// A buffer is recycled once the host has released it and the device has finished the copy into it.
+typedef struct D3D12ReadbackPool D3D12ReadbackPool;
+
+// One read-back buffer acquired from the pool
+typedef struct ReadbackSlice
+{
+    ID3D12Resource* buffer;
+
+    // The persistently mapped host address of `buffer`
+    const void* data;
+
+    // The size of `buffer`, which may be larger than the requested size
+    uint64_t size;
+} ReadbackSlice;
+
+extern D3D12ReadbackPool* CreateD3D12ReadbackPool(D3D12HeapArena* arena);
+
+// Acquire a read-back buffer of at least `size` bytes. `completedFenceValue` is the completed value of the fence
+// that the copies into the pooled buffers are tracked with. Returns false on failure.
+extern bool ReadbackPoolAcquire(D3D12ReadbackPool* pool, uint64_t size, uint64_t completedFenceValue, ReadbackSlice* pSlice);
+
+// Record that the copy into `slice` is finished when the fence reaches `fenceValue`
+extern void ReadbackPoolSubmit(D3D12ReadbackPool* pool, const ReadbackSlice* slice, uint64_t fenceValue);
+
+// Return the buffer whose mapped host address is `data` to the pool
+extern void ReadbackPoolRelease(D3D12ReadbackPool* pool, const void* data);
+
+// All the buffers are released regardless of whether they are still acquired
+extern void DestroyD3D12ReadbackPool(D3D12ReadbackPool* pool);
+
+#endif // D3D12_READBACK_POOL_H
+
@@ -0,0 +1,178 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "heap_allocator.h"
+
+// The allocator is a complete binary tree stored in an array, whose root is the whole range and whose leaves are the
+// minimum blocks. Each node records (order + 1) of the largest free block in its subtree, where a block of order `k`
+// spans `minBlockSize << k` bytes. 0 means the subtree is fully allocated.
+struct BuddyAllocator
+{
+    uint64_t capacity;
+    uint64_t minBlockSize;
+    uint64_t usedBytes;
+    uint32_t allocationCount;
+    unsigned maxOrder;
+    size_t leafCount;
+    uint8_t tree[];
+};
+
+static inline bool IsPowerOf2(uint64_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+static inline unsigned Log2(uint64_t value)
+{
+    unsigned result = 0;
+    while (value > 1)
+    {
+        value >>= 1;
+        ++result;
+    }
+    return result;
+}
+
+// The order of the smallest block that holds `size` bytes aligned to `alignment`
+static unsigned GetBlockOrder(const BuddyAllocator* allocator, uint64_t size, uint64_t alignment)
+{
+    const uint64_t required = size > alignment ? size : alignment;
+    unsigned order = 0;
+    while ((allocator->minBlockSize << order) < required && order <= allocator->maxOrder) {
+        ++order;
+    }
+    return order;
+}
+
+// Recompute the ancestors of `node` (of order `order`) after its free state has changed
+static void UpdateAncestors(BuddyAllocator* allocator, size_t node, unsigned order)
+{
+    uint8_t* tree = allocator->tree;
+    while (node > 0)
+    {
+        node = (node - 1) / 2;
+        const uint8_t fullChild = (uint8_t)(order + 1);
+        const uint8_t left = tree[2 * node + 1];
+        const uint8_t right = tree[2 * node + 2];
+
+        // Two fully free buddies merge into one block of the parent order
+        tree[node] = left == fullChild && right == fullChild ? (uint8_t)(fullChild + 1) : (left > right ? left : right);
+        ++order;
+    }
+}
+
+BuddyAllocator* CreateBuddyAllocator(uint64_t capacity, uint64_t minBlockSize)
+{
+    if (!IsPowerOf2(capacity) || !IsPowerOf2(minBlockSize) || capacity < minBlockSize) return NULL;
+
+    const size_t leafCount = (size_t)(capacity / minBlockSize);
+    const size_t nodeCount = 2 * leafCount - 1;
+
+    BuddyAllocator* allocator = malloc(sizeof(*allocator) + nodeCount);
+    if (allocator == NULL) return NULL;
+
+    allocator->capacity = capacity;
+    allocator->minBlockSize = minBlockSize;
+    allocator->usedBytes = 0;
+    allocator->allocationCount = 0;
+    allocator->maxOrder = Log2(leafCount);
+    allocator->leafCount = leafCount;
+
+    // Every node starts as one free block of its own order
+    unsigned order = allocator->maxOrder + 1;
+    for (size_t levelBegin = 0, levelSize = 1; levelBegin < nodeCount; levelBegin += levelSize, levelSize *= 2, --order)
+    {
+        for (size_t i = 0; i < levelSize; ++i) {
+            allocator->tree[levelBegin + i] = (uint8_t)order;
+        }
+    }
+
+    return allocator;
+}
+
+bool BuddyAllocate(BuddyAllocator* allocator, uint64_t size, uint64_t alignment, uint64_t* pOffset)
+{
+    if (allocator == NULL || size == 0 || (alignment != 0 && !IsPowerOf2(alignment))) return false;
+
+    const unsigned order = GetBlockOrder(allocator, size, alignment);
+    if (order > allocator->maxOrder) return false;
+
+    uint8_t* tree = allocator->tree;
+    const uint8_t required = (uint8_t)(order + 1);
+    if (tree[0] < required) return false;
+
+    // Descend to a free block of the required order.
+    // When both children fit, take the tighter one so that the larger free blocks stay intact.
+    size_t node = 0;
+    for (unsigned nodeOrder = allocator->maxOrder; nodeOrder != order; --nodeOrder)
+    {
+        const size_t left = 2 * node + 1;
+        const size_t right = left + 1;
+        if (tree[left] >= required && (tree[right] < required || tree[left] <= tree[right])) {
+            node = left;
+        }
+        else {
+            node = right;
+        }
+    }
+
+    tree[node] = 0;
+    UpdateAncestors(allocator, node, order);
+
+    const unsigned depth = allocator->maxOrder - order;
+    const uint64_t indexInLevel = (uint64_t)(node - (((size_t)1 << depth) - 1));
+    *pOffset = indexInLevel * (allocator->minBlockSize << order);
+
+    allocator->usedBytes += allocator->minBlockSize << order;
+    ++allocator->allocationCount;
+
+    return true;
+}
+
+void BuddyFree(BuddyAllocator* allocator, uint64_t offset)
+{
+    if (allocator == NULL || offset >= allocator->capacity || offset % allocator->minBlockSize != 0) return;
+
+    // The allocated block is the lowest node on the path from the leaf at `offset` to the root that is marked as 0
+    size_t node = (size_t)(offset / allocator->minBlockSize) + allocator->leafCount - 1;
+    unsigned order = 0;
+    while (allocator->tree[node] != 0)
+    {
+        // Not allocated
+        if (node == 0) return;
+
+        node = (node - 1) / 2;
+        ++order;
+    }
+
+    allocator->tree[node] = (uint8_t)(order + 1);
+    UpdateAncestors(allocator, node, order);
+
+    allocator->usedBytes -= allocator->minBlockSize << order;
+    --allocator->allocationCount;
+}
+
+uint64_t BuddyGetBlockSize(const BuddyAllocator* allocator, uint64_t size, uint64_t alignment)
+{
+    const unsigned order = GetBlockOrder(allocator, size, alignment);
+    return order > allocator->maxOrder ? 0 : allocator->minBlockSize << order;
+}
+
+void BuddyGetStats(const BuddyAllocator* allocator, BuddyAllocatorStats* pStats)
+{
+    const uint64_t freeBytes = allocator->capacity - allocator->usedBytes;
+    const uint8_t largest = allocator->tree[0];
+
+    pStats->capacity = allocator->capacity;
+    pStats->usedBytes = allocator->usedBytes;
+    pStats->allocationCount = allocator->allocationCount;
+    pStats->largestFreeBlock = largest == 0 ? 0 : allocator->minBlockSize << (largest - 1);
+    pStats->fragmentation = freeBytes == 0 ? 0.0 : 1.0 - (double)pStats->largestFreeBlock / (double)freeBytes;
+}
+
+void DestroyBuddyAllocator(BuddyAllocator* allocator)
+{
+    free(allocator);
+}
+
@@ -0,0 +1,51 @@
+#ifndef HEAP_ALLOCATOR_H
+#define HEAP_ALLOCATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// A buddy allocator that sub-allocates offsets inside one contiguous range, such as an ID3D12Heap.
+// It never touches the managed memory itself, so it can be exercised on the host without any device.
+// Each block is aligned to its own size, so any power-of-2 alignment up to the block size comes for free.
+typedef struct BuddyAllocator BuddyAllocator;
+
+// The occupancy of a buddy allocator
+typedef struct BuddyAllocatorStats
+{
+    // The size of the managed range in bytes
+    uint64_t capacity;
+
+    // The bytes occupied by the allocated blocks, including the rounding up to the block sizes
+    uint64_t usedBytes;
+
+    // The number of live allocations
+    uint32_t allocationCount;
+
+    // The size of the largest block that can still be allocated
+    uint64_t largestFreeBlock;
+
+    // 1 - largestFreeBlock / freeBytes. 0 means all the free bytes are available as a single block.
+    double fragmentation;
+} BuddyAllocatorStats;
+
+// Create a buddy allocator managing `capacity` bytes with blocks of at least `minBlockSize` bytes.
+// Both of them must be powers of 2 and `capacity` must not be less than `minBlockSize`.
+extern BuddyAllocator* CreateBuddyAllocator(uint64_t capacity, uint64_t minBlockSize);
+
+// Allocate `size` bytes aligned to `alignment` (0 or a power of 2).
+// Returns false if there is no free block large enough.
+extern bool BuddyAllocate(BuddyAllocator* allocator, uint64_t size, uint64_t alignment, uint64_t* pOffset);
+
+// Free the block that starts at `offset`, and merge it with its free buddies
+extern void BuddyFree(BuddyAllocator* allocator, uint64_t offset);
+
+// Returns the block size that an allocation of `size` bytes occupies, or 0 if it exceeds the capacity
+extern uint64_t BuddyGetBlockSize(const BuddyAllocator* allocator, uint64_t size, uint64_t alignment);
+
+extern void BuddyGetStats(const BuddyAllocator* allocator, BuddyAllocatorStats* pStats);
+
+extern void DestroyBuddyAllocator(BuddyAllocator* allocator);
+
+#endif // HEAP_ALLOCATOR_H
+
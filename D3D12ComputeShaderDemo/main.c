@@ -1,1535 +1,657 @@
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include <stdlib.h>
-#include <stdalign.h>
-
-#define _USE_MATH_DEFINES
-#include <math.h>
-
-#include <Windows.h>
-#include <d3d12.h>
-#include <d3dcompiler.h>
-#include <dxgi1_4.h>
-
-enum
-{
-    // Max number of hardware adapter count
-    MAX_HARDWARE_ADAPTER_COUNT = 16,
-
-    // Test data element count
-    TEST_DATA_COUNT = 4096,
-
-    // Command Queue Fence signal value for data transfer
-    COPY_SYNC_SIGNAL_VALUE = 1,
-
-    // Command Queue Fence signal value for compute shader execution
-    COMPUTE_SYNC_SIGNAL_VALUE = 2
-};
-
-// The factory used to create D3D12 devices
-static IDXGIFactory4* s_factory;
-
-// The compatible D3D12 device object
-static ID3D12Device *s_device;
-
-// The root signature for compute pipeline state object
-static ID3D12RootSignature *s_computeRootSignature;
-
-// The compute pipeline state object
-static ID3D12PipelineState *s_computeState;
-
-// The descriptor heap resource object. 
-// In this sample, there're two slots in this heap. 
-// The first slot stores the shader view resource descriptor, 
-// and the second slot stores the unordered access view descriptor.
-static ID3D12DescriptorHeap* s_heap;
-
-// The destination buffer object with unordered access view type
-static ID3D12Resource *s_dstDataBuffer;
-
-// The source buffer object with shader source view type
-static ID3D12Resource *s_srcDataBuffer;
-
-// The intermediate buffer object used to copy the source data to the SRV buffer
-static ID3D12Resource* s_uploadBuffer;
-
-// The second destination buffer object with unordered access view type
-static ID3D12Resource* s_dst2Buffer;
-
-// The intermediate buffer object used to copy specified data to the the second destination data
-static ID3D12Resource* s_dst2UploadBuffer;
-
-// The constant buffer object
-static ID3D12Resource* s_constantBuffer;
-
-// The intermediate buffer object used to upload data to the constant buffer object
-static ID3D12Resource* s_constantUploadBuffer;
-
-// The heap descriptor(of SRV, UAV and CBV type)  size
-static size_t s_srvUavDescriptorSize;
-
-// The command allocator object
-static ID3D12CommandAllocator *s_computeAllocator;
-
-// The command queue object
-static ID3D12CommandQueue *s_computeCommandQueue;
-
-// The command list object
-static ID3D12GraphicsCommandList *s_computeCommandList;
-
-// Fence object
-static ID3D12Fence* s_fence;
-
-// Win32 API event handle
-static HANDLE s_hEvent;
-
-// Indicate whether the specified D3D device supports root signature version 1.1 or not
-static bool s_supportSignatureVersion1_1;
-
-// The first source data buffer
-static int *s_dataBuffer0;
-
-// The second source data buffer
-static int* s_dataBuffer1;
-
-
-static void TransWStrToString(char dstBuf[], const WCHAR srcBuf[])
-{
-    if (dstBuf == NULL || srcBuf == NULL) return;
-
-    const int len = WideCharToMultiByte(CP_UTF8, 0, srcBuf, -1, NULL, 0, NULL, NULL);
-    WideCharToMultiByte(CP_UTF8, 0, srcBuf, -1, dstBuf, len, NULL, NULL);
-    dstBuf[len] = '\0';
-}
-
-static D3D12_SHADER_BYTECODE CreateCompiledShaderObjectFromPath(const char csoPath[])
-{
-    D3D12_SHADER_BYTECODE result = { 0 };
-    FILE* fp = NULL;
-    const errno_t err = fopen_s(&fp, csoPath, "rb");
-    if (err != 0 || fp == NULL)
-    {
-        fprintf(stderr, "Read compiled shader object file: `%s` failed: %d\n", csoPath, err);
-        if (fp != NULL) {
-            fclose(fp);
-        }
-        return result;
-    }
-
-    fseek(fp, 0, SEEK_END);
-    const size_t fileSize = (size_t)ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    const size_t codeElemCount = (fileSize + sizeof(uint32_t)) / sizeof(uint32_t);
-    uint32_t* csoBlob = (uint32_t*)calloc(codeElemCount, sizeof(uint32_t));
-    if (csoBlob == NULL)
-    {
-        fprintf(stderr, "Lack of system memory to allocate memory for `%s` CSO object!\n", csoPath);
-        return result;
-    }
-    if (fread(csoBlob, 1, fileSize, fp) < 1) {
-        printf("WARNING: Read compiled shader object file `%s` error!\n", csoPath);
-    }
-    fclose(fp);
-
-    result.pShaderBytecode = csoBlob;
-    result.BytecodeLength = fileSize;
-    return result;
-}
-
-static bool QueryDeviceSupportedMaxFeatureLevel(void)
-{
-    const D3D_FEATURE_LEVEL requestedLevels[] = {
-        D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_11_1,
-        D3D_FEATURE_LEVEL_12_0, D3D_FEATURE_LEVEL_12_1, D3D_FEATURE_LEVEL_12_2
-    };
-    D3D12_FEATURE_DATA_FEATURE_LEVELS featureLevels = {
-        .NumFeatureLevels = sizeof(requestedLevels) / sizeof(requestedLevels[0]),
-        .pFeatureLevelsRequested = requestedLevels
-    };
-
-    auto const hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_FEATURE_LEVELS, &featureLevels, sizeof(featureLevels));
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_FEATURE_LEVELS` failed: %ld\n", hRes);
-        return false;
-    }
-
-    const D3D_FEATURE_LEVEL maxFeatureLevel = featureLevels.MaxSupportedFeatureLevel;
-
-    char strBuf[32] = { '\0' };
-    switch (maxFeatureLevel)
-    {
-    case D3D_FEATURE_LEVEL_1_0_CORE:
-        strcpy_s(strBuf, sizeof(strBuf), "1.0 core");
-        break;
-
-    case D3D_FEATURE_LEVEL_9_1:
-        strcpy_s(strBuf, sizeof(strBuf), "9.1");
-        break;
-
-    case D3D_FEATURE_LEVEL_9_2:
-        strcpy_s(strBuf, sizeof(strBuf), "9.2");
-        break;
-
-    case D3D_FEATURE_LEVEL_9_3:
-        strcpy_s(strBuf, sizeof(strBuf), "9.3");
-        break;
-
-    case D3D_FEATURE_LEVEL_10_0:
-        strcpy_s(strBuf, sizeof(strBuf), "10.0");
-        break;
-
-    case D3D_FEATURE_LEVEL_10_1:
-        strcpy_s(strBuf, sizeof(strBuf), "10.1");
-        break;
-
-    case D3D_FEATURE_LEVEL_11_0:
-        strcpy_s(strBuf, sizeof(strBuf), "11.0");
-        break;
-
-    case D3D_FEATURE_LEVEL_11_1:
-        strcpy_s(strBuf, sizeof(strBuf), "11.1");
-        break;
-
-    case D3D_FEATURE_LEVEL_12_0:
-        strcpy_s(strBuf, sizeof(strBuf), "12.0");
-        break;
-
-    case D3D_FEATURE_LEVEL_12_1:
-        strcpy_s(strBuf, sizeof(strBuf), "12.1");
-        break;
-
-    case D3D_FEATURE_LEVEL_12_2:
-        strcpy_s(strBuf, sizeof(strBuf), "12.2");
-        break;
-
-    default:
-        break;
-    }
-
-    printf("Current device supports max feature level: %s\n", strBuf);
-    return true;
-}
-
-static bool CreateD3D12Device(void)
-{
-    HRESULT hRes = S_OK;
-
-#if defined(DEBUG) || defined(_DEBUG)
-    // In debug mode
-    ID3D12Debug* debugController = NULL;
-    hRes = D3D12GetDebugInterface(&IID_ID3D12Debug, (void**)&debugController);
-    if (SUCCEEDED(hRes)) {
-        debugController->lpVtbl->EnableDebugLayer(debugController);
-    }
-    else {
-        printf("WARNING: Failed to enable debug layer: %ld\n", hRes);
-    }
-#endif // defined(DEBUG) || defined(_DEBUG)
-
-    hRes = CreateDXGIFactory1(&IID_IDXGIFactory4, (void**)&s_factory);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CreateDXGIFactory1 failed: %ld\n", hRes);
-        return false;
-    }
-
-    // Enumerate the adapters (video cards)
-    IDXGIAdapter1* hardwareAdapters[MAX_HARDWARE_ADAPTER_COUNT] = { 0 };
-    UINT foundAdapterCount;
-    for (foundAdapterCount = 0; foundAdapterCount < MAX_HARDWARE_ADAPTER_COUNT; ++foundAdapterCount)
-    {
-        hRes = s_factory->lpVtbl->EnumAdapters1(s_factory, foundAdapterCount, &hardwareAdapters[foundAdapterCount]);
-        if (FAILED(hRes))
-        {
-            if (hRes != DXGI_ERROR_NOT_FOUND) {
-                printf("WARNING: Some error occurred during enumerating adapters: %ld\n", hRes);
-            }
-            break;
-        }
-    }
-    if (foundAdapterCount == 0)
-    {
-        fprintf(stderr, "There are no Direct3D capable adapters found on the current platform...\n");
-        return false;
-    }
-
-    printf("Found %u Direct3D capable device%s in all.\n", foundAdapterCount, foundAdapterCount > 1 ? "s" : "");
-
-    DXGI_ADAPTER_DESC1 adapterDesc = { 0 };
-    char strBuf[512] = { '\0' };
-    for (UINT i = 0; i < foundAdapterCount; ++i)
-    {
-        hRes = hardwareAdapters[i]->lpVtbl->GetDesc1(hardwareAdapters[i], &adapterDesc);
-        if (FAILED(hRes))
-        {
-            fprintf(stderr, "hardwareAdapters[%u] GetDesc1 failed: %ld\n", i, hRes);
-            return false;
-        }
-
-        TransWStrToString(strBuf, adapterDesc.Description);
-        printf("Adapter[%u]: %s\n", i, strBuf);
-    }
-    printf("Please Choose which adapter to use: ");
-
-    gets_s(strBuf, sizeof(strBuf));
-
-    char* endChar = NULL;
-    int selectedAdapterIndex = atoi(strBuf);
-    if (selectedAdapterIndex < 0 || selectedAdapterIndex >= (int)foundAdapterCount)
-    {
-        puts("WARNING: The index you input exceeds the range of available adatper count. So adatper[0] will be used!");
-        selectedAdapterIndex = 0;
-    }
-
-    hRes = hardwareAdapters[selectedAdapterIndex]->lpVtbl->GetDesc1(hardwareAdapters[selectedAdapterIndex], &adapterDesc);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "hardwareAdapters[%d] GetDesc1 failed: %ld\n", selectedAdapterIndex, hRes);
-        return false;
-    }
-
-    TransWStrToString(strBuf, adapterDesc.Description);
-
-    printf("\nYou have chosen adapter[%ld]\n", selectedAdapterIndex);
-    printf("Adapter description: %s\n", strBuf);
-    printf("Dedicated Video Memory: %.1f GB\n", (double)(adapterDesc.DedicatedVideoMemory) / (1024.0 * 1024.0 * 1024.0));
-    printf("Dedicated System Memory: %.1f GB\n", (double)(adapterDesc.DedicatedSystemMemory) / (1024.0 * 1024.0 * 1024.0));
-    printf("Shared System Memory: %.1f GB\n", (double)(adapterDesc.SharedSystemMemory) / (1024.0 * 1024.0 * 1024.0));
-
-    hRes = D3D12CreateDevice((IUnknown*)hardwareAdapters[selectedAdapterIndex], D3D_FEATURE_LEVEL_12_0, &IID_ID3D12Device, (void**)&s_device);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "D3D12CreateDevice failed: %ld\n", hRes);
-        return false;
-    }
-
-    if(!QueryDeviceSupportedMaxFeatureLevel()) return false;
-
-    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { .HighestShaderModel = D3D_HIGHEST_SHADER_MODEL };
-    hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel));
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_SHADER_MODEL` failed: %ld\n", hRes);
-        return false;
-    }
-
-    const int minor = shaderModel.HighestShaderModel & 0x0f;
-    const int major = shaderModel.HighestShaderModel >> 4;
-    printf("Current device support highest shader model: %d.%d\n", major, minor);
-
-    D3D12_FEATURE_DATA_ROOT_SIGNATURE rootSignature = { .HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1 };
-    hRes = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_ROOT_SIGNATURE, &rootSignature, sizeof(rootSignature));
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CheckFeatureSupport for `D3D12_FEATURE_DATA_ROOT_SIGNATURE` failed: %ld\n", hRes);
-        return false;
-    }
-
-    const char* signatureVersion = "1.0";
-    switch (rootSignature.HighestVersion)
-    {
-    case D3D_ROOT_SIGNATURE_VERSION_1_0:
-    default:
-        s_supportSignatureVersion1_1 = false;
-        break;
-
-    case D3D_ROOT_SIGNATURE_VERSION_1_1:
-        signatureVersion = "1.1";
-        s_supportSignatureVersion1_1 = true;
-        break;
-    }
-    printf("Current device supports highest root signature version: %s\n", signatureVersion);
-
-    puts("\n================================================\n");
-
-    return true;
-}
-
-static bool CreateRootSignature(void)
-{
-    const D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags = D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS |
-                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
-                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
-                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS |
-                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_AMPLIFICATION_SHADER_ROOT_ACCESS |
-                                    D3D12_ROOT_SIGNATURE_FLAG_DENY_MESH_SHADER_ROOT_ACCESS;
-
-    ID3DBlob* errorBlob = NULL;
-    ID3DBlob* signature = NULL;
-    HRESULT hRes = S_OK;
-    if (s_supportSignatureVersion1_1)
-    {
-        const D3D12_DESCRIPTOR_RANGE1 ranges[] = {
-            // t0
-            {
-                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
-                .NumDescriptors = 1,
-                .BaseShaderRegister = 0,
-                .RegisterSpace = 0,
-                .Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC,
-                .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
-            },
-            // u0
-            {
-                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV,
-                .NumDescriptors = 1,
-                .BaseShaderRegister = 0,
-                .RegisterSpace = 0,
-                .Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE,
-                .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
-            },
-            // u1
-            {
-                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV,
-                .NumDescriptors = 1,
-                .BaseShaderRegister = 1,
-                .RegisterSpace = 0,
-                .Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE,
-                .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
-            }
-        };
-
-        // There're 3 parameters which will be passed to the compute shader
-        const D3D12_ROOT_PARAMETER1 rootParameters[] = {
-            // The first is the constant buffer object, b0
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV,
-                .Descriptor = {
-                    .ShaderRegister = 0,
-                    .RegisterSpace = 0,
-                    .Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC
-                },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            },
-            // The second is the shader source view object, t0
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
-                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &ranges[0] },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            },
-            // The third is the unordered access view object, u0
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
-                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &ranges[1] },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            },
-            // The fourth is the unordered access view object, u1
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
-                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &ranges[2] },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            }
-        };
-
-        const D3D12_VERSIONED_ROOT_SIGNATURE_DESC computeRootSignatureDesc = {
-            .Version = D3D_ROOT_SIGNATURE_VERSION_1_1,
-            .Desc_1_1 = {
-                .NumParameters = sizeof(rootParameters) / sizeof(rootParameters[0]),
-                .pParameters = rootParameters,
-                .NumStaticSamplers = 0,
-                .pStaticSamplers = NULL,
-                .Flags = rootSignatureFlags
-            }
-        };
-
-        hRes = D3D12SerializeVersionedRootSignature(&computeRootSignatureDesc, &signature, &errorBlob);
-    }
-    else
-    {
-        // D3D_ROOT_SIGNATURE_VERSION_1_0 situation
-        const D3D12_DESCRIPTOR_RANGE ranges[] = {
-            // t0
-            {
-                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
-                .NumDescriptors = 1,
-                .BaseShaderRegister = 0,
-                .RegisterSpace = 0,
-                .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
-            },
-            // u0
-            {
-                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV,
-                .NumDescriptors = 1,
-                .BaseShaderRegister = 0,
-                .RegisterSpace = 0,
-                .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
-            },
-            // u1
-            {
-                .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV,
-                .NumDescriptors = 1,
-                .BaseShaderRegister = 1,
-                .RegisterSpace = 0,
-                .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
-            }
-        };
-
-        // There're 3 parameters which will be passed to the compute shader
-        const D3D12_ROOT_PARAMETER rootParameters[] = {
-            // The first is the constant buffer object, b0
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV,
-                .Descriptor = {
-                    .ShaderRegister = 0,
-                    .RegisterSpace = 0,
-                },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            },
-            // The second is the shader source view object, t0
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
-                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &ranges[0] },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            },
-            // The third is the unordered access view object, u0
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
-                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &ranges[1] },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            },
-            // The fourth is the unordered access view object, u1
-            {
-                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
-                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &ranges[2] },
-                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
-            }
-        };
-
-        const D3D12_ROOT_SIGNATURE_DESC computeRootSignatureDesc = {
-            .NumParameters = (UINT)(sizeof(rootParameters) / sizeof(rootParameters[0])),
-            .pParameters = rootParameters,
-            .NumStaticSamplers = 0,
-            .Flags = rootSignatureFlags
-        };
-
-        hRes = D3D12SerializeRootSignature(&computeRootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &errorBlob);
-    }
-
-    do
-    {
-        if (FAILED(hRes))
-        {
-            fprintf(stderr, "D3D12SerializeVersionedRootSignature failed: %ld\n", hRes);
-            break;
-        }
-
-        hRes = s_device->lpVtbl->CreateRootSignature(s_device, 0, signature->lpVtbl->GetBufferPointer(signature),
-            signature->lpVtbl->GetBufferSize(signature), &IID_ID3D12RootSignature, &s_computeRootSignature);
-        if (FAILED(hRes))
-        {
-            fprintf(stderr, "CreateRootSignature failed: %ld\n", hRes);
-            break;
-        }
-    }
-    while (false);
-
-    if (errorBlob != NULL) {
-        errorBlob->lpVtbl->Release(errorBlob);
-    }
-    if (signature != NULL) {
-        signature->lpVtbl->Release(signature);
-    }
-
-    if (FAILED(hRes)) return false;
-
-    // This setting is optional.
-    hRes = s_computeRootSignature->lpVtbl->SetName(s_computeRootSignature, L"s_computeRootSignature");
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "s_computeRootSignature setName failed: %ld\n", hRes);
-        return false;
-    }
-
-    return true;
-}
-
-// Updates subresources, all the subresource arrays should be populated.
-// This function is the C-style implementation translated from C++ style inline function in the D3DX12 library.
-static void WriteDeviceResourceAndSync(
-    _In_ ID3D12GraphicsCommandList* commandList,
-    _In_ ID3D12Resource* pDestinationDeviceResource,
-    _In_ ID3D12Resource* pUploadHostResource,
-    size_t dstOffset,
-    size_t srcoffset,
-    size_t dataSize,
-    bool isDstReadWrite)
-{
-    const D3D12_RESOURCE_BARRIER beginCopyBarrier = {
-        .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-        .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-        .Transition = {
-            .pResource = pDestinationDeviceResource,
-            .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-            .StateBefore = D3D12_RESOURCE_STATE_COMMON,
-            .StateAfter = D3D12_RESOURCE_STATE_COPY_DEST
-        }
-    };
-    commandList->lpVtbl->ResourceBarrier(commandList, 1, &beginCopyBarrier);
-
-    commandList->lpVtbl->CopyBufferRegion(commandList, pDestinationDeviceResource, (UINT64)dstOffset, pUploadHostResource, srcoffset, dataSize);
-
-    const D3D12_RESOURCE_STATES hasUAVState = isDstReadWrite ? D3D12_RESOURCE_STATE_UNORDERED_ACCESS : D3D12_RESOURCE_STATE_COMMON;
-    const D3D12_RESOURCE_BARRIER endCopyBarrier = {
-        .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-        .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-        .Transition = {
-            .pResource = pDestinationDeviceResource,
-            .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-            .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
-            .StateAfter = hasUAVState
-        }
-    };
-    commandList->lpVtbl->ResourceBarrier(commandList, 1, &endCopyBarrier);
-}
-
-static void SyncAndReadDeviceResources(
-    _In_ ID3D12GraphicsCommandList* commandList,
-    _In_ ID3D12Resource* pReadbackHostResource1,
-    _In_ ID3D12Resource* pSourceDeviceResource1,
-    _In_ ID3D12Resource* pReadbackHostResource2,
-    _In_ ID3D12Resource* pSourceDeviceResource2)
-{
-    const D3D12_RESOURCE_BARRIER beginCopyBarriers[] = {
-        {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition = {
-                .pResource = pSourceDeviceResource1,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                .StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE
-            }
-        },
-        {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition = {
-                .pResource = pSourceDeviceResource2,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                .StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE
-            }
-        }
-    };
-    commandList->lpVtbl->ResourceBarrier(commandList, sizeof(beginCopyBarriers) / sizeof(beginCopyBarriers[0]), beginCopyBarriers);
-
-    commandList->lpVtbl->CopyResource(commandList, pReadbackHostResource1, pSourceDeviceResource1);
-    commandList->lpVtbl->CopyResource(commandList, pReadbackHostResource2, pSourceDeviceResource2);
-
-    const D3D12_RESOURCE_BARRIER endCopyBarriers[] = {
-        {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition = {
-                .pResource = pSourceDeviceResource1,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE,
-                .StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-            }
-        },
-        {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition = {
-                .pResource = pSourceDeviceResource2,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE,
-                .StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-            }
-        }
-    };
-    commandList->lpVtbl->ResourceBarrier(commandList, sizeof(endCopyBarriers) / sizeof(endCopyBarriers[0]), endCopyBarriers);
-}
-
-// Create the write-only Shader Resource View buffer object
-static ID3D12Resource* CreateSRVBuffer(const void* inputData, size_t dataSize, UINT elemCount, UINT elemSize)
-{
-    ID3D12Resource *resultBuffer = NULL;
-    HRESULT hr = S_OK;
-
-    do
-    {
-        const D3D12_HEAP_PROPERTIES heapProperties = {
-            .Type = D3D12_HEAP_TYPE_DEFAULT,
-            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-            .CreationNodeMask = 1,
-            .VisibleNodeMask = 1
-        };
-        const D3D12_HEAP_PROPERTIES heapUploadProperties = {
-            .Type = D3D12_HEAP_TYPE_UPLOAD,
-            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-            .CreationNodeMask = 1,
-            .VisibleNodeMask = 1
-        };
-
-        const D3D12_RESOURCE_DESC resourceDesc = {
-            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-            .Alignment = 0,
-            .Width = dataSize,
-            .Height = 1,
-            .DepthOrArraySize = 1,
-            .MipLevels = 1,
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .SampleDesc = { .Count = 1, .Quality = 0 },
-            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-            .Flags = D3D12_RESOURCE_FLAG_NONE
-        };
-        const D3D12_RESOURCE_DESC uploadBufferDesc = {
-            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-            .Alignment = 0,
-            .Width = dataSize,
-            .Height = 1,
-            .DepthOrArraySize = 1,
-            .MipLevels = 1,
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .SampleDesc = { .Count = 1, .Quality = 0 },
-            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-            .Flags = D3D12_RESOURCE_FLAG_NONE
-        };
-
-        // Create the SRV buffer and make it as the copy destination.
-        hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-                                                    D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void**)&resultBuffer);
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "CreateCommittedResource for resultBuffer failed: %ld\n", hr);
-            break;
-        }
-
-        // Create the upload buffer and make it as the generic read intermediate.
-        hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapUploadProperties, D3D12_HEAP_FLAG_NONE, &uploadBufferDesc,
-                                                    D3D12_RESOURCE_STATE_GENERIC_READ, NULL, &IID_ID3D12Resource, (void**)&s_uploadBuffer);
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "CreateCommittedResource for s_uploadBuffer failed: %ld\n", hr);
-            break;
-        }
-
-        // Transfer data from host to the device SRV buffer
-        void* hostMemPtr = NULL;
-        const D3D12_RANGE readRange = { 0, 0 };
-        hr = s_uploadBuffer->lpVtbl->Map(s_uploadBuffer, 0, &readRange, &hostMemPtr);
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "Map s_uploadBuffer failed: %ld\n", hr);
-            break;
-        }
-
-        memcpy(hostMemPtr, inputData, dataSize);
-        s_uploadBuffer->lpVtbl->Unmap(s_uploadBuffer, 0, NULL);
-
-        // Upload data from s_uploadBuffer to resultBuffer
-        WriteDeviceResourceAndSync(s_computeCommandList, resultBuffer, s_uploadBuffer, 0U, 0U, dataSize, false);
-
-        // Attention! None of the operations above has been executed.
-        // They have just been put into the command list.
-        // So the intermediate buffer s_uploadBuffer MUST NOT be released here.
-
-        // Setup the SRV descriptor. This will be stored in the first slot of the heap.
-        const D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
-            .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
-            .Buffer = {
-                .FirstElement = 0,
-                .NumElements = elemCount,
-                .StructureByteStride = elemSize,
-                .Flags = D3D12_BUFFER_SRV_FLAG_NONE
-            }
-        };
-
-        // Get the descriptor handle from the descriptor heap.
-        D3D12_CPU_DESCRIPTOR_HANDLE srvHandle;
-        s_heap->lpVtbl->GetCPUDescriptorHandleForHeapStart(s_heap, &srvHandle);
-
-        // Create the SRV for the buffer with the descriptor handle
-        s_device->lpVtbl->CreateShaderResourceView(s_device, resultBuffer, &srvDesc, srvHandle);
-    }
-    while (false);
-
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "CreateSRVBuffer failed: %ld\n", hr);
-        return NULL;
-    }
-
-    return resultBuffer;
-}
-
-// Create the write-only Unordered Access View buffer object for the first destination buffer object
-static ID3D12Resource* CreateUAV_RBuffer(const void* inputData, size_t dataSize, UINT elemCount, UINT elemSize)
-{
-    ID3D12Resource *resultBuffer = NULL;
-    HRESULT hr = S_OK;
-
-    do
-    {
-        const D3D12_HEAP_PROPERTIES heapProperties = {
-            .Type = D3D12_HEAP_TYPE_DEFAULT,
-            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-            .CreationNodeMask = 1,
-            .VisibleNodeMask = 1
-        };
-        const D3D12_RESOURCE_DESC resourceDesc = {
-            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-            .Alignment = 0,
-            .Width = dataSize,
-            .Height = 1, 
-            .DepthOrArraySize = 1,
-            .MipLevels = 1,
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .SampleDesc = {.Count = 1, .Quality = 0 },
-            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-            .Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
-        };
-
-        // Create the UAV buffer and make it in the unordered access state.
-        hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-                                                    D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void**)&resultBuffer);
-
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "Failed to create resultBuffer: %ld\n", hr);
-            return NULL;
-        }
-
-        // Setup the UAV descriptor. This will be stored in the second slot of the heap.
-        const D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .ViewDimension = D3D12_UAV_DIMENSION_BUFFER,
-            .Buffer = {
-                .FirstElement = 0,
-                .NumElements = elemCount,
-                .StructureByteStride = elemSize,
-                .CounterOffsetInBytes = 0,
-                .Flags = D3D12_BUFFER_UAV_FLAG_NONE
-            }
-        };
-
-        // Get the descriptor handle from the descriptor heap.
-        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle;
-        s_heap->lpVtbl->GetCPUDescriptorHandleForHeapStart(s_heap, &uavHandle);
-
-        // It will occupy the second slot.
-        uavHandle.ptr += 1U * s_srvUavDescriptorSize;
-
-        s_device->lpVtbl->CreateUnorderedAccessView(s_device, resultBuffer, NULL, &uavDesc, uavHandle);
-    }
-    while (false);
-
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "Create UAV Buffer failed: %ld\n", hr);
-        return NULL;
-    }
-
-    return resultBuffer;
-}
-
-// Create the read-write Unordered Access View buffer object for the second destination buffer object
-static bool CreateUAV2_RWBuffer(const void* inputData, size_t dataSize, UINT elemCount, UINT elemSize)
-{
-    HRESULT hr = S_OK;
-
-    do
-    {
-        const D3D12_HEAP_PROPERTIES heapProperties = {
-            .Type = D3D12_HEAP_TYPE_DEFAULT,
-            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-            .CreationNodeMask = 1,
-            .VisibleNodeMask = 1
-        };
-        const D3D12_HEAP_PROPERTIES heapUploadProperties = {
-            .Type = D3D12_HEAP_TYPE_UPLOAD,
-            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-            .CreationNodeMask = 1,
-            .VisibleNodeMask = 1
-        };
-
-        const D3D12_RESOURCE_DESC resourceDesc = {
-            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-            .Alignment = 0,
-            .Width = dataSize,
-            .Height = 1,
-            .DepthOrArraySize = 1,
-            .MipLevels = 1,
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .SampleDesc = {.Count = 1, .Quality = 0 },
-            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-            .Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
-        };
-        const D3D12_RESOURCE_DESC uploadBufferDesc = {
-            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-            .Alignment = 0,
-            .Width = dataSize,
-            .Height = 1,
-            .DepthOrArraySize = 1,
-            .MipLevels = 1,
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .SampleDesc = {.Count = 1, .Quality = 0 },
-            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-            .Flags = D3D12_RESOURCE_FLAG_NONE
-        };
-
-        // Create the UAV buffer and make it in the unordered access state.
-        hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-                                                    D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void**)&s_dst2Buffer);
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "Failed to create resultBuffer: %ld\n", hr);
-            break;
-        }
-
-        // Create the upload buffer and make it as the generic read intermediate.
-        hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapUploadProperties, D3D12_HEAP_FLAG_NONE, &uploadBufferDesc,
-                                                    D3D12_RESOURCE_STATE_GENERIC_READ, NULL, &IID_ID3D12Resource, (void**)&s_dst2UploadBuffer);
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "CreateCommittedResource for s_dst2UploadBuffer failed: %ld\n", hr);
-            break;
-        }
-
-        // Transfer data from host to the device UAV buffer
-        void* hostMemPtr = NULL;
-        const D3D12_RANGE readRange = { 0, 0 };
-        hr = s_dst2UploadBuffer->lpVtbl->Map(s_dst2UploadBuffer, 0, &readRange, &hostMemPtr);
-        if (FAILED(hr))
-        {
-            fprintf(stderr, "Map s_dst2UploadBuffer failed: %ld\n", hr);
-            break;
-        }
-
-        memcpy(hostMemPtr, inputData, dataSize);
-        s_dst2UploadBuffer->lpVtbl->Unmap(s_dst2UploadBuffer, 0, NULL);
-
-        // Upload data from s_dst2UploadBuffer to s_dst2Buffer
-        WriteDeviceResourceAndSync(s_computeCommandList, s_dst2Buffer, s_dst2UploadBuffer, 0U, 0U, dataSize, true);
-
-        // Setup the UAV descriptor. This will be stored in the second slot of the heap.
-        const D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {
-            .Format = DXGI_FORMAT_UNKNOWN,
-            .ViewDimension = D3D12_UAV_DIMENSION_BUFFER,
-            .Buffer = {
-                .FirstElement = 0,
-                .NumElements = elemCount,
-                .StructureByteStride = elemSize,
-                .CounterOffsetInBytes = 0,
-                .Flags = D3D12_BUFFER_UAV_FLAG_NONE
-            }
-        };
-
-        // Get the descriptor handle from the descriptor heap.
-        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle;
-        s_heap->lpVtbl->GetCPUDescriptorHandleForHeapStart(s_heap, &uavHandle);
-
-        // It will occupy the third slot.
-        uavHandle.ptr += 2U * s_srvUavDescriptorSize;
-
-        s_device->lpVtbl->CreateUnorderedAccessView(s_device, s_dst2Buffer, NULL, &uavDesc, uavHandle);
-    }
-    while (false);
-
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "Create UAV Buffer failed: %ld\n", hr);
-        return false;
-    }
-
-    return true;
-}
-
-// Create and initialize the constant buffer object
-static bool CreateConstantBuffer(const void* inputData, size_t dataSize)
-{
-    const D3D12_HEAP_PROPERTIES heapProperties = {
-        .Type = D3D12_HEAP_TYPE_DEFAULT,
-        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-        .CreationNodeMask = 1,
-        .VisibleNodeMask = 1
-    };
-    const D3D12_HEAP_PROPERTIES heapUploadProperties = {
-        .Type = D3D12_HEAP_TYPE_UPLOAD,
-        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-        .CreationNodeMask = 1,
-        .VisibleNodeMask = 1
-    };
-
-    const D3D12_RESOURCE_DESC resourceDesc = {
-        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-        .Alignment = 0,
-        .Width = dataSize,
-        .Height = 1,
-        .DepthOrArraySize = 1,
-        .MipLevels = 1,
-        .Format = DXGI_FORMAT_UNKNOWN,
-        .SampleDesc = {.Count = 1, .Quality = 0 },
-        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-        .Flags = D3D12_RESOURCE_FLAG_NONE
-    };
-    const D3D12_RESOURCE_DESC uploadBufferDesc = {
-        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-        .Alignment = 0,
-        .Width = dataSize,
-        .Height = 1,
-        .DepthOrArraySize = 1,
-        .MipLevels = 1,
-        .Format = DXGI_FORMAT_UNKNOWN,
-        .SampleDesc = {.Count = 1, .Quality = 0 },
-        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-        .Flags = D3D12_RESOURCE_FLAG_NONE
-    };
-
-    // Create the constant buffer and make it as the copy destination.
-    HRESULT hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-                                                        D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void**)&s_constantBuffer);
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "CreateCommittedResource for s_constantBuffer failed: %ld\n", hr);
-        return false;
-    }
-
-    // Create the upload buffer and make it as the generic read intermediate.
-    hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapUploadProperties, D3D12_HEAP_FLAG_NONE, &uploadBufferDesc,
-                                                D3D12_RESOURCE_STATE_GENERIC_READ, NULL, &IID_ID3D12Resource, (void**)&s_constantUploadBuffer);
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "CreateCommittedResource for s_constantUploadBuffer failed: %ld\n", hr);
-        return false;
-    }
-
-    // This setting is optional.
-    s_constantBuffer->lpVtbl->SetName(s_constantBuffer, L"s_constantBuffer");
-
-    // Transfer data from host to the device UAV buffer
-    void* hostMemPtr = NULL;
-    const D3D12_RANGE readRange = { 0, 0 };
-    hr = s_constantUploadBuffer->lpVtbl->Map(s_constantUploadBuffer, 0, &readRange, &hostMemPtr);
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "Map s_constantUploadBuffer failed: %ld\n", hr);
-        return false;
-    }
-
-    memcpy(hostMemPtr, inputData, dataSize);
-    s_constantUploadBuffer->lpVtbl->Unmap(s_constantUploadBuffer, 0, NULL);
-
-    // Upload data from s_constantUploadBuffer to s_constantBuffer
-    WriteDeviceResourceAndSync(s_computeCommandList, s_constantBuffer, s_constantUploadBuffer, 0U, 0U, dataSize, false);
-
-    return true;
-}
-
-// Create the compute pipeline state object
-static bool CreateComputePipelineStateObject(void)
-{
-    // ---- Create descriptor heaps. ----
-    const D3D12_DESCRIPTOR_HEAP_DESC srvUavHeapDesc = {
-        // There are three descriptors for the heap. One for SRV buffer, the other two for UAV buffers
-        .NumDescriptors = 3,
-        .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
-        .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
-        .NodeMask = 0
-    };
-
-    HRESULT hr = s_device->lpVtbl->CreateDescriptorHeap(s_device, &srvUavHeapDesc, &IID_ID3D12DescriptorHeap, (void**)&s_heap);
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "Failed to create s_srvHeap: %ld\n", hr);
-        return false;
-    }
-
-    // This setting is optional.
-    s_heap->lpVtbl->SetName(s_heap, L"s_heap");
-
-    // Get the size of each descriptor handle
-    s_srvUavDescriptorSize = s_device->lpVtbl->GetDescriptorHandleIncrementSize(s_device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-    // ---- Load Assets ----
-    const D3D12_SHADER_BYTECODE computeShaderObj = CreateCompiledShaderObjectFromPath("shaders/compute.cso");
-    if (computeShaderObj.pShaderBytecode == NULL || computeShaderObj.BytecodeLength == 0) return false;
-
-    // Describe and create the compute pipeline state object (PSO).
-    const D3D12_COMPUTE_PIPELINE_STATE_DESC computePsoDesc = {
-        .pRootSignature = s_computeRootSignature,
-        .CS = computeShaderObj,
-        .NodeMask = 0,
-        .CachedPSO = {.pCachedBlob = NULL, .CachedBlobSizeInBytes = 0 },
-        .Flags = D3D12_PIPELINE_STATE_FLAG_NONE
-    };
-    hr = s_device->lpVtbl->CreateComputePipelineState(s_device, &computePsoDesc, &IID_ID3D12PipelineState, (void**)&s_computeState);
-    if (FAILED(hr)) return false;
-
-    return true;
-}
-
-// Initialize the command list and the command queue
-static bool InitComputeCommands(void)
-{
-    const D3D12_COMMAND_QUEUE_DESC queueDesc = {
-        .Type = D3D12_COMMAND_LIST_TYPE_DIRECT,
-        .Priority = 0,
-        .Flags = D3D12_COMMAND_QUEUE_FLAG_NONE,
-        .NodeMask = 0
-    };
-    HRESULT hRes = s_device->lpVtbl->CreateCommandQueue(s_device, &queueDesc, &IID_ID3D12CommandQueue, (void**)&s_computeCommandQueue);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CreateCommandQueue failed: %ld\n", hRes);
-        return false;
-    }
-
-    hRes = s_device->lpVtbl->CreateCommandAllocator(s_device, D3D12_COMMAND_LIST_TYPE_DIRECT, &IID_ID3D12CommandAllocator, (void**)&s_computeAllocator);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CreateCommandAllocator failed: %ld\n", hRes);
-        return false;
-    }
-
-    hRes = s_device->lpVtbl->CreateCommandList(s_device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT, s_computeAllocator, NULL, &IID_ID3D12CommandList, (void**)&s_computeCommandList);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CreateCommandList failed: %ld\n", hRes);
-        return false;
-    }
-
-    return true;
-}
-
-// Create the source buffer object and the destination buffer object.
-// Initialize the SRV buffer object with the input buffer
-static bool CreateBuffers(void)
-{
-    enum { bufferSize = TEST_DATA_COUNT * sizeof(*s_dataBuffer0) };
-
-    // Allocate the source data buffers
-    s_dataBuffer0 = malloc(bufferSize);
-    s_dataBuffer1 = malloc(bufferSize);
-    if (s_dataBuffer0 == NULL || s_dataBuffer1 == NULL)
-    {
-        fprintf(stderr, "Lack of memory for host buffers...\n");
-        return false;
-    }
-
-    // Initialize the source data buffers
-    for (int i = 0; i < TEST_DATA_COUNT; i++) {
-        s_dataBuffer0[i] = i + 1;
-    }
-
-    int index = 0;
-    enum { nGroups = TEST_DATA_COUNT / 1024 };
-    for (int i = 0; i < nGroups; i++)
-    {
-        for (int j = 0; j < 1024; j++) {
-            s_dataBuffer1[index++] = i + 1;
-        }
-    }
-
-    // Create the compute shader's constant buffer.
-    s_srcDataBuffer = CreateSRVBuffer(s_dataBuffer0, bufferSize, TEST_DATA_COUNT, (UINT)sizeof(int));
-    s_dstDataBuffer = CreateUAV_RBuffer(NULL, bufferSize, TEST_DATA_COUNT, (UINT)sizeof(int));
-    if (!CreateUAV2_RWBuffer(s_dataBuffer1, bufferSize, TEST_DATA_COUNT, (UINT)sizeof(int))) return false;
-
-    D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = { 0 };
-    HRESULT hr = s_device->lpVtbl->CheckFeatureSupport(s_device, D3D12_FEATURE_D3D12_OPTIONS1,
-                                                        &options1, sizeof(options1));
-    if (FAILED(hr)) return false;
-
-    struct { int cbValue; UINT minWaveLanes; } cbuffer = {
-        1, 64
-    };
-
-    if (options1.WaveOps)
-    {
-        puts("Current GPU supports HLSL 6.0 wave operations!!");
-        printf("The minimum wave lane count is: %u\n", options1.WaveLaneCountMin);
-
-        cbuffer.minWaveLanes = options1.WaveLaneCountMin;
-    }
-
-    return CreateConstantBuffer(&cbuffer, sizeof(cbuffer));
-}
-
-// Create ID3D12Fence fence object and Win32 s_hEvent handle
-static bool CreateFenceAndEvent(void)
-{
-    HRESULT hRes = s_device->lpVtbl->CreateFence(s_device, 0, D3D12_FENCE_FLAG_NONE, &IID_ID3D12Fence, (void**)&s_fence);
-    if (FAILED(hRes))
-    {
-        fprintf(stderr, "CreateFence failed: %ld\n", hRes);
-        return false;
-    }
-
-    s_hEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
-    if (s_hEvent == NULL)
-    {
-        const DWORD err = GetLastError();
-        fprintf(stderr, "Failed to create event handle: %u\n", err);
-        return false;
-    }
-
-    return true;
-}
-
-// Wait for the whole command queue completed
-static void SyncCommandQueue(ID3D12CommandQueue* commandQueue, ID3D12Device* device, UINT64 signalValue)
-{
-    // Add an instruction to the command queue to set a new fence point.  Because we 
-    // are on the GPU timeline, the new fence point won't be set until the GPU finishes
-    // processing all the commands prior to this Signal().
-    HRESULT hRes = commandQueue->lpVtbl->Signal(commandQueue, s_fence, signalValue);
-    if (FAILED(hRes)) {
-        fprintf(stderr, "Signal failed: %ld\n", hRes);
-    }
-
-    // Wait until the GPU has completed commands up to this fence point.
-    // Fire event when GPU hits current fence.  
-    hRes = s_fence->lpVtbl->SetEventOnCompletion(s_fence, signalValue, s_hEvent);
-    if (FAILED(hRes)) {
-        fprintf(stderr, "Set event failed: %ld\n", hRes);
-    }
-
-    // Wait until the GPU hits current fence event is fired.
-    WaitForSingleObject(s_hEvent, INFINITE);
-}
-
-// Do the compute operation and fetch the result
-static void DoCompute(void)
-{
-    ID3D12Resource *readBackBuffer = NULL;
-    ID3D12Resource* readBackBuffer2 = NULL;
-
-    const D3D12_HEAP_PROPERTIES heapProperties = {
-        .Type = D3D12_HEAP_TYPE_READBACK,
-        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-        .CreationNodeMask = 1,
-        .VisibleNodeMask = 1
-    };
-    const D3D12_RESOURCE_DESC resourceDesc = {
-        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-        .Alignment = 0,
-        .Width = TEST_DATA_COUNT * sizeof(*s_dataBuffer0),
-        .Height = 1,
-        .DepthOrArraySize = 1,
-        .MipLevels = 1,
-        .Format = DXGI_FORMAT_UNKNOWN,
-        .SampleDesc = {.Count = 1, .Quality = 0 },
-        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-        .Flags = D3D12_RESOURCE_FLAG_NONE
-    };
-
-    // Source and Destination buffer resource must have the same size/width,
-    // So the resourceDesc2 MUST NOT set the width that is not equal to `TEST_DATA_COUNT * sizeof(*s_dataBuffer0)`
-    const D3D12_RESOURCE_DESC resourceDesc2 = {
-        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-        .Alignment = 0,
-        .Width = TEST_DATA_COUNT * sizeof(*s_dataBuffer1),
-        .Height = 1,
-        .DepthOrArraySize = 1,
-        .MipLevels = 1,
-        .Format = DXGI_FORMAT_UNKNOWN,
-        .SampleDesc = {.Count = 1, .Quality = 0 },
-        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-        .Flags = D3D12_RESOURCE_FLAG_NONE
-    };
-
-    // Create the read-back buffer object that will fetch the result from the UAV buffer object.
-    // And make it as the copy destination.
-    HRESULT hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-                                                    D3D12_RESOURCE_STATE_COPY_DEST, NULL, &IID_ID3D12Resource, (void**)&readBackBuffer);
-    if (FAILED(hr)) return;
-
-    hr = s_device->lpVtbl->CreateCommittedResource(s_device, &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc2,
-                                                    D3D12_RESOURCE_STATE_COPY_DEST, NULL, &IID_ID3D12Resource, (void**)&readBackBuffer2);
-    if (FAILED(hr)) return;
-
-    // Reuse the memory associated with command recording.
-    // We can only reset when the associated command lists have finished execution on the GPU.
-    hr = s_computeAllocator->lpVtbl->Reset(s_computeAllocator);
-    if(FAILED(hr)) return;
-
-    // A command list can be reset after it has been added to the command queue via ExecuteCommandList.
-    // Reusing the command list reuses memory.
-    hr = s_computeCommandList->lpVtbl->Reset(s_computeCommandList, s_computeAllocator, s_computeState);
-    if(FAILED(hr)) return;
-
-    s_computeCommandList->lpVtbl->SetComputeRootSignature(s_computeCommandList, s_computeRootSignature);
-
-    ID3D12DescriptorHeap* ppHeaps[] = { s_heap };
-    s_computeCommandList->lpVtbl->SetDescriptorHeaps(s_computeCommandList, sizeof(ppHeaps) / sizeof(ppHeaps[0]), ppHeaps);
-
-    D3D12_GPU_DESCRIPTOR_HANDLE srvHandle;
-    // Get the SRV GPU descriptor handle from the descriptor heap
-    s_heap->lpVtbl->GetGPUDescriptorHandleForHeapStart(s_heap, &srvHandle);
-
-    D3D12_GPU_DESCRIPTOR_HANDLE uavHandle, uavHandle2;
-    // Get the UAV GPU descriptor handle from the descriptor heap
-    s_heap->lpVtbl->GetGPUDescriptorHandleForHeapStart(s_heap, &uavHandle);
-    uavHandle.ptr += 1U * s_srvUavDescriptorSize;
-
-    s_heap->lpVtbl->GetGPUDescriptorHandleForHeapStart(s_heap, &uavHandle2);
-    uavHandle2.ptr += 2U * s_srvUavDescriptorSize;
-
-    // Setup the input parameters
-    s_computeCommandList->lpVtbl->SetComputeRootConstantBufferView(s_computeCommandList, 0, s_constantBuffer->lpVtbl->GetGPUVirtualAddress(s_constantBuffer));
-    s_computeCommandList->lpVtbl->SetComputeRootDescriptorTable(s_computeCommandList, 1, srvHandle);
-    s_computeCommandList->lpVtbl->SetComputeRootDescriptorTable(s_computeCommandList, 2, uavHandle);
-    s_computeCommandList->lpVtbl->SetComputeRootDescriptorTable(s_computeCommandList, 3, uavHandle2);
-
-    // Dispatch the GPU threads
-    s_computeCommandList->lpVtbl->Dispatch(s_computeCommandList, 4, 1, 1);
-
-    // Sync the compute shader execution and transfer the dst buffers to readback buffers
-    SyncAndReadDeviceResources(s_computeCommandList, readBackBuffer, s_dstDataBuffer, readBackBuffer2, s_dst2Buffer);
-
-    // Close the command list
-    s_computeCommandList->lpVtbl->Close(s_computeCommandList);
-
-    s_computeCommandQueue->lpVtbl->ExecuteCommandLists(s_computeCommandQueue, 1, 
-                                                    (ID3D12CommandList* const[]) { (ID3D12CommandList*)s_computeCommandList });
-
-    SyncCommandQueue(s_computeCommandQueue, s_device, COMPUTE_SYNC_SIGNAL_VALUE);
-
-    void* pData = NULL;
-    D3D12_RANGE range = { 0, TEST_DATA_COUNT };
-    // Map the memory buffer so that we may access the data from the host side.
-    hr = readBackBuffer->lpVtbl->Map(readBackBuffer, 0, &range, &pData);
-    if (FAILED(hr)) return;
-
-    int* resultBuffer = malloc(TEST_DATA_COUNT * sizeof(*resultBuffer));
-    if (resultBuffer == NULL) return;
-    memcpy(resultBuffer, pData, TEST_DATA_COUNT * sizeof(*resultBuffer));
-
-    // After copying the data, just release the read-back buffer object.
-    readBackBuffer->lpVtbl->Unmap(readBackBuffer, 0, NULL);
-    readBackBuffer->lpVtbl->Release(readBackBuffer);
-
-    int* resultBuffer2 = malloc(TEST_DATA_COUNT * sizeof(*resultBuffer2));
-    if (resultBuffer2 == NULL) return;
-    range = (D3D12_RANGE){ 0, TEST_DATA_COUNT };
-    hr = readBackBuffer2->lpVtbl->Map(readBackBuffer2, 0, &range, &pData);
-    if (FAILED(hr)) return;
-
-    memcpy(resultBuffer2, pData, TEST_DATA_COUNT * sizeof(*resultBuffer2));
-
-    readBackBuffer2->lpVtbl->Unmap(readBackBuffer2, 0, NULL);
-    readBackBuffer2->lpVtbl->Release(readBackBuffer2);
-
-    // Verify the result
-    bool equal = true;
-    for (int i = 0; i < TEST_DATA_COUNT; i++)
-    {
-        if (resultBuffer[i] - 1 != s_dataBuffer0[i])
-        {
-            printf("%d index elements are not equal!\n", i);
-            equal = false;
-            break;
-        }
-    }
-    if (equal) {
-        puts("Verification 1 OK!");
-    }
-    printf("[0] = %d, [1] = %d, [2] = %d, [3] = %d\n", 
-        resultBuffer2[0], resultBuffer2[1], resultBuffer2[2], resultBuffer2[3]);
-
-    equal = true;
-    for (int i = 4; i < TEST_DATA_COUNT; i++)
-    {
-        if (resultBuffer2[i] != s_dataBuffer1[i])
-        {
-            printf("%d index elements are not equal!\n", i);
-            equal = false;
-            break;
-        }
-    }
-    if (equal) {
-        puts("Verification 2 OK!");
-    }
-
-    free(resultBuffer);
-    free(resultBuffer2);
-}
-
-// Release all the resources
-void ReleaseResources(void)
-{
-    if (s_hEvent != NULL)
-    {
-        CloseHandle(s_hEvent);
-        s_hEvent = NULL;
-    }
-    if (s_fence != NULL)
-    {
-        s_fence->lpVtbl->Release(s_fence);
-        s_fence = NULL;
-    }
-    if (s_heap != NULL)
-    {
-        s_heap->lpVtbl->Release(s_heap);
-        s_heap = NULL;
-    }
-
-    if (s_srcDataBuffer != NULL)
-    {
-        s_srcDataBuffer->lpVtbl->Release(s_srcDataBuffer);
-        s_srcDataBuffer = NULL;
-    }
-
-    if (s_dstDataBuffer != NULL)
-    {
-        s_dstDataBuffer->lpVtbl->Release(s_dstDataBuffer);
-        s_dstDataBuffer = NULL;
-    }
-
-    if (s_uploadBuffer != NULL)
-    {
-        s_uploadBuffer->lpVtbl->Release(s_uploadBuffer);
-        s_uploadBuffer = NULL;
-    }
-
-    if (s_constantBuffer != NULL)
-    {
-        s_constantBuffer->lpVtbl->Release(s_constantBuffer);
-        s_constantBuffer = NULL;
-    }
-
-    if (s_constantUploadBuffer != NULL)
-    {
-        s_constantUploadBuffer->lpVtbl->Release(s_constantUploadBuffer);
-        s_constantUploadBuffer = NULL;
-    }
-
-    if (s_dst2Buffer != NULL)
-    {
-        s_dst2Buffer->lpVtbl->Release(s_dst2Buffer);
-        s_dst2Buffer = NULL;
-    }
-
-    if (s_dst2UploadBuffer != NULL)
-    {
-        s_dst2UploadBuffer->lpVtbl->Release(s_dst2UploadBuffer);
-        s_dst2UploadBuffer = NULL;
-    }
-
-    if (s_dataBuffer0 != NULL)
-    {
-        free(s_dataBuffer0);
-        s_dataBuffer0 = NULL;
-    }
-
-    if (s_dataBuffer1 != NULL)
-    {
-        free(s_dataBuffer1);
-        s_dataBuffer1 = NULL;
-    }
-
-    if (s_computeAllocator != NULL)
-    {
-        s_computeAllocator->lpVtbl->Release(s_computeAllocator);
-        s_computeAllocator = NULL;
-    }
-
-    if (s_computeCommandList != NULL)
-    {
-        s_computeCommandList->lpVtbl->Release(s_computeCommandList);
-        s_computeCommandList = NULL;
-    }
-
-    if (s_computeCommandQueue != NULL)
-    {
-        s_computeCommandQueue->lpVtbl->Release(s_computeCommandQueue);
-        s_computeCommandQueue = NULL;
-    }
-
-    if (s_computeState != NULL)
-    {
-        s_computeState->lpVtbl->Release(s_computeState);
-        s_computeState = NULL;
-    }
-
-    if (s_computeRootSignature != NULL)
-    {
-        s_computeRootSignature->lpVtbl->Release(s_computeRootSignature);
-        s_computeRootSignature = NULL;
-    }
-
-    if (s_device != NULL)
-    {
-        s_device->lpVtbl->Release(s_device);
-        s_device = NULL;
-    }
-    if (s_factory != NULL)
-    {
-        s_factory->lpVtbl->Release(s_factory);
-        s_factory = NULL;
-    }
-}
-
-int main(void)
-{
-    do
-    {
-        if (!CreateD3D12Device()) break;
-
-        if (!CreateRootSignature()) break;
-
-        if (!CreateComputePipelineStateObject()) break;
-
-        if (!InitComputeCommands())
-        {
-            puts("InitComputeCommands failed!");
-            break;
-        }
-        if (!CreateBuffers())
-        {
-            puts("CreateBuuffers failed!");
-            break;
-        }
-        if (!CreateFenceAndEvent()) break;
-
-        HRESULT hRes = s_computeCommandList->lpVtbl->Close(s_computeCommandList);
-        if(FAILED(hRes))
-        {
-            fprintf(stderr, "Execute init commands failed: %ld\n", hRes);
-            break;
-        }
-
-        s_computeCommandQueue->lpVtbl->ExecuteCommandLists(s_computeCommandQueue, 1, (ID3D12CommandList* const []) { (ID3D12CommandList*)s_computeCommandList });
-
-        SyncCommandQueue(s_computeCommandQueue, s_device, COPY_SYNC_SIGNAL_VALUE);
-
-        // After finishing the whole buffer copy operation,
-        // the intermediate buffer s_uploadBuffer can be released now.
-        if (s_uploadBuffer != NULL)
-        {
-            s_uploadBuffer->lpVtbl->Release(s_uploadBuffer);
-            s_uploadBuffer = NULL;
-        }
-        if (s_constantUploadBuffer != NULL)
-        {
-            s_constantUploadBuffer->lpVtbl->Release(s_constantUploadBuffer);
-            s_constantUploadBuffer = NULL;
-        }
-        if (s_dst2UploadBuffer != NULL)
-        {
-            s_dst2UploadBuffer->lpVtbl->Release(s_dst2UploadBuffer);
-            s_dst2UploadBuffer = NULL;
-        }
-
-        DoCompute();
-    }
-    while (false);
-
-    ReleaseResources();
-}
-
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "compute_backend.h"
+#include "cpu_kernels.h"
+#include "result_verifier.h"
+#include "thread_pool.h"
+#include "shader_asset.h"
+
+enum
+{
+    // The default test data element count
+    TEST_DATA_COUNT = 4096,
+
+    // The constant value added to each source element (g_constant)
+    TEST_CONSTANT_VALUE = 1,
+
+    // At most two backends run the same job in the compare mode
+    MAX_BACKEND_COUNT = 2
+};
+
+// The backend selection from the command line
+typedef enum BackendSelection
+{
+    BACKEND_SELECTION_D3D12,
+    BACKEND_SELECTION_CPU,
+    // Execute the same job on both of the backends and compare the results
+    BACKEND_SELECTION_COMPARE
+} BackendSelection;
+
+// The first source data buffer
+static int *s_dataBuffer0;
+
+// The second source data buffer
+static int* s_dataBuffer1;
+
+// The test data element count, which can be specified by `--count=N`
+static size_t s_elemCount = TEST_DATA_COUNT;
+
+// The number of times the compute job is run on each backend, which can be specified by `--iterations=N`
+static uint32_t s_iterationCount = 1;
+
+// Indicate whether the compiled kernels should be packed into the shader archive instead of running the job (`--pack-shaders`)
+static bool s_packShaders;
+
+// Indicate whether the CPU kernels should be benchmarked instead of running the job (`--benchmark-kernels`)
+static bool s_benchmarkKernels;
+
+// The fraction of the results that are verified, which can be specified by `--verify-fraction=F`
+static double s_verificationFraction = 1.0;
+
+// The worker threads that verify the results
+static ThreadPool* s_verificationPool;
+
+// Indicate whether the backends verify the results themselves and only hand out the summary records (`--verify-on-device`)
+static bool s_verifyOnDevice;
+
+// The pass layout of the read-write buffer shared by all the backends
+static ReductionLayout s_layout;
+
+// The number of jobs of `s_elemCount` elements packed into each batch, which can be specified by `--batch=N`.
+// 0 runs a single job per dispatch.
+static uint32_t s_batchJobCount;
+
+// The job descriptor table of the batch. Job j adds TEST_CONSTANT_VALUE + j to its segment of the packed inputs.
+static BatchJob* s_batchJobs;
+
+// The layout of the read-write buffer of the batch
+static BatchLayout s_batchLayout;
+
+
+// Lay out the batch of `s_batchJobCount` jobs of `s_elemCount` elements each, packed back to back
+static bool CreateBatchJobs(void)
+{
+    if (s_elemCount > UINT32_MAX / s_batchJobCount)
+    {
+        fprintf(stderr, "The batch of %u jobs of %zu elements is not supported!\n", s_batchJobCount, s_elemCount);
+        return false;
+    }
+
+    s_batchJobs = malloc(s_batchJobCount * sizeof(*s_batchJobs));
+    if (s_batchJobs == NULL)
+    {
+        fprintf(stderr, "Lack of memory for the job descriptor table...\n");
+        return false;
+    }
+
+    for (uint32_t j = 0; j < s_batchJobCount; j++)
+    {
+        s_batchJobs[j] = (BatchJob){
+            .inputOffset = (uint32_t)(j * s_elemCount),
+            .elementCount = (uint32_t)s_elemCount,
+            .constantValue = (int32_t)(TEST_CONSTANT_VALUE + j)
+        };
+    }
+
+    if (!BuildBatchLayout(s_batchJobs, s_batchJobCount, (uint64_t)s_batchJobCount * s_elemCount, COMPUTE_GROUP_THREAD_COUNT, &s_batchLayout))
+    {
+        fprintf(stderr, "The batch of %u jobs of %zu elements is not supported!\n", s_batchJobCount, s_elemCount);
+        return false;
+    }
+
+    printf("%u jobs of %zu elements are packed into each batch, %llu groups per dispatch\n", s_batchJobCount, s_elemCount,
+        (unsigned long long)s_batchLayout.groupCount);
+    return true;
+}
+
+// Allocate and initialize the host source data buffers, which hold the packed inputs of all the jobs of a batch
+static bool CreateHostBuffers(void)
+{
+    if (!BuildReductionLayout(s_elemCount, COMPUTE_GROUP_THREAD_COUNT, &s_layout))
+    {
+        fprintf(stderr, "The element count %zu is not supported!\n", s_elemCount);
+        return false;
+    }
+    if (s_batchJobCount > 0 && !CreateBatchJobs()) return false;
+
+    const size_t inputCount = s_batchJobCount > 0 ? (size_t)s_batchLayout.inputElementCount : s_elemCount;
+    const size_t bufferSize = inputCount * sizeof(*s_dataBuffer0);
+
+    // Allocate the source data buffers
+    s_dataBuffer0 = malloc(bufferSize);
+    s_dataBuffer1 = malloc(bufferSize);
+    if (s_dataBuffer0 == NULL || s_dataBuffer1 == NULL)
+    {
+        fprintf(stderr, "Lack of memory for host buffers...\n");
+        return false;
+    }
+
+    // Initialize the source data buffers.
+    // Each element of the second buffer is the 1-based index of the thread group it belongs to in its job.
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        s_dataBuffer0[i] = (int)(i + 1);
+        s_dataBuffer1[i] = (int)(i % s_elemCount / COMPUTE_GROUP_THREAD_COUNT + 1);
+    }
+
+    return true;
+}
+
+// Print the report of a verification, and return whether it has found no mismatch
+static bool PrintVerificationReport(const char* name, const char* elementName, const VerificationReport* report)
+{
+    if (report->mismatchCount > 0)
+    {
+        printf("%s: %zu of %zu %s are not equal, from index %zu to %zu!\n", name, report->mismatchCount, report->checkedCount, elementName,
+            report->firstMismatch, report->lastMismatch);
+        return false;
+    }
+
+    printf("%s: %zu %s checked, checksum 0x%08X\n", name, report->checkedCount, elementName, report->checksum);
+    return true;
+}
+
+// Print a summary record of the on-device verification, and return whether it is the expected one.
+// The checksum of the results matches the one of `expected` only if the results are the expected ones.
+static bool PrintVerificationSummary(const char* name, const char* elementName, const VerificationSummary* summary,
+                                    const VerificationSummary* expected)
+{
+    if (summary->mismatchCount > 0)
+    {
+        printf("%s: %u of %u %s are not equal, from index %u!\n", name, summary->mismatchCount, summary->checkedCount, elementName,
+            summary->firstMismatch);
+        return false;
+    }
+    if (summary->checkedCount != expected->checkedCount || summary->checksum != expected->checksum)
+    {
+        printf("%s: %u %s checked with checksum 0x%08X instead of %u with 0x%08X!\n", name, summary->checkedCount, elementName,
+            summary->checksum, expected->checkedCount, expected->checksum);
+        return false;
+    }
+
+    printf("%s: %u %s checked on the device, checksum 0x%08X\n", name, summary->checkedCount, elementName, summary->checksum);
+    return true;
+}
+
+// Verify the summary records of the on-device verification against the summaries of the expected results,
+// which are computed on the host by the CPU references
+static bool VerifySummaries(const ComputeResultView* results)
+{
+    if (results->summaryCount != 1 + s_layout.passCount)
+    {
+        printf("%u summary records instead of %u!\n", results->summaryCount, 1 + s_layout.passCount);
+        return false;
+    }
+
+    // The expected destination buffer, and the expected read-write buffer with the partial sums of every pass
+    int* expectedDst = malloc(s_elemCount * sizeof(int));
+    int* expectedRw = malloc((size_t)s_layout.totalElementCount * sizeof(int));
+    VerificationSummary expected[COMPUTE_MAX_VERIFICATION_SUMMARY_COUNT];
+    bool succeeded = expectedDst != NULL && expectedRw != NULL;
+    if (succeeded)
+    {
+        for (size_t i = 0; i < s_elemCount; i++)
+        {
+            expectedDst[i] = (int)((uint32_t)s_dataBuffer0[i] + (uint32_t)TEST_CONSTANT_VALUE);
+            expectedRw[i] = s_dataBuffer1[i];
+        }
+        ReferenceElementSummary(expectedDst, s_dataBuffer0, s_elemCount, TEST_CONSTANT_VALUE, &expected[0]);
+
+        const CPUKernels* kernels = GetCPUKernels(GetBestCPUKernelISA());
+        for (uint32_t p = 0; p < s_layout.passCount; p++)
+        {
+            const ReductionPass* pass = &s_layout.passes[p];
+            for (uint64_t g = 0; g < pass->groupCount; g++)
+            {
+                const uint64_t first = g * COMPUTE_GROUP_THREAD_COUNT;
+                const uint64_t count = pass->elementCount - first < COMPUTE_GROUP_THREAD_COUNT ? pass->elementCount - first : COMPUTE_GROUP_THREAD_COUNT;
+                expectedRw[pass->outputOffset + g] = kernels->Sum(&expectedRw[pass->inputOffset + first], (size_t)count);
+            }
+            ReferenceGroupSumSummary(&expectedRw[pass->outputOffset], &expectedRw[pass->inputOffset], (size_t)pass->elementCount,
+                                    COMPUTE_GROUP_THREAD_COUNT, &expected[1 + p]);
+        }
+    }
+    else {
+        fprintf(stderr, "Lack of memory for the expected results...\n");
+    }
+    free(expectedDst);
+    free(expectedRw);
+    if (!succeeded) return false;
+
+    if (!PrintVerificationSummary("Destination buffer", "elements", &results->summaries[0], &expected[0])) return false;
+    puts("Verification 1 OK!");
+
+    for (uint32_t p = 0; p < s_layout.passCount; p++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "Pass %u", p);
+        if (!PrintVerificationSummary(name, "group sums", &results->summaries[1 + p], &expected[1 + p])) return false;
+    }
+    puts("Verification 2 OK!");
+
+    return true;
+}
+
+// Verify the results of a batch job by job: the segment of the destination buffer and the group sums of each job.
+// Only the mismatching jobs are reported.
+static bool VerifyBatchResults(const ComputeResultView* results)
+{
+    VerificationReport report;
+    for (uint32_t j = 0; j < s_batchJobCount; j++)
+    {
+        const BatchJob* job = &s_batchJobs[j];
+        if (!VerifyElements(s_verificationPool, &results->dstResult[job->inputOffset], &s_dataBuffer0[job->inputOffset], job->elementCount,
+                            job->constantValue, s_verificationFraction, &report)) return false;
+        if (report.mismatchCount > 0)
+        {
+            char name[48];
+            snprintf(name, sizeof(name), "Destination buffer of job %u", j);
+            return PrintVerificationReport(name, "elements", &report);
+        }
+    }
+    printf("Destination buffer: %u jobs checked\n", s_batchJobCount);
+    puts("Verification 1 OK!");
+
+    // The group sums of all the jobs follow the packed inputs
+    const int* groupSums = &results->rwResult[s_batchLayout.inputElementCount];
+    for (uint32_t j = 0; j < s_batchJobCount; j++)
+    {
+        const BatchJob* job = &s_batchJobs[j];
+        if (!VerifyGroupSums(s_verificationPool, &groupSums[job->firstGroup], &results->rwResult[job->inputOffset], job->elementCount,
+                            COMPUTE_GROUP_THREAD_COUNT, s_verificationFraction, &report)) return false;
+        if (report.mismatchCount > 0)
+        {
+            char name[48];
+            snprintf(name, sizeof(name), "Group sums of job %u", j);
+            return PrintVerificationReport(name, "group sums", &report);
+        }
+    }
+    printf("Group sums: %llu groups of %u jobs checked\n", (unsigned long long)s_batchLayout.groupCount, s_batchJobCount);
+    puts("Verification 2 OK!");
+
+    return true;
+}
+
+// Verify the results fetched from the backend in place.
+// The work is spread over the verification threads, and only `s_verificationFraction` of the elements are checked.
+static bool VerifyResults(const ComputeResultView* results)
+{
+    if (s_verifyOnDevice) return VerifySummaries(results);
+    if (s_batchJobCount > 0) return VerifyBatchResults(results);
+
+    const int* resultBuffer = results->dstResult;
+    const int* resultBuffer2 = results->rwResult;
+    VerificationReport report;
+
+    if (!VerifyElements(s_verificationPool, resultBuffer, s_dataBuffer0, s_elemCount, TEST_CONSTANT_VALUE, s_verificationFraction, &report) ||
+        !PrintVerificationReport("Destination buffer", "elements", &report)) return false;
+    puts("Verification 1 OK!");
+
+    // The input part of the read-write buffer must be left untouched
+    if (!VerifyElements(s_verificationPool, resultBuffer2, s_dataBuffer1, s_elemCount, 0, s_verificationFraction, &report) ||
+        !PrintVerificationReport("Read-write buffer input", "elements", &report)) return false;
+
+    // The partial sums of each pass must be the group sums of the previous level
+    for (uint32_t p = 0; p < s_layout.passCount; p++)
+    {
+        const ReductionPass* pass = &s_layout.passes[p];
+        char name[32];
+        snprintf(name, sizeof(name), "Pass %u", p);
+        if (!VerifyGroupSums(s_verificationPool, &resultBuffer2[pass->outputOffset], &resultBuffer2[pass->inputOffset],
+                            (size_t)pass->elementCount, COMPUTE_GROUP_THREAD_COUNT, s_verificationFraction, &report) ||
+            !PrintVerificationReport(name, "group sums", &report)) return false;
+    }
+
+    const ReductionPass* firstPass = &s_layout.passes[0];
+    printf("[0] = %d, [1] = %d, ..., total = %d in %u passes\n",
+        resultBuffer2[firstPass->outputOffset], firstPass->groupCount > 1 ? resultBuffer2[firstPass->outputOffset + 1] : 0,
+        resultBuffer2[s_layout.resultOffset], s_layout.passCount);
+    puts("Verification 2 OK!");
+
+    return true;
+}
+
+// Upload the job to the specified backend and submit the compute operation.
+// The device, the pipeline and the buffers of the backend are reused by every call.
+static bool DoCompute(const ComputeBackend* backend, ComputeTicket* pTicket)
+{
+    const bool created = s_batchJobCount > 0 ?
+        backend->CreateBatchBuffers(s_dataBuffer0, s_dataBuffer1, s_batchJobs, s_batchJobCount, &s_batchLayout) :
+        backend->CreateBuffers(s_dataBuffer0, s_dataBuffer1, s_elemCount, TEST_CONSTANT_VALUE);
+    if (!created) return false;
+
+    return backend->Dispatch(pTicket);
+}
+
+// Wait for the job of `ticket` and map its results. The results of the previous job are handed back first.
+static bool CompleteCompute(const ComputeBackend* backend, ComputeTicket ticket, ComputeResultView* results)
+{
+    if (results->dstResult != NULL || results->rwResult != NULL || results->summaries != NULL) {
+        backend->ReleaseResults(results);
+    }
+
+    // Only wait for the submission of this job
+    if (!backend->Sync(ticket)) return false;
+
+    return backend->ReadResults(ticket, results);
+}
+
+static double GetTimeInSeconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Run the compute job `s_iterationCount` times in a row and verify the results of the last run.
+// Up to `inFlightJobCount` jobs are in flight, so the next job is uploaded while the previous ones are executing.
+static bool RunComputeJobs(const ComputeBackend* backend, ComputeResultView* results)
+{
+    printf("Running the compute job %u time(s) on the %s backend...\n", s_iterationCount, backend->name);
+
+    // The tickets of the jobs in flight, oldest first
+    ComputeTicket tickets[COMPUTE_MAX_IN_FLIGHT_JOB_COUNT] = { 0 };
+    uint32_t inFlightCount = 0;
+
+    const double beginTime = GetTimeInSeconds();
+    for (uint32_t i = 0; i < s_iterationCount; i++)
+    {
+        if (inFlightCount == backend->inFlightJobCount)
+        {
+            if (!CompleteCompute(backend, tickets[0], results)) return false;
+
+            --inFlightCount;
+            memmove(&tickets[0], &tickets[1], inFlightCount * sizeof(tickets[0]));
+        }
+
+        if (!DoCompute(backend, &tickets[inFlightCount])) return false;
+        ++inFlightCount;
+    }
+
+    // Drain the pipeline. The results of the last job are kept for the verification.
+    for (uint32_t i = 0; i < inFlightCount; i++)
+    {
+        if (!CompleteCompute(backend, tickets[i], results)) return false;
+    }
+    const double elapsedTime = GetTimeInSeconds() - beginTime;
+
+    if (s_iterationCount > 1)
+    {
+        printf("%u jobs in %.3f ms: %.1f jobs/s, %.3f ms per job\n", s_iterationCount, elapsedTime * 1000.0,
+            s_iterationCount / elapsedTime, elapsedTime * 1000.0 / s_iterationCount);
+    }
+    if (s_batchJobCount > 0) {
+        printf("%u jobs per dispatch: %.1f batched jobs/s\n", s_batchJobCount, (double)s_batchJobCount * s_iterationCount / elapsedTime);
+    }
+
+    return VerifyResults(results);
+}
+
+#ifdef _WIN32
+// Compare the results of two backends element by element, or their summary records if they have verified the results themselves
+static bool CompareResults(const ComputeResultView* results0, const ComputeResultView* results1)
+{
+    const size_t dstCount = s_batchJobCount > 0 ? (size_t)s_batchLayout.inputElementCount : s_elemCount;
+    const size_t rwCount = (size_t)(s_batchJobCount > 0 ? s_batchLayout.totalElementCount : s_layout.totalElementCount);
+    const bool isDifferent = s_verifyOnDevice ?
+        memcmp(results0->summaries, results1->summaries, (1 + s_layout.passCount) * sizeof(VerificationSummary)) != 0 :
+        memcmp(results0->dstResult, results1->dstResult, dstCount * sizeof(int)) != 0 ||
+        memcmp(results0->rwResult, results1->rwResult, rwCount * sizeof(int)) != 0;
+    if (isDifferent)
+    {
+        puts("The results of the backends differ!");
+        return false;
+    }
+    puts("The results of the backends are identical!");
+    return true;
+}
+#endif // _WIN32
+
+static BackendSelection ParseBackendSelection(int argc, char* argv[])
+{
+#ifdef _WIN32
+    BackendSelection selection = BACKEND_SELECTION_D3D12;
+#else
+    BackendSelection selection = BACKEND_SELECTION_CPU;
+#endif // _WIN32
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--backend=d3d12") == 0) {
+            selection = BACKEND_SELECTION_D3D12;
+        }
+        else if (strcmp(argv[i], "--backend=cpu") == 0) {
+            selection = BACKEND_SELECTION_CPU;
+        }
+        else if (strcmp(argv[i], "--backend=compare") == 0) {
+            selection = BACKEND_SELECTION_COMPARE;
+        }
+        else if (strncmp(argv[i], "--count=", strlen("--count=")) == 0)
+        {
+            const unsigned long long count = strtoull(argv[i] + strlen("--count="), NULL, 10);
+            if (count > 0 && count <= SIZE_MAX / sizeof(int)) {
+                s_elemCount = (size_t)count;
+            }
+            else {
+                printf("WARNING: Invalid element count `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strncmp(argv[i], "--iterations=", strlen("--iterations=")) == 0)
+        {
+            const unsigned long iterationCount = strtoul(argv[i] + strlen("--iterations="), NULL, 10);
+            if (iterationCount > 0 && iterationCount <= UINT32_MAX) {
+                s_iterationCount = (uint32_t)iterationCount;
+            }
+            else {
+                printf("WARNING: Invalid iteration count `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strncmp(argv[i], "--batch=", strlen("--batch=")) == 0)
+        {
+            const unsigned long jobCount = strtoul(argv[i] + strlen("--batch="), NULL, 10);
+            if (jobCount > 0 && jobCount <= UINT32_MAX) {
+                s_batchJobCount = (uint32_t)jobCount;
+            }
+            else {
+                printf("WARNING: Invalid batch job count `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strncmp(argv[i], "--verify-fraction=", strlen("--verify-fraction=")) == 0)
+        {
+            const double fraction = strtod(argv[i] + strlen("--verify-fraction="), NULL);
+            if (fraction > 0.0 && fraction <= 1.0) {
+                s_verificationFraction = fraction;
+            }
+            else {
+                printf("WARNING: Invalid verification fraction `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strcmp(argv[i], "--verify-on-device") == 0)
+        {
+            s_verifyOnDevice = true;
+#ifdef _WIN32
+            SetD3D12DeviceVerification(true);
+#endif // _WIN32
+            SetCPUEngineDeviceVerification(true);
+        }
+        else if (strcmp(argv[i], "--pack-shaders") == 0) {
+            s_packShaders = true;
+        }
+        else if (strcmp(argv[i], "--benchmark-kernels") == 0) {
+            s_benchmarkKernels = true;
+        }
+        else if (strcmp(argv[i], "--reduction=tree") == 0) {
+            SetCPUEngineReductionMode(COMPUTE_REDUCTION_TREE, 0);
+        }
+        else if (strncmp(argv[i], "--reduction=wave", strlen("--reduction=wave")) == 0)
+        {
+            // --reduction=wave or --reduction=wave:<lane count>, where the lane count is a wave size of D3D12,
+            // i.e. a power of two from 4 to 128
+            const char* laneCount = strchr(argv[i], ':');
+            const unsigned long lanes = laneCount != NULL ? strtoul(laneCount + 1, NULL, 10) : 0;
+            if (laneCount == NULL || (lanes >= 4 && lanes <= 128 && (lanes & (lanes - 1)) == 0)) {
+                SetCPUEngineReductionMode(COMPUTE_REDUCTION_WAVE, (uint32_t)lanes);
+            }
+            else {
+                printf("WARNING: Invalid wave lane count `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strcmp(argv[i], "--cpu-kernel=native") == 0) {
+            SetCPUEngineKernelMode(CPU_KERNEL_NATIVE, 0);
+        }
+        else if (strcmp(argv[i], "--cpu-kernel=reference") == 0) {
+            SetCPUEngineKernelMode(CPU_KERNEL_REFERENCE, 0);
+        }
+        else if (strcmp(argv[i], "--cpu-kernel=compiled") == 0) {
+            SetCPUEngineKernelMode(CPU_KERNEL_COMPILED, 0);
+        }
+        else if (strncmp(argv[i], "--cpu-kernel=bytecode", strlen("--cpu-kernel=bytecode")) == 0)
+        {
+            // --cpu-kernel=bytecode or --cpu-kernel=bytecode:<lane count>
+            const char* laneCount = strchr(argv[i], ':');
+            const unsigned long lanes = laneCount != NULL ? strtoul(laneCount + 1, NULL, 10) : 0;
+            if (lanes == 0 || lanes == 4 || lanes == 8 || lanes == 16) {
+                SetCPUEngineKernelMode(CPU_KERNEL_BYTECODE, (uint32_t)lanes);
+            }
+            else {
+                printf("WARNING: Invalid lane count `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strncmp(argv[i], "--cpu-isa=", strlen("--cpu-isa=")) == 0)
+        {
+            CPUKernelISA isa;
+            if (FindCPUKernelISA(argv[i] + strlen("--cpu-isa="), &isa)) {
+                SetCPUEngineKernelISA(isa);
+            }
+            else {
+                printf("WARNING: Unknown instruction set `%s` is ignored!\n", argv[i]);
+            }
+        }
+#ifdef _WIN32
+        else if (strncmp(argv[i], "--adapter=", strlen("--adapter=")) == 0) {
+            SetD3D12AdapterSelection(argv[i] + strlen("--adapter="));
+        }
+        else if (strcmp(argv[i], "--no-bindless") == 0) {
+            SetD3D12BindlessResources(false);
+        }
+        else if (strncmp(argv[i], "--grid-stride", strlen("--grid-stride")) == 0)
+        {
+            // --grid-stride or --grid-stride=<resident group count>
+            const char* groupCount = strchr(argv[i], '=');
+            const unsigned long groups = groupCount != NULL ? strtoul(groupCount + 1, NULL, 10) : 0;
+            if (groups <= MAX_DISPATCH_GROUPS_PER_DIMENSION) {
+                SetD3D12GridStride(true, (uint32_t)groups);
+            }
+            else {
+                printf("WARNING: Invalid resident group count `%s` is ignored!\n", argv[i]);
+            }
+        }
+        else if (strcmp(argv[i], "--raw-buffers") == 0) {
+            SetD3D12RawBuffers(true);
+        }
+#endif // _WIN32
+        else {
+            printf("WARNING: Unknown argument `%s` is ignored!\n", argv[i]);
+        }
+    }
+
+    if (s_batchJobCount > 0 && s_verifyOnDevice)
+    {
+        puts("WARNING: The batches are only verified on the host. So `--verify-on-device` is ignored!");
+        s_verifyOnDevice = false;
+#ifdef _WIN32
+        SetD3D12DeviceVerification(false);
+#endif // _WIN32
+        SetCPUEngineDeviceVerification(false);
+    }
+
+#ifndef _WIN32
+    if (selection != BACKEND_SELECTION_CPU)
+    {
+        puts("WARNING: The D3D12 backend is not available on the current platform. So the CPU backend will be used!");
+        selection = BACKEND_SELECTION_CPU;
+    }
+#endif // !_WIN32
+
+    return selection;
+}
+
+int main(int argc, char* argv[])
+{
+    const BackendSelection selection = ParseBackendSelection(argc, argv);
+    if (s_packShaders)
+    {
+        if (!PackShaderArchive(SHADER_ARCHIVE_PATH)) return EXIT_FAILURE;
+
+        printf("Packed the compiled kernels into `%s`\n", SHADER_ARCHIVE_PATH);
+        return EXIT_SUCCESS;
+    }
+    if (s_benchmarkKernels) {
+        return BenchmarkCPUKernels(s_elemCount, COMPUTE_GROUP_THREAD_COUNT, s_iterationCount) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const ComputeBackend* backends[MAX_BACKEND_COUNT] = { 0 };
+    ComputeResultView results[MAX_BACKEND_COUNT] = { 0 };
+    int backendCount = 0;
+    int exitCode = EXIT_FAILURE;
+
+#ifdef _WIN32
+    if (selection != BACKEND_SELECTION_CPU) {
+        backends[backendCount++] = GetD3D12ComputeBackend();
+    }
+#endif // _WIN32
+    if (selection != BACKEND_SELECTION_D3D12) {
+        backends[backendCount++] = GetCPUComputeBackend();
+    }
+
+    // The result views point into the memory of the backends,
+    // so all the backends are kept alive until the results have been compared.
+    int initializedCount = 0;
+    do
+    {
+        if (!CreateHostBuffers()) break;
+
+        // The verification does not need any scratch memory
+        s_verificationPool = CreateThreadPool(0, 0);
+        if (s_verificationPool == NULL)
+        {
+            fprintf(stderr, "Failed to create the verification thread pool!\n");
+            break;
+        }
+
+        bool succeeded = true;
+        for (int i = 0; i < backendCount && succeeded; i++)
+        {
+            ++initializedCount;
+            succeeded = backends[i]->Init() && RunComputeJobs(backends[i], &results[i]);
+        }
+        if (!succeeded) break;
+
+#ifdef _WIN32
+        if (selection == BACKEND_SELECTION_COMPARE && !CompareResults(&results[0], &results[1])) break;
+#endif // _WIN32
+
+        exitCode = EXIT_SUCCESS;
+    }
+    while (false);
+
+    for (int i = 0; i < initializedCount; i++)
+    {
+        if (results[i].dstResult != NULL || results[i].rwResult != NULL || results[i].summaries != NULL) {
+            backends[i]->ReleaseResults(&results[i]);
+        }
+        backends[i]->Release();
+    }
+    DestroyThreadPool(s_verificationPool);
+    free(s_dataBuffer0);
+    free(s_dataBuffer1);
+    free(s_batchJobs);
+
+    return exitCode;
+}
+
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pipeline_cache.h"
+
+enum
+{
+    // "PSOC" in little-endian byte order
+    PIPELINE_CACHE_MAGIC = 0x434f5350,
+
+    // A larger blob size in the header is rather a sign of a corrupted file
+    PIPELINE_CACHE_MAX_BLOB_SIZE = 64 * 1024 * 1024
+};
+
+#define FNV_OFFSET_BASIS    UINT64_C(0xcbf29ce484222325)
+#define FNV_PRIME           UINT64_C(0x100000001b3)
+
+// The layout of the beginning of a cache file, followed by the root signature blob and then the pipeline state blob
+typedef struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t formatVersion;
+    PipelineCacheKey key;
+    uint64_t rootSignatureSize;
+    uint64_t pipelineStateSize;
+
+    // The hash of both blobs, one after the other
+    uint64_t payloadHash;
+} PipelineCacheFileHeader;
+
+static uint64_t ContinueHash(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool KeysEqual(const PipelineCacheKey* key1, const PipelineCacheKey* key2)
+{
+    return key1->adapterLuid == key2->adapterLuid && key1->driverVersion == key2->driverVersion &&
+            key1->shaderHash == key2->shaderHash && key1->rootSignatureVersion == key2->rootSignatureVersion &&
+            key1->shaderModel == key2->shaderModel;
+}
+
+static FILE* OpenCacheFile(const char* path, const char* mode)
+{
+#ifdef _MSC_VER
+    FILE* fp = NULL;
+    return fopen_s(&fp, path, mode) == 0 ? fp : NULL;
+#else
+    return fopen(path, mode);
+#endif // _MSC_VER
+}
+
+// Read a blob of `size` bytes into a new allocation, or leave it NULL if `size` is 0
+static bool ReadBlob(FILE* fp, uint64_t size, void** ppBlob)
+{
+    *ppBlob = NULL;
+    if (size == 0) return true;
+
+    void* blob = malloc((size_t)size);
+    if (blob == NULL) return false;
+
+    if (fread(blob, 1, (size_t)size, fp) != (size_t)size)
+    {
+        free(blob);
+        return false;
+    }
+
+    *ppBlob = blob;
+    return true;
+}
+
+uint64_t HashPipelineCacheBytes(const void* data, size_t size)
+{
+    return ContinueHash(FNV_OFFSET_BASIS, data, size);
+}
+
+bool LoadPipelineCache(const char* path, const PipelineCacheKey* key, PipelineCacheEntry* pEntry)
+{
+    *pEntry = (PipelineCacheEntry){ 0 };
+
+    FILE* fp = OpenCacheFile(path, "rb");
+    if (fp == NULL) return false;
+
+    bool loaded = false;
+    PipelineCacheEntry entry = { 0 };
+    do
+    {
+        PipelineCacheFileHeader header = { 0 };
+        if (fread(&header, sizeof(header), 1, fp) != 1) break;
+
+        if (header.magic != PIPELINE_CACHE_MAGIC || header.formatVersion != PIPELINE_CACHE_FORMAT_VERSION) break;
+        if (!KeysEqual(&header.key, key)) break;
+        if (header.rootSignatureSize > PIPELINE_CACHE_MAX_BLOB_SIZE || header.pipelineStateSize > PIPELINE_CACHE_MAX_BLOB_SIZE) break;
+
+        if (!ReadBlob(fp, header.rootSignatureSize, &entry.rootSignature)) break;
+        entry.rootSignatureSize = (size_t)header.rootSignatureSize;
+
+        if (!ReadBlob(fp, header.pipelineStateSize, &entry.pipelineState)) break;
+        entry.pipelineStateSize = (size_t)header.pipelineStateSize;
+
+        uint64_t payloadHash = HashPipelineCacheBytes(entry.rootSignature, entry.rootSignatureSize);
+        payloadHash = ContinueHash(payloadHash, entry.pipelineState, entry.pipelineStateSize);
+        if (payloadHash != header.payloadHash) break;
+
+        loaded = true;
+    }
+    while (false);
+
+    fclose(fp);
+
+    if (!loaded)
+    {
+        FreePipelineCacheEntry(&entry);
+        return false;
+    }
+
+    *pEntry = entry;
+    return true;
+}
+
+bool StorePipelineCache(const char* path, const PipelineCacheKey* key, const PipelineCacheEntry* entry)
+{
+    PipelineCacheFileHeader header = {
+        .magic = PIPELINE_CACHE_MAGIC,
+        .formatVersion = PIPELINE_CACHE_FORMAT_VERSION,
+        .key = *key,
+        .rootSignatureSize = entry->rootSignatureSize,
+        .pipelineStateSize = entry->pipelineStateSize
+    };
+    header.payloadHash = HashPipelineCacheBytes(entry->rootSignature, entry->rootSignatureSize);
+    header.payloadHash = ContinueHash(header.payloadHash, entry->pipelineState, entry->pipelineStateSize);
+
+    // Write the whole file at once, so that a concurrent reader rarely sees a partial file
+    const size_t fileSize = sizeof(header) + entry->rootSignatureSize + entry->pipelineStateSize;
+    uint8_t* fileData = malloc(fileSize);
+    if (fileData == NULL) return false;
+
+    memcpy(fileData, &header, sizeof(header));
+    if (entry->rootSignatureSize > 0) {
+        memcpy(fileData + sizeof(header), entry->rootSignature, entry->rootSignatureSize);
+    }
+    if (entry->pipelineStateSize > 0) {
+        memcpy(fileData + sizeof(header) + entry->rootSignatureSize, entry->pipelineState, entry->pipelineStateSize);
+    }
+
+    bool stored = false;
+    FILE* fp = OpenCacheFile(path, "wb");
+    if (fp != NULL)
+    {
+        stored = fwrite(fileData, 1, fileSize, fp) == fileSize;
+        stored = fclose(fp) == 0 && stored;
+    }
+
+    free(fileData);
+    return stored;
+}
+
+void FreePipelineCacheEntry(PipelineCacheEntry* entry)
+{
+    free(entry->rootSignature);
+    free(entry->pipelineState);
+    *entry = (PipelineCacheEntry){ 0 };
+}
+
@@ -0,0 +1,62 @@
+#ifndef PIPELINE_CACHE_H
+#define PIPELINE_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The version of the cache file layout.
+    // Bump it whenever the root signature built by the backend changes while the shaders stay the same,
+    // so that the stale serialized root signatures are not loaded any more.
+    PIPELINE_CACHE_FORMAT_VERSION = 3
+};
+
+// What a cached pipeline is only valid for. A cache file with another key is ignored.
+typedef struct PipelineCacheKey
+{
+    // `AdapterLuid` of the adapter as (HighPart << 32) | LowPart
+    uint64_t adapterLuid;
+
+    // The user mode driver version reported by the adapter
+    uint64_t driverVersion;
+
+    // The hash of the compute shader bytecode
+    uint64_t shaderHash;
+
+    // The D3D_ROOT_SIGNATURE_VERSION that the root signature is serialized with
+    uint32_t rootSignatureVersion;
+
+    // The D3D_SHADER_MODEL of the device, which may change the code generated for the same bytecode
+    uint32_t shaderModel;
+} PipelineCacheKey;
+
+// The blobs of one cached pipeline. Either of them may be missing (NULL with a size of 0).
+typedef struct PipelineCacheEntry
+{
+    // The serialized root signature, as passed to ID3D12Device::CreateRootSignature
+    void* rootSignature;
+    size_t rootSignatureSize;
+
+    // The output of ID3D12PipelineState::GetCachedBlob
+    void* pipelineState;
+    size_t pipelineStateSize;
+} PipelineCacheEntry;
+
+// The 64-bit FNV-1a hash of `size` bytes
+extern uint64_t HashPipelineCacheBytes(const void* data, size_t size);
+
+// Load the entry stored in the file at `path` for `key`.
+// Returns false, with an empty entry, if the file does not exist, is truncated or corrupted, or was stored for another key.
+// The blobs of the entry are owned by the caller and freed with `FreePipelineCacheEntry`.
+extern bool LoadPipelineCache(const char* path, const PipelineCacheKey* key, PipelineCacheEntry* pEntry);
+
+// Replace the file at `path` with `entry` stored for `key`.
+// A file torn by concurrent writers fails the checksum of the next load, so it is simply stored again.
+extern bool StorePipelineCache(const char* path, const PipelineCacheKey* key, const PipelineCacheEntry* entry);
+
+extern void FreePipelineCacheEntry(PipelineCacheEntry* entry);
+
+#endif // PIPELINE_CACHE_H
+
@@ -0,0 +1,75 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "queue_scheduler.h"
+
+// Make `queue` wait for the fence of `fenceQueue`, unless the wait is already implied
+static bool WaitForFence(QueueScheduler* scheduler, ComputeQueueType queue, ComputeQueueType fenceQueue, uint64_t value)
+{
+    // The work on one queue is executed in submission order
+    if (queue == fenceQueue || value == 0) return true;
+
+    if (value <= scheduler->waitedValues[queue][fenceQueue]) return true;
+
+    if (!scheduler->ops.Wait(scheduler->ops.userData, queue, fenceQueue, value)) return false;
+
+    scheduler->waitedValues[queue][fenceQueue] = value;
+    return true;
+}
+
+// Submit one stage of the job in `slot` and signal the next value of the fence of `queue`
+static uint64_t SubmitStage(QueueScheduler* scheduler, ComputeQueueType queue, uint32_t slot)
+{
+    if (!scheduler->ops.Execute(scheduler->ops.userData, queue, slot)) return 0;
+
+    const uint64_t value = scheduler->fenceValues[queue] + 1;
+    if (!scheduler->ops.Signal(scheduler->ops.userData, queue, value)) return 0;
+
+    scheduler->fenceValues[queue] = value;
+    scheduler->slots[slot].fenceValues[queue] = value;
+    return value;
+}
+
+bool InitQueueScheduler(QueueScheduler* scheduler, const QueueSchedulerOps* ops, uint32_t slotCount)
+{
+    if (slotCount == 0 || slotCount > QUEUE_SCHEDULER_MAX_SLOT_COUNT) return false;
+
+    memset(scheduler, 0, sizeof(*scheduler));
+    scheduler->ops = *ops;
+    scheduler->slotCount = slotCount;
+    return true;
+}
+
+uint64_t QueueSchedulerSubmitUploads(QueueScheduler* scheduler, uint32_t slot)
+{
+    if (slot >= scheduler->slotCount) return 0;
+
+    // The uploads overwrite the buffers of the slot,
+    // which the kernels and the read-back of the previous job of the slot may still be reading
+    const ScheduledJob* job = &scheduler->slots[slot];
+    if (!WaitForFence(scheduler, COMPUTE_QUEUE_UPLOAD, COMPUTE_QUEUE_COMPUTE, job->fenceValues[COMPUTE_QUEUE_COMPUTE])) return 0;
+    if (!WaitForFence(scheduler, COMPUTE_QUEUE_UPLOAD, COMPUTE_QUEUE_READBACK, job->fenceValues[COMPUTE_QUEUE_READBACK])) return 0;
+
+    return SubmitStage(scheduler, COMPUTE_QUEUE_UPLOAD, slot);
+}
+
+uint64_t QueueSchedulerSubmitJob(QueueScheduler* scheduler, uint32_t slot)
+{
+    if (slot >= scheduler->slotCount) return 0;
+
+    // The kernels consume the uploads of the job,
+    // and overwrite the results that the read-back of the previous job of the slot may still be reading
+    const ScheduledJob* job = &scheduler->slots[slot];
+    if (!WaitForFence(scheduler, COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_UPLOAD, job->fenceValues[COMPUTE_QUEUE_UPLOAD])) return 0;
+    if (!WaitForFence(scheduler, COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_READBACK, job->fenceValues[COMPUTE_QUEUE_READBACK])) return 0;
+
+    const uint64_t computeValue = SubmitStage(scheduler, COMPUTE_QUEUE_COMPUTE, slot);
+    if (computeValue == 0) return 0;
+
+    // The read-back copies the results of the kernels
+    if (!WaitForFence(scheduler, COMPUTE_QUEUE_READBACK, COMPUTE_QUEUE_COMPUTE, computeValue)) return 0;
+
+    return SubmitStage(scheduler, COMPUTE_QUEUE_READBACK, slot);
+}
+
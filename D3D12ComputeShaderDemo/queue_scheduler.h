@@ -0,0 +1,82 @@
+#ifndef QUEUE_SCHEDULER_H
+#define QUEUE_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum
+{
+    // The max number of job slots tracked by a scheduler
+    QUEUE_SCHEDULER_MAX_SLOT_COUNT = 8
+};
+
+// The device queues that the stages of a job are spread across. Each queue signals its own monotonic fence.
+typedef enum ComputeQueueType
+{
+    // The copy queue of the host-to-device transfers
+    COMPUTE_QUEUE_UPLOAD,
+
+    // The compute queue that executes the kernels
+    COMPUTE_QUEUE_COMPUTE,
+
+    // The copy queue of the device-to-host transfers
+    COMPUTE_QUEUE_READBACK,
+
+    COMPUTE_QUEUE_TYPE_COUNT
+} ComputeQueueType;
+
+// The queue operations issued by the scheduler.
+// The D3D12 backend implements them with ID3D12CommandQueue and one ID3D12Fence per queue,
+// while a stand-in implementation can replay and check the schedule without a device.
+typedef struct QueueSchedulerOps
+{
+    void* userData;
+
+    // Submit the commands recorded on `queue` for the job in `slot`
+    bool (*Execute)(void* userData, ComputeQueueType queue, uint32_t slot);
+
+    // Set the fence of `queue` to `value` once all the work submitted to `queue` so far has completed
+    bool (*Signal)(void* userData, ComputeQueueType queue, uint64_t value);
+
+    // Hold back the work submitted to `queue` from now on until the fence of `fenceQueue` has reached `value`.
+    // The host is not blocked.
+    bool (*Wait)(void* userData, ComputeQueueType queue, ComputeQueueType fenceQueue, uint64_t value);
+} QueueSchedulerOps;
+
+// The fence values at which the stages of the last job of a slot complete, 0 for a stage that has never been submitted
+typedef struct ScheduledJob
+{
+    uint64_t fenceValues[COMPUTE_QUEUE_TYPE_COUNT];
+} ScheduledJob;
+
+// Spread the jobs over the upload, compute and read-back queues.
+// The stages of one job are chained with cross-queue waits, and a job only waits for the job that used the same slot before,
+// so the uploads of the next job overlap the kernels of the current one and the read-back of the previous one.
+typedef struct QueueScheduler
+{
+    QueueSchedulerOps ops;
+    uint32_t slotCount;
+
+    // The last value signaled on the fence of each queue
+    uint64_t fenceValues[COMPUTE_QUEUE_TYPE_COUNT];
+
+    // waitedValues[q][f] is the largest value of the fence of queue `f` that queue `q` has waited for.
+    // Waiting for a value that is not larger is redundant, so it is not issued again.
+    uint64_t waitedValues[COMPUTE_QUEUE_TYPE_COUNT][COMPUTE_QUEUE_TYPE_COUNT];
+
+    ScheduledJob slots[QUEUE_SCHEDULER_MAX_SLOT_COUNT];
+} QueueScheduler;
+
+// Returns false if `slotCount` is 0 or larger than QUEUE_SCHEDULER_MAX_SLOT_COUNT
+extern bool InitQueueScheduler(QueueScheduler* scheduler, const QueueSchedulerOps* ops, uint32_t slotCount);
+
+// Submit the upload commands of the job in `slot`. It may be called several times for one job when its uploads are split.
+// Returns the value of the upload fence that signals their completion, or 0 on failure.
+extern uint64_t QueueSchedulerSubmitUploads(QueueScheduler* scheduler, uint32_t slot);
+
+// Submit the compute commands and then the read-back commands of the job in `slot`, after all its uploads.
+// Returns the value of the read-back fence that signals the completion of the whole job, or 0 on failure.
+extern uint64_t QueueSchedulerSubmitJob(QueueScheduler* scheduler, uint32_t slot);
+
+#endif // QUEUE_SCHEDULER_H
+
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "reduction_layout.h"
+
+DispatchGrid ComputeDispatchGrid(uint64_t groupCount)
+{
+    const uint64_t maxGroups = MAX_DISPATCH_GROUPS_PER_DIMENSION;
+    DispatchGrid grid = { 1, 1, 1 };
+
+    if (groupCount <= maxGroups)
+    {
+        grid.x = (uint32_t)(groupCount > 0 ? groupCount : 1);
+        return grid;
+    }
+
+    grid.x = (uint32_t)maxGroups;
+    const uint64_t rowCount = (groupCount + maxGroups - 1) / maxGroups;
+    if (rowCount <= maxGroups)
+    {
+        grid.y = (uint32_t)rowCount;
+        return grid;
+    }
+
+    grid.y = (uint32_t)maxGroups;
+    grid.z = (uint32_t)((rowCount + maxGroups - 1) / maxGroups);
+    return grid;
+}
+
+bool BuildReductionLayout(uint64_t elementCount, uint32_t groupSize, ReductionLayout* layout)
+{
+    if (layout == NULL || elementCount == 0 || groupSize < 2) return false;
+
+    memset(layout, 0, sizeof(*layout));
+    layout->inputElementCount = elementCount;
+
+    uint64_t inputOffset = 0;
+    uint64_t inputCount = elementCount;
+    uint64_t outputOffset = elementCount;
+
+    // Each pass reduces the partial sums of the previous one until a single scalar is left
+    do
+    {
+        if (layout->passCount == MAX_REDUCTION_PASS_COUNT) return false;
+
+        ReductionPass* pass = &layout->passes[layout->passCount++];
+        pass->inputOffset = inputOffset;
+        pass->elementCount = inputCount;
+        pass->outputOffset = outputOffset;
+        pass->groupCount = (inputCount + groupSize - 1) / groupSize;
+        pass->grid = ComputeDispatchGrid(pass->groupCount);
+
+        inputOffset = outputOffset;
+        inputCount = pass->groupCount;
+        outputOffset += pass->groupCount;
+    }
+    while (inputCount > 1);
+
+    layout->totalElementCount = outputOffset;
+    layout->resultOffset = outputOffset - 1;
+
+    // The kernels address the read-write buffer with 32-bit element indices
+    return layout->totalElementCount <= UINT32_MAX;
+}
+
+void LimitReductionGrids(ReductionLayout* layout, uint32_t residentGroupCount)
+{
+    for (uint32_t i = 0; i < layout->passCount; i++)
+    {
+        ReductionPass* pass = &layout->passes[i];
+        pass->grid = ComputeDispatchGrid(pass->groupCount < residentGroupCount ? pass->groupCount : residentGroupCount);
+    }
+}
+
+void FillReductionPassConstants(const ReductionLayout* layout, uint32_t passIndex, int constantValue,
+                                uint32_t minWaveLanes, ReductionPassConstants* constants)
+{
+    const ReductionPass* pass = &layout->passes[passIndex];
+
+    constants->constantValue = constantValue;
+    constants->minWaveLanes = minWaveLanes;
+    constants->elementCount = (uint32_t)pass->elementCount;
+    constants->inputOffset = (uint32_t)pass->inputOffset;
+    constants->outputOffset = (uint32_t)pass->outputOffset;
+    constants->groupCount = (uint32_t)pass->groupCount;
+    constants->groupsPerRow = pass->grid.x;
+    constants->groupsPerSlice = pass->grid.x * pass->grid.y;
+    constants->passIndex = passIndex;
+
+    // The summary records of the on-device verification follow the partial sums of the last pass
+    constants->summaryOffset = (uint32_t)layout->totalElementCount;
+}
+
+bool CheckReductionPassConstantsLayout(const ShaderReflection* reflection)
+{
+    static const struct { const char* name; uint32_t offset; bool isRequired; } members[] = {
+        { "g_constant", offsetof(ReductionPassConstants, constantValue), true },
+        { "g_minWaveLanes", offsetof(ReductionPassConstants, minWaveLanes), true },
+        { "g_elementCount", offsetof(ReductionPassConstants, elementCount), true },
+        { "g_inputOffset", offsetof(ReductionPassConstants, inputOffset), true },
+        { "g_outputOffset", offsetof(ReductionPassConstants, outputOffset), true },
+        { "g_groupCount", offsetof(ReductionPassConstants, groupCount), true },
+        { "g_groupsPerRow", offsetof(ReductionPassConstants, groupsPerRow), true },
+        { "g_groupsPerSlice", offsetof(ReductionPassConstants, groupsPerSlice), true },
+        { "g_passIndex", offsetof(ReductionPassConstants, passIndex), true },
+        { "g_summaryOffset", offsetof(ReductionPassConstants, summaryOffset), false }
+    };
+    enum { MEMBER_COUNT = sizeof(members) / sizeof(members[0]) };
+
+    if (reflection->isDXIL) return true;
+
+    const ShaderBinding* binding = FindShaderBinding(reflection, SHADER_BINDING_CBV, 0, 0);
+    const ShaderConstantBuffer* constantBuffer = NULL;
+    for (uint32_t i = 0; binding != NULL && i < reflection->constantBufferCount && constantBuffer == NULL; ++i)
+    {
+        if (strcmp(reflection->constantBuffers[i].name, binding->name) == 0) {
+            constantBuffer = &reflection->constantBuffers[i];
+        }
+    }
+    if (constantBuffer == NULL)
+    {
+        fprintf(stderr, "The kernel does not declare the pass constants at b0!\n");
+        return false;
+    }
+
+    const uint32_t recordSize = (uint32_t)(sizeof(ReductionPassConstants) + 15) & ~15U;
+    if (constantBuffer->size > recordSize)
+    {
+        fprintf(stderr, "The pass constants `%s` of the kernel are %u bytes instead of at most %u!\n",
+                constantBuffer->name, constantBuffer->size, recordSize);
+        return false;
+    }
+
+    bool isDeclared[MEMBER_COUNT] = { false };
+    for (uint32_t v = 0; v < constantBuffer->variableCount; ++v)
+    {
+        const ShaderVariable* variable = &reflection->variables[constantBuffer->firstVariable + v];
+        uint32_t m = 0;
+        while (m < MEMBER_COUNT && strcmp(members[m].name, variable->name) != 0) ++m;
+        if (m == MEMBER_COUNT || variable->offset != members[m].offset || variable->size != sizeof(uint32_t))
+        {
+            fprintf(stderr, "The pass constant `%s` of the kernel at offset %u does not match ReductionPassConstants!\n",
+                    variable->name, variable->offset);
+            return false;
+        }
+        isDeclared[m] = true;
+    }
+
+    for (uint32_t m = 0; m < MEMBER_COUNT; ++m)
+    {
+        if (members[m].isRequired && !isDeclared[m])
+        {
+            fprintf(stderr, "The pass constants `%s` of the kernel do not declare `%s`!\n", constantBuffer->name, members[m].name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool BuildBatchLayout(BatchJob jobs[], uint32_t jobCount, uint64_t inputElementCount, uint32_t groupSize, BatchLayout* layout)
+{
+    if (layout == NULL || jobs == NULL || jobCount == 0 || groupSize == 0) return false;
+
+    memset(layout, 0, sizeof(*layout));
+    layout->inputElementCount = inputElementCount;
+
+    uint64_t inputEnd = 0;
+    for (uint32_t i = 0; i < jobCount; i++)
+    {
+        BatchJob* job = &jobs[i];
+        if (job->inputOffset < inputEnd || (uint64_t)job->inputOffset + job->elementCount > inputElementCount) return false;
+
+        job->firstGroup = (uint32_t)layout->groupCount;
+        layout->groupCount += (job->elementCount + groupSize - 1) / groupSize;
+        inputEnd = (uint64_t)job->inputOffset + job->elementCount;
+
+        if (layout->groupCount > UINT32_MAX) return false;
+    }
+
+    layout->totalElementCount = inputElementCount + layout->groupCount;
+    layout->grid = ComputeDispatchGrid(layout->groupCount);
+
+    // The kernel addresses the read-write buffer with 32-bit element indices
+    return layout->groupCount > 0 && layout->totalElementCount <= UINT32_MAX;
+}
+
+void FillBatchConstants(const BatchLayout* layout, uint32_t jobCount, BatchConstants* constants)
+{
+    constants->jobCount = jobCount;
+    constants->groupCount = (uint32_t)layout->groupCount;
+    constants->groupsPerRow = layout->grid.x;
+    constants->groupsPerSlice = layout->grid.x * layout->grid.y;
+    constants->outputOffset = (uint32_t)layout->inputElementCount;
+}
+
+uint32_t FindBatchJob(const BatchJob jobs[], uint32_t jobCount, uint64_t groupIndex)
+{
+    // The first job always starts at group 0, and the job is kept within [first, first + count)
+    uint32_t first = 0;
+    uint32_t count = jobCount;
+    while (count > 1)
+    {
+        const uint32_t step = count / 2;
+        if (jobs[first + step].firstGroup <= groupIndex)
+        {
+            first += step;
+            count -= step;
+        }
+        else {
+            count = step;
+        }
+    }
+
+    return first;
+}
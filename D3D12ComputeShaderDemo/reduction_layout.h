@@ -0,0 +1,152 @@
+#ifndef REDUCTION_LAYOUT_H
+#define REDUCTION_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "shader_reflection.h"
+
+enum
+{
+    // D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION
+    MAX_DISPATCH_GROUPS_PER_DIMENSION = 65535,
+
+    // The max number of reduction passes. 1024^6 exceeds the 32-bit element index space of the kernels.
+    MAX_REDUCTION_PASS_COUNT = 6,
+
+    // When the constants are bound as a root CBV, each pass owns one 256-byte aligned record (D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT)
+    REDUCTION_PASS_CONSTANTS_STRIDE = 256
+};
+
+// The thread group grid of one dispatch
+typedef struct DispatchGrid
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+} DispatchGrid;
+
+// One pass of the hierarchical group sum.
+// The pass reduces rwBuffer[inputOffset, inputOffset + elementCount) into rwBuffer[outputOffset, outputOffset + groupCount).
+typedef struct ReductionPass
+{
+    uint64_t inputOffset;
+    uint64_t elementCount;
+    uint64_t outputOffset;
+    uint64_t groupCount;
+    DispatchGrid grid;
+} ReductionPass;
+
+// The layout of the read-write buffer: the input elements followed by the partial sums of each pass.
+// The partial sums of the last pass is a single scalar, the sum of all the input elements.
+typedef struct ReductionLayout
+{
+    uint32_t passCount;
+    ReductionPass passes[MAX_REDUCTION_PASS_COUNT];
+
+    // The input element count
+    uint64_t inputElementCount;
+
+    // The element count of the whole read-write buffer
+    uint64_t totalElementCount;
+
+    // The element index of the final scalar sum
+    uint64_t resultOffset;
+} ReductionLayout;
+
+// The constant buffer record of one pass (cbCS in shaders/compute.hlsl).
+// The on-device verification runs once per pass with the same record.
+typedef struct ReductionPassConstants
+{
+    int32_t constantValue;      // g_constant
+    uint32_t minWaveLanes;      // g_minWaveLanes
+    uint32_t elementCount;      // g_elementCount
+    uint32_t inputOffset;       // g_inputOffset
+    uint32_t outputOffset;      // g_outputOffset
+    uint32_t groupCount;        // g_groupCount
+    uint32_t groupsPerRow;      // g_groupsPerRow
+    uint32_t groupsPerSlice;    // g_groupsPerSlice
+    uint32_t passIndex;         // g_passIndex
+    uint32_t summaryOffset;     // g_summaryOffset, only declared by shaders/verify.hlsl
+} ReductionPassConstants;
+
+// One job of a batch (BatchJob in shaders/compute_batch.hlsl).
+// The job adds its own constant to the elements [inputOffset, inputOffset + elementCount) of the packed inputs,
+// and writes the sums of its groups to the groups [firstGroup, firstGroup + its group count) of the batch.
+// A thread group never spans two jobs.
+typedef struct BatchJob
+{
+    uint32_t inputOffset;
+    uint32_t elementCount;
+    int32_t constantValue;
+    uint32_t firstGroup;
+} BatchJob;
+
+// The layout of the read-write buffer of a batch: the packed inputs of all the jobs followed by the group sums of all the jobs.
+// The whole batch is executed by a single dispatch, so there is no further reduction pass.
+typedef struct BatchLayout
+{
+    // The element count of the packed inputs, which is also the element index of the first group sum
+    uint64_t inputElementCount;
+
+    // The group count of all the jobs
+    uint64_t groupCount;
+
+    // The element count of the whole read-write buffer
+    uint64_t totalElementCount;
+
+    DispatchGrid grid;
+} BatchLayout;
+
+// The constant buffer record of a batch (cbBatch in shaders/compute_batch.hlsl)
+typedef struct BatchConstants
+{
+    uint32_t jobCount;          // g_jobCount
+    uint32_t groupCount;        // g_groupCount
+    uint32_t groupsPerRow;      // g_groupsPerRow
+    uint32_t groupsPerSlice;    // g_groupsPerSlice
+    uint32_t outputOffset;      // g_outputOffset
+} BatchConstants;
+
+// Map `groupCount` thread groups onto a 1D, 2D or 3D grid that respects the per-dimension dispatch limit.
+// Some groups of the last row or slice may exceed `groupCount`, and the kernels ignore them.
+extern DispatchGrid ComputeDispatchGrid(uint64_t groupCount);
+
+// Build the pass layout of the hierarchical group sum of `elementCount` input elements,
+// where each thread group reduces `groupSize` elements.
+// Returns false if the whole read-write buffer cannot be addressed by the 32-bit element indices of the kernels.
+extern bool BuildReductionLayout(uint64_t elementCount, uint32_t groupSize, ReductionLayout* layout);
+
+// Cap the grid of each pass at `residentGroupCount` groups for a grid-stride kernel,
+// whose groups loop over the groups of the pass with a stride of the dispatched group count.
+// The capped grids are 1D, so `groupsPerRow` of the pass constants is the stride.
+// `residentGroupCount` must be in [1, MAX_DISPATCH_GROUPS_PER_DIMENSION].
+extern void LimitReductionGrids(ReductionLayout* layout, uint32_t residentGroupCount);
+
+// Fill the constant buffer record of the pass `passIndex`
+extern void FillReductionPassConstants(const ReductionLayout* layout, uint32_t passIndex, int constantValue,
+                                        uint32_t minWaveLanes, ReductionPassConstants* constants);
+
+// Check that the constant buffer bound to b0 of a reflected kernel has the layout of ReductionPassConstants:
+// it declares every member up to g_passIndex at the offset of its field, g_summaryOffset at most,
+// and no other member, within the 16-byte aligned size of the record.
+// The constant buffer layouts of DXIL are not known, so they are not checked.
+// Returns false and prints the first mismatch otherwise, e.g. for a kernel compiled from an older cbCS.
+extern bool CheckReductionPassConstantsLayout(const ShaderReflection* reflection);
+
+// Assign the first group of each of the `jobCount` jobs, where each thread group reduces `groupSize` elements of a single job,
+// and build the layout of the batch over `inputElementCount` packed input elements.
+// The jobs must be ordered by their input offsets and must not overlap, since each of them owns its segment of the destination buffer.
+// Returns false if a job exceeds the packed inputs, or if the read-write buffer cannot be addressed by 32-bit element indices.
+extern bool BuildBatchLayout(BatchJob jobs[], uint32_t jobCount, uint64_t inputElementCount, uint32_t groupSize, BatchLayout* layout);
+
+// Fill the constant buffer record of the single dispatch of a batch
+extern void FillBatchConstants(const BatchLayout* layout, uint32_t jobCount, BatchConstants* constants);
+
+// Find the job of the group `groupIndex` of a batch: the last job whose first group is not after it.
+// The binary search is the one of shaders/compute_batch.hlsl. The empty jobs own no group, so they are never found.
+extern uint32_t FindBatchJob(const BatchJob jobs[], uint32_t jobCount, uint64_t groupIndex);
+
+#endif // REDUCTION_LAYOUT_H
+
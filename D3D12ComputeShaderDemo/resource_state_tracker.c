@@ -0,0 +1,126 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "resource_state_tracker.h"
+
+// Find the entry of `resource`, or add one in the common state
+static TrackedResource* FindTrackedResource(ResourceStateTracker* tracker, const void* resource)
+{
+    for (uint32_t i = 0; i < tracker->resourceCount; ++i)
+    {
+        if (tracker->resources[i].resource == resource) return &tracker->resources[i];
+    }
+
+    if (tracker->resourceCount == RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT) return NULL;
+
+    TrackedResource* entry = &tracker->resources[tracker->resourceCount++];
+    *entry = (TrackedResource){ .resource = resource, .state = RESOURCE_STATE_COMMON };
+    return entry;
+}
+
+static bool QueueBarrier(ResourceStateTracker* tracker, const ResourceBarrierDesc* barrier)
+{
+    if (tracker->barrierCount == RESOURCE_STATE_TRACKER_MAX_BARRIER_COUNT) return false;
+
+    tracker->barriers[tracker->barrierCount++] = *barrier;
+    return true;
+}
+
+static bool QueueTransition(ResourceStateTracker* tracker, TrackedResource* entry, uint32_t state, ResourceBarrierSplit split)
+{
+    const ResourceBarrierDesc barrier = {
+        .type = RESOURCE_BARRIER_TRANSITION,
+        .split = split,
+        .resource = entry->resource,
+        .stateBefore = entry->state,
+        .stateAfter = state
+    };
+    return QueueBarrier(tracker, &barrier);
+}
+
+// Indicate whether a use of `entry` in `state` needs no barrier, i.e. the buffer is already in that state or can be promoted to it
+static bool IsPromotable(const TrackedResource* entry, uint32_t state)
+{
+    if (entry->state == RESOURCE_STATE_COMMON) return true;
+
+    // The read states already reached are also valid for the reads that only need some of them
+    if ((state & ~RESOURCE_STATE_READ_MASK) == 0 && (entry->state & state) == state) return true;
+    if (state == entry->state) return true;
+
+    // A buffer promoted to read states can be promoted again to other read states
+    return entry->isPromoted && (entry->state & ~RESOURCE_STATE_READ_MASK) == 0 && (state & ~RESOURCE_STATE_READ_MASK) == 0;
+}
+
+void ResetResourceStateTracker(ResourceStateTracker* tracker)
+{
+    tracker->resourceCount = 0;
+    tracker->barrierCount = 0;
+}
+
+bool TrackResourceUse(ResourceStateTracker* tracker, const void* resource, uint32_t state)
+{
+    TrackedResource* entry = FindTrackedResource(tracker, resource);
+    if (entry == NULL) return false;
+
+    if (entry->pendingState != RESOURCE_STATE_COMMON)
+    {
+        // End the split transition that has begun, then move on from its target state if the use needs another one
+        if (!QueueTransition(tracker, entry, entry->pendingState, RESOURCE_BARRIER_SPLIT_END_ONLY)) return false;
+        entry->state = entry->pendingState;
+        entry->pendingState = RESOURCE_STATE_COMMON;
+        entry->isPromoted = false;
+        entry->hasUnorderedAccesses = false;
+    }
+
+    if (IsPromotable(entry, state))
+    {
+        entry->isPromoted = entry->isPromoted || entry->state == RESOURCE_STATE_COMMON;
+        entry->state |= state;
+    }
+    else
+    {
+        // A transition also orders the unordered accesses before it
+        if (!QueueTransition(tracker, entry, state, RESOURCE_BARRIER_SPLIT_NONE)) return false;
+        entry->state = state;
+        entry->isPromoted = false;
+        entry->hasUnorderedAccesses = false;
+    }
+
+    entry->hasUnorderedAccesses = entry->hasUnorderedAccesses || state == RESOURCE_STATE_UNORDERED_ACCESS;
+    return true;
+}
+
+bool TrackUnorderedAccessDependency(ResourceStateTracker* tracker, const void* resource)
+{
+    TrackedResource* entry = FindTrackedResource(tracker, resource);
+    if (entry == NULL) return false;
+    if (!entry->hasUnorderedAccesses) return true;
+
+    const ResourceBarrierDesc barrier = { .type = RESOURCE_BARRIER_UAV, .resource = resource };
+    if (!QueueBarrier(tracker, &barrier)) return false;
+
+    entry->hasUnorderedAccesses = false;
+    return true;
+}
+
+bool BeginResourceTransition(ResourceStateTracker* tracker, const void* resource, uint32_t state)
+{
+    TrackedResource* entry = FindTrackedResource(tracker, resource);
+    if (entry == NULL) return false;
+
+    // A transition that has already begun, or that the promotion makes unnecessary, is left to the next use
+    if (entry->pendingState != RESOURCE_STATE_COMMON || state == RESOURCE_STATE_COMMON || IsPromotable(entry, state)) return true;
+
+    if (!QueueTransition(tracker, entry, state, RESOURCE_BARRIER_SPLIT_BEGIN_ONLY)) return false;
+    entry->pendingState = state;
+    return true;
+}
+
+uint32_t TakeResourceBarriers(ResourceStateTracker* tracker, const ResourceBarrierDesc** ppBarriers)
+{
+    const uint32_t barrierCount = tracker->barrierCount;
+    *ppBarriers = tracker->barriers;
+    tracker->barrierCount = 0;
+    return barrierCount;
+}
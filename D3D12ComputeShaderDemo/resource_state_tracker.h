@@ -0,0 +1,112 @@
+#ifndef RESOURCE_STATE_TRACKER_H
+#define RESOURCE_STATE_TRACKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The max number of buffers used by one command list
+    RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT = 16,
+
+    // The max number of barriers of one dependency point
+    RESOURCE_STATE_TRACKER_MAX_BARRIER_COUNT = 2 * RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT
+};
+
+// The buffer states, a subset of D3D12_RESOURCE_STATES. The read states can be combined.
+typedef enum ResourceState
+{
+    RESOURCE_STATE_COMMON = 0,
+    RESOURCE_STATE_CONSTANT_BUFFER = 1 << 0,        // D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER
+    RESOURCE_STATE_UNORDERED_ACCESS = 1 << 1,
+    RESOURCE_STATE_SHADER_RESOURCE = 1 << 2,        // D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE
+    RESOURCE_STATE_COPY_DEST = 1 << 3,
+    RESOURCE_STATE_COPY_SOURCE = 1 << 4,
+
+    RESOURCE_STATE_READ_MASK = RESOURCE_STATE_CONSTANT_BUFFER | RESOURCE_STATE_SHADER_RESOURCE | RESOURCE_STATE_COPY_SOURCE
+} ResourceState;
+
+typedef enum ResourceBarrierType
+{
+    RESOURCE_BARRIER_TRANSITION,
+
+    // Orders the unordered accesses before the barrier with the ones after it
+    RESOURCE_BARRIER_UAV
+} ResourceBarrierType;
+
+// The halves of a split transition (D3D12_RESOURCE_BARRIER_FLAGS)
+typedef enum ResourceBarrierSplit
+{
+    RESOURCE_BARRIER_SPLIT_NONE,
+    RESOURCE_BARRIER_SPLIT_BEGIN_ONLY,
+    RESOURCE_BARRIER_SPLIT_END_ONLY
+} ResourceBarrierSplit;
+
+// One barrier of the generated stream, free of any D3D12 type
+typedef struct ResourceBarrierDesc
+{
+    ResourceBarrierType type;
+    ResourceBarrierSplit split;
+
+    // The opaque handle of the resource, e.g. its ID3D12Resource
+    const void* resource;
+
+    // The states of a transition, combinations of ResourceState
+    uint32_t stateBefore;
+    uint32_t stateAfter;
+} ResourceBarrierDesc;
+
+// The last known state of one buffer in the command list
+typedef struct TrackedResource
+{
+    const void* resource;
+    uint32_t state;
+
+    // Indicate whether the state has been reached by an implicit promotion from the common state,
+    // in which case other read states can still be promoted into it
+    bool isPromoted;
+
+    // The target state of a split transition that has begun, or RESOURCE_STATE_COMMON if there is none
+    uint32_t pendingState;
+
+    // Indicate whether the buffer has been accessed as a UAV since the last barrier that orders those accesses
+    bool hasUnorderedAccesses;
+} TrackedResource;
+
+// The tracker of the buffer states of one command list.
+// Every buffer is in the common state when the command list begins, since buffers decay to it at the end of each
+// ExecuteCommandLists. A use from the common state is an implicit promotion and needs no barrier,
+// so only the transitions out of a promoted write state, the transitions that were begun as split barriers
+// and the UAV dependencies generate barriers. They are batched until `TakeResourceBarriers`.
+typedef struct ResourceStateTracker
+{
+    uint32_t resourceCount;
+    TrackedResource resources[RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT];
+
+    // The barriers of the next dependency point, in order
+    uint32_t barrierCount;
+    ResourceBarrierDesc barriers[RESOURCE_STATE_TRACKER_MAX_BARRIER_COUNT];
+} ResourceStateTracker;
+
+// Forget all the states and the pending barriers, at the start of a command list
+extern void ResetResourceStateTracker(ResourceStateTracker* tracker);
+
+// Declare that the next command accesses `resource` in `state`, and queue the transition it needs.
+// A use as a UAV is assumed to write the buffer. Returns false if the tracker is full.
+extern bool TrackResourceUse(ResourceStateTracker* tracker, const void* resource, uint32_t state);
+
+// Declare that the next command depends on the unordered accesses to `resource` made so far,
+// and queue a UAV barrier if there are any. Returns false if the tracker is full.
+extern bool TrackUnorderedAccessDependency(ResourceStateTracker* tracker, const void* resource);
+
+// Begin the transition of `resource` to `state` at the next dependency point, so that the device can perform it
+// while the commands in between are executed. The transition ends at the next use of the buffer.
+// No barrier is needed if the buffer can still be promoted. Returns false if the tracker is full.
+extern bool BeginResourceTransition(ResourceStateTracker* tracker, const void* resource, uint32_t state);
+
+// Take the barriers queued since the last call, which must be recorded in a single batch before the next command.
+// `*ppBarriers` stays valid until the next call on the tracker. Returns the barrier count.
+extern uint32_t TakeResourceBarriers(ResourceStateTracker* tracker, const ResourceBarrierDesc** ppBarriers);
+
+#endif // RESOURCE_STATE_TRACKER_H
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "result_verifier.h"
+#include "cpu_kernels.h"
+
+enum
+{
+    // The number of elements of a verification task, which fits in the L2 cache of a core
+    VERIFICATION_CHUNK_SIZE = 64 * 1024
+};
+
+// The buffers of one verification, shared by all its tasks
+typedef struct VerificationJob
+{
+    const CPUKernels* kernels;
+    const int* actual;
+    const int* expected;
+    int constantValue;
+
+    // The element count, or the group count of the group sums
+    size_t count;
+
+    // The elements or groups per chunk
+    size_t chunkSize;
+
+    // The summed elements of the group sums
+    size_t valueCount;
+    size_t groupSize;
+
+    double fraction;
+
+    // The report of each chunk, merged in order once all of them are done
+    VerificationReport* chunkReports;
+} VerificationJob;
+
+static bool IsChunkSampled(size_t chunkIndex, double fraction)
+{
+    // The chunks where the rounded-up running count of the sampled ones increases, which include the first one
+    return fraction >= 1.0 || ceil((double)(chunkIndex + 1) * fraction) != ceil((double)chunkIndex * fraction);
+}
+
+// Prepare the report of a chunk, and return the range of its elements if it is sampled
+static bool BeginChunk(const VerificationJob* job, size_t chunkIndex, size_t* pBegin, size_t* pEnd)
+{
+    VerificationReport* report = &job->chunkReports[chunkIndex];
+    *report = (VerificationReport){ .firstMismatch = SIZE_MAX, .lastMismatch = SIZE_MAX };
+    if (!IsChunkSampled(chunkIndex, job->fraction)) return false;
+
+    *pBegin = chunkIndex * job->chunkSize;
+    *pEnd = job->count - *pBegin < job->chunkSize ? job->count : *pBegin + job->chunkSize;
+    report->checkedCount = *pEnd - *pBegin;
+    return true;
+}
+
+static void VerifyElementChunk(void* userData, size_t chunkIndex, unsigned workerIndex, void* workerScratch)
+{
+    (void)workerIndex;
+    (void)workerScratch;
+
+    const VerificationJob* job = userData;
+    VerificationReport* report = &job->chunkReports[chunkIndex];
+    size_t begin, end;
+    if (!BeginChunk(job, chunkIndex, &begin, &end)) return;
+
+    report->mismatchCount = job->kernels->CountMismatches(job->actual + begin, job->expected + begin, end - begin, job->constantValue,
+                                                          &report->checksum);
+    if (report->mismatchCount == 0) return;
+
+    // Only the chunks that have mismatches are scanned again for their positions
+    const uint32_t constantValue = (uint32_t)job->constantValue;
+    for (size_t i = begin; i < end; ++i)
+    {
+        if ((uint32_t)job->actual[i] != (uint32_t)job->expected[i] + constantValue)
+        {
+            report->firstMismatch = report->firstMismatch == SIZE_MAX ? i : report->firstMismatch;
+            report->lastMismatch = i;
+        }
+    }
+}
+
+static void VerifyGroupSumChunk(void* userData, size_t chunkIndex, unsigned workerIndex, void* workerScratch)
+{
+    (void)workerIndex;
+    (void)workerScratch;
+
+    const VerificationJob* job = userData;
+    VerificationReport* report = &job->chunkReports[chunkIndex];
+    size_t begin, end;
+    if (!BeginChunk(job, chunkIndex, &begin, &end)) return;
+
+    for (size_t g = begin; g < end; ++g)
+    {
+        const size_t first = g * job->groupSize;
+        const size_t count = job->valueCount - first < job->groupSize ? job->valueCount - first : job->groupSize;
+        if (job->actual[g] != job->kernels->Sum(job->expected + first, count))
+        {
+            ++report->mismatchCount;
+            report->firstMismatch = report->firstMismatch == SIZE_MAX ? g : report->firstMismatch;
+            report->lastMismatch = g;
+        }
+        report->checksum += (uint32_t)job->actual[g];
+    }
+}
+
+static bool RunVerification(ThreadPool* pool, VerificationJob* job, ThreadPoolTask task, VerificationReport* pReport)
+{
+    const size_t chunkCount = (job->count + job->chunkSize - 1) / job->chunkSize;
+    *pReport = (VerificationReport){ .firstMismatch = SIZE_MAX, .lastMismatch = SIZE_MAX };
+    if (chunkCount == 0) return true;
+
+    job->kernels = GetCPUKernels(GetBestCPUKernelISA());
+    job->chunkReports = malloc(chunkCount * sizeof(*job->chunkReports));
+    if (job->chunkReports == NULL)
+    {
+        fprintf(stderr, "Lack of memory for the verification reports...\n");
+        return false;
+    }
+
+    ThreadPoolRun(pool, task, job, chunkCount);
+
+    for (size_t c = 0; c < chunkCount; ++c)
+    {
+        const VerificationReport* chunkReport = &job->chunkReports[c];
+        pReport->checkedCount += chunkReport->checkedCount;
+        pReport->mismatchCount += chunkReport->mismatchCount;
+        pReport->checksum += chunkReport->checksum;
+        if (chunkReport->mismatchCount > 0)
+        {
+            pReport->firstMismatch = pReport->firstMismatch == SIZE_MAX ? chunkReport->firstMismatch : pReport->firstMismatch;
+            pReport->lastMismatch = chunkReport->lastMismatch;
+        }
+    }
+
+    free(job->chunkReports);
+    return true;
+}
+
+bool VerifyElements(ThreadPool* pool, const int actual[], const int expected[], size_t count, int constantValue, double fraction,
+                    VerificationReport* pReport)
+{
+    VerificationJob job = {
+        .actual = actual,
+        .expected = expected,
+        .constantValue = constantValue,
+        .count = count,
+        .chunkSize = VERIFICATION_CHUNK_SIZE,
+        .fraction = fraction
+    };
+    return RunVerification(pool, &job, VerifyElementChunk, pReport);
+}
+
+bool VerifyGroupSums(ThreadPool* pool, const int sums[], const int values[], size_t valueCount, size_t groupSize, double fraction,
+                    VerificationReport* pReport)
+{
+    VerificationJob job = {
+        .actual = sums,
+        .expected = values,
+        .count = (valueCount + groupSize - 1) / groupSize,
+        .chunkSize = VERIFICATION_CHUNK_SIZE / groupSize > 0 ? VERIFICATION_CHUNK_SIZE / groupSize : 1,
+        .valueCount = valueCount,
+        .groupSize = groupSize,
+        .fraction = fraction
+    };
+    return RunVerification(pool, &job, VerifyGroupSumChunk, pReport);
+}
@@ -0,0 +1,40 @@
+#ifndef RESULT_VERIFIER_H
+#define RESULT_VERIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "thread_pool.h"
+
+// The outcome of the verification of a result buffer
+typedef struct VerificationReport
+{
+    // The number of the checked elements, which is less than the element count when only a fraction of them is sampled
+    size_t checkedCount;
+
+    size_t mismatchCount;
+
+    // The indices of the first and the last mismatching elements, or SIZE_MAX if there is none
+    size_t firstMismatch;
+    size_t lastMismatch;
+
+    // The wrapping 32-bit sum of the checked elements, which identifies the results of a run
+    uint32_t checksum;
+} VerificationReport;
+
+// The buffers are split into chunks that are verified in parallel by the workers of `pool`, with the widest supported SIMD kernels.
+// `fraction` in (0, 1] is the fraction of the chunks that are checked, evenly spread over the buffer and always including the first one.
+// Both functions read the result memory in place, so it can be a mapped read-back buffer.
+// They return false only if the memory for the chunk reports cannot be allocated.
+
+// Check actual[i] == expected[i] + constantValue for the `count` elements
+extern bool VerifyElements(ThreadPool* pool, const int actual[], const int expected[], size_t count, int constantValue, double fraction,
+                            VerificationReport* pReport);
+
+// Check that each element of `sums` is the wrapping sum of its group of `groupSize` elements of `values[0, valueCount)`.
+// The elements of the report are the groups.
+extern bool VerifyGroupSums(ThreadPool* pool, const int sums[], const int values[], size_t valueCount, size_t groupSize, double fraction,
+                            VerificationReport* pReport);
+
+#endif // RESULT_VERIFIER_H
@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ring_allocator.h"
+
+void InitRingAllocator(RingAllocator* ring, uint64_t capacity)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->capacity = capacity;
+}
+
+bool RingAllocate(RingAllocator* ring, uint64_t size, uint64_t alignment, uint64_t* pOffset)
+{
+    if (size == 0 || size > ring->capacity) return false;
+
+    uint64_t position = ring->head;
+    if (alignment > 1) {
+        position = (position + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Skip the rest of the range if the allocation would wrap around
+    const uint64_t offset = position % ring->capacity;
+    if (offset + size > ring->capacity) {
+        position += ring->capacity - offset;
+    }
+
+    if (position + size - ring->tail > ring->capacity) return false;
+
+    ring->head = position + size;
+    *pOffset = position % ring->capacity;
+    return true;
+}
+
+bool RingFinishSubmission(RingAllocator* ring, uint64_t fenceValue)
+{
+    // Nothing has been allocated by this submission
+    if (ring->head == ring->submissionBegin) return true;
+
+    if (ring->submissionCount == RING_MAX_PENDING_SUBMISSIONS) return false;
+
+    const uint32_t index = (ring->firstSubmission + ring->submissionCount) % RING_MAX_PENDING_SUBMISSIONS;
+    ring->submissions[index] = (RingSubmission){ .fenceValue = fenceValue, .end = ring->head };
+    ++ring->submissionCount;
+    ring->submissionBegin = ring->head;
+
+    return true;
+}
+
+void RingRetire(RingAllocator* ring, uint64_t completedFenceValue)
+{
+    while (ring->submissionCount > 0)
+    {
+        const RingSubmission* submission = &ring->submissions[ring->firstSubmission];
+        if (submission->fenceValue > completedFenceValue) break;
+
+        ring->tail = submission->end;
+        ring->firstSubmission = (ring->firstSubmission + 1) % RING_MAX_PENDING_SUBMISSIONS;
+        --ring->submissionCount;
+    }
+}
+
@@ -0,0 +1,63 @@
+#ifndef RING_ALLOCATOR_H
+#define RING_ALLOCATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The max number of submissions whose ring space has not been retired yet
+    RING_MAX_PENDING_SUBMISSIONS = 64
+};
+
+// The ring space consumed by one submission, which is reclaimed once its fence value has been reached
+typedef struct RingSubmission
+{
+    uint64_t fenceValue;
+    uint64_t end;
+} RingSubmission;
+
+// A FIFO sub-allocator of a fixed range, such as a persistently mapped upload buffer.
+// The allocations are retired in submission order when the fence value of their submission completes.
+// `head` and `tail` are monotonic positions, and the offset inside the range is the position modulo the capacity.
+typedef struct RingAllocator
+{
+    uint64_t capacity;
+
+    // The position of the next allocation
+    uint64_t head;
+
+    // The position of the oldest byte that may still be read by the device
+    uint64_t tail;
+
+    // The position where the allocations of the current (not yet submitted) submission begin
+    uint64_t submissionBegin;
+
+    // The pending submissions, oldest first
+    RingSubmission submissions[RING_MAX_PENDING_SUBMISSIONS];
+    uint32_t firstSubmission;
+    uint32_t submissionCount;
+} RingAllocator;
+
+extern void InitRingAllocator(RingAllocator* ring, uint64_t capacity);
+
+// Allocate `size` bytes aligned to `alignment` (0 or a power of 2). An allocation never wraps around the end of the range.
+// Returns false if the ring does not have enough space before older submissions are retired.
+extern bool RingAllocate(RingAllocator* ring, uint64_t size, uint64_t alignment, uint64_t* pOffset);
+
+// Tag all the allocations since the last call with `fenceValue`, the value to be signaled after they are consumed.
+// Returns false if there are too many pending submissions.
+extern bool RingFinishSubmission(RingAllocator* ring, uint64_t fenceValue);
+
+// Reclaim the space of all the submissions whose fence values are not greater than `completedFenceValue`
+extern void RingRetire(RingAllocator* ring, uint64_t completedFenceValue);
+
+// The bytes that are allocated and not yet retired
+static inline uint64_t RingGetUsedBytes(const RingAllocator* ring)
+{
+    return ring->head - ring->tail;
+}
+
+#endif // RING_ALLOCATOR_H
+
@@ -0,0 +1,208 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "root_signature_layout.h"
+
+// The order of the bindings in the root signature
+static bool BindingPrecedes(const ShaderBinding* binding1, const ShaderBinding* binding2)
+{
+    if (binding1->type != binding2->type) return binding1->type < binding2->type;
+    if (binding1->registerSpace != binding2->registerSpace) return binding1->registerSpace < binding2->registerSpace;
+    return binding1->registerIndex < binding2->registerIndex;
+}
+
+static bool CanBeRootDescriptor(const ShaderBinding* binding)
+{
+    return binding->isBuffer && binding->bindCount == 1 && binding->type != SHADER_BINDING_SAMPLER;
+}
+
+// Append a descriptor table of the bindings `tableBindings`. An unbounded range is only valid as the last one of its table.
+static void AppendDescriptorTable(const ShaderReflection* reflection, const uint32_t tableBindings[], uint32_t tableBindingCount,
+                                RootSignatureLayout* layout)
+{
+    if (tableBindingCount == 0) return;
+
+    RootParameterLayout* parameter = &layout->parameters[layout->parameterCount++];
+    *parameter = (RootParameterLayout){ .type = ROOT_PARAMETER_DESCRIPTOR_TABLE, .firstRange = layout->rangeCount };
+
+    for (uint32_t i = 0; i < tableBindingCount; ++i)
+    {
+        const ShaderBinding* binding = &reflection->bindings[tableBindings[i]];
+        layout->ranges[layout->rangeCount++] = (RootDescriptorRange){
+            .type = binding->type,
+            .baseRegister = binding->registerIndex,
+            .registerSpace = binding->registerSpace,
+            .descriptorCount = binding->bindCount,
+            .tableOffset = parameter->descriptorCount
+        };
+        parameter->descriptorCount += binding->bindCount;
+        ++parameter->rangeCount;
+    }
+
+    layout->dwordCount += ROOT_DESCRIPTOR_TABLE_DWORD_COUNT;
+}
+
+bool BuildRootSignatureLayout(const ShaderReflection* reflection, RootSignatureLayout* pLayout)
+{
+    memset(pLayout, 0, sizeof(*pLayout));
+
+    // Sort the bindings with an insertion sort, since there are only a few of them
+    uint32_t order[SHADER_REFLECTION_MAX_BINDING_COUNT];
+    const uint32_t bindingCount = reflection->bindingCount;
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        uint32_t j = i;
+        for (; j > 0 && BindingPrecedes(&reflection->bindings[i], &reflection->bindings[order[j - 1]]); --j) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    // Start with every eligible binding as a root descriptor, then demote the last ones until the signature fits
+    bool isRootDescriptor[SHADER_REFLECTION_MAX_BINDING_COUNT] = { false };
+    uint32_t rootDescriptorCount = 0;
+    bool needsResourceTable = false, needsSamplerTable = false;
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        const ShaderBinding* binding = &reflection->bindings[order[i]];
+        isRootDescriptor[i] = CanBeRootDescriptor(binding);
+        rootDescriptorCount += isRootDescriptor[i] ? 1 : 0;
+        needsResourceTable |= !isRootDescriptor[i] && binding->type != SHADER_BINDING_SAMPLER && binding->bindCount > 0;
+        needsSamplerTable |= binding->type == SHADER_BINDING_SAMPLER && binding->bindCount > 0;
+    }
+
+    // Every unbounded array gets a table of its own
+    uint32_t tableCount = (needsResourceTable ? 1 : 0) + (needsSamplerTable ? 1 : 0);
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        tableCount += reflection->bindings[order[i]].bindCount == 0 ? 1 : 0;
+    }
+
+    for (uint32_t i = bindingCount; i > 0 && rootDescriptorCount * ROOT_DESCRIPTOR_DWORD_COUNT + tableCount > ROOT_SIGNATURE_MAX_DWORD_COUNT; --i)
+    {
+        if (!isRootDescriptor[i - 1]) continue;
+
+        isRootDescriptor[i - 1] = false;
+        --rootDescriptorCount;
+        if (!needsResourceTable)
+        {
+            needsResourceTable = true;
+            ++tableCount;
+        }
+    }
+    if (rootDescriptorCount * ROOT_DESCRIPTOR_DWORD_COUNT + tableCount > ROOT_SIGNATURE_MAX_DWORD_COUNT) return false;
+
+    uint32_t resourceTable[SHADER_REFLECTION_MAX_BINDING_COUNT], samplerTable[SHADER_REFLECTION_MAX_BINDING_COUNT];
+    uint32_t resourceTableCount = 0, samplerTableCount = 0;
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        const ShaderBinding* binding = &reflection->bindings[order[i]];
+        if (isRootDescriptor[i])
+        {
+            static const RootParameterType rootParameterTypes[] = {
+                [SHADER_BINDING_CBV] = ROOT_PARAMETER_CBV,
+                [SHADER_BINDING_SRV] = ROOT_PARAMETER_SRV,
+                [SHADER_BINDING_UAV] = ROOT_PARAMETER_UAV
+            };
+            pLayout->parameters[pLayout->parameterCount++] = (RootParameterLayout){
+                .type = rootParameterTypes[binding->type],
+                .shaderRegister = binding->registerIndex,
+                .registerSpace = binding->registerSpace
+            };
+            pLayout->dwordCount += ROOT_DESCRIPTOR_DWORD_COUNT;
+        }
+        else if (binding->bindCount > 0)
+        {
+            if (binding->type == SHADER_BINDING_SAMPLER) {
+                samplerTable[samplerTableCount++] = order[i];
+            }
+            else {
+                resourceTable[resourceTableCount++] = order[i];
+            }
+        }
+    }
+
+    AppendDescriptorTable(reflection, resourceTable, resourceTableCount, pLayout);
+    AppendDescriptorTable(reflection, samplerTable, samplerTableCount, pLayout);
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        if (reflection->bindings[order[i]].bindCount == 0) {
+            AppendDescriptorTable(reflection, &order[i], 1, pLayout);
+        }
+    }
+
+    return true;
+}
+
+void BuildBindlessRootSignatureLayout(uint32_t indexCount, RootSignatureLayout* pLayout)
+{
+    memset(pLayout, 0, sizeof(*pLayout));
+
+    pLayout->parameters[pLayout->parameterCount++] = (RootParameterLayout){ .type = ROOT_PARAMETER_CBV, .shaderRegister = 0 };
+    pLayout->parameters[pLayout->parameterCount++] = (RootParameterLayout){
+        .type = ROOT_PARAMETER_CONSTANTS,
+        .shaderRegister = 1,
+        .constantCount = indexCount
+    };
+    pLayout->dwordCount = ROOT_DESCRIPTOR_DWORD_COUNT + indexCount;
+    pLayout->isDescriptorHeapIndexed = true;
+}
+
+bool InlineRootConstants(RootSignatureLayout* layout, uint32_t registerIndex, uint32_t registerSpace, uint32_t dwordCount)
+{
+    if (dwordCount == 0 || dwordCount > ROOT_CONSTANTS_MAX_DWORD_COUNT) return false;
+    if (layout->dwordCount - ROOT_DESCRIPTOR_DWORD_COUNT + dwordCount > ROOT_SIGNATURE_MAX_DWORD_COUNT) return false;
+
+    for (uint32_t i = 0; i < layout->parameterCount; ++i)
+    {
+        RootParameterLayout* parameter = &layout->parameters[i];
+        if (parameter->type != ROOT_PARAMETER_CBV || parameter->shaderRegister != registerIndex || parameter->registerSpace != registerSpace) continue;
+
+        parameter->type = ROOT_PARAMETER_CONSTANTS;
+        parameter->constantCount = dwordCount;
+        layout->dwordCount = layout->dwordCount - ROOT_DESCRIPTOR_DWORD_COUNT + dwordCount;
+        return true;
+    }
+
+    return false;
+}
+
+bool FindRootSignatureBinding(const RootSignatureLayout* layout, ShaderBindingType type, uint32_t registerIndex,
+                            uint32_t registerSpace, uint32_t* pParameterIndex, uint32_t* pTableOffset)
+{
+    static const ShaderBindingType rootDescriptorTypes[] = {
+        [ROOT_PARAMETER_CBV] = SHADER_BINDING_CBV,
+        [ROOT_PARAMETER_SRV] = SHADER_BINDING_SRV,
+        [ROOT_PARAMETER_UAV] = SHADER_BINDING_UAV,
+        [ROOT_PARAMETER_CONSTANTS] = SHADER_BINDING_CBV
+    };
+
+    for (uint32_t i = 0; i < layout->parameterCount; ++i)
+    {
+        const RootParameterLayout* parameter = &layout->parameters[i];
+        if (parameter->type != ROOT_PARAMETER_DESCRIPTOR_TABLE)
+        {
+            if (rootDescriptorTypes[parameter->type] == type && parameter->shaderRegister == registerIndex && parameter->registerSpace == registerSpace)
+            {
+                *pParameterIndex = i;
+                *pTableOffset = 0;
+                return true;
+            }
+            continue;
+        }
+
+        for (uint32_t r = 0; r < parameter->rangeCount; ++r)
+        {
+            const RootDescriptorRange* range = &layout->ranges[parameter->firstRange + r];
+            if (range->type != type || range->registerSpace != registerSpace || registerIndex < range->baseRegister) continue;
+            if (range->descriptorCount != 0 && registerIndex - range->baseRegister >= range->descriptorCount) continue;
+
+            *pParameterIndex = i;
+            *pTableOffset = range->tableOffset + (registerIndex - range->baseRegister);
+            return true;
+        }
+    }
+
+    return false;
+}
+
@@ -0,0 +1,112 @@
+#ifndef ROOT_SIGNATURE_LAYOUT_H
+#define ROOT_SIGNATURE_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "shader_reflection.h"
+
+enum
+{
+    // The size limit of a root signature in DWORDs, and the cost of each kind of root parameter
+    ROOT_SIGNATURE_MAX_DWORD_COUNT = 64,
+    ROOT_DESCRIPTOR_DWORD_COUNT = 2,
+    ROOT_DESCRIPTOR_TABLE_DWORD_COUNT = 1,
+
+    // The largest constant buffer inlined as root constants (64 bytes). A larger one stays behind a root CBV.
+    ROOT_CONSTANTS_MAX_DWORD_COUNT = 16,
+
+    ROOT_SIGNATURE_MAX_PARAMETER_COUNT = SHADER_REFLECTION_MAX_BINDING_COUNT,
+    ROOT_SIGNATURE_MAX_RANGE_COUNT = SHADER_REFLECTION_MAX_BINDING_COUNT
+};
+
+// The kinds of root parameters, in the order of D3D12_ROOT_PARAMETER_TYPE minus the root constants, which come last
+typedef enum RootParameterType
+{
+    ROOT_PARAMETER_DESCRIPTOR_TABLE,
+    ROOT_PARAMETER_CBV,
+    ROOT_PARAMETER_SRV,
+    ROOT_PARAMETER_UAV,
+
+    // 32-bit values inlined in the root arguments, which the shader reads as a constant buffer
+    ROOT_PARAMETER_CONSTANTS
+} RootParameterType;
+
+// The descriptors of one binding inside a descriptor table
+typedef struct RootDescriptorRange
+{
+    ShaderBindingType type;
+    uint32_t baseRegister;
+    uint32_t registerSpace;
+
+    // 0 for an unbounded range, which is always the last one of its table
+    uint32_t descriptorCount;
+
+    // The position of the first descriptor of the range from the start of its table
+    uint32_t tableOffset;
+} RootDescriptorRange;
+
+typedef struct RootParameterLayout
+{
+    RootParameterType type;
+
+    // The register of a root descriptor or root constants
+    uint32_t shaderRegister;
+    uint32_t registerSpace;
+
+    // The number of 32-bit values of root constants
+    uint32_t constantCount;
+
+    // The ranges of a descriptor table are ranges[firstRange, firstRange + rangeCount) of the layout
+    uint32_t firstRange;
+    uint32_t rangeCount;
+
+    // The number of descriptors of a bounded descriptor table
+    uint32_t descriptorCount;
+} RootParameterLayout;
+
+// The root signature of a shader, derived from its reflection, free of any D3D12 type
+typedef struct RootSignatureLayout
+{
+    uint32_t parameterCount;
+    RootParameterLayout parameters[ROOT_SIGNATURE_MAX_PARAMETER_COUNT];
+
+    uint32_t rangeCount;
+    RootDescriptorRange ranges[ROOT_SIGNATURE_MAX_RANGE_COUNT];
+
+    // The size of the root arguments
+    uint32_t dwordCount;
+
+    // Indicate whether the shaders fetch their CBV/SRV/UAV descriptors from ResourceDescriptorHeap (Shader Model 6.6),
+    // i.e. D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    bool isDescriptorHeapIndexed;
+} RootSignatureLayout;
+
+// Build the smallest root signature that binds all the resources of `reflection`.
+// The single structured buffers, raw buffers and constant buffers become root descriptors,
+// which the shader reaches without an indirection through a descriptor heap.
+// All the other resources are packed into one CBV/SRV/UAV descriptor table and one sampler table.
+// If the root descriptors do not fit into the 64-DWORD limit, the ones with the highest registers are moved into the table.
+// The parameters are ordered by CBVs, SRVs and UAVs, each by register space and register, and then the tables.
+// Returns false if the resources cannot be bound within the limit.
+extern bool BuildRootSignatureLayout(const ShaderReflection* reflection, RootSignatureLayout* pLayout);
+
+// Build the root signature shared by all the bindless kernels: the constants of each pass in a root CBV at b0,
+// and the `indexCount` descriptor heap indices of the buffers in root constants at b1.
+// The kernels fetch their buffers from ResourceDescriptorHeap, so the signature does not depend on their resources.
+extern void BuildBindlessRootSignatureLayout(uint32_t indexCount, RootSignatureLayout* pLayout);
+
+// Turn the root CBV of register b`registerIndex` into `dwordCount` root constants,
+// whose values are set in the root arguments of each dispatch instead of being read from a buffer.
+// Returns false and leaves the layout unchanged if the register is not a root CBV,
+// or if the constants exceed ROOT_CONSTANTS_MAX_DWORD_COUNT or the size limit of the root signature.
+extern bool InlineRootConstants(RootSignatureLayout* layout, uint32_t registerIndex, uint32_t registerSpace, uint32_t dwordCount);
+
+// Find where register `registerIndex` of `type` is bound.
+// `pParameterIndex` receives the index of its root parameter, and `pTableOffset` its position in the descriptor table
+// (0 for a root descriptor or root constants). Returns false if the register is not bound.
+extern bool FindRootSignatureBinding(const RootSignatureLayout* layout, ShaderBindingType type, uint32_t registerIndex,
+                                    uint32_t registerSpace, uint32_t* pParameterIndex, uint32_t* pTableOffset);
+
+#endif // ROOT_SIGNATURE_LAYOUT_H
+
@@ -0,0 +1,467 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+#include "shader_asset.h"
+
+enum
+{
+    // "DXBC"
+    DXBC_CONTAINER_MAGIC = 0x43425844,
+
+    // The bytes in front of the part offsets: the magic, the 16-byte digest, the version, the file size and the part count
+    DXBC_CONTAINER_HEADER_SIZE = 32,
+
+    // The digest covers everything after the magic and the digest themselves
+    DXBC_DIGEST_END = 20,
+
+    // "SPAK"
+    SHADER_ARCHIVE_MAGIC = 0x4b415053,
+    SHADER_ARCHIVE_VERSION = 1,
+
+    // The alignment of every kernel in an archive
+    SHADER_ARCHIVE_ALIGNMENT = 16,
+
+    // The max length of the path of a compiled shader object, including the terminating null character
+    SHADER_MAX_PATH_LENGTH = sizeof(SHADER_DIRECTORY) + SHADER_ARCHIVE_MAX_NAME_LENGTH
+};
+
+struct ShaderAssetFile
+{
+    const uint8_t* data;
+    size_t size;
+
+#ifdef _WIN32
+    HANDLE hFile;
+    HANDLE hMapping;
+#endif // _WIN32
+};
+
+typedef struct ShaderArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+} ShaderArchiveHeader;
+
+// One kernel of an archive. The entries follow the header, and the containers follow the entries.
+typedef struct ShaderArchiveEntry
+{
+    char name[SHADER_ARCHIVE_MAX_NAME_LENGTH];
+
+    // The offset from the beginning of the archive
+    uint64_t offset;
+    uint64_t size;
+} ShaderArchiveEntry;
+
+static const char* const s_shaderKernelNames[SHADER_KERNEL_COUNT] = {
+    "compute.cso", "compute_wave.cso", "compute_bindless.cso", "compute_batch.cso",
+    "compute_stride.cso", "compute_raw.cso", "verify.cso", "verify_bindless.cso"
+};
+
+static inline uint32_t ReadUInt32(const uint8_t* bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static inline uint32_t RotateLeft(uint32_t value, uint32_t shift)
+{
+    return (value << shift) | (value >> (32 - shift));
+}
+
+// The MD5 compression function over one 64-byte block
+static void MD5Transform(uint32_t state[4], const uint8_t block[64])
+{
+    static const uint32_t sines[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+    };
+    static const uint32_t shifts[4][4] = { { 7, 12, 17, 22 }, { 5, 9, 14, 20 }, { 4, 11, 16, 23 }, { 6, 10, 15, 21 } };
+
+    uint32_t words[16];
+    for (int i = 0; i < 16; ++i) {
+        words[i] = ReadUInt32(block + i * 4);
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        uint32_t f, g;
+        switch (i / 16)
+        {
+        case 0:
+            f = (b & c) | (~b & d);
+            g = i;
+            break;
+
+        case 1:
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+            break;
+
+        case 2:
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+            break;
+
+        default:
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+            break;
+        }
+
+        const uint32_t rotated = RotateLeft(a + f + sines[i] + words[g], shifts[i / 16][i % 4]);
+        a = d;
+        d = c;
+        c = b;
+        b += rotated;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+// The digest of a DXBC container. It is MD5 over the bytes after the digest, except for the last block(s):
+// the bit count is stored in the first word of the final block instead of the last two words,
+// and the last word holds (bit count >> 2) | 1.
+static void ComputeContainerDigest(const uint8_t* data, size_t size, uint32_t digest[4])
+{
+    data += DXBC_DIGEST_END;
+    size -= DXBC_DIGEST_END;
+
+    uint32_t state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+    const size_t leftOver = size % 64;
+    for (size_t offset = 0; offset < size - leftOver; offset += 64) {
+        MD5Transform(state, data + offset);
+    }
+
+    const uint32_t bitCount = (uint32_t)size * 8;
+    const uint32_t lastWord = (bitCount >> 2) | 1;
+    const uint8_t* tail = data + size - leftOver;
+
+    uint8_t block[64] = { 0 };
+    if (leftOver >= 56)
+    {
+        memcpy(block, tail, leftOver);
+        block[leftOver] = 0x80;
+        MD5Transform(state, block);
+
+        memset(block, 0, sizeof(block));
+        memcpy(block, &bitCount, sizeof(bitCount));
+    }
+    else
+    {
+        memcpy(block, &bitCount, sizeof(bitCount));
+        memcpy(block + 4, tail, leftOver);
+        block[4 + leftOver] = 0x80;
+    }
+    memcpy(block + 60, &lastWord, sizeof(lastWord));
+    MD5Transform(state, block);
+
+    memcpy(digest, state, sizeof(state));
+}
+
+ShaderAssetFile* OpenShaderAssetFile(const char* path)
+{
+    ShaderAssetFile* file = calloc(1, sizeof(*file));
+    if (file == NULL) return NULL;
+
+#ifdef _WIN32
+    file->hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER fileSize = { 0 };
+    do
+    {
+        if (file->hFile == INVALID_HANDLE_VALUE) break;
+        if (!GetFileSizeEx(file->hFile, &fileSize) || fileSize.QuadPart <= 0 || (uint64_t)fileSize.QuadPart > SIZE_MAX) break;
+
+        file->hMapping = CreateFileMappingA(file->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (file->hMapping == NULL) break;
+
+        file->data = MapViewOfFile(file->hMapping, FILE_MAP_READ, 0, 0, 0);
+        file->size = (size_t)fileSize.QuadPart;
+    }
+    while (false);
+#else
+    const int fd = open(path, O_RDONLY);
+    struct stat fileStat;
+    if (fd >= 0 && fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        void* data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            file->data = data;
+            file->size = (size_t)fileStat.st_size;
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif // _WIN32
+
+    if (file->data == NULL)
+    {
+        CloseShaderAssetFile(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+void CloseShaderAssetFile(ShaderAssetFile* file)
+{
+    if (file == NULL) return;
+
+#ifdef _WIN32
+    if (file->data != NULL) {
+        UnmapViewOfFile(file->data);
+    }
+    if (file->hMapping != NULL) {
+        CloseHandle(file->hMapping);
+    }
+    if (file->hFile != NULL && file->hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(file->hFile);
+    }
+#else
+    if (file->data != NULL) {
+        munmap((void*)file->data, file->size);
+    }
+#endif // _WIN32
+
+    free(file);
+}
+
+bool ValidateShaderContainer(const void* data, size_t size)
+{
+    const uint8_t* bytes = data;
+    if (bytes == NULL || size < DXBC_CONTAINER_HEADER_SIZE) return false;
+
+    // The container version is 1.0
+    if (ReadUInt32(bytes) != DXBC_CONTAINER_MAGIC || ReadUInt32(bytes + 20) != 1) return false;
+
+    // The container may be followed by padding, but must not be truncated
+    const uint32_t containerSize = ReadUInt32(bytes + 24);
+    const uint32_t partCount = ReadUInt32(bytes + 28);
+    if (containerSize > size || containerSize < DXBC_CONTAINER_HEADER_SIZE) return false;
+    if (partCount > (containerSize - DXBC_CONTAINER_HEADER_SIZE) / sizeof(uint32_t)) return false;
+
+    // Every part is a 4-byte FourCC and a 4-byte size followed by its data
+    const uint32_t partsBegin = DXBC_CONTAINER_HEADER_SIZE + partCount * (uint32_t)sizeof(uint32_t);
+    for (uint32_t i = 0; i < partCount; ++i)
+    {
+        const uint32_t partOffset = ReadUInt32(bytes + DXBC_CONTAINER_HEADER_SIZE + i * sizeof(uint32_t));
+        if (partOffset < partsBegin || partOffset > containerSize - 8) return false;
+        if (ReadUInt32(bytes + partOffset + 4) > containerSize - 8 - partOffset) return false;
+    }
+
+    // An unsigned container, e.g. compiled by DXC without the validator, has an all-zero digest
+    uint32_t storedDigest[4];
+    memcpy(storedDigest, bytes + 4, sizeof(storedDigest));
+    if ((storedDigest[0] | storedDigest[1] | storedDigest[2] | storedDigest[3]) == 0) return true;
+
+    uint32_t digest[4];
+    ComputeContainerDigest(bytes, containerSize, digest);
+    return memcmp(digest, storedDigest, sizeof(digest)) == 0;
+}
+
+bool FindShaderContainerPart(const void* data, size_t size, const char partFourCC[4], const void** ppPartData, size_t* pPartSize)
+{
+    const uint8_t* bytes = data;
+    if (bytes == NULL || size < DXBC_CONTAINER_HEADER_SIZE) return false;
+
+    const uint32_t partCount = ReadUInt32(bytes + 28);
+    for (uint32_t i = 0; i < partCount; ++i)
+    {
+        const uint32_t partOffset = ReadUInt32(bytes + DXBC_CONTAINER_HEADER_SIZE + i * sizeof(uint32_t));
+        if (memcmp(bytes + partOffset, partFourCC, 4) != 0) continue;
+
+        *ppPartData = bytes + partOffset + 8;
+        *pPartSize = ReadUInt32(bytes + partOffset + 4);
+        return true;
+    }
+
+    return false;
+}
+
+bool GetShaderObject(const ShaderAssetFile* file, ShaderBytecode* pBytecode)
+{
+    if (!ValidateShaderContainer(file->data, file->size)) return false;
+
+    pBytecode->data = file->data;
+    pBytecode->size = ReadUInt32(file->data + 24);
+    return true;
+}
+
+bool FindShaderInArchive(const ShaderAssetFile* file, const char* name, ShaderBytecode* pBytecode)
+{
+    ShaderArchiveHeader header;
+    if (file->size < sizeof(header)) return false;
+    memcpy(&header, file->data, sizeof(header));
+
+    if (header.magic != SHADER_ARCHIVE_MAGIC || header.version != SHADER_ARCHIVE_VERSION) return false;
+    if (header.entryCount > SHADER_ARCHIVE_MAX_ENTRY_COUNT || sizeof(header) + header.entryCount * sizeof(ShaderArchiveEntry) > file->size) return false;
+
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        ShaderArchiveEntry entry;
+        memcpy(&entry, file->data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (strncmp(entry.name, name, sizeof(entry.name)) != 0) continue;
+
+        if (entry.offset > file->size || entry.size > file->size - entry.offset) return false;
+        if (!ValidateShaderContainer(file->data + entry.offset, (size_t)entry.size)) return false;
+
+        pBytecode->data = file->data + entry.offset;
+        pBytecode->size = (size_t)entry.size;
+        return true;
+    }
+
+    return false;
+}
+
+const char* GetShaderKernelName(ShaderKernel kernel)
+{
+    return (uint32_t)kernel < SHADER_KERNEL_COUNT ? s_shaderKernelNames[kernel] : "";
+}
+
+bool LoadShaderKernel(const ShaderAssetFile* archive, ShaderKernel kernel, ShaderAssetFile** ppObjectFile, ShaderBytecode* pBytecode)
+{
+    const char* name = GetShaderKernelName(kernel);
+    char path[SHADER_MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), SHADER_DIRECTORY "%s", name);
+
+    CloseShaderAssetFile(*ppObjectFile);
+    *ppObjectFile = OpenShaderAssetFile(path);
+
+    ShaderBytecode packed = { 0 };
+    if (archive != NULL && FindShaderInArchive(archive, name, &packed))
+    {
+        ShaderBytecode loose = { 0 };
+        if (*ppObjectFile == NULL ||
+            (GetShaderObject(*ppObjectFile, &loose) && loose.size == packed.size && memcmp(loose.data, packed.data, packed.size) == 0))
+        {
+            CloseShaderAssetFile(*ppObjectFile);
+            *ppObjectFile = NULL;
+            *pBytecode = packed;
+            return true;
+        }
+
+        printf("WARNING: `%s` differs from its copy in `%s`, which is stale. So `%s` will be loaded!\n", path, SHADER_ARCHIVE_PATH, path);
+    }
+
+    if (*ppObjectFile == NULL)
+    {
+        fprintf(stderr, "Read compiled shader object file: `%s` failed!\n", path);
+        return false;
+    }
+    if (!GetShaderObject(*ppObjectFile, pBytecode))
+    {
+        fprintf(stderr, "Compiled shader object file `%s` is corrupted!\n", path);
+        CloseShaderAssetFile(*ppObjectFile);
+        *ppObjectFile = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+bool PackShaderArchive(const char* archivePath)
+{
+    const uint32_t shaderCount = SHADER_KERNEL_COUNT;
+    ShaderAssetFile* shaderFiles[SHADER_ARCHIVE_MAX_ENTRY_COUNT] = { 0 };
+    ShaderArchiveEntry entries[SHADER_ARCHIVE_MAX_ENTRY_COUNT] = { 0 };
+    FILE* fp = NULL;
+    bool packed = false;
+
+    do
+    {
+        uint64_t offset = sizeof(ShaderArchiveHeader) + shaderCount * sizeof(ShaderArchiveEntry);
+        uint32_t i;
+        for (i = 0; i < shaderCount; ++i)
+        {
+            ShaderBytecode bytecode = { 0 };
+            const char* name = s_shaderKernelNames[i];
+            char path[SHADER_MAX_PATH_LENGTH];
+            snprintf(path, sizeof(path), SHADER_DIRECTORY "%s", name);
+
+            shaderFiles[i] = OpenShaderAssetFile(path);
+            if (shaderFiles[i] == NULL)
+            {
+                fprintf(stderr, "Failed to open `%s`!\n", path);
+                break;
+            }
+            if (!GetShaderObject(shaderFiles[i], &bytecode))
+            {
+                fprintf(stderr, "`%s` is not a valid compiled shader object!\n", path);
+                break;
+            }
+
+            memcpy(entries[i].name, name, strlen(name) + 1);
+            offset = (offset + SHADER_ARCHIVE_ALIGNMENT - 1) & ~(uint64_t)(SHADER_ARCHIVE_ALIGNMENT - 1);
+            entries[i].offset = offset;
+            entries[i].size = bytecode.size;
+            offset += bytecode.size;
+        }
+        if (i < shaderCount) break;
+
+#ifdef _MSC_VER
+        if (fopen_s(&fp, archivePath, "wb") != 0) {
+            fp = NULL;
+        }
+#else
+        fp = fopen(archivePath, "wb");
+#endif // _MSC_VER
+        if (fp == NULL)
+        {
+            fprintf(stderr, "Failed to create the shader archive `%s`!\n", archivePath);
+            break;
+        }
+
+        const ShaderArchiveHeader header = { .magic = SHADER_ARCHIVE_MAGIC, .version = SHADER_ARCHIVE_VERSION, .entryCount = shaderCount };
+        bool written = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(entries, sizeof(entries[0]), shaderCount, fp) == shaderCount;
+
+        uint64_t position = sizeof(header) + shaderCount * sizeof(entries[0]);
+        for (i = 0; i < shaderCount && written; ++i)
+        {
+            static const uint8_t padding[SHADER_ARCHIVE_ALIGNMENT] = { 0 };
+            const size_t paddingSize = (size_t)(entries[i].offset - position);
+            written = fwrite(padding, 1, paddingSize, fp) == paddingSize &&
+                    fwrite(shaderFiles[i]->data, 1, (size_t)entries[i].size, fp) == entries[i].size;
+            position = entries[i].offset + entries[i].size;
+        }
+
+        packed = fclose(fp) == 0 && written;
+        if (!packed) {
+            fprintf(stderr, "Failed to write the shader archive `%s`!\n", archivePath);
+        }
+    }
+    while (false);
+
+    for (uint32_t i = 0; i < shaderCount; ++i) {
+        CloseShaderAssetFile(shaderFiles[i]);
+    }
+
+    return packed;
+}
+
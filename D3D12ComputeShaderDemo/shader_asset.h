@@ -0,0 +1,82 @@
+#ifndef SHADER_ASSET_H
+#define SHADER_ASSET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The max length of a kernel name in a shader archive, including the terminating null character
+    SHADER_ARCHIVE_MAX_NAME_LENGTH = 48,
+
+    // The max number of kernels in a shader archive
+    SHADER_ARCHIVE_MAX_ENTRY_COUNT = 64
+};
+
+// The path of the archive that packs all the compiled kernels of the demo
+#define SHADER_ARCHIVE_PATH     "shaders/kernels.pak"
+
+// The directory of the compiled shader objects of the kernels
+#define SHADER_DIRECTORY        "shaders/"
+
+// The compiled kernels of the demo, all of which are packed into the shader archive
+typedef enum ShaderKernel
+{
+    SHADER_KERNEL_COMPUTE,
+    SHADER_KERNEL_COMPUTE_WAVE,
+    SHADER_KERNEL_COMPUTE_BINDLESS,
+    SHADER_KERNEL_COMPUTE_BATCH,
+    SHADER_KERNEL_COMPUTE_STRIDE,
+    SHADER_KERNEL_COMPUTE_RAW,
+    SHADER_KERNEL_VERIFY,
+    SHADER_KERNEL_VERIFY_BINDLESS,
+
+    SHADER_KERNEL_COUNT
+} ShaderKernel;
+
+// A read-only memory mapping of a shader asset file, either a single compiled shader object (.cso) or a shader archive
+typedef struct ShaderAssetFile ShaderAssetFile;
+
+// The bytes of one shader container. They point into the mapping of their file, and are valid until the file is closed.
+typedef struct ShaderBytecode
+{
+    const void* data;
+    size_t size;
+} ShaderBytecode;
+
+// Map the whole file at `path`. Returns NULL if it cannot be opened or is empty.
+extern ShaderAssetFile* OpenShaderAssetFile(const char* path);
+
+extern void CloseShaderAssetFile(ShaderAssetFile* file);
+
+// Validate the DXBC container (as produced by FXC for DXBC and by DXC for DXIL) of `size` bytes:
+// the header, the bounds of every part and, unless the container is unsigned (an all-zero digest), its MD5-based digest.
+extern bool ValidateShaderContainer(const void* data, size_t size);
+
+// Find the first part of the FourCC `partFourCC` (e.g. "RDEF") in a validated shader container.
+// `pPartSize` receives the size of the part data that `ppPartData` points to.
+extern bool FindShaderContainerPart(const void* data, size_t size, const char partFourCC[4], const void** ppPartData, size_t* pPartSize);
+
+// Get the validated shader container that makes up the whole of a .cso file. Returns false if it is not valid.
+extern bool GetShaderObject(const ShaderAssetFile* file, ShaderBytecode* pBytecode);
+
+// Find the validated shader container called `name`, e.g. "compute.cso", in a shader archive.
+// Returns false if the file is not a valid archive, if it has no such kernel, or if the kernel is not valid.
+extern bool FindShaderInArchive(const ShaderAssetFile* file, const char* name, ShaderBytecode* pBytecode);
+
+// Get the name of a kernel, e.g. "compute.cso", which is both its file name in SHADER_DIRECTORY and its name in the archive
+extern const char* GetShaderKernelName(ShaderKernel kernel);
+
+// Get the validated shader container of `kernel` from the shader archive `archive`, which may be NULL,
+// or else from its compiled shader object, which is mapped into `*ppObjectFile` and replaces the file it held before.
+// An archive entry is ignored if the compiled shader object exists with different bytes, i.e. it has been rebuilt
+// since the archive was packed. `*ppObjectFile` is NULL if the archive entry is used.
+extern bool LoadShaderKernel(const ShaderAssetFile* archive, ShaderKernel kernel, ShaderAssetFile** ppObjectFile, ShaderBytecode* pBytecode);
+
+// Pack the compiled shader objects of all the kernels into a new archive at `archivePath`.
+// Every shader object is validated before it is packed.
+extern bool PackShaderArchive(const char* archivePath);
+
+#endif // SHADER_ASSET_H
+
@@ -0,0 +1,1681 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pipeline_cache.h"
+#include "shader_compiler.h"
+#include "shader_interpreter.h"
+#include "shader_jit.h"
+#include "shader_program.h"
+
+enum
+{
+    // The lanes of a group are padded to a multiple of the widest SIMD register of 32-bit values (AVX-512)
+    LANE_ALIGNMENT = 16,
+
+    // The register files of the scratch memory start at the cache line size
+    SCRATCH_ALIGNMENT = 64,
+
+    // The max source operand count of an arithmetic instruction (bfi)
+    MAX_SOURCE_COUNT = 4
+};
+
+// How a compiled operation is executed
+typedef enum OperationKind
+{
+    OPERATION_NOP,
+    OPERATION_ALU,
+    OPERATION_LOAD,
+    OPERATION_STORE,
+    OPERATION_BUFFER_INFO,
+    OPERATION_ATOMIC,
+    OPERATION_IF,
+    OPERATION_ELSE,
+    OPERATION_ENDIF,
+    OPERATION_LOOP,
+    OPERATION_ENDLOOP,
+    OPERATION_BREAK,
+    OPERATION_CONTINUE,
+    OPERATION_RETURN
+} OperationKind;
+
+// One instruction lowered for the execution of a whole thread group
+typedef struct CompiledOperation
+{
+    const DecodedInstruction* instruction;
+    uint8_t kind;
+
+    // An arithmetic or load operation whose sources hold the same value in all the threads is computed once
+    // and broadcast to the lanes. The control flow of a uniform condition is taken by all the threads together,
+    // without an execution mask.
+    bool isUniform;
+
+    // A destination register is also a source register, so all the results are computed before any of them is written
+    bool isStaged;
+
+    // The components of the sources that the operation reads
+    uint8_t sourceMask;
+
+    // break and continue: the endloop of the innermost loop
+    uint32_t loopEnd;
+
+    // break and continue: the depth of the mask stack with the entry of the innermost loop
+    uint32_t loopDepth;
+} CompiledOperation;
+
+struct CompiledShader
+{
+    // The decoded program that the operations point into
+    ShaderProgram* program;
+
+    // The cache key, and the next shader of the cache
+    uint64_t hash;
+    size_t bytecodeSize;
+    uint32_t referenceCount;
+    CompiledShader* next;
+
+    // The number of lanes of the register arrays, i.e. the thread count padded to LANE_ALIGNMENT
+    uint32_t laneCount;
+
+    CompiledOperation* operations;
+    uint32_t operationCount;
+    uint32_t phaseCount;
+
+    // The max number of divergent blocks that are open at the same time
+    uint32_t maxMaskDepth;
+
+    // SV_GroupThreadID and SV_GroupIndex of each lane
+    uint32_t* threadIDInGroup[3];
+    uint32_t* threadIndexInGroup;
+
+    // The layout of the scratch memory of a thread group
+    size_t tempsOffset;
+    size_t sourcesOffset;
+    size_t resultsOffset;
+    size_t masksOffset;
+    size_t scalarsOffset;
+    size_t scratchSize;
+
+    // The machine code of the shader, or NULL if the processor or an instruction has no translation
+    NativeShader* nativeShader;
+};
+
+// The compiled shaders that have references, by bytecode hash
+static CompiledShader* s_compiledShaders;
+
+// ---- Compilation ----
+
+// The innermost loop visited by the uniformity analysis
+typedef struct LoopAnalysis
+{
+    uint32_t pc;
+
+    // The components that are uniform on all the paths that leave the loop, and on all the paths that continue it
+    uint8_t* breakState;
+    uint8_t* continueState;
+    bool hasBreak;
+} LoopAnalysis;
+
+// The analysis of the temp components that hold the same value in all the threads of the group.
+// Its state has one entry per temp component, 1 for uniform, and flows along the structured control flow.
+typedef struct UniformityAnalysis
+{
+    const ShaderProgram* program;
+    CompiledOperation* operations;
+    size_t stateSize;
+
+    // The loops whose threads can leave them or continue them in different iterations
+    bool* isDivergentLoop;
+    bool hasChanged;
+
+    uint32_t loopCount;
+    LoopAnalysis loops[MAX_CONTROL_FLOW_DEPTH];
+} UniformityAnalysis;
+
+static bool IsOperandUniform(const uint8_t* state, const DecodedOperand* operand, uint32_t componentMask)
+{
+    switch (operand->type)
+    {
+    case OPERAND_TEMP:
+        for (uint32_t c = 0; c < 4; ++c) {
+            if ((componentMask & (1U << c)) != 0 && state[operand->registerIndex * 4 + operand->swizzle[c]] == 0) return false;
+        }
+        return true;
+
+    case OPERAND_CONSTANT_BUFFER:
+    case OPERAND_IMMEDIATE_CONSTANT_BUFFER:
+        return !operand->hasRelativeIndex || state[operand->relativeRegister * 4 + operand->relativeComponent] != 0;
+
+    case OPERAND_THREAD_ID:
+    case OPERAND_THREAD_ID_IN_GROUP:
+    case OPERAND_THREAD_ID_IN_GROUP_FLATTENED:
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+static void SetDestinationUniformity(uint8_t* state, const DecodedOperand* operand, bool isUniform)
+{
+    if (operand->type != OPERAND_TEMP) return;
+
+    for (uint32_t c = 0; c < 4; ++c) {
+        if ((operand->mask & (1U << c)) != 0) {
+            state[operand->registerIndex * 4 + c] = isUniform ? 1 : 0;
+        }
+    }
+}
+
+static void IntersectUniformity(uint8_t* state, const uint8_t* other, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        state[i] &= other[i];
+    }
+}
+
+// Whether the sources of a non-control-flow operation are uniform
+static bool AreSourcesUniform(const uint8_t* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const OpcodeInfo* info = &instruction->info;
+    switch (operation->kind)
+    {
+    case OPERATION_ALU:
+        for (uint32_t i = info->dstCount; i < instruction->operandCount; ++i) {
+            if (!IsOperandUniform(state, &instruction->operands[i], operation->sourceMask)) return false;
+        }
+        return true;
+
+    case OPERATION_LOAD:
+        // The address, and the byte offset of a structured buffer
+        for (uint32_t i = 1; i + 1 < instruction->operandCount; ++i) {
+            if (!IsOperandUniform(state, &instruction->operands[i], 0x1)) return false;
+        }
+        return true;
+
+    case OPERATION_BUFFER_INFO:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static bool AnalyzeBlock(UniformityAnalysis* analysis, uint32_t begin, uint32_t end, bool isUniformContext, uint8_t* state);
+
+static bool AnalyzeIf(UniformityAnalysis* analysis, uint32_t pc, bool isUniformContext, uint8_t* state)
+{
+    const DecodedInstruction* instruction = &analysis->program->instructions[pc];
+    const bool isUniform = isUniformContext && IsOperandUniform(state, &instruction->operands[0], 0x1);
+    analysis->operations[pc].isUniform = isUniform;
+    analysis->operations[instruction->jumpTarget].isUniform = isUniform;
+    analysis->operations[instruction->endTarget].isUniform = isUniform;
+
+    // The components are uniform after the block if they are on both paths
+    uint8_t* branchState = malloc(analysis->stateSize);
+    if (branchState == NULL) return false;
+
+    bool succeeded = false;
+    do
+    {
+        memcpy(branchState, state, analysis->stateSize);
+        if (!AnalyzeBlock(analysis, pc + 1, instruction->jumpTarget, isUniform, branchState)) break;
+        if (instruction->jumpTarget != instruction->endTarget)
+        {
+            if (!AnalyzeBlock(analysis, instruction->jumpTarget + 1, instruction->endTarget, isUniform, state)) break;
+        }
+        IntersectUniformity(state, branchState, analysis->stateSize);
+
+        succeeded = true;
+    }
+    while (false);
+
+    free(branchState);
+    return succeeded;
+}
+
+static bool AnalyzeLoop(UniformityAnalysis* analysis, uint32_t pc, bool isUniformContext, uint8_t* state)
+{
+    const DecodedInstruction* instruction = &analysis->program->instructions[pc];
+    const bool isUniform = isUniformContext && !analysis->isDivergentLoop[pc];
+    analysis->operations[pc].isUniform = isUniform;
+    analysis->operations[instruction->jumpTarget].isUniform = isUniform;
+
+    LoopAnalysis* loop = &analysis->loops[analysis->loopCount++];
+    uint8_t* bodyState = malloc(analysis->stateSize);
+    loop->breakState = malloc(analysis->stateSize);
+    loop->continueState = malloc(analysis->stateSize);
+    loop->pc = pc;
+
+    bool succeeded = false;
+    do
+    {
+        if (bodyState == NULL || loop->breakState == NULL || loop->continueState == NULL) break;
+
+        // The state at the start of the body is iterated until the back edges do not change it
+        for (;;)
+        {
+            memset(loop->breakState, 1, analysis->stateSize);
+            memset(loop->continueState, 1, analysis->stateSize);
+            loop->hasBreak = false;
+
+            memcpy(bodyState, state, analysis->stateSize);
+            if (!AnalyzeBlock(analysis, pc + 1, instruction->jumpTarget, isUniform, bodyState)) break;
+
+            IntersectUniformity(bodyState, loop->continueState, analysis->stateSize);
+            IntersectUniformity(bodyState, state, analysis->stateSize);
+            if (memcmp(bodyState, state, analysis->stateSize) == 0)
+            {
+                succeeded = true;
+                break;
+            }
+            memcpy(state, bodyState, analysis->stateSize);
+        }
+
+        // The loop is left by the breaks, or not at all when it only returns
+        if (succeeded && loop->hasBreak) {
+            memcpy(state, loop->breakState, analysis->stateSize);
+        }
+    }
+    while (false);
+
+    free(bodyState);
+    free(loop->breakState);
+    free(loop->continueState);
+    --analysis->loopCount;
+    return succeeded;
+}
+
+// Analyze the instructions [begin, end) of a structured block, executed by all the threads of the group if `isUniformContext` is true
+static bool AnalyzeBlock(UniformityAnalysis* analysis, uint32_t begin, uint32_t end, bool isUniformContext, uint8_t* state)
+{
+    for (uint32_t pc = begin; pc < end; ++pc)
+    {
+        CompiledOperation* operation = &analysis->operations[pc];
+        const DecodedInstruction* instruction = operation->instruction;
+        switch (operation->kind)
+        {
+        case OPERATION_IF:
+            if (!AnalyzeIf(analysis, pc, isUniformContext, state)) return false;
+            pc = instruction->endTarget;
+            break;
+
+        case OPERATION_LOOP:
+            if (!AnalyzeLoop(analysis, pc, isUniformContext, state)) return false;
+            pc = instruction->jumpTarget;
+            break;
+
+        case OPERATION_BREAK:
+        case OPERATION_CONTINUE:
+        {
+            // A loop that the threads leave at different times executes its body with an execution mask
+            LoopAnalysis* loop = &analysis->loops[analysis->loopCount - 1];
+            operation->isUniform = isUniformContext && (instruction->info.srcCount == 0 || IsOperandUniform(state, &instruction->operands[0], 0x1));
+            if (!operation->isUniform && !analysis->isDivergentLoop[loop->pc])
+            {
+                analysis->isDivergentLoop[loop->pc] = true;
+                analysis->hasChanged = true;
+            }
+
+            if (operation->kind == OPERATION_BREAK)
+            {
+                IntersectUniformity(loop->breakState, state, analysis->stateSize);
+                loop->hasBreak = true;
+            }
+            else {
+                IntersectUniformity(loop->continueState, state, analysis->stateSize);
+            }
+            break;
+        }
+
+        case OPERATION_RETURN:
+            // The threads that return early leave the others uniform
+            operation->isUniform = isUniformContext && (instruction->info.srcCount == 0 || IsOperandUniform(state, &instruction->operands[0], 0x1));
+            break;
+
+        case OPERATION_ALU:
+        case OPERATION_LOAD:
+        case OPERATION_STORE:
+        case OPERATION_BUFFER_INFO:
+        case OPERATION_ATOMIC:
+            operation->isUniform = isUniformContext && AreSourcesUniform(state, operation);
+            for (uint32_t i = 0; i < instruction->info.dstCount; ++i) {
+                SetDestinationUniformity(state, &instruction->operands[i], operation->isUniform);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+// Whether a destination register of an instruction is also read by a source
+static bool HasRegisterHazard(const DecodedInstruction* instruction, uint32_t firstSource)
+{
+    const OpcodeInfo* info = &instruction->info;
+    for (uint32_t d = 0; d < info->dstCount; ++d)
+    {
+        const DecodedOperand* destination = &instruction->operands[d];
+        if (destination->type != OPERAND_TEMP) continue;
+
+        for (uint32_t i = firstSource; i < instruction->operandCount; ++i)
+        {
+            const DecodedOperand* source = &instruction->operands[i];
+            if (source->type == OPERAND_TEMP && source->registerIndex == destination->registerIndex) return true;
+            if (source->hasRelativeIndex && source->relativeRegister == destination->registerIndex) return true;
+        }
+    }
+    return false;
+}
+
+// Lower the decoded instructions into operations
+static bool LowerInstructions(CompiledShader* shader)
+{
+    const ShaderProgram* program = shader->program;
+    for (uint32_t pc = 0; pc < program->instructionCount; ++pc)
+    {
+        const DecodedInstruction* instruction = &program->instructions[pc];
+        const OpcodeInfo* info = &instruction->info;
+        CompiledOperation* operation = &shader->operations[pc];
+        *operation = (CompiledOperation){ .instruction = instruction };
+
+        switch (instruction->opcode)
+        {
+        case OP_IF:         operation->kind = OPERATION_IF; break;
+        case OP_ELSE:       operation->kind = OPERATION_ELSE; break;
+        case OP_ENDIF:      operation->kind = OPERATION_ENDIF; break;
+        case OP_LOOP:       operation->kind = OPERATION_LOOP; break;
+        case OP_ENDLOOP:    operation->kind = OPERATION_ENDLOOP; break;
+        case OP_BREAK:
+        case OP_BREAKC:     operation->kind = OPERATION_BREAK; break;
+        case OP_CONTINUE:
+        case OP_CONTINUEC:  operation->kind = OPERATION_CONTINUE; break;
+        case OP_RET:
+        case OP_RETC:       operation->kind = OPERATION_RETURN; break;
+        case OP_LD_RAW:
+        case OP_LD_STRUCTURED:
+            operation->kind = OPERATION_LOAD;
+            operation->isStaged = HasRegisterHazard(instruction, 1);
+            break;
+        case OP_STORE_RAW:
+        case OP_STORE_STRUCTURED:
+            operation->kind = OPERATION_STORE;
+            break;
+        case OP_BUFINFO:
+            operation->kind = OPERATION_BUFFER_INFO;
+            break;
+
+        case OP_SYNC:
+            // The threads of the group execute each operation together, so a group barrier is only the end of a phase
+            if (instruction->syncFlags & SYNC_THREADS_IN_GROUP) {
+                ++shader->phaseCount;
+            }
+            break;
+
+        default:
+            if (info->opcodeClass == OPCODE_MEMORY)
+            {
+                operation->kind = OPERATION_ATOMIC;
+                operation->isStaged = HasRegisterHazard(instruction, info->dstCount);
+            }
+            else if (info->opcodeClass == OPCODE_INT || info->opcodeClass == OPCODE_FLOAT)
+            {
+                operation->kind = OPERATION_ALU;
+
+                // The dot products read the components of their width regardless of the destination mask
+                for (uint32_t i = 0; i < info->dstCount; ++i) {
+                    operation->sourceMask |= instruction->operands[i].mask;
+                }
+                if (instruction->opcode == OP_DP2) operation->sourceMask = 0x3;
+                if (instruction->opcode == OP_DP3) operation->sourceMask = 0x7;
+                if (instruction->opcode == OP_DP4) operation->sourceMask = 0xf;
+
+                // A single component written and read by the same lane is safe, since each lane reads its sources before it writes
+                const uint32_t destinationMask = instruction->operands[0].mask;
+                const bool isSingleComponent = info->dstCount == 1 && (destinationMask & (destinationMask - 1)) == 0;
+                operation->isStaged = !isSingleComponent && HasRegisterHazard(instruction, info->dstCount);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+// Find the innermost loop of each break and continue, and the depth of the mask stack at each divergent block
+static void LinkOperations(CompiledShader* shader)
+{
+    typedef struct OpenBlock
+    {
+        uint32_t pc;
+        uint32_t maskDepth;
+    } OpenBlock;
+
+    OpenBlock openBlocks[MAX_CONTROL_FLOW_DEPTH];
+    uint32_t depth = 0, maskDepth = 0;
+    for (uint32_t pc = 0; pc < shader->operationCount; ++pc)
+    {
+        CompiledOperation* operation = &shader->operations[pc];
+        switch (operation->kind)
+        {
+        case OPERATION_IF:
+        case OPERATION_LOOP:
+            maskDepth += operation->isUniform ? 0 : 1;
+            openBlocks[depth++] = (OpenBlock){ .pc = pc, .maskDepth = maskDepth };
+            if (maskDepth > shader->maxMaskDepth) {
+                shader->maxMaskDepth = maskDepth;
+            }
+            break;
+
+        case OPERATION_ENDIF:
+        case OPERATION_ENDLOOP:
+            --depth;
+            maskDepth -= operation->isUniform ? 0 : 1;
+            break;
+
+        case OPERATION_BREAK:
+        case OPERATION_CONTINUE:
+        {
+            uint32_t loop = depth;
+            while (shader->operations[openBlocks[loop - 1].pc].kind != OPERATION_LOOP) {
+                --loop;
+            }
+            operation->loopEnd = shader->program->instructions[openBlocks[loop - 1].pc].jumpTarget;
+            operation->loopDepth = openBlocks[loop - 1].maskDepth;
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
+static void DestroyCompiledShader(CompiledShader* shader)
+{
+    if (shader == NULL) return;
+
+    DestroyNativeShader(shader->nativeShader);
+    DestroyShaderProgram(shader->program);
+    free(shader->operations);
+    for (uint32_t i = 0; i < 3; ++i) {
+        free(shader->threadIDInGroup[i]);
+    }
+    free(shader->threadIndexInGroup);
+    free(shader);
+}
+
+static CompiledShader* CompileShader(const void* data, size_t size)
+{
+    CompiledShader* shader = calloc(1, sizeof(*shader));
+    UniformityAnalysis analysis = { 0 };
+    uint8_t* state = NULL;
+    bool succeeded = false;
+    do
+    {
+        if (shader == NULL) break;
+
+        // The lane count of the interpreter is not used
+        shader->program = CreateShaderProgram(data, size, SHADER_INTERPRETER_MIN_LANE_COUNT);
+        if (shader->program == NULL) break;
+
+        const ShaderProgram* program = shader->program;
+        shader->operationCount = program->instructionCount;
+        shader->operations = calloc(program->instructionCount + 1, sizeof(*shader->operations));
+        if (shader->operations == NULL) break;
+
+        shader->phaseCount = 1;
+        if (!LowerInstructions(shader)) break;
+
+        // The uniformity is analyzed again whenever a loop turns out to be divergent, which makes more components non-uniform
+        analysis = (UniformityAnalysis){
+            .program = program,
+            .operations = shader->operations,
+            .stateSize = (size_t)program->tempCount * 4 + 1
+        };
+        analysis.isDivergentLoop = calloc(program->instructionCount + 1, sizeof(bool));
+        state = malloc(analysis.stateSize);
+        if (analysis.isDivergentLoop == NULL || state == NULL) break;
+
+        bool isAnalyzed = true;
+        do
+        {
+            analysis.hasChanged = false;
+            memset(state, 0, analysis.stateSize);
+            isAnalyzed = AnalyzeBlock(&analysis, 0, program->instructionCount, true, state);
+        }
+        while (isAnalyzed && analysis.hasChanged);
+        if (!isAnalyzed) break;
+
+        LinkOperations(shader);
+
+        // The system values of each lane, in SV_GroupIndex order
+        shader->laneCount = (program->threadCount + LANE_ALIGNMENT - 1) & ~(uint32_t)(LANE_ALIGNMENT - 1);
+        const size_t laneBytes = (size_t)shader->laneCount * sizeof(uint32_t);
+        bool isAllocated = true;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            shader->threadIDInGroup[i] = calloc(1, laneBytes);
+            isAllocated &= shader->threadIDInGroup[i] != NULL;
+        }
+        shader->threadIndexInGroup = calloc(1, laneBytes);
+        if (!isAllocated || shader->threadIndexInGroup == NULL) break;
+
+        for (uint32_t thread = 0; thread < program->threadCount; ++thread)
+        {
+            shader->threadIndexInGroup[thread] = thread;
+            shader->threadIDInGroup[0][thread] = thread % program->threadGroupSize[0];
+            shader->threadIDInGroup[1][thread] = (thread / program->threadGroupSize[0]) % program->threadGroupSize[1];
+            shader->threadIDInGroup[2][thread] = thread / (program->threadGroupSize[0] * program->threadGroupSize[1]);
+        }
+
+        // The group-shared memory, the temp registers, the staged sources and results, the lane masks
+        // (active, returned, break, continue, and 3 per level of the mask stack), then the uniform values of the temp components
+        const size_t alignment = SCRATCH_ALIGNMENT;
+        const size_t componentCount = (size_t)program->tempCount * 4;
+        shader->tempsOffset = ((size_t)program->groupSharedBytes + alignment - 1) & ~(alignment - 1);
+        shader->sourcesOffset = shader->tempsOffset + componentCount * laneBytes;
+        shader->resultsOffset = shader->sourcesOffset + MAX_SOURCE_COUNT * 4 * laneBytes;
+        shader->masksOffset = shader->resultsOffset + 2 * 4 * laneBytes;
+        shader->scalarsOffset = shader->masksOffset + (4 + 3 * (size_t)shader->maxMaskDepth) * shader->laneCount;
+        shader->scratchSize = shader->scalarsOffset + componentCount * (sizeof(uint32_t) + 1);
+
+        // The lane loops remain for the groups that the machine code cannot execute, so the scratch memory fits both
+        shader->nativeShader = CreateNativeShader(program, shader->laneCount);
+        if (shader->nativeShader != NULL && GetNativeShaderScratchSize(shader->nativeShader) > shader->scratchSize) {
+            shader->scratchSize = GetNativeShaderScratchSize(shader->nativeShader);
+        }
+
+        shader->hash = HashPipelineCacheBytes(data, size);
+        shader->bytecodeSize = size;
+        succeeded = true;
+    }
+    while (false);
+
+    free(state);
+    free(analysis.isDivergentLoop);
+    if (!succeeded)
+    {
+        DestroyCompiledShader(shader);
+        return NULL;
+    }
+
+    return shader;
+}
+
+CompiledShader* AcquireCompiledShader(const void* data, size_t size)
+{
+    const uint64_t hash = HashPipelineCacheBytes(data, size);
+    for (CompiledShader* shader = s_compiledShaders; shader != NULL; shader = shader->next)
+    {
+        if (shader->hash == hash && shader->bytecodeSize == size)
+        {
+            ++shader->referenceCount;
+            return shader;
+        }
+    }
+
+    CompiledShader* shader = CompileShader(data, size);
+    if (shader == NULL) return NULL;
+
+    shader->referenceCount = 1;
+    shader->next = s_compiledShaders;
+    s_compiledShaders = shader;
+    return shader;
+}
+
+void ReleaseCompiledShader(CompiledShader* shader)
+{
+    if (shader == NULL || --shader->referenceCount > 0) return;
+
+    for (CompiledShader** link = &s_compiledShaders; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == shader)
+        {
+            *link = shader->next;
+            break;
+        }
+    }
+    DestroyCompiledShader(shader);
+}
+
+void GetCompiledShaderThreadGroupSize(const CompiledShader* shader, uint32_t threadGroupSize[3])
+{
+    GetShaderProgramThreadGroupSize(shader->program, threadGroupSize);
+}
+
+uint32_t GetCompiledShaderPhaseCount(const CompiledShader* shader)
+{
+    return shader->phaseCount;
+}
+
+size_t GetCompiledShaderScratchSize(const CompiledShader* shader)
+{
+    return shader->scratchSize;
+}
+
+const char* GetCompiledShaderTargetName(const CompiledShader* shader)
+{
+    return shader->nativeShader != NULL ? "x86-64 AVX2 machine code" : "C lane loops";
+}
+
+// ---- Execution ----
+
+// A divergent block: the lanes that entered it, and the masks saved for its end
+typedef struct MaskEntry
+{
+    uint8_t* outerLanes;
+
+    // if: the lanes that take the else branch, loop: the break lanes of the enclosing loop
+    uint8_t* otherLanes;
+
+    // loop: the continue lanes of the enclosing loop
+    uint8_t* savedContinueLanes;
+
+    // The range of the lanes that entered the block, and whether they are all the lanes of the range
+    uint32_t begin;
+    uint32_t end;
+    bool isDense;
+} MaskEntry;
+
+// The state of a thread group. The registers are laid out as [tempCount][4 components][laneCount],
+// and the lane masks hold 1 for the lanes that are set.
+typedef struct GroupState
+{
+    const CompiledShader* shader;
+    const ShaderBindings* bindings;
+    uint32_t groupID[3];
+    uint8_t* groupShared;
+    uint32_t* temps;
+    uint32_t* sourceLanes;
+    uint32_t* resultLanes;
+
+    uint8_t* activeLanes;
+    uint8_t* retiredLanes;
+    uint8_t* breakLanes;
+    uint8_t* continueLanes;
+    uint32_t retiredCount;
+
+    // Whether a lane has returned, or has left or continued a loop, so that it is not restored with the lanes of a block
+    bool hasStoppedLanes;
+
+    // The temp components written by a uniform operation hold their value in `scalarValues` instead of their lanes,
+    // until a divergent operation writes them
+    uint32_t* scalarValues;
+    uint8_t* isScalar;
+
+    // The active lanes are all in [begin, end), and `isDense` is true if all the lanes of the range are active
+    uint32_t begin;
+    uint32_t end;
+    bool isDense;
+
+    uint32_t maskDepth;
+    MaskEntry maskStack[MAX_CONTROL_FLOW_DEPTH];
+} GroupState;
+
+static inline uint32_t* GetTempLanes(const GroupState* state, uint32_t registerIndex, uint32_t component)
+{
+    return state->temps + ((size_t)registerIndex * 4 + component) * state->shader->laneCount;
+}
+
+static inline uint32_t* GetStagingLanes(uint32_t* lanes, const GroupState* state, uint32_t index, uint32_t component)
+{
+    return lanes + ((size_t)index * 4 + component) * state->shader->laneCount;
+}
+
+static void FillLanes(uint32_t* lanes, uint32_t begin, uint32_t end, uint32_t value)
+{
+    for (uint32_t l = begin; l < end; ++l) {
+        lanes[l] = value;
+    }
+}
+
+// Get the lanes of a temp component that a source reads. The value of a uniform component is broadcast to `staging`.
+static const uint32_t* ReadTempLanes(const GroupState* state, uint32_t registerIndex, uint32_t component, uint32_t* staging)
+{
+    const size_t index = (size_t)registerIndex * 4 + component;
+    if (state->isScalar[index] == 0) return GetTempLanes(state, registerIndex, component);
+
+    FillLanes(staging, state->begin, state->end, state->scalarValues[index]);
+    return staging;
+}
+
+static inline uint32_t ReadTempValue(const GroupState* state, uint32_t registerIndex, uint32_t component, uint32_t lane)
+{
+    const size_t index = (size_t)registerIndex * 4 + component;
+    return state->isScalar[index] != 0 ? state->scalarValues[index] : GetTempLanes(state, registerIndex, component)[lane];
+}
+
+// Get the lanes of a temp component that the active lanes write. The value of a uniform component is broadcast first
+// to the lanes that keep it, i.e. unless all the threads of the group are written.
+static uint32_t* WriteTempLanes(const GroupState* state, uint32_t registerIndex, uint32_t component)
+{
+    const size_t index = (size_t)registerIndex * 4 + component;
+    uint32_t* lanes = GetTempLanes(state, registerIndex, component);
+    if (state->isScalar[index] != 0)
+    {
+        const uint32_t threadCount = state->shader->program->threadCount;
+        if (!state->isDense || state->begin != 0 || state->end != threadCount) {
+            FillLanes(lanes, 0, threadCount, state->scalarValues[index]);
+        }
+        state->isScalar[index] = 0;
+    }
+    return lanes;
+}
+
+// Find the range of the `count` active lanes in [begin, end), where all the lanes outside it are inactive
+static void FindActiveRange(GroupState* state, uint32_t begin, uint32_t end, uint32_t count)
+{
+    if (count == 0)
+    {
+        state->begin = state->end = begin;
+        state->isDense = true;
+        return;
+    }
+
+    // The inactive lanes at both ends are skipped 8 at a time
+    const uint8_t* active = state->activeLanes;
+    uint64_t lanes = 0;
+    while (end - begin >= sizeof(lanes) && (memcpy(&lanes, active + begin, sizeof(lanes)), lanes == 0)) {
+        begin += sizeof(lanes);
+    }
+    while (begin < end && active[begin] == 0) {
+        ++begin;
+    }
+    while (end - begin >= sizeof(lanes) && (memcpy(&lanes, active + end - sizeof(lanes), sizeof(lanes)), lanes == 0)) {
+        end -= sizeof(lanes);
+    }
+    while (end > begin && active[end - 1] == 0) {
+        --end;
+    }
+
+    state->begin = begin;
+    state->end = end;
+    state->isDense = count == end - begin;
+}
+
+// Find the range of the active lanes in [begin, end)
+static void UpdateActiveRange(GroupState* state, uint32_t begin, uint32_t end)
+{
+    const uint8_t* active = state->activeLanes;
+    uint32_t count = 0;
+    for (uint32_t l = begin; l < end; ++l) {
+        count += active[l];
+    }
+    FindActiveRange(state, begin, end, count);
+}
+
+// Write `values` to the active lanes of `target`
+static void WriteLanes(const GroupState* state, uint32_t* target, const uint32_t* values)
+{
+    if (target == values) return;
+
+    if (state->isDense)
+    {
+        memcpy(target + state->begin, values + state->begin, (state->end - state->begin) * sizeof(uint32_t));
+        return;
+    }
+
+    const uint8_t* active = state->activeLanes;
+    const uint32_t begin = state->begin, end = state->end;
+    for (uint32_t l = begin; l < end; ++l)
+    {
+        const uint32_t select = 0U - active[l];
+        target[l] = (values[l] & select) | (target[l] & ~select);
+    }
+}
+
+// Get the lanes of the component `component` of a source operand, after the swizzle and the modifier.
+// The values that are not in a register are built in `staging`.
+static const uint32_t* GetSourceLanes(const GroupState* state, const DecodedOperand* operand, uint32_t component, bool isFloat,
+                                    uint32_t* staging)
+{
+    const CompiledShader* shader = state->shader;
+    const ShaderProgram* program = shader->program;
+    const uint32_t begin = state->begin, end = state->end;
+    const uint32_t registerComponent = operand->swizzle[component];
+
+    const uint32_t* lanes = staging;
+    switch (operand->type)
+    {
+    case OPERAND_TEMP:
+        lanes = ReadTempLanes(state, operand->registerIndex, registerComponent, staging);
+        break;
+
+    case OPERAND_IMMEDIATE32:
+        FillLanes(staging, begin, end, operand->immediate[component]);
+        break;
+
+    case OPERAND_CONSTANT_BUFFER:
+    case OPERAND_IMMEDIATE_CONSTANT_BUFFER:
+    {
+        const ShaderBufferBinding* binding = &state->bindings->constantBuffers[operand->registerIndex];
+        const uint8_t* data = operand->type == OPERAND_CONSTANT_BUFFER ? binding->data : (const uint8_t*)program->immediateConstants;
+        const size_t size = operand->type == OPERAND_CONSTANT_BUFFER ? binding->size : (size_t)program->immediateConstantCount * sizeof(uint32_t);
+        const size_t relativeIndex = (size_t)operand->relativeRegister * 4 + operand->relativeComponent;
+        if (!operand->hasRelativeIndex || state->isScalar[relativeIndex] != 0)
+        {
+            const uint64_t element = (uint64_t)operand->elementIndex + (operand->hasRelativeIndex ? state->scalarValues[relativeIndex] : 0);
+            FillLanes(staging, begin, end, ReadShaderConstant(data, size, element, registerComponent));
+            break;
+        }
+
+        const uint32_t* offsets = GetTempLanes(state, operand->relativeRegister, operand->relativeComponent);
+        for (uint32_t l = begin; l < end; ++l) {
+            staging[l] = ReadShaderConstant(data, size, (uint64_t)operand->elementIndex + offsets[l], registerComponent);
+        }
+        break;
+    }
+
+    case OPERAND_THREAD_ID:
+        if (registerComponent < 3)
+        {
+            const uint32_t base = state->groupID[registerComponent] * program->threadGroupSize[registerComponent];
+            const uint32_t* threadIDs = shader->threadIDInGroup[registerComponent];
+            for (uint32_t l = begin; l < end; ++l) {
+                staging[l] = base + threadIDs[l];
+            }
+        }
+        else {
+            FillLanes(staging, begin, end, 0);
+        }
+        break;
+
+    case OPERAND_THREAD_GROUP_ID:
+        FillLanes(staging, begin, end, registerComponent < 3 ? state->groupID[registerComponent] : 0);
+        break;
+
+    case OPERAND_THREAD_ID_IN_GROUP:
+        if (registerComponent < 3) {
+            lanes = shader->threadIDInGroup[registerComponent];
+        }
+        else {
+            FillLanes(staging, begin, end, 0);
+        }
+        break;
+
+    case OPERAND_THREAD_ID_IN_GROUP_FLATTENED:
+        lanes = shader->threadIndexInGroup;
+        break;
+
+    default:
+        FillLanes(staging, begin, end, 0);
+        break;
+    }
+
+    if (operand->modifier == 0) return lanes;
+
+    // A float operation flips the sign bit, and an integer operation negates the two's complement value
+    const uint32_t absMask = (operand->modifier & OPERAND_MODIFIER_ABS) ? 0x7fffffffU : UINT32_MAX;
+    if ((operand->modifier & OPERAND_MODIFIER_NEG) == 0) {
+        for (uint32_t l = begin; l < end; ++l) {
+            staging[l] = lanes[l] & absMask;
+        }
+    }
+    else if (isFloat) {
+        for (uint32_t l = begin; l < end; ++l) {
+            staging[l] = (lanes[l] & absMask) ^ 0x80000000U;
+        }
+    }
+    else {
+        for (uint32_t l = begin; l < end; ++l) {
+            staging[l] = 0U - (lanes[l] & absMask);
+        }
+    }
+    return staging;
+}
+
+// Get the component `component` of a uniform source operand from the first active lane
+static uint32_t GetSourceValue(const GroupState* state, const DecodedOperand* operand, uint32_t component, bool isFloat)
+{
+    const ShaderProgram* program = state->shader->program;
+    const uint32_t lane = state->begin;
+    const uint32_t registerComponent = operand->swizzle[component];
+
+    uint32_t value = 0;
+    switch (operand->type)
+    {
+    case OPERAND_TEMP:
+        value = ReadTempValue(state, operand->registerIndex, registerComponent, lane);
+        break;
+
+    case OPERAND_IMMEDIATE32:
+        value = operand->immediate[component];
+        break;
+
+    case OPERAND_CONSTANT_BUFFER:
+    case OPERAND_IMMEDIATE_CONSTANT_BUFFER:
+    {
+        const ShaderBufferBinding* binding = &state->bindings->constantBuffers[operand->registerIndex];
+        const uint8_t* data = operand->type == OPERAND_CONSTANT_BUFFER ? binding->data : (const uint8_t*)program->immediateConstants;
+        const size_t size = operand->type == OPERAND_CONSTANT_BUFFER ? binding->size : (size_t)program->immediateConstantCount * sizeof(uint32_t);
+        const uint64_t element = (uint64_t)operand->elementIndex +
+                                (operand->hasRelativeIndex ? ReadTempValue(state, operand->relativeRegister, operand->relativeComponent, lane) : 0);
+        value = ReadShaderConstant(data, size, element, registerComponent);
+        break;
+    }
+
+    case OPERAND_THREAD_GROUP_ID:
+        value = registerComponent < 3 ? state->groupID[registerComponent] : 0;
+        break;
+
+    default:
+        break;
+    }
+
+    if (operand->modifier & OPERAND_MODIFIER_ABS) {
+        value &= 0x7fffffffU;
+    }
+    if (operand->modifier & OPERAND_MODIFIER_NEG) {
+        value = isFloat ? value ^ 0x80000000U : 0U - value;
+    }
+    return value;
+}
+
+// The lanes of the results of the destination `index`: the register itself when all the lanes of the range are written
+// with no other component to compute first, or else the staged results. The component of a destination that does not write it,
+// e.g. of the second destination of udiv, is also staged.
+static uint32_t* GetResultLanes(const GroupState* state, const CompiledOperation* operation, uint32_t index, uint32_t component)
+{
+    const DecodedOperand* operand = &operation->instruction->operands[index];
+    if (state->isDense && !operation->isStaged && operand->type == OPERAND_TEMP && (operand->mask & (1U << component)) != 0) {
+        return WriteTempLanes(state, operand->registerIndex, component);
+    }
+    return GetStagingLanes(state->resultLanes, state, index, component);
+}
+
+// Write the results of the destination `index` to the active lanes, or broadcast them if the operation is uniform
+static void WriteResults(const GroupState* state, const CompiledOperation* operation, uint32_t index, bool saturate,
+                        uint32_t* const results[4])
+{
+    const DecodedOperand* operand = &operation->instruction->operands[index];
+    if (operand->type != OPERAND_TEMP) return;
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((operand->mask & (1U << c)) == 0) continue;
+
+        if (saturate) {
+            SaturateShaderLanes(results[c], state->begin, state->end);
+        }
+        WriteLanes(state, WriteTempLanes(state, operand->registerIndex, c), results[c]);
+    }
+}
+
+// Write the results of a uniform operation
+static void BroadcastResults(const GroupState* state, const DecodedOperand* operand, const uint32_t values[4])
+{
+    if (operand->type != OPERAND_TEMP) return;
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((operand->mask & (1U << c)) == 0) continue;
+
+        const size_t index = (size_t)operand->registerIndex * 4 + c;
+        state->scalarValues[index] = values[c];
+        state->isScalar[index] = 1;
+    }
+}
+
+// Compute a uniform arithmetic operation once, for the first active lane
+static void ExecuteUniformALU(const GroupState* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const OpcodeInfo* info = &instruction->info;
+    const bool isFloat = info->opcodeClass == OPCODE_FLOAT;
+
+    uint32_t sources[MAX_SOURCE_COUNT][4] = { { 0 } };
+    for (uint32_t i = 0; i < info->srcCount; ++i) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            if ((operation->sourceMask & (1U << c)) != 0) {
+                sources[i][c] = GetSourceValue(state, &instruction->operands[info->dstCount + i], c, isFloat);
+            }
+        }
+    }
+
+    uint32_t results[2][4] = { { 0 } };
+    if (instruction->opcode == OP_DP2 || instruction->opcode == OP_DP3 || instruction->opcode == OP_DP4)
+    {
+        const uint32_t* const a[4] = { &sources[0][0], &sources[0][1], &sources[0][2], &sources[0][3] };
+        const uint32_t* const b[4] = { &sources[1][0], &sources[1][1], &sources[1][2], &sources[1][3] };
+        ComputeShaderDotProductLanes(instruction->opcode - OP_DP2 + 2, 0, 1, a, b, &results[0][0]);
+        results[0][1] = results[0][2] = results[0][3] = results[0][0];
+    }
+    else
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if ((operation->sourceMask & (1U << c)) == 0) continue;
+
+            const uint32_t* const componentSources[4] = { &sources[0][c], &sources[1][c], &sources[2][c], &sources[3][c] };
+            ComputeShaderLanes(instruction, 0, 1, componentSources, &results[0][c], &results[1][c]);
+        }
+    }
+
+    if (instruction->saturate) {
+        SaturateShaderLanes(results[0], 0, 4);
+    }
+    for (uint32_t i = 0; i < info->dstCount; ++i) {
+        BroadcastResults(state, &instruction->operands[i], results[i]);
+    }
+}
+
+static void ExecuteALU(const GroupState* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const OpcodeInfo* info = &instruction->info;
+    const bool isFloat = info->opcodeClass == OPCODE_FLOAT;
+    const uint32_t begin = state->begin, end = state->end;
+
+    const uint32_t* sources[MAX_SOURCE_COUNT][4] = { { NULL } };
+    for (uint32_t i = 0; i < info->srcCount; ++i) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            if ((operation->sourceMask & (1U << c)) != 0) {
+                sources[i][c] = GetSourceLanes(state, &instruction->operands[info->dstCount + i], c, isFloat,
+                                                GetStagingLanes(state->sourceLanes, state, i, c));
+            }
+        }
+    }
+
+    uint32_t* results[2][4] = { { NULL } };
+    if (instruction->opcode == OP_DP2 || instruction->opcode == OP_DP3 || instruction->opcode == OP_DP4)
+    {
+        // The dot products write the same sum to every component
+        uint32_t* sum = GetStagingLanes(state->resultLanes, state, 0, 0);
+        ComputeShaderDotProductLanes(instruction->opcode - OP_DP2 + 2, begin, end, sources[0], sources[1], sum);
+        for (uint32_t c = 0; c < 4; ++c) {
+            results[0][c] = sum;
+        }
+        WriteResults(state, operation, 0, instruction->saturate, results[0]);
+        return;
+    }
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((operation->sourceMask & (1U << c)) == 0) continue;
+
+        const uint32_t* const componentSources[4] = { sources[0][c], sources[1][c], sources[2][c], sources[3][c] };
+        for (uint32_t i = 0; i < info->dstCount; ++i) {
+            results[i][c] = GetResultLanes(state, operation, i, c);
+        }
+        ComputeShaderLanes(instruction, begin, end, componentSources, results[0][c], results[1][c]);
+
+        // Without a hazard, each component is written before the next one is computed
+        if (!operation->isStaged)
+        {
+            if (instruction->saturate) {
+                SaturateShaderLanes(results[0][c], begin, end);
+            }
+            for (uint32_t i = 0; i < info->dstCount; ++i)
+            {
+                const DecodedOperand* operand = &instruction->operands[i];
+                if (operand->type == OPERAND_TEMP && (operand->mask & (1U << c)) != 0) {
+                    WriteLanes(state, WriteTempLanes(state, operand->registerIndex, c), results[i][c]);
+                }
+            }
+        }
+    }
+
+    if (operation->isStaged)
+    {
+        for (uint32_t i = 0; i < info->dstCount; ++i) {
+            WriteResults(state, operation, i, i == 0 && instruction->saturate, results[i]);
+        }
+    }
+}
+
+// A memory access whose lanes [begin, end) address evenly spaced elements of a structured buffer, or evenly spaced dwords
+// of a raw buffer, e.g. at SV_GroupIndex plus a uniform base. The component `c` of the lane `l` is at the byte offset
+// `offset + (l - begin) * step + c * 4`.
+typedef struct LinearAccess
+{
+    size_t offset;
+    size_t step;
+} LinearAccess;
+
+// Check whether the access of the lanes [begin, end) at `addresses` and the uniform `byteOffset` is linear and in bounds
+// up to the component `lastComponent`
+static bool GetLinearAccess(const MemoryView* memory, uint32_t begin, uint32_t end, const uint32_t* addresses, uint32_t byteOffset,
+                            uint32_t lastComponent, LinearAccess* pAccess)
+{
+    const uint32_t first = addresses[begin], last = addresses[end - 1];
+    if (last < first || (last - first) % (end - begin > 1 ? end - begin - 1 : 1) != 0) return false;
+
+    const uint32_t step = end - begin > 1 ? (last - first) / (end - begin - 1) : 0;
+    uint32_t mismatch = 0;
+    for (uint32_t l = begin; l < end; ++l) {
+        mismatch |= addresses[l] ^ (first + (l - begin) * step);
+    }
+    if (mismatch != 0) return false;
+
+    // The offsets grow with the lanes, so the last component of the last lane bounds all of them.
+    // The raw addresses are dword aligned, so that each lane reads the dwords of its own address.
+    if (memory->structureStride == 0 && ((first | step) & 3) != 0) return false;
+    if (GetShaderMemoryOffset(memory, last, byteOffset, lastComponent) == SIZE_MAX) return false;
+
+    *pAccess = (LinearAccess){
+        .offset = memory->structureStride != 0 ? (size_t)first * memory->structureStride + byteOffset : first,
+        .step = memory->structureStride != 0 ? (size_t)step * memory->structureStride : step
+    };
+    return true;
+}
+
+// The byte offset of a structured access if it is the same for all the lanes, which is the case of the immediate offsets
+static bool GetUniformByteOffset(const DecodedInstruction* instruction, const DecodedOperand* operand, uint32_t* pByteOffset)
+{
+    if (instruction->opcode != OP_LD_STRUCTURED && instruction->opcode != OP_STORE_STRUCTURED)
+    {
+        *pByteOffset = 0;
+        return true;
+    }
+
+    if (operand->type != OPERAND_IMMEDIATE32 || operand->modifier != 0) return false;
+
+    *pByteOffset = operand->immediate[0];
+    return true;
+}
+
+static void ExecuteLoad(const GroupState* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const bool isStructured = instruction->opcode == OP_LD_STRUCTURED;
+    const DecodedOperand* memoryOperand = &instruction->operands[isStructured ? 3 : 2];
+    const MemoryView memory = GetShaderMemoryView(state->shader->program, state->bindings, state->groupShared, memoryOperand);
+
+    if (operation->isUniform)
+    {
+        const uint32_t address = GetSourceValue(state, &instruction->operands[1], 0, false);
+        const uint32_t byteOffset = isStructured ? GetSourceValue(state, &instruction->operands[2], 0, false) : 0;
+        uint32_t values[4] = { 0 };
+        for (uint32_t c = 0; c < 4; ++c) {
+            if ((instruction->operands[0].mask & (1U << c)) != 0) {
+                LoadShaderMemoryLanes(&memory, 0, 1, &address, &byteOffset, memoryOperand->swizzle[c], &values[c]);
+            }
+        }
+        BroadcastResults(state, &instruction->operands[0], values);
+        return;
+    }
+
+    const uint32_t* addresses = GetSourceLanes(state, &instruction->operands[1], 0, false, GetStagingLanes(state->sourceLanes, state, 0, 0));
+    const uint32_t* byteOffsets = isStructured ?
+        GetSourceLanes(state, &instruction->operands[2], 0, false, GetStagingLanes(state->sourceLanes, state, 1, 0)) : NULL;
+
+    // The swizzle of the memory operand selects the loaded components
+    uint32_t lastComponent = 0;
+    for (uint32_t c = 0; c < 4; ++c) {
+        if ((instruction->operands[0].mask & (1U << c)) != 0 && memoryOperand->swizzle[c] > lastComponent) {
+            lastComponent = memoryOperand->swizzle[c];
+        }
+    }
+    uint32_t byteOffset;
+    LinearAccess access;
+    const bool isLinear = GetUniformByteOffset(instruction, &instruction->operands[2], &byteOffset) &&
+                          GetLinearAccess(&memory, state->begin, state->end, addresses, byteOffset, lastComponent, &access);
+
+    uint32_t* results[4] = { NULL };
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((instruction->operands[0].mask & (1U << c)) == 0) continue;
+
+        results[c] = GetResultLanes(state, operation, 0, c);
+        if (isLinear)
+        {
+            // The inactive lanes of the range load in-bounds memory that is not written
+            const uint8_t* source = memory.data + access.offset + memoryOperand->swizzle[c] * sizeof(uint32_t);
+            uint32_t* result = results[c];
+            if (access.step == sizeof(uint32_t)) {
+                memcpy(result + state->begin, source, (state->end - state->begin) * sizeof(uint32_t));
+            }
+            else {
+                for (uint32_t l = state->begin; l < state->end; ++l) {
+                    memcpy(&result[l], source + (l - state->begin) * access.step, sizeof(uint32_t));
+                }
+            }
+        }
+        else {
+            LoadShaderMemoryLanes(&memory, state->begin, state->end, addresses, byteOffsets, memoryOperand->swizzle[c], results[c]);
+        }
+        if (!operation->isStaged) {
+            WriteLanes(state, WriteTempLanes(state, instruction->operands[0].registerIndex, c), results[c]);
+        }
+    }
+
+    if (operation->isStaged) {
+        WriteResults(state, operation, 0, false, results);
+    }
+}
+
+static void ExecuteStore(const GroupState* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const bool isStructured = instruction->opcode == OP_STORE_STRUCTURED;
+    const DecodedOperand* memoryOperand = &instruction->operands[0];
+    const MemoryView memory = GetShaderMemoryView(state->shader->program, state->bindings, state->groupShared, memoryOperand);
+
+    const uint32_t* addresses = GetSourceLanes(state, &instruction->operands[1], 0, false, GetStagingLanes(state->sourceLanes, state, 0, 0));
+    const uint32_t* byteOffsets = isStructured ?
+        GetSourceLanes(state, &instruction->operands[2], 0, false, GetStagingLanes(state->sourceLanes, state, 1, 0)) : NULL;
+    const uint32_t* values[4] = { NULL };
+    for (uint32_t c = 0; c < 4; ++c) {
+        if ((memoryOperand->mask & (1U << c)) != 0) {
+            values[c] = GetSourceLanes(state, &instruction->operands[isStructured ? 3 : 2], c, false, GetStagingLanes(state->sourceLanes, state, 2, c));
+        }
+    }
+
+    // The lanes of a linear store do not overlap when they write distinct elements, or raw dwords beyond the components of the previous lane
+    uint32_t lastComponent = 0;
+    for (uint32_t c = 0; c < 4; ++c) {
+        if ((memoryOperand->mask & (1U << c)) != 0) {
+            lastComponent = c;
+        }
+    }
+    uint32_t byteOffset;
+    LinearAccess access;
+    if (state->isDense && GetUniformByteOffset(instruction, &instruction->operands[2], &byteOffset) &&
+        GetLinearAccess(&memory, state->begin, state->end, addresses, byteOffset, lastComponent, &access) &&
+        (state->end - state->begin == 1 || access.step >= (lastComponent + 1) * sizeof(uint32_t)))
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if ((memoryOperand->mask & (1U << c)) == 0) continue;
+
+            uint8_t* target = memory.data + access.offset + c * sizeof(uint32_t);
+            const uint32_t* value = values[c];
+            if (access.step == sizeof(uint32_t)) {
+                memcpy(target, value + state->begin, (state->end - state->begin) * sizeof(uint32_t));
+            }
+            else {
+                for (uint32_t l = state->begin; l < state->end; ++l) {
+                    memcpy(target + (l - state->begin) * access.step, &value[l], sizeof(uint32_t));
+                }
+            }
+        }
+        return;
+    }
+
+    StoreShaderMemoryLanes(&memory, state->begin, state->end, state->isDense ? NULL : state->activeLanes, addresses, byteOffsets,
+                            memoryOperand->mask, values);
+}
+
+static void ExecuteBufferInfo(const GroupState* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const MemoryView memory = GetShaderMemoryView(state->shader->program, state->bindings, state->groupShared, &instruction->operands[1]);
+
+    // The element count of a structured buffer, or the byte size of a raw buffer
+    const size_t size = memory.structureStride != 0 ? memory.size / memory.structureStride : memory.size;
+    const uint32_t value = size <= UINT32_MAX ? (uint32_t)size : UINT32_MAX;
+
+    uint32_t* results[4];
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        results[c] = GetStagingLanes(state->resultLanes, state, 0, c);
+        FillLanes(results[c], state->begin, state->end, value);
+    }
+    WriteResults(state, operation, 0, false, results);
+}
+
+static void ExecuteAtomic(const GroupState* state, const CompiledOperation* operation)
+{
+    const DecodedInstruction* instruction = operation->instruction;
+    const OpcodeInfo* info = &instruction->info;
+    const DecodedOperand* memoryOperand = &instruction->operands[info->dstCount - 1];
+    const MemoryView memory = GetShaderMemoryView(state->shader->program, state->bindings, state->groupShared, memoryOperand);
+    const bool isShared = memoryOperand->type == OPERAND_UAV;
+    const bool hasCompareValue = instruction->opcode == OP_ATOMIC_CMP_STORE || instruction->opcode == OP_IMM_ATOMIC_CMP_EXCH;
+
+    // The address of a structured buffer is the element index and the byte offset
+    const DecodedOperand* addressOperand = &instruction->operands[info->dstCount];
+    const uint32_t* addresses = GetSourceLanes(state, addressOperand, 0, false, GetStagingLanes(state->sourceLanes, state, 0, 0));
+    const uint32_t* byteOffsets = memory.structureStride != 0 ?
+        GetSourceLanes(state, addressOperand, 1, false, GetStagingLanes(state->sourceLanes, state, 0, 1)) : NULL;
+    const uint32_t* compareValues = hasCompareValue ?
+        GetSourceLanes(state, &instruction->operands[info->dstCount + 1], 0, false, GetStagingLanes(state->sourceLanes, state, 1, 0)) : NULL;
+    const uint32_t* values = GetSourceLanes(state, &instruction->operands[instruction->operandCount - 1], 0, false,
+                                            GetStagingLanes(state->sourceLanes, state, 2, 0));
+
+    uint32_t* results = GetStagingLanes(state->resultLanes, state, 0, 0);
+    for (uint32_t l = state->begin; l < state->end; ++l)
+    {
+        results[l] = 0;
+        if (state->activeLanes[l] == 0) continue;
+
+        const size_t offset = GetShaderMemoryOffset(&memory, addresses[l], byteOffsets != NULL ? byteOffsets[l] : 0, 0);
+        if (offset == SIZE_MAX) continue;
+
+        results[l] = ApplyShaderAtomicOperation(instruction->opcode, (uint32_t*)(memory.data + offset), isShared, values[l],
+                                                compareValues != NULL ? compareValues[l] : 0);
+    }
+
+    if (info->dstCount == 2)
+    {
+        uint32_t* const componentResults[4] = { results, results, results, results };
+        WriteResults(state, operation, 0, false, componentResults);
+    }
+}
+
+// Test the condition of a uniform control flow operation
+static bool TestUniformCondition(const GroupState* state, const DecodedInstruction* instruction)
+{
+    return (GetSourceValue(state, &instruction->operands[0], 0, false) != 0) == instruction->testNonZero;
+}
+
+// Get the lanes of the condition of a divergent control flow operation, 1 for the lanes that pass the test
+static const uint8_t* TestConditionLanes(const GroupState* state, const DecodedInstruction* instruction)
+{
+    const uint32_t* values = GetSourceLanes(state, &instruction->operands[0], 0, false, GetStagingLanes(state->sourceLanes, state, 0, 0));
+    uint8_t* lanes = (uint8_t*)GetStagingLanes(state->sourceLanes, state, 1, 0);
+    const uint8_t* active = state->activeLanes;
+    const uint8_t pass = instruction->testNonZero ? 1 : 0;
+    const uint32_t begin = state->begin, end = state->end;
+    for (uint32_t l = begin; l < end; ++l) {
+        lanes[l] = (uint8_t)((values[l] != 0) == pass) & active[l];
+    }
+    return lanes;
+}
+
+// Recompute the active lanes of the range of a mask entry from the lanes of the entry that have not stopped.
+// `isOuter` is true for the lanes that entered the block, whose range is the range of the entry.
+static void RestoreActiveLanes(GroupState* state, const MaskEntry* entry, const uint8_t* lanes, bool isOuter)
+{
+    const uint32_t begin = entry->begin, end = entry->end;
+    if (!state->hasStoppedLanes)
+    {
+        memcpy(state->activeLanes + begin, lanes + begin, end - begin);
+        if (!isOuter)
+        {
+            UpdateActiveRange(state, begin, end);
+            return;
+        }
+
+        state->begin = begin;
+        state->end = end;
+        state->isDense = entry->isDense;
+        return;
+    }
+
+    // The mask pointers are read once, since the byte stores could alias them
+    uint8_t* active = state->activeLanes;
+    const uint8_t* retired = state->retiredLanes;
+    const uint8_t* breaks = state->breakLanes;
+    const uint8_t* continues = state->continueLanes;
+    for (uint32_t l = begin; l < end; ++l) {
+        active[l] = lanes[l] & (uint8_t)~(retired[l] | breaks[l] | continues[l]);
+    }
+    UpdateActiveRange(state, begin, end);
+}
+
+// Whether a lane of the loop entry `entry` can still execute the current iteration
+static bool HasLoopLanes(const GroupState* state, const MaskEntry* entry)
+{
+    const uint8_t* lanes = entry->outerLanes;
+    const uint8_t* retired = state->retiredLanes;
+    const uint8_t* breaks = state->breakLanes;
+    const uint8_t* continues = state->continueLanes;
+    uint32_t count = 0;
+    for (uint32_t l = entry->begin; l < entry->end; ++l) {
+        count += lanes[l] & (uint8_t)~(retired[l] | breaks[l] | continues[l]);
+    }
+    return count != 0;
+}
+
+void ExecuteCompiledThreadGroup(const CompiledShader* shader, const ShaderBindings* bindings, const uint32_t groupID[3], void* scratch)
+{
+    if (shader->nativeShader != NULL && ExecuteNativeThreadGroup(shader->nativeShader, bindings, groupID, scratch)) return;
+
+    const ShaderProgram* program = shader->program;
+    const uint32_t laneCount = shader->laneCount;
+    uint8_t* const scratchBytes = scratch;
+    uint8_t* const masks = scratchBytes + shader->masksOffset;
+
+    // The temp registers are not cleared: a shader reads the registers that it has written
+    GroupState state = {
+        .shader = shader,
+        .bindings = bindings,
+        .groupID = { groupID[0], groupID[1], groupID[2] },
+        .groupShared = scratchBytes,
+        .temps = (uint32_t*)(scratchBytes + shader->tempsOffset),
+        .sourceLanes = (uint32_t*)(scratchBytes + shader->sourcesOffset),
+        .resultLanes = (uint32_t*)(scratchBytes + shader->resultsOffset),
+        .activeLanes = masks,
+        .retiredLanes = masks + laneCount,
+        .breakLanes = masks + 2 * laneCount,
+        .continueLanes = masks + 3 * laneCount,
+        .scalarValues = (uint32_t*)(scratchBytes + shader->scalarsOffset),
+        .isScalar = scratchBytes + shader->scalarsOffset + (size_t)program->tempCount * 4 * sizeof(uint32_t),
+        .begin = 0,
+        .end = program->threadCount,
+        .isDense = true
+    };
+    for (uint32_t d = 0; d < shader->maxMaskDepth; ++d)
+    {
+        uint8_t* entryLanes = masks + (4 + 3 * (size_t)d) * laneCount;
+        state.maskStack[d] = (MaskEntry){ .outerLanes = entryLanes, .otherLanes = entryLanes + laneCount, .savedContinueLanes = entryLanes + 2 * laneCount };
+    }
+
+    // The group-shared memory starts zeroed, and all the threads of the group are active
+    memset(scratchBytes, 0, program->groupSharedBytes);
+    memset(masks, 0, 4 * (size_t)laneCount);
+    memset(state.activeLanes, 1, program->threadCount);
+    memset(state.isScalar, 0, (size_t)program->tempCount * 4);
+
+    for (uint32_t pc = 0; pc < shader->operationCount; )
+    {
+        const CompiledOperation* operation = &shader->operations[pc++];
+        const DecodedInstruction* instruction = operation->instruction;
+
+        // The blocks that no lane executes are only walked through
+        if (operation->kind <= OPERATION_ATOMIC && state.begin == state.end) continue;
+
+        switch (operation->kind)
+        {
+        case OPERATION_ALU:
+            if (operation->isUniform) {
+                ExecuteUniformALU(&state, operation);
+            }
+            else {
+                ExecuteALU(&state, operation);
+            }
+            break;
+
+        case OPERATION_LOAD:            ExecuteLoad(&state, operation); break;
+        case OPERATION_STORE:           ExecuteStore(&state, operation); break;
+        case OPERATION_BUFFER_INFO:     ExecuteBufferInfo(&state, operation); break;
+        case OPERATION_ATOMIC:          ExecuteAtomic(&state, operation); break;
+
+        case OPERATION_IF:
+        {
+            if (operation->isUniform)
+            {
+                if (!TestUniformCondition(&state, instruction)) {
+                    pc = instruction->jumpTarget + 1;
+                }
+                break;
+            }
+
+            // A block entered by no lane is skipped as a whole
+            if (state.begin == state.end)
+            {
+                pc = instruction->endTarget + 1;
+                break;
+            }
+
+            MaskEntry* entry = &state.maskStack[state.maskDepth++];
+            entry->begin = state.begin;
+            entry->end = state.end;
+            entry->isDense = state.isDense;
+
+            // The condition is tested, and the lanes are split between the branches in one pass
+            const uint32_t* values = GetSourceLanes(&state, &instruction->operands[0], 0, false, GetStagingLanes(state.sourceLanes, &state, 0, 0));
+            const uint8_t pass = instruction->testNonZero ? 1 : 0;
+            uint8_t* active = state.activeLanes;
+            uint8_t* outerLanes = entry->outerLanes;
+            uint8_t* elseLanes = entry->otherLanes;
+            const uint32_t begin = state.begin, end = state.end;
+            uint32_t count = 0;
+            for (uint32_t l = begin; l < end; ++l)
+            {
+                const uint8_t lane = active[l];
+                const uint8_t taken = (uint8_t)((values[l] != 0) == pass) & lane;
+                outerLanes[l] = lane;
+                elseLanes[l] = lane ^ taken;
+                active[l] = taken;
+                count += taken;
+            }
+            FindActiveRange(&state, begin, end, count);
+            if (state.begin == state.end) {
+                pc = instruction->jumpTarget;
+            }
+            break;
+        }
+
+        case OPERATION_ELSE:
+        {
+            if (operation->isUniform)
+            {
+                pc = instruction->jumpTarget + 1;
+                break;
+            }
+
+            const MaskEntry* entry = &state.maskStack[state.maskDepth - 1];
+            RestoreActiveLanes(&state, entry, entry->otherLanes, false);
+            if (state.begin == state.end) {
+                pc = instruction->jumpTarget;
+            }
+            break;
+        }
+
+        case OPERATION_ENDIF:
+        {
+            if (operation->isUniform) break;
+
+            const MaskEntry* entry = &state.maskStack[--state.maskDepth];
+            RestoreActiveLanes(&state, entry, entry->outerLanes, true);
+            break;
+        }
+
+        case OPERATION_LOOP:
+        {
+            if (operation->isUniform) break;
+
+            if (state.begin == state.end)
+            {
+                pc = instruction->jumpTarget + 1;
+                break;
+            }
+
+            MaskEntry* entry = &state.maskStack[state.maskDepth++];
+            entry->begin = state.begin;
+            entry->end = state.end;
+            entry->isDense = state.isDense;
+            const size_t count = state.end - state.begin;
+            memcpy(entry->outerLanes + state.begin, state.activeLanes + state.begin, count);
+            memcpy(entry->otherLanes + state.begin, state.breakLanes + state.begin, count);
+            memcpy(entry->savedContinueLanes + state.begin, state.continueLanes + state.begin, count);
+            memset(state.breakLanes + state.begin, 0, count);
+            memset(state.continueLanes + state.begin, 0, count);
+            break;
+        }
+
+        case OPERATION_ENDLOOP:
+        {
+            if (operation->isUniform)
+            {
+                pc = instruction->jumpTarget + 1;
+                break;
+            }
+
+            // The lanes that continued rejoin the next iteration, and the loop ends when all the lanes have left it
+            const MaskEntry* entry = &state.maskStack[state.maskDepth - 1];
+            const size_t count = entry->end - entry->begin;
+            memset(state.continueLanes + entry->begin, 0, count);
+            RestoreActiveLanes(&state, entry, entry->outerLanes, true);
+            if (state.begin != state.end)
+            {
+                pc = instruction->jumpTarget + 1;
+                break;
+            }
+
+            memcpy(state.breakLanes + entry->begin, entry->otherLanes + entry->begin, count);
+            memcpy(state.continueLanes + entry->begin, entry->savedContinueLanes + entry->begin, count);
+            --state.maskDepth;
+            RestoreActiveLanes(&state, entry, entry->outerLanes, true);
+            break;
+        }
+
+        case OPERATION_BREAK:
+        case OPERATION_CONTINUE:
+        {
+            if (operation->isUniform)
+            {
+                if (instruction->info.srcCount == 0 || TestUniformCondition(&state, instruction)) {
+                    pc = operation->kind == OPERATION_BREAK ? operation->loopEnd + 1 : operation->loopEnd;
+                }
+                break;
+            }
+
+            if (state.begin == state.end) break;
+
+            const uint8_t* lanes = instruction->info.srcCount == 1 ? TestConditionLanes(&state, instruction) : state.activeLanes;
+            state.hasStoppedLanes = true;
+            uint8_t* active = state.activeLanes;
+            uint8_t* stoppedLanes = operation->kind == OPERATION_BREAK ? state.breakLanes : state.continueLanes;
+            const uint32_t begin = state.begin, end = state.end;
+            for (uint32_t l = begin; l < end; ++l)
+            {
+                const uint8_t stopped = lanes[l];
+                stoppedLanes[l] |= stopped;
+                active[l] &= (uint8_t)(stopped ^ 1);
+            }
+            UpdateActiveRange(&state, begin, end);
+
+            // When no lane of the loop is left, e.g. none waits for an else branch, the rest of the iteration is skipped
+            if (state.begin == state.end && !HasLoopLanes(&state, &state.maskStack[operation->loopDepth - 1]))
+            {
+                state.maskDepth = operation->loopDepth;
+                pc = operation->loopEnd;
+            }
+            break;
+        }
+
+        case OPERATION_RETURN:
+        {
+            if (operation->isUniform)
+            {
+                if (instruction->info.srcCount == 0 || TestUniformCondition(&state, instruction)) return;
+                break;
+            }
+
+            if (state.begin == state.end) break;
+
+            const uint8_t* lanes = instruction->info.srcCount == 1 ? TestConditionLanes(&state, instruction) : state.activeLanes;
+            state.hasStoppedLanes = true;
+            uint8_t* active = state.activeLanes;
+            uint8_t* retiredLanes = state.retiredLanes;
+            const uint32_t begin = state.begin, end = state.end;
+            uint32_t count = 0;
+            for (uint32_t l = begin; l < end; ++l)
+            {
+                const uint8_t retired = lanes[l];
+                count += retired;
+                retiredLanes[l] |= retired;
+                active[l] &= (uint8_t)(retired ^ 1);
+            }
+            state.retiredCount += count;
+            if (state.retiredCount == program->threadCount) return;
+
+            UpdateActiveRange(&state, begin, end);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
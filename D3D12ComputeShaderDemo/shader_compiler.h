@@ -0,0 +1,43 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "shader_interpreter.h"
+
+// A compute shader compiled for the execution of whole thread groups on the CPU.
+// Every operation runs over the threads of the group as contiguous lanes, and the group barriers split the program into phases
+// that all the threads finish before any of them starts the next one.
+// On x86-64 processors with AVX2 the shader is translated into machine code (see shader_jit.h). Otherwise, or if the shader uses
+// an instruction that has no translation, the operations are C loops over the lanes.
+typedef struct CompiledShader CompiledShader;
+
+// Compile the compute shader of a validated DXBC container, or take another reference to the compiled shader of the same bytecode.
+// The compiled shaders are cached by the hash of their bytecode until their last reference is released.
+// Returns NULL and prints the reason if the shader cannot be decoded, just as `CreateShaderProgram`.
+// The cache is not synchronized, so the shaders are acquired and released by the thread that initializes the backends.
+extern CompiledShader* AcquireCompiledShader(const void* data, size_t size);
+
+extern void ReleaseCompiledShader(CompiledShader* shader);
+
+// Get [numthreads(x, y, z)] of the shader
+extern void GetCompiledShaderThreadGroupSize(const CompiledShader* shader, uint32_t threadGroupSize[3]);
+
+// Get the number of phases that the group barriers split the shader into
+extern uint32_t GetCompiledShaderPhaseCount(const CompiledShader* shader);
+
+// Get the size of the scratch memory that `ExecuteCompiledThreadGroup` needs:
+// the registers and the execution masks of all the threads of a group, and the group-shared memory
+extern size_t GetCompiledShaderScratchSize(const CompiledShader* shader);
+
+// Get what executes the shader: the machine code or the lane loops
+extern const char* GetCompiledShaderTargetName(const CompiledShader* shader);
+
+// Execute the thread group `groupID` of a dispatch.
+// Different thread groups can be executed concurrently with a scratch memory each.
+extern void ExecuteCompiledThreadGroup(const CompiledShader* shader, const ShaderBindings* bindings, const uint32_t groupID[3],
+                                        void* scratch);
+
+#endif // SHADER_COMPILER_H
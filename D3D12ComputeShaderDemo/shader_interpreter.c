@@ -0,0 +1,1784 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif // _WIN32
+
+#include "shader_asset.h"
+#include "shader_interpreter.h"
+#include "shader_program.h"
+
+enum
+{
+    // D3D10_SB_OPERAND_INDEX_REPRESENTATION
+    INDEX_IMMEDIATE32 = 0,
+    INDEX_RELATIVE = 2,
+    INDEX_IMMEDIATE32_PLUS_RELATIVE = 3,
+
+    // D3D10_SB_CUSTOMDATA_DCL_IMMEDIATE_CONSTANT_BUFFER
+    CUSTOMDATA_IMMEDIATE_CONSTANT_BUFFER = 3,
+
+    // The SM5.1 range IDs of the resource declarations
+    MAX_RANGE_ID_COUNT = 16,
+
+    MAX_TEMP_COUNT = 4096,
+
+    // The group-shared memory limit of D3D12 (D3D12_CS_TGSM_REGISTER_COUNT dwords)
+    MAX_GROUP_SHARED_BYTES = 32 * 1024,
+
+    // The batches of the scratch memory start at the cache line size
+    SCRATCH_ALIGNMENT = 64
+};
+
+static const OpcodeInfo s_opcodeInfos[OP_COUNT] = {
+    [OP_ADD] = { OPCODE_FLOAT, 1, 2 },
+    [OP_AND] = { OPCODE_INT, 1, 2 },
+    [OP_BREAK] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_BREAKC] = { OPCODE_CONTROL_FLOW, 0, 1 },
+    [OP_CONTINUE] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_CONTINUEC] = { OPCODE_CONTROL_FLOW, 0, 1 },
+    [OP_DIV] = { OPCODE_FLOAT, 1, 2 },
+    [OP_DP2] = { OPCODE_FLOAT, 1, 2 },
+    [OP_DP3] = { OPCODE_FLOAT, 1, 2 },
+    [OP_DP4] = { OPCODE_FLOAT, 1, 2 },
+    [OP_ELSE] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_ENDIF] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_ENDLOOP] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_EQ] = { OPCODE_FLOAT, 1, 2 },
+    [OP_FRC] = { OPCODE_FLOAT, 1, 1 },
+    [OP_FTOI] = { OPCODE_FLOAT, 1, 1 },
+    [OP_FTOU] = { OPCODE_FLOAT, 1, 1 },
+    [OP_GE] = { OPCODE_FLOAT, 1, 2 },
+    [OP_IADD] = { OPCODE_INT, 1, 2 },
+    [OP_IF] = { OPCODE_CONTROL_FLOW, 0, 1 },
+    [OP_IEQ] = { OPCODE_INT, 1, 2 },
+    [OP_IGE] = { OPCODE_INT, 1, 2 },
+    [OP_ILT] = { OPCODE_INT, 1, 2 },
+    [OP_IMAD] = { OPCODE_INT, 1, 3 },
+    [OP_IMAX] = { OPCODE_INT, 1, 2 },
+    [OP_IMIN] = { OPCODE_INT, 1, 2 },
+    [OP_IMUL] = { OPCODE_INT, 2, 2 },
+    [OP_INE] = { OPCODE_INT, 1, 2 },
+    [OP_INEG] = { OPCODE_INT, 1, 1 },
+    [OP_ISHL] = { OPCODE_INT, 1, 2 },
+    [OP_ISHR] = { OPCODE_INT, 1, 2 },
+    [OP_ITOF] = { OPCODE_INT, 1, 1 },
+    [OP_LOOP] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_LT] = { OPCODE_FLOAT, 1, 2 },
+    [OP_MAD] = { OPCODE_FLOAT, 1, 3 },
+    [OP_MIN] = { OPCODE_FLOAT, 1, 2 },
+    [OP_MAX] = { OPCODE_FLOAT, 1, 2 },
+    [OP_MOV] = { OPCODE_FLOAT, 1, 1 },
+    [OP_MOVC] = { OPCODE_FLOAT, 1, 3 },
+    [OP_MUL] = { OPCODE_FLOAT, 1, 2 },
+    [OP_NE] = { OPCODE_FLOAT, 1, 2 },
+    [OP_NOP] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_NOT] = { OPCODE_INT, 1, 1 },
+    [OP_OR] = { OPCODE_INT, 1, 2 },
+    [OP_RET] = { OPCODE_CONTROL_FLOW, 0, 0 },
+    [OP_RETC] = { OPCODE_CONTROL_FLOW, 0, 1 },
+    [OP_ROUND_NE] = { OPCODE_FLOAT, 1, 1 },
+    [OP_ROUND_NI] = { OPCODE_FLOAT, 1, 1 },
+    [OP_ROUND_PI] = { OPCODE_FLOAT, 1, 1 },
+    [OP_ROUND_Z] = { OPCODE_FLOAT, 1, 1 },
+    [OP_RSQ] = { OPCODE_FLOAT, 1, 1 },
+    [OP_SQRT] = { OPCODE_FLOAT, 1, 1 },
+    [OP_UDIV] = { OPCODE_INT, 2, 2 },
+    [OP_ULT] = { OPCODE_INT, 1, 2 },
+    [OP_UGE] = { OPCODE_INT, 1, 2 },
+    [OP_UMUL] = { OPCODE_INT, 2, 2 },
+    [OP_UMAD] = { OPCODE_INT, 1, 3 },
+    [OP_UMAX] = { OPCODE_INT, 1, 2 },
+    [OP_UMIN] = { OPCODE_INT, 1, 2 },
+    [OP_USHR] = { OPCODE_INT, 1, 2 },
+    [OP_UTOF] = { OPCODE_INT, 1, 1 },
+    [OP_XOR] = { OPCODE_INT, 1, 2 },
+    [OP_BUFINFO] = { OPCODE_MEMORY, 1, 1 },
+    [OP_RCP] = { OPCODE_FLOAT, 1, 1 },
+    [OP_COUNTBITS] = { OPCODE_INT, 1, 1 },
+    [OP_FIRSTBIT_HI] = { OPCODE_INT, 1, 1 },
+    [OP_FIRSTBIT_LO] = { OPCODE_INT, 1, 1 },
+    [OP_FIRSTBIT_SHI] = { OPCODE_INT, 1, 1 },
+    [OP_UBFE] = { OPCODE_INT, 1, 3 },
+    [OP_IBFE] = { OPCODE_INT, 1, 3 },
+    [OP_BFI] = { OPCODE_INT, 1, 4 },
+    [OP_BFREV] = { OPCODE_INT, 1, 1 },
+    [OP_LD_RAW] = { OPCODE_MEMORY, 1, 2 },
+    [OP_STORE_RAW] = { OPCODE_MEMORY, 1, 2 },
+    [OP_LD_STRUCTURED] = { OPCODE_MEMORY, 1, 3 },
+    [OP_STORE_STRUCTURED] = { OPCODE_MEMORY, 1, 3 },
+    [OP_ATOMIC_AND] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_OR] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_XOR] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_CMP_STORE] = { OPCODE_MEMORY, 1, 3 },
+    [OP_ATOMIC_IADD] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_IMAX] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_IMIN] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_UMAX] = { OPCODE_MEMORY, 1, 2 },
+    [OP_ATOMIC_UMIN] = { OPCODE_MEMORY, 1, 2 },
+    [OP_IMM_ATOMIC_IADD] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_AND] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_OR] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_XOR] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_EXCH] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_CMP_EXCH] = { OPCODE_MEMORY, 2, 3 },
+    [OP_IMM_ATOMIC_IMAX] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_IMIN] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_UMAX] = { OPCODE_MEMORY, 2, 2 },
+    [OP_IMM_ATOMIC_UMIN] = { OPCODE_MEMORY, 2, 2 },
+    [OP_SYNC] = { OPCODE_CONTROL_FLOW, 0, 0 }
+};
+
+
+typedef enum ControlFlowKind
+{
+    CONTROL_FLOW_IF,
+    CONTROL_FLOW_LOOP
+} ControlFlowKind;
+
+// An open if or loop of a lane batch
+typedef struct ControlFlowEntry
+{
+    uint32_t kind;
+
+    // The lanes that were active when the block was entered
+    uint32_t outerMask;
+
+    // if: the lanes that take the else branch
+    uint32_t elseMask;
+
+    // loop: the break and continue masks of the enclosing loop
+    uint32_t savedBreakMask;
+    uint32_t savedContinueMask;
+} ControlFlowEntry;
+
+// The threads executed together by one SIMD step. The temp registers follow the structure,
+// laid out as [tempCount][4 components][laneCount] so that each operation runs over contiguous lanes.
+typedef struct LaneBatch
+{
+    uint32_t pc;
+    bool isFinished;
+
+    // The lanes that exist, are executing, have returned, have left the innermost loop, and wait for its next iteration
+    uint32_t laneMask;
+    uint32_t activeMask;
+    uint32_t retiredMask;
+    uint32_t breakMask;
+    uint32_t continueMask;
+
+    uint32_t controlFlowDepth;
+    ControlFlowEntry controlFlow[MAX_CONTROL_FLOW_DEPTH];
+
+    uint32_t threadIDInGroup[3][SHADER_INTERPRETER_MAX_LANE_COUNT];
+    uint32_t threadIndexInGroup[SHADER_INTERPRETER_MAX_LANE_COUNT];
+} LaneBatch;
+
+// The state shared by the lane batches of one thread group
+typedef struct GroupContext
+{
+    const ShaderProgram* program;
+    const ShaderBindings* bindings;
+    uint32_t groupID[3];
+    uint8_t* groupShared;
+} GroupContext;
+
+
+#ifdef _WIN32
+#define AtomicCompareExchangeUInt32(p, expected, desired) \
+    ((uint32_t)InterlockedCompareExchange((volatile LONG*)(p), (LONG)(desired), (LONG)(expected)))
+#else
+static inline uint32_t AtomicCompareExchangeUInt32(uint32_t* p, uint32_t expected, uint32_t desired)
+{
+    __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return expected;
+}
+#endif // _WIN32
+
+static inline float AsFloat(uint32_t value)
+{
+    union { uint32_t u; float f; } bits = { .u = value };
+    return bits.f;
+}
+
+static inline uint32_t AsUInt(float value)
+{
+    union { float f; uint32_t u; } bits = { .f = value };
+    return bits.u;
+}
+
+static inline uint32_t LoadUInt32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline void StoreUInt32(uint8_t* p, uint32_t value)
+{
+    memcpy(p, &value, sizeof(value));
+}
+
+static uint32_t CountBits(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555U);
+    value = (value & 0x33333333U) + ((value >> 2) & 0x33333333U);
+    return (((value + (value >> 4)) & 0x0f0f0f0fU) * 0x01010101U) >> 24;
+}
+
+// The number of zero bits above the highest set bit, or ~0 if there is none
+static uint32_t FirstBitHigh(uint32_t value)
+{
+    if (value == 0) return UINT32_MAX;
+
+    uint32_t count = 0;
+    for (; (value & 0x80000000U) == 0; value <<= 1) {
+        ++count;
+    }
+    return count;
+}
+
+static uint32_t FirstBitLow(uint32_t value)
+{
+    if (value == 0) return UINT32_MAX;
+
+    uint32_t count = 0;
+    for (; (value & 1U) == 0; value >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+static uint32_t ReverseBits(uint32_t value)
+{
+    value = ((value >> 1) & 0x55555555U) | ((value & 0x55555555U) << 1);
+    value = ((value >> 2) & 0x33333333U) | ((value & 0x33333333U) << 2);
+    value = ((value >> 4) & 0x0f0f0f0fU) | ((value & 0x0f0f0f0fU) << 4);
+    value = ((value >> 8) & 0x00ff00ffU) | ((value & 0x00ff00ffU) << 8);
+    return (value >> 16) | (value << 16);
+}
+
+static uint32_t FloatToInt(float value)
+{
+    if (value != value) return 0;
+    if (value >= 2147483648.0f) return (uint32_t)INT32_MAX;
+    if (value <= -2147483648.0f) return (uint32_t)INT32_MIN;
+    return (uint32_t)(int32_t)value;
+}
+
+static uint32_t FloatToUInt(float value)
+{
+    if (!(value > 0.0f)) return 0;
+    if (value >= 4294967296.0f) return UINT32_MAX;
+    return (uint32_t)value;
+}
+
+// ---- Decoding ----
+
+typedef struct TokenReader
+{
+    const uint32_t* tokens;
+    uint32_t position;
+    uint32_t end;
+} TokenReader;
+
+static bool ReadToken(TokenReader* reader, uint32_t* pToken)
+{
+    if (reader->position >= reader->end) return false;
+
+    *pToken = reader->tokens[reader->position++];
+    return true;
+}
+
+// An operand as encoded, before its indices are resolved
+typedef struct RawOperand
+{
+    uint32_t type;
+    uint32_t componentCount;
+    uint8_t mask;
+    uint8_t swizzle[4];
+    uint8_t modifier;
+    uint32_t indexCount;
+    uint32_t index[3];
+    bool hasRelativeIndex[3];
+    uint8_t relativeComponent[3];
+    uint32_t relativeRegister[3];
+    uint32_t immediate[4];
+} RawOperand;
+
+static bool ReadOperand(TokenReader* reader, RawOperand* operand);
+
+// Read the relative part of an operand index, which must be a component of a temp register
+static bool ReadRelativeIndex(TokenReader* reader, RawOperand* operand, uint32_t dimension)
+{
+    RawOperand relative;
+    if (!ReadOperand(reader, &relative)) return false;
+    if (relative.type != OPERAND_TEMP || relative.indexCount != 1 || relative.hasRelativeIndex[0] || relative.modifier != 0) return false;
+
+    operand->hasRelativeIndex[dimension] = true;
+    operand->relativeRegister[dimension] = relative.index[0];
+    operand->relativeComponent[dimension] = relative.swizzle[0];
+    return true;
+}
+
+static bool ReadOperand(TokenReader* reader, RawOperand* operand)
+{
+    uint32_t token;
+    if (!ReadToken(reader, &token)) return false;
+
+    memset(operand, 0, sizeof(*operand));
+    operand->type = (token >> 12) & 0xff;
+    operand->indexCount = (token >> 20) & 0x3;
+
+    // 0, 1 or 4 components, selected by a write mask, a swizzle or a single component
+    switch (token & 0x3)
+    {
+    case 0:
+        operand->componentCount = 0;
+        operand->mask = 0x1;
+        break;
+
+    case 1:
+        operand->componentCount = 1;
+        operand->mask = 0x1;
+        break;
+
+    case 2:
+    {
+        operand->componentCount = 4;
+        const uint32_t selectionMode = (token >> 2) & 0x3;
+        if (selectionMode == 0)
+        {
+            operand->mask = (token >> 4) & 0xf;
+            for (uint32_t c = 0; c < 4; ++c) {
+                operand->swizzle[c] = (uint8_t)c;
+            }
+        }
+        else if (selectionMode == 1)
+        {
+            operand->mask = 0xf;
+            for (uint32_t c = 0; c < 4; ++c) {
+                operand->swizzle[c] = (uint8_t)((token >> (4 + 2 * c)) & 0x3);
+            }
+        }
+        else if (selectionMode == 2)
+        {
+            operand->mask = 0x1;
+            memset(operand->swizzle, (token >> 4) & 0x3, sizeof(operand->swizzle));
+        }
+        else return false;
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    // The extended operand token carries the modifier
+    for (uint32_t extendedToken = token; (extendedToken & 0x80000000U) != 0; )
+    {
+        if (!ReadToken(reader, &extendedToken)) return false;
+        if ((extendedToken & 0x3f) == 1) {
+            operand->modifier = (extendedToken >> 6) & 0xff;
+        }
+    }
+
+    for (uint32_t d = 0; d < operand->indexCount; ++d)
+    {
+        const uint32_t representation = (token >> (22 + 3 * d)) & 0x7;
+        switch (representation)
+        {
+        case INDEX_IMMEDIATE32:
+            if (!ReadToken(reader, &operand->index[d])) return false;
+            break;
+
+        case INDEX_RELATIVE:
+            if (!ReadRelativeIndex(reader, operand, d)) return false;
+            break;
+
+        case INDEX_IMMEDIATE32_PLUS_RELATIVE:
+            if (!ReadToken(reader, &operand->index[d]) || !ReadRelativeIndex(reader, operand, d)) return false;
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    if (operand->type == OPERAND_IMMEDIATE32)
+    {
+        const uint32_t valueCount = operand->componentCount == 4 ? 4 : 1;
+        for (uint32_t c = 0; c < valueCount; ++c) {
+            if (!ReadToken(reader, &operand->immediate[c])) return false;
+        }
+        for (uint32_t c = valueCount; c < 4; ++c) {
+            operand->immediate[c] = operand->immediate[0];
+        }
+    }
+
+    return true;
+}
+
+// The register index of a declared range of SM5.1, or of a register of SM5.0
+typedef struct RangeMap
+{
+    bool isDeclared[MAX_RANGE_ID_COUNT];
+    uint32_t registerIndex[MAX_RANGE_ID_COUNT];
+} RangeMap;
+
+typedef struct DecodeState
+{
+    ShaderProgram* program;
+    RangeMap constantBufferRanges;
+    RangeMap resourceRanges;
+    RangeMap uavRanges;
+} DecodeState;
+
+// Read the register operand of a resource declaration. SM5.1 declares a range [lower, upper] of a register space.
+static bool ReadDeclaredRegister(DecodeState* state, TokenReader* reader, RangeMap* ranges, uint32_t registerLimit,
+                                RawOperand* operand, uint32_t* pRegister)
+{
+    if (!ReadOperand(reader, operand)) return false;
+
+    if (!state->program->isModel51)
+    {
+        *pRegister = operand->index[0];
+        return *pRegister < registerLimit;
+    }
+
+    const uint32_t rangeID = operand->index[0];
+    if (operand->indexCount != 3 || rangeID >= MAX_RANGE_ID_COUNT || operand->index[1] != operand->index[2] || operand->index[1] >= registerLimit)
+    {
+        fprintf(stderr, "The shader interpreter only supports single resources, not arrays!\n");
+        return false;
+    }
+
+    ranges->isDeclared[rangeID] = true;
+    ranges->registerIndex[rangeID] = operand->index[1];
+    *pRegister = operand->index[1];
+    return true;
+}
+
+// Read the register space that follows an SM5.1 declaration
+static bool ReadDeclaredSpace(const DecodeState* state, TokenReader* reader)
+{
+    if (!state->program->isModel51) return true;
+
+    uint32_t space;
+    if (!ReadToken(reader, &space)) return false;
+    if (space != 0)
+    {
+        fprintf(stderr, "The shader interpreter only supports the register space 0!\n");
+        return false;
+    }
+    return true;
+}
+
+static bool DecodeDeclaration(DecodeState* state, uint32_t opcode, uint32_t opcodeToken, TokenReader* reader)
+{
+    ShaderProgram* program = state->program;
+    RawOperand operand;
+    uint32_t registerIndex = 0;
+
+    switch (opcode)
+    {
+    case OP_DCL_GLOBAL_FLAGS:
+    case OP_DCL_INPUT:
+        return true;
+
+    case OP_DCL_TEMPS:
+        return ReadToken(reader, &program->tempCount) && program->tempCount <= MAX_TEMP_COUNT;
+
+    case OP_DCL_THREAD_GROUP:
+        return ReadToken(reader, &program->threadGroupSize[0]) && ReadToken(reader, &program->threadGroupSize[1]) &&
+            ReadToken(reader, &program->threadGroupSize[2]);
+
+    case OP_DCL_CONSTANT_BUFFER:
+    {
+        if (!ReadDeclaredRegister(state, reader, &state->constantBufferRanges, SHADER_INTERPRETER_MAX_CONSTANT_BUFFER_COUNT,
+                                &operand, &registerIndex)) return false;
+
+        // The size in 16-byte elements follows the SM5.1 range
+        uint32_t elementCount;
+        if (program->isModel51 && !ReadToken(reader, &elementCount)) return false;
+        if (!ReadDeclaredSpace(state, reader)) return false;
+
+        program->constantBuffers[registerIndex] = true;
+        return true;
+    }
+
+    case OP_DCL_RESOURCE_RAW:
+    case OP_DCL_RESOURCE_STRUCTURED:
+    {
+        if (!ReadDeclaredRegister(state, reader, &state->resourceRanges, SHADER_INTERPRETER_MAX_RESOURCE_COUNT, &operand, &registerIndex)) return false;
+
+        uint32_t stride = 0;
+        if (opcode == OP_DCL_RESOURCE_STRUCTURED && (!ReadToken(reader, &stride) || stride == 0 || stride % 4 != 0)) return false;
+        if (!ReadDeclaredSpace(state, reader)) return false;
+
+        program->resources[registerIndex] = (BufferDeclaration){ .isDeclared = true, .structureStride = stride };
+        return true;
+    }
+
+    case OP_DCL_UAV_RAW:
+    case OP_DCL_UAV_STRUCTURED:
+    {
+        // The hidden counter of an append, consume or counter buffer is not supported
+        if ((opcodeToken >> 23) & 0x1)
+        {
+            fprintf(stderr, "The shader interpreter does not support UAV counters!\n");
+            return false;
+        }
+        if (!ReadDeclaredRegister(state, reader, &state->uavRanges, SHADER_INTERPRETER_MAX_UAV_COUNT, &operand, &registerIndex)) return false;
+
+        uint32_t stride = 0;
+        if (opcode == OP_DCL_UAV_STRUCTURED && (!ReadToken(reader, &stride) || stride == 0 || stride % 4 != 0)) return false;
+        if (!ReadDeclaredSpace(state, reader)) return false;
+
+        program->uavs[registerIndex] = (BufferDeclaration){ .isDeclared = true, .structureStride = stride };
+        return true;
+    }
+
+    case OP_DCL_TGSM_RAW:
+    case OP_DCL_TGSM_STRUCTURED:
+    {
+        if (!ReadOperand(reader, &operand) || operand.index[0] >= MAX_TGSM_COUNT) return false;
+
+        uint32_t stride = 0, size = 0;
+        if (opcode == OP_DCL_TGSM_RAW)
+        {
+            if (!ReadToken(reader, &size)) return false;
+        }
+        else
+        {
+            uint32_t count;
+            if (!ReadToken(reader, &stride) || !ReadToken(reader, &count) || stride == 0 || stride % 4 != 0) return false;
+            size = stride * count;
+        }
+        if (size > MAX_GROUP_SHARED_BYTES - program->groupSharedBytes) return false;
+
+        program->groupShared[operand.index[0]] = (GroupSharedDeclaration){
+            .isDeclared = true,
+            .offset = program->groupSharedBytes,
+            .size = size,
+            .structureStride = stride
+        };
+        program->groupSharedBytes += (size + 3) & ~3U;
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+// Resolve the register and the element indices of an operand of an executable instruction
+static bool ResolveOperand(const DecodeState* state, const RawOperand* raw, DecodedOperand* operand)
+{
+    const ShaderProgram* program = state->program;
+    *operand = (DecodedOperand){ .type = (uint8_t)raw->type, .modifier = raw->modifier, .mask = raw->mask };
+    memcpy(operand->swizzle, raw->swizzle, sizeof(operand->swizzle));
+    memcpy(operand->immediate, raw->immediate, sizeof(operand->immediate));
+
+    // Only the element index of a constant buffer may be relative
+    uint32_t elementDimension = UINT32_MAX;
+    bool isValid = true;
+    switch (raw->type)
+    {
+    case OPERAND_TEMP:
+        operand->registerIndex = raw->index[0];
+        isValid = raw->indexCount == 1 && operand->registerIndex < program->tempCount;
+        break;
+
+    case OPERAND_CONSTANT_BUFFER:
+    {
+        const uint32_t registerDimension = program->isModel51 ? 1 : 0;
+        elementDimension = registerDimension + 1;
+        if (raw->indexCount != elementDimension + 1 || raw->hasRelativeIndex[registerDimension]) return false;
+
+        operand->registerIndex = raw->index[registerDimension];
+        isValid = operand->registerIndex < SHADER_INTERPRETER_MAX_CONSTANT_BUFFER_COUNT && program->constantBuffers[operand->registerIndex];
+        break;
+    }
+
+    case OPERAND_IMMEDIATE_CONSTANT_BUFFER:
+        elementDimension = 0;
+        isValid = raw->indexCount == 1;
+        break;
+
+    case OPERAND_RESOURCE:
+    case OPERAND_UAV:
+    {
+        const uint32_t registerDimension = program->isModel51 ? 1 : 0;
+        if (raw->indexCount != registerDimension + 1 || raw->hasRelativeIndex[registerDimension])
+        {
+            fprintf(stderr, "The shader interpreter does not support dynamically indexed resources!\n");
+            return false;
+        }
+
+        operand->registerIndex = raw->index[registerDimension];
+        const BufferDeclaration* declarations = raw->type == OPERAND_RESOURCE ? program->resources : program->uavs;
+        const uint32_t limit = raw->type == OPERAND_RESOURCE ? SHADER_INTERPRETER_MAX_RESOURCE_COUNT : SHADER_INTERPRETER_MAX_UAV_COUNT;
+        isValid = operand->registerIndex < limit && declarations[operand->registerIndex].isDeclared;
+        break;
+    }
+
+    case OPERAND_TGSM:
+        operand->registerIndex = raw->index[0];
+        isValid = raw->indexCount == 1 && operand->registerIndex < MAX_TGSM_COUNT && program->groupShared[operand->registerIndex].isDeclared;
+        break;
+
+    case OPERAND_IMMEDIATE32:
+    case OPERAND_NULL:
+    case OPERAND_THREAD_ID:
+    case OPERAND_THREAD_GROUP_ID:
+    case OPERAND_THREAD_ID_IN_GROUP:
+    case OPERAND_THREAD_ID_IN_GROUP_FLATTENED:
+        isValid = raw->indexCount == 0;
+        break;
+
+    default:
+        fprintf(stderr, "The shader interpreter does not support the operand type %u!\n", raw->type);
+        return false;
+    }
+    if (!isValid) return false;
+
+    if (elementDimension != UINT32_MAX)
+    {
+        operand->elementIndex = raw->index[elementDimension];
+        operand->hasRelativeIndex = raw->hasRelativeIndex[elementDimension];
+        operand->relativeRegister = raw->relativeRegister[elementDimension];
+        operand->relativeComponent = raw->relativeComponent[elementDimension];
+        if (operand->hasRelativeIndex && operand->relativeRegister >= program->tempCount) return false;
+    }
+
+    return true;
+}
+
+static bool IsValueOperand(uint32_t type)
+{
+    return type != OPERAND_RESOURCE && type != OPERAND_UAV && type != OPERAND_TGSM && type != OPERAND_NULL;
+}
+
+// Check that the operands of an instruction have the kinds that its opcode expects
+static bool ValidateInstructionOperands(const DecodedInstruction* instruction)
+{
+    const OpcodeInfo* info = &instruction->info;
+    const DecodedOperand* operands = instruction->operands;
+    if (instruction->operandCount != info->dstCount + info->srcCount) return false;
+
+    // Integer operations can only negate their sources
+    for (uint32_t i = info->dstCount; i < instruction->operandCount; ++i) {
+        if (info->opcodeClass == OPCODE_INT && (operands[i].modifier & OPERAND_MODIFIER_ABS) != 0) return false;
+    }
+
+    switch (instruction->opcode)
+    {
+    case OP_LD_STRUCTURED:
+        return operands[0].type == OPERAND_TEMP && IsValueOperand(operands[1].type) && IsValueOperand(operands[2].type) && !IsValueOperand(operands[3].type);
+
+    case OP_LD_RAW:
+    case OP_BUFINFO:
+        return operands[0].type == OPERAND_TEMP && (instruction->opcode == OP_BUFINFO || IsValueOperand(operands[1].type)) &&
+            !IsValueOperand(operands[instruction->operandCount - 1].type) && operands[instruction->operandCount - 1].type != OPERAND_NULL;
+
+    case OP_STORE_STRUCTURED:
+    case OP_STORE_RAW:
+        return (operands[0].type == OPERAND_UAV || operands[0].type == OPERAND_TGSM) && IsValueOperand(operands[1].type) &&
+            IsValueOperand(operands[2].type) && (instruction->opcode == OP_STORE_RAW || IsValueOperand(operands[3].type));
+
+    default:
+        break;
+    }
+
+    if (info->opcodeClass == OPCODE_MEMORY)
+    {
+        // The atomic operations: [the returned value,] the memory, the address and the values
+        const uint32_t memoryIndex = info->dstCount - 1;
+        if (memoryIndex == 1 && operands[0].type != OPERAND_TEMP && operands[0].type != OPERAND_NULL) return false;
+        if (operands[memoryIndex].type != OPERAND_UAV && operands[memoryIndex].type != OPERAND_TGSM) return false;
+        for (uint32_t i = info->dstCount; i < instruction->operandCount; ++i) {
+            if (!IsValueOperand(operands[i].type)) return false;
+        }
+        return true;
+    }
+
+    for (uint32_t i = 0; i < info->dstCount; ++i) {
+        if (operands[i].type != OPERAND_TEMP && operands[i].type != OPERAND_NULL) return false;
+    }
+    for (uint32_t i = info->dstCount; i < instruction->operandCount; ++i) {
+        if (!IsValueOperand(operands[i].type)) return false;
+    }
+    return true;
+}
+
+// Match the if/else/endif and loop/endloop blocks, and check that break and continue are inside a loop
+static bool LinkControlFlow(ShaderProgram* program)
+{
+    uint32_t openBlocks[MAX_CONTROL_FLOW_DEPTH];
+    uint32_t depth = 0, loopDepth = 0;
+
+    for (uint32_t pc = 0; pc < program->instructionCount; ++pc)
+    {
+        DecodedInstruction* instruction = &program->instructions[pc];
+        switch (instruction->opcode)
+        {
+        case OP_IF:
+        case OP_LOOP:
+            if (depth == MAX_CONTROL_FLOW_DEPTH) return false;
+            loopDepth += instruction->opcode == OP_LOOP ? 1 : 0;
+            openBlocks[depth++] = pc;
+            break;
+
+        case OP_ELSE:
+        {
+            if (depth == 0) return false;
+            DecodedInstruction* block = &program->instructions[openBlocks[depth - 1]];
+            if (block->opcode != OP_IF || block->jumpTarget != 0) return false;
+            block->jumpTarget = pc;
+            openBlocks[depth - 1] = pc;
+            break;
+        }
+
+        case OP_ENDIF:
+        {
+            if (depth == 0) return false;
+            DecodedInstruction* block = &program->instructions[openBlocks[--depth]];
+            if (block->opcode == OP_ELSE)
+            {
+                block->jumpTarget = pc;
+
+                // Find the if of the else
+                for (uint32_t i = openBlocks[depth]; i-- > 0; )
+                {
+                    if (program->instructions[i].opcode == OP_IF && program->instructions[i].jumpTarget == openBlocks[depth])
+                    {
+                        program->instructions[i].endTarget = pc;
+                        break;
+                    }
+                }
+            }
+            else if (block->opcode == OP_IF)
+            {
+                block->jumpTarget = pc;
+                block->endTarget = pc;
+            }
+            else return false;
+            break;
+        }
+
+        case OP_ENDLOOP:
+        {
+            if (depth == 0 || program->instructions[openBlocks[depth - 1]].opcode != OP_LOOP) return false;
+            const uint32_t loopStart = openBlocks[--depth];
+            program->instructions[loopStart].jumpTarget = pc;
+            instruction->jumpTarget = loopStart;
+            --loopDepth;
+            break;
+        }
+
+        case OP_BREAK:
+        case OP_BREAKC:
+        case OP_CONTINUE:
+        case OP_CONTINUEC:
+            if (loopDepth == 0) return false;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return depth == 0;
+}
+
+static bool DecodeInstructions(DecodeState* state, const uint32_t* tokens, uint32_t tokenCount)
+{
+    ShaderProgram* program = state->program;
+    program->instructions = calloc(tokenCount, sizeof(*program->instructions));
+    if (program->instructions == NULL) return false;
+
+    for (uint32_t index = 2; index < tokenCount; )
+    {
+        const uint32_t opcodeToken = tokens[index];
+        const uint32_t opcode = opcodeToken & 0x7ff;
+        uint32_t length = (opcodeToken >> 24) & 0x7f;
+        if (opcode == OP_CUSTOMDATA)
+        {
+            if (index + 1 >= tokenCount) return false;
+            length = tokens[index + 1];
+        }
+        if (length == 0 || length > tokenCount - index) return false;
+
+        TokenReader reader = { .tokens = tokens, .position = index + 1, .end = index + length };
+        index += length;
+
+        if (opcode == OP_CUSTOMDATA)
+        {
+            // Only the immediate constant buffer matters, the comments and the debug data are skipped
+            if ((opcodeToken >> 11) != CUSTOMDATA_IMMEDIATE_CONSTANT_BUFFER) continue;
+
+            program->immediateConstantCount = length - 2;
+            program->immediateConstants = malloc(((size_t)program->immediateConstantCount + 1) * sizeof(uint32_t));
+            if (program->immediateConstants == NULL) return false;
+            memcpy(program->immediateConstants, &tokens[reader.position + 1], (size_t)program->immediateConstantCount * sizeof(uint32_t));
+            continue;
+        }
+
+        if (opcode >= OP_COUNT || s_opcodeInfos[opcode].opcodeClass == OPCODE_UNSUPPORTED)
+        {
+            if (!DecodeDeclaration(state, opcode, opcodeToken, &reader))
+            {
+                fprintf(stderr, "The shader interpreter does not support the opcode %u at token %u!\n", opcode, index - length);
+                return false;
+            }
+            continue;
+        }
+
+        DecodedInstruction* instruction = &program->instructions[program->instructionCount++];
+        instruction->opcode = (uint16_t)opcode;
+        instruction->info = s_opcodeInfos[opcode];
+        instruction->testNonZero = ((opcodeToken >> 18) & 0x1) != 0;
+        instruction->saturate = ((opcodeToken >> 13) & 0x1) != 0;
+        instruction->syncFlags = (uint8_t)((opcodeToken >> 11) & 0xf);
+
+        // The extended opcode tokens, e.g. the resource dimension of ld_structured_indexable, are not needed
+        for (uint32_t extendedToken = opcodeToken; (extendedToken & 0x80000000U) != 0; ) {
+            if (!ReadToken(&reader, &extendedToken)) return false;
+        }
+
+        while (reader.position < reader.end)
+        {
+            RawOperand raw;
+            if (instruction->operandCount == MAX_INSTRUCTION_OPERAND_COUNT || !ReadOperand(&reader, &raw) ||
+                !ResolveOperand(state, &raw, &instruction->operands[instruction->operandCount++]))
+            {
+                fprintf(stderr, "The shader interpreter cannot decode the operands of the opcode %u at token %u!\n", opcode, index - length);
+                return false;
+            }
+        }
+
+        if (!ValidateInstructionOperands(instruction))
+        {
+            fprintf(stderr, "The opcode %u at token %u has unexpected operands!\n", opcode, index - length);
+            return false;
+        }
+    }
+
+    if (!LinkControlFlow(program))
+    {
+        fprintf(stderr, "The control flow of the shader is not structured!\n");
+        return false;
+    }
+
+    return true;
+}
+
+ShaderProgram* CreateShaderProgram(const void* data, size_t size, uint32_t laneCount)
+{
+    if (laneCount != 4 && laneCount != 8 && laneCount != 16) return NULL;
+
+    const void* codeData = NULL;
+    size_t codeSize = 0;
+    if (!FindShaderContainerPart(data, size, "SHEX", &codeData, &codeSize) && !FindShaderContainerPart(data, size, "SHDR", &codeData, &codeSize))
+    {
+        fprintf(stderr, "The shader has no SM5 bytecode. DXIL cannot be interpreted!\n");
+        return NULL;
+    }
+    if (codeSize < 2 * sizeof(uint32_t) || codeSize % sizeof(uint32_t) != 0) return NULL;
+
+    // The tokens are copied so that they are aligned
+    const uint32_t tokenCapacity = (uint32_t)(codeSize / sizeof(uint32_t));
+    uint32_t* tokens = malloc(codeSize);
+    ShaderProgram* program = calloc(1, sizeof(*program));
+    bool succeeded = false;
+    do
+    {
+        if (tokens == NULL || program == NULL) break;
+        memcpy(tokens, codeData, codeSize);
+
+        // The program type 5 is a compute shader
+        const uint32_t versionToken = tokens[0];
+        const uint32_t tokenCount = tokens[1];
+        if ((versionToken >> 16) != 5 || ((versionToken >> 4) & 0xf) != 5 || tokenCount < 2 || tokenCount > tokenCapacity)
+        {
+            fprintf(stderr, "The shader interpreter only supports cs_5_0 and cs_5_1!\n");
+            break;
+        }
+
+        program->laneCount = laneCount;
+        program->isModel51 = (versionToken & 0xf) >= 1;
+
+        DecodeState state = { .program = program };
+        if (!DecodeInstructions(&state, tokens, tokenCount)) break;
+
+        const uint32_t* groupSize = program->threadGroupSize;
+        if (groupSize[0] == 0 || groupSize[1] == 0 || groupSize[2] == 0 ||
+            (uint64_t)groupSize[0] * groupSize[1] * groupSize[2] > MAX_THREAD_GROUP_THREAD_COUNT) break;
+
+        program->threadCount = groupSize[0] * groupSize[1] * groupSize[2];
+        program->batchCount = (program->threadCount + laneCount - 1) / laneCount;
+
+        // The group-shared memory is followed by the lane batches
+        const size_t registerBytes = (size_t)program->tempCount * 4 * laneCount * sizeof(uint32_t);
+        program->batchStride = (sizeof(LaneBatch) + registerBytes + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+        program->batchesOffset = ((size_t)program->groupSharedBytes + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+        program->scratchSize = program->batchesOffset + program->batchCount * program->batchStride;
+
+        succeeded = true;
+    }
+    while (false);
+
+    free(tokens);
+    if (!succeeded)
+    {
+        DestroyShaderProgram(program);
+        return NULL;
+    }
+
+    return program;
+}
+
+void DestroyShaderProgram(ShaderProgram* program)
+{
+    if (program == NULL) return;
+
+    free(program->instructions);
+    free(program->immediateConstants);
+    free(program);
+}
+
+void GetShaderProgramThreadGroupSize(const ShaderProgram* program, uint32_t threadGroupSize[3])
+{
+    memcpy(threadGroupSize, program->threadGroupSize, sizeof(program->threadGroupSize));
+}
+
+size_t GetShaderProgramScratchSize(const ShaderProgram* program)
+{
+    return program->scratchSize;
+}
+
+// ---- Execution ----
+
+typedef uint32_t LaneValues[SHADER_INTERPRETER_MAX_LANE_COUNT];
+
+static inline uint32_t* GetTempRegister(const ShaderProgram* program, LaneBatch* batch, uint32_t registerIndex, uint32_t component)
+{
+    uint32_t* registers = (uint32_t*)(batch + 1);
+    return registers + ((size_t)registerIndex * 4 + component) * program->laneCount;
+}
+
+uint32_t ReadShaderConstant(const uint8_t* data, size_t size, uint64_t element, uint32_t component)
+{
+    const uint64_t offset = element * 16 + component * sizeof(uint32_t);
+    return data != NULL && offset + sizeof(uint32_t) <= size ? LoadUInt32(data + offset) : 0;
+}
+
+// Fetch the components of a source operand that the mask `componentMask` needs, after the swizzle and the modifier
+static void FetchSource(const GroupContext* context, LaneBatch* batch, const DecodedOperand* operand, bool isFloat,
+                        uint32_t componentMask, LaneValues values[4])
+{
+    const ShaderProgram* program = context->program;
+    const uint32_t laneCount = program->laneCount;
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((componentMask & (1U << c)) == 0) continue;
+
+        const uint32_t component = operand->swizzle[c];
+        uint32_t* result = values[c];
+        switch (operand->type)
+        {
+        case OPERAND_TEMP:
+            memcpy(result, GetTempRegister(program, batch, operand->registerIndex, component), laneCount * sizeof(uint32_t));
+            break;
+
+        case OPERAND_IMMEDIATE32:
+            for (uint32_t l = 0; l < laneCount; ++l) {
+                result[l] = operand->immediate[c];
+            }
+            break;
+
+        case OPERAND_CONSTANT_BUFFER:
+        case OPERAND_IMMEDIATE_CONSTANT_BUFFER:
+        {
+            const ShaderBufferBinding* binding = &context->bindings->constantBuffers[operand->registerIndex];
+            const uint8_t* data = operand->type == OPERAND_CONSTANT_BUFFER ? binding->data : (const uint8_t*)program->immediateConstants;
+            const size_t size = operand->type == OPERAND_CONSTANT_BUFFER ? binding->size : (size_t)program->immediateConstantCount * sizeof(uint32_t);
+            if (!operand->hasRelativeIndex)
+            {
+                const uint32_t value = ReadShaderConstant(data, size, operand->elementIndex, component);
+                for (uint32_t l = 0; l < laneCount; ++l) {
+                    result[l] = value;
+                }
+            }
+            else
+            {
+                const uint32_t* offsets = GetTempRegister(program, batch, operand->relativeRegister, operand->relativeComponent);
+                for (uint32_t l = 0; l < laneCount; ++l) {
+                    result[l] = ReadShaderConstant(data, size, (uint64_t)operand->elementIndex + offsets[l], component);
+                }
+            }
+            break;
+        }
+
+        case OPERAND_THREAD_ID:
+            for (uint32_t l = 0; l < laneCount; ++l) {
+                result[l] = component < 3 ? context->groupID[component] * program->threadGroupSize[component] + batch->threadIDInGroup[component][l] : 0;
+            }
+            break;
+
+        case OPERAND_THREAD_GROUP_ID:
+            for (uint32_t l = 0; l < laneCount; ++l) {
+                result[l] = component < 3 ? context->groupID[component] : 0;
+            }
+            break;
+
+        case OPERAND_THREAD_ID_IN_GROUP:
+            for (uint32_t l = 0; l < laneCount; ++l) {
+                result[l] = component < 3 ? batch->threadIDInGroup[component][l] : 0;
+            }
+            break;
+
+        case OPERAND_THREAD_ID_IN_GROUP_FLATTENED:
+            memcpy(result, batch->threadIndexInGroup, laneCount * sizeof(uint32_t));
+            break;
+
+        default:
+            memset(result, 0, laneCount * sizeof(uint32_t));
+            break;
+        }
+
+        // A float operation flips the sign bit, and an integer operation negates the two's complement value
+        if (operand->modifier & OPERAND_MODIFIER_ABS) {
+            for (uint32_t l = 0; l < laneCount; ++l) {
+                result[l] &= 0x7fffffffU;
+            }
+        }
+        if (operand->modifier & OPERAND_MODIFIER_NEG)
+        {
+            if (isFloat) {
+                for (uint32_t l = 0; l < laneCount; ++l) {
+                    result[l] ^= 0x80000000U;
+                }
+            }
+            else {
+                for (uint32_t l = 0; l < laneCount; ++l) {
+                    result[l] = 0U - result[l];
+                }
+            }
+        }
+    }
+}
+
+// Write the components of `values` selected by the destination mask to the active lanes of a temp register
+static void WriteDestination(const GroupContext* context, LaneBatch* batch, const DecodedOperand* operand, bool saturate,
+                            LaneValues values[4])
+{
+    if (operand->type == OPERAND_NULL) return;
+
+    const ShaderProgram* program = context->program;
+    const uint32_t laneCount = program->laneCount;
+    LaneValues laneSelect;
+    for (uint32_t l = 0; l < laneCount; ++l) {
+        laneSelect[l] = (batch->activeMask >> l) & 1U ? UINT32_MAX : 0;
+    }
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((operand->mask & (1U << c)) == 0) continue;
+
+        uint32_t* value = values[c];
+        if (saturate) {
+            SaturateShaderLanes(value, 0, laneCount);
+        }
+
+        uint32_t* target = GetTempRegister(program, batch, operand->registerIndex, c);
+        for (uint32_t l = 0; l < laneCount; ++l) {
+            target[l] = (value[l] & laneSelect[l]) | (target[l] & ~laneSelect[l]);
+        }
+    }
+}
+
+// The lanes whose component 0 of `values` passes the test of a conditional instruction
+static uint32_t TestLanes(const ShaderProgram* program, const DecodedInstruction* instruction, const uint32_t values[])
+{
+    uint32_t mask = 0;
+    for (uint32_t l = 0; l < program->laneCount; ++l) {
+        mask |= (uint32_t)((values[l] != 0) == instruction->testNonZero) << l;
+    }
+    return mask;
+}
+
+void ComputeShaderLanes(const DecodedInstruction* instruction, uint32_t begin, uint32_t end, const uint32_t* const sources[4],
+                        uint32_t* result, uint32_t* result2)
+{
+    const uint32_t* a = sources[0];
+    const uint32_t* b = sources[1];
+    const uint32_t* d = sources[2];
+    const uint32_t* e = sources[3];
+    uint32_t* r = result;
+    uint32_t* r2 = result2;
+
+    switch (instruction->opcode)
+    {
+#define LANE_LOOP(expression)   for (uint32_t l = begin; l < end; ++l) { r[l] = (expression); } break
+    case OP_ADD:            LANE_LOOP(AsUInt(AsFloat(a[l]) + AsFloat(b[l])));
+    case OP_MUL:            LANE_LOOP(AsUInt(AsFloat(a[l]) * AsFloat(b[l])));
+    case OP_MAD:            LANE_LOOP(AsUInt(AsFloat(a[l]) * AsFloat(b[l]) + AsFloat(d[l])));
+    case OP_DIV:            LANE_LOOP(AsUInt(AsFloat(a[l]) / AsFloat(b[l])));
+    case OP_MIN:            LANE_LOOP(AsUInt(fminf(AsFloat(a[l]), AsFloat(b[l]))));
+    case OP_MAX:            LANE_LOOP(AsUInt(fmaxf(AsFloat(a[l]), AsFloat(b[l]))));
+    case OP_EQ:             LANE_LOOP(AsFloat(a[l]) == AsFloat(b[l]) ? UINT32_MAX : 0);
+    case OP_NE:             LANE_LOOP(AsFloat(a[l]) != AsFloat(b[l]) ? UINT32_MAX : 0);
+    case OP_LT:             LANE_LOOP(AsFloat(a[l]) < AsFloat(b[l]) ? UINT32_MAX : 0);
+    case OP_GE:             LANE_LOOP(AsFloat(a[l]) >= AsFloat(b[l]) ? UINT32_MAX : 0);
+    case OP_FRC:            LANE_LOOP(AsUInt(AsFloat(a[l]) - floorf(AsFloat(a[l]))));
+    case OP_ROUND_NE:       LANE_LOOP(AsUInt(nearbyintf(AsFloat(a[l]))));
+    case OP_ROUND_NI:       LANE_LOOP(AsUInt(floorf(AsFloat(a[l]))));
+    case OP_ROUND_PI:       LANE_LOOP(AsUInt(ceilf(AsFloat(a[l]))));
+    case OP_ROUND_Z:        LANE_LOOP(AsUInt(truncf(AsFloat(a[l]))));
+    case OP_SQRT:           LANE_LOOP(AsUInt(sqrtf(AsFloat(a[l]))));
+    case OP_RSQ:            LANE_LOOP(AsUInt(1.0f / sqrtf(AsFloat(a[l]))));
+    case OP_RCP:            LANE_LOOP(AsUInt(1.0f / AsFloat(a[l])));
+    case OP_FTOI:           LANE_LOOP(FloatToInt(AsFloat(a[l])));
+    case OP_FTOU:           LANE_LOOP(FloatToUInt(AsFloat(a[l])));
+    case OP_ITOF:           LANE_LOOP(AsUInt((float)(int32_t)a[l]));
+    case OP_UTOF:           LANE_LOOP(AsUInt((float)a[l]));
+    case OP_MOV:            LANE_LOOP(a[l]);
+    case OP_MOVC:           LANE_LOOP(a[l] != 0 ? b[l] : d[l]);
+    case OP_IADD:           LANE_LOOP(a[l] + b[l]);
+    case OP_IMAD:
+    case OP_UMAD:           LANE_LOOP(a[l] * b[l] + d[l]);
+    case OP_INEG:           LANE_LOOP(0U - a[l]);
+    case OP_ISHL:           LANE_LOOP(a[l] << (b[l] & 31));
+    case OP_ISHR:           LANE_LOOP((uint32_t)((int32_t)a[l] >> (b[l] & 31)));
+    case OP_USHR:           LANE_LOOP(a[l] >> (b[l] & 31));
+    case OP_AND:            LANE_LOOP(a[l] & b[l]);
+    case OP_OR:             LANE_LOOP(a[l] | b[l]);
+    case OP_XOR:            LANE_LOOP(a[l] ^ b[l]);
+    case OP_NOT:            LANE_LOOP(~a[l]);
+    case OP_IEQ:            LANE_LOOP(a[l] == b[l] ? UINT32_MAX : 0);
+    case OP_INE:            LANE_LOOP(a[l] != b[l] ? UINT32_MAX : 0);
+    case OP_IGE:            LANE_LOOP((int32_t)a[l] >= (int32_t)b[l] ? UINT32_MAX : 0);
+    case OP_ILT:            LANE_LOOP((int32_t)a[l] < (int32_t)b[l] ? UINT32_MAX : 0);
+    case OP_UGE:            LANE_LOOP(a[l] >= b[l] ? UINT32_MAX : 0);
+    case OP_ULT:            LANE_LOOP(a[l] < b[l] ? UINT32_MAX : 0);
+    case OP_IMAX:           LANE_LOOP((int32_t)a[l] > (int32_t)b[l] ? a[l] : b[l]);
+    case OP_IMIN:           LANE_LOOP((int32_t)a[l] < (int32_t)b[l] ? a[l] : b[l]);
+    case OP_UMAX:           LANE_LOOP(a[l] > b[l] ? a[l] : b[l]);
+    case OP_UMIN:           LANE_LOOP(a[l] < b[l] ? a[l] : b[l]);
+    case OP_COUNTBITS:      LANE_LOOP(CountBits(a[l]));
+    case OP_FIRSTBIT_HI:    LANE_LOOP(FirstBitHigh(a[l]));
+    case OP_FIRSTBIT_LO:    LANE_LOOP(FirstBitLow(a[l]));
+    case OP_FIRSTBIT_SHI:   LANE_LOOP(FirstBitHigh((int32_t)a[l] < 0 ? ~a[l] : a[l]));
+    case OP_BFREV:          LANE_LOOP(ReverseBits(a[l]));
+#undef LANE_LOOP
+
+    case OP_IMUL:
+        for (uint32_t l = begin; l < end; ++l)
+        {
+            const int64_t product = (int64_t)(int32_t)a[l] * (int32_t)b[l];
+            r[l] = (uint32_t)((uint64_t)product >> 32);
+            r2[l] = (uint32_t)product;
+        }
+        break;
+
+    case OP_UMUL:
+        for (uint32_t l = begin; l < end; ++l)
+        {
+            const uint64_t product = (uint64_t)a[l] * b[l];
+            r[l] = (uint32_t)(product >> 32);
+            r2[l] = (uint32_t)product;
+        }
+        break;
+
+    case OP_UDIV:
+        // Division by 0 gives ~0 for both the quotient and the remainder
+        for (uint32_t l = begin; l < end; ++l)
+        {
+            r[l] = b[l] != 0 ? a[l] / b[l] : UINT32_MAX;
+            r2[l] = b[l] != 0 ? a[l] % b[l] : UINT32_MAX;
+        }
+        break;
+
+    case OP_UBFE:
+    case OP_IBFE:
+        // width, offset, value
+        for (uint32_t l = begin; l < end; ++l)
+        {
+            const uint32_t width = a[l] & 31, offset = b[l] & 31;
+            if (width == 0) {
+                r[l] = 0;
+            }
+            else if (width + offset < 32)
+            {
+                r[l] = instruction->opcode == OP_UBFE ? (d[l] << (32 - width - offset)) >> (32 - width) :
+                        (uint32_t)((int32_t)(d[l] << (32 - width - offset)) >> (32 - width));
+            }
+            else {
+                r[l] = instruction->opcode == OP_UBFE ? d[l] >> offset : (uint32_t)((int32_t)d[l] >> offset);
+            }
+        }
+        break;
+
+    case OP_BFI:
+        // width, offset, inserted bits, base
+        for (uint32_t l = begin; l < end; ++l)
+        {
+            const uint32_t width = a[l] & 31, offset = b[l] & 31;
+            const uint32_t bitMask = ((1U << width) - 1) << offset;
+            r[l] = ((d[l] << offset) & bitMask) | (e[l] & ~bitMask);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void SaturateShaderLanes(uint32_t* values, uint32_t begin, uint32_t end)
+{
+    for (uint32_t l = begin; l < end; ++l)
+    {
+        const float f = AsFloat(values[l]);
+        values[l] = AsUInt(f > 0.0f ? (f < 1.0f ? f : 1.0f) : 0.0f);
+    }
+}
+
+void ComputeShaderDotProductLanes(uint32_t componentCount, uint32_t begin, uint32_t end, const uint32_t* const a[4],
+                                const uint32_t* const b[4], uint32_t* result)
+{
+    // The products are accumulated in component order
+    for (uint32_t l = begin; l < end; ++l) {
+        result[l] = AsUInt(AsFloat(a[0][l]) * AsFloat(b[0][l]));
+    }
+    for (uint32_t c = 1; c < componentCount; ++c) {
+        for (uint32_t l = begin; l < end; ++l) {
+            result[l] = AsUInt(AsFloat(result[l]) + AsFloat(a[c][l]) * AsFloat(b[c][l]));
+        }
+    }
+}
+
+// Execute an arithmetic instruction
+static void ExecuteALU(const GroupContext* context, LaneBatch* batch, const DecodedInstruction* instruction)
+{
+    const uint32_t laneCount = context->program->laneCount;
+    const OpcodeInfo* info = &instruction->info;
+    const bool isFloat = info->opcodeClass == OPCODE_FLOAT;
+
+    // The dot products read the components of their width regardless of the destination mask
+    uint32_t sourceMask = 0;
+    for (uint32_t i = 0; i < info->dstCount; ++i) {
+        sourceMask |= instruction->operands[i].mask;
+    }
+    if (instruction->opcode == OP_DP2) sourceMask = 0x3;
+    if (instruction->opcode == OP_DP3) sourceMask = 0x7;
+    if (instruction->opcode == OP_DP4) sourceMask = 0xf;
+
+    LaneValues sources[4][4];
+    for (uint32_t i = 0; i < info->srcCount; ++i) {
+        FetchSource(context, batch, &instruction->operands[info->dstCount + i], isFloat, sourceMask, sources[i]);
+    }
+
+    LaneValues results[2][4];
+    const bool isDotProduct = instruction->opcode == OP_DP2 || instruction->opcode == OP_DP3 || instruction->opcode == OP_DP4;
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((sourceMask & (1U << c)) == 0) continue;
+
+        if (isDotProduct) continue;
+
+        const uint32_t* const componentSources[4] = { sources[0][c], sources[1][c], sources[2][c], sources[3][c] };
+        ComputeShaderLanes(instruction, 0, laneCount, componentSources, results[0][c], results[1][c]);
+    }
+
+    // The dot products write the same sum to every component
+    if (isDotProduct)
+    {
+        const uint32_t* const a[4] = { sources[0][0], sources[0][1], sources[0][2], sources[0][3] };
+        const uint32_t* const b[4] = { sources[1][0], sources[1][1], sources[1][2], sources[1][3] };
+        ComputeShaderDotProductLanes(instruction->opcode - OP_DP2 + 2, 0, laneCount, a, b, results[0][0]);
+        for (uint32_t c = 1; c < 4; ++c) {
+            memcpy(results[0][c], results[0][0], laneCount * sizeof(uint32_t));
+        }
+    }
+
+    WriteDestination(context, batch, &instruction->operands[0], instruction->saturate, results[0]);
+    if (info->dstCount == 2) {
+        WriteDestination(context, batch, &instruction->operands[1], false, results[1]);
+    }
+}
+
+MemoryView GetShaderMemoryView(const ShaderProgram* program, const ShaderBindings* bindings, uint8_t* groupShared,
+                                const DecodedOperand* operand)
+{
+    const ShaderBufferBinding* binding = NULL;
+    const BufferDeclaration* declaration = NULL;
+    switch (operand->type)
+    {
+    case OPERAND_TGSM:
+    {
+        const GroupSharedDeclaration* sharedDeclaration = &program->groupShared[operand->registerIndex];
+        return (MemoryView){ .data = groupShared + sharedDeclaration->offset, .size = sharedDeclaration->size, .structureStride = sharedDeclaration->structureStride };
+    }
+
+    case OPERAND_RESOURCE:
+        binding = &bindings->resources[operand->registerIndex];
+        declaration = &program->resources[operand->registerIndex];
+        break;
+
+    default:
+        binding = &bindings->uavs[operand->registerIndex];
+        declaration = &program->uavs[operand->registerIndex];
+        break;
+    }
+
+    return (MemoryView){ .data = binding->data, .size = binding->data != NULL ? binding->size : 0, .structureStride = declaration->structureStride };
+}
+
+// The byte offset of a structured element member or of a raw address, or SIZE_MAX if it is out of bounds.
+// A structured member must lie in the element, and the element in the buffer.
+static inline size_t GetMemoryOffset(const MemoryView* memory, uint32_t address, uint32_t byteOffset, uint32_t component)
+{
+    uint64_t offset;
+    if (memory->structureStride != 0)
+    {
+        if ((uint64_t)byteOffset + component * sizeof(uint32_t) + sizeof(uint32_t) > memory->structureStride) return SIZE_MAX;
+        offset = (uint64_t)address * memory->structureStride + byteOffset + component * sizeof(uint32_t);
+    }
+    else {
+        offset = (uint64_t)(address & ~3U) + component * sizeof(uint32_t);
+    }
+
+    return offset + sizeof(uint32_t) <= memory->size ? (size_t)offset : SIZE_MAX;
+}
+
+size_t GetShaderMemoryOffset(const MemoryView* memory, uint32_t address, uint32_t byteOffset, uint32_t component)
+{
+    return GetMemoryOffset(memory, address, byteOffset, component);
+}
+
+void LoadShaderMemoryLanes(const MemoryView* memory, uint32_t begin, uint32_t end, const uint32_t* addresses,
+                            const uint32_t* byteOffsets, uint32_t component, uint32_t* result)
+{
+    for (uint32_t l = begin; l < end; ++l)
+    {
+        const size_t offset = GetMemoryOffset(memory, addresses[l], byteOffsets != NULL ? byteOffsets[l] : 0, component);
+        result[l] = offset != SIZE_MAX ? LoadUInt32(memory->data + offset) : 0;
+    }
+}
+
+void StoreShaderMemoryLanes(const MemoryView* memory, uint32_t begin, uint32_t end, const uint8_t* activeLanes,
+                            const uint32_t* addresses, const uint32_t* byteOffsets, uint32_t componentMask,
+                            const uint32_t* const values[4])
+{
+    // The lanes store in order, and each component of the mask is written to the next dword
+    for (uint32_t l = begin; l < end; ++l)
+    {
+        if (activeLanes != NULL && activeLanes[l] == 0) continue;
+
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if ((componentMask & (1U << c)) == 0) continue;
+
+            const size_t offset = GetMemoryOffset(memory, addresses[l], byteOffsets != NULL ? byteOffsets[l] : 0, c);
+            if (offset != SIZE_MAX) {
+                StoreUInt32(memory->data + offset, values[c][l]);
+            }
+        }
+    }
+}
+
+static void ExecuteLoad(const GroupContext* context, LaneBatch* batch, const DecodedInstruction* instruction)
+{
+    const uint32_t laneCount = context->program->laneCount;
+    const bool isStructured = instruction->opcode == OP_LD_STRUCTURED;
+    const DecodedOperand* memoryOperand = &instruction->operands[isStructured ? 3 : 2];
+    const MemoryView memory = GetShaderMemoryView(context->program, context->bindings, context->groupShared, memoryOperand);
+
+    LaneValues addresses[4], byteOffsets[4];
+    FetchSource(context, batch, &instruction->operands[1], false, 0x1, addresses);
+    if (isStructured) {
+        FetchSource(context, batch, &instruction->operands[2], false, 0x1, byteOffsets);
+    }
+    else {
+        memset(byteOffsets[0], 0, sizeof(byteOffsets[0]));
+    }
+
+    // The swizzle of the memory operand selects the loaded components
+    LaneValues results[4];
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((instruction->operands[0].mask & (1U << c)) == 0) continue;
+
+        LoadShaderMemoryLanes(&memory, 0, laneCount, addresses[0], byteOffsets[0], memoryOperand->swizzle[c], results[c]);
+    }
+
+    WriteDestination(context, batch, &instruction->operands[0], false, results);
+}
+
+static void ExecuteStore(const GroupContext* context, LaneBatch* batch, const DecodedInstruction* instruction)
+{
+    const uint32_t laneCount = context->program->laneCount;
+    const bool isStructured = instruction->opcode == OP_STORE_STRUCTURED;
+    const DecodedOperand* memoryOperand = &instruction->operands[0];
+    const MemoryView memory = GetShaderMemoryView(context->program, context->bindings, context->groupShared, memoryOperand);
+
+    LaneValues addresses[4], byteOffsets[4], values[4];
+    FetchSource(context, batch, &instruction->operands[1], false, 0x1, addresses);
+    if (isStructured) {
+        FetchSource(context, batch, &instruction->operands[2], false, 0x1, byteOffsets);
+    }
+    else {
+        memset(byteOffsets[0], 0, sizeof(byteOffsets[0]));
+    }
+    FetchSource(context, batch, &instruction->operands[isStructured ? 3 : 2], false, memoryOperand->mask, values);
+
+    uint8_t activeLanes[SHADER_INTERPRETER_MAX_LANE_COUNT];
+    for (uint32_t l = 0; l < laneCount; ++l) {
+        activeLanes[l] = (uint8_t)((batch->activeMask >> l) & 1U);
+    }
+    const uint32_t* const componentValues[4] = { values[0], values[1], values[2], values[3] };
+    StoreShaderMemoryLanes(&memory, 0, laneCount, activeLanes, addresses[0], byteOffsets[0], memoryOperand->mask, componentValues);
+}
+
+static void ExecuteBufferInfo(const GroupContext* context, LaneBatch* batch, const DecodedInstruction* instruction)
+{
+    const uint32_t laneCount = context->program->laneCount;
+    const MemoryView memory = GetShaderMemoryView(context->program, context->bindings, context->groupShared, &instruction->operands[1]);
+
+    // The element count of a structured buffer, or the byte size of a raw buffer
+    const size_t value = memory.structureStride != 0 ? memory.size / memory.structureStride : memory.size;
+    LaneValues results[4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        for (uint32_t l = 0; l < laneCount; ++l) {
+            results[c][l] = value <= UINT32_MAX ? (uint32_t)value : UINT32_MAX;
+        }
+    }
+
+    WriteDestination(context, batch, &instruction->operands[0], false, results);
+}
+
+uint32_t ApplyShaderAtomicOperation(uint32_t opcode, uint32_t* target, bool isShared, uint32_t operand, uint32_t compareValue)
+{
+    uint32_t original = *target;
+    for (;;)
+    {
+        uint32_t value;
+        switch (opcode)
+        {
+        case OP_ATOMIC_AND:
+        case OP_IMM_ATOMIC_AND:     value = original & operand; break;
+        case OP_ATOMIC_OR:
+        case OP_IMM_ATOMIC_OR:      value = original | operand; break;
+        case OP_ATOMIC_XOR:
+        case OP_IMM_ATOMIC_XOR:     value = original ^ operand; break;
+        case OP_ATOMIC_IADD:
+        case OP_IMM_ATOMIC_IADD:    value = original + operand; break;
+        case OP_ATOMIC_IMAX:
+        case OP_IMM_ATOMIC_IMAX:    value = (int32_t)original > (int32_t)operand ? original : operand; break;
+        case OP_ATOMIC_IMIN:
+        case OP_IMM_ATOMIC_IMIN:    value = (int32_t)original < (int32_t)operand ? original : operand; break;
+        case OP_ATOMIC_UMAX:
+        case OP_IMM_ATOMIC_UMAX:    value = original > operand ? original : operand; break;
+        case OP_ATOMIC_UMIN:
+        case OP_IMM_ATOMIC_UMIN:    value = original < operand ? original : operand; break;
+        case OP_IMM_ATOMIC_EXCH:    value = operand; break;
+        default:                    value = original == compareValue ? operand : original; break;
+        }
+
+        if (!isShared)
+        {
+            *target = value;
+            return original;
+        }
+
+        const uint32_t observed = AtomicCompareExchangeUInt32(target, original, value);
+        if (observed == original) return original;
+        original = observed;
+    }
+}
+
+static void ExecuteAtomic(const GroupContext* context, LaneBatch* batch, const DecodedInstruction* instruction)
+{
+    const uint32_t laneCount = context->program->laneCount;
+    const OpcodeInfo* info = &instruction->info;
+    const DecodedOperand* memoryOperand = &instruction->operands[info->dstCount - 1];
+    const MemoryView memory = GetShaderMemoryView(context->program, context->bindings, context->groupShared, memoryOperand);
+    const bool isShared = memoryOperand->type == OPERAND_UAV;
+    const bool hasCompareValue = instruction->opcode == OP_ATOMIC_CMP_STORE || instruction->opcode == OP_IMM_ATOMIC_CMP_EXCH;
+
+    // The address of a structured buffer is the element index and the byte offset
+    LaneValues addresses[4], compareValues[4], values[4];
+    FetchSource(context, batch, &instruction->operands[info->dstCount], false, memory.structureStride != 0 ? 0x3 : 0x1, addresses);
+    if (hasCompareValue) {
+        FetchSource(context, batch, &instruction->operands[info->dstCount + 1], false, 0x1, compareValues);
+    }
+    FetchSource(context, batch, &instruction->operands[instruction->operandCount - 1], false, 0x1, values);
+
+    LaneValues results[4] = { { 0 } };
+    for (uint32_t l = 0; l < laneCount; ++l)
+    {
+        if ((batch->activeMask & (1U << l)) == 0) continue;
+
+        const size_t offset = GetMemoryOffset(&memory, addresses[0][l], memory.structureStride != 0 ? addresses[1][l] : 0, 0);
+        if (offset == SIZE_MAX) continue;
+
+        results[0][l] = ApplyShaderAtomicOperation(instruction->opcode, (uint32_t*)(memory.data + offset), isShared, values[0][l],
+                                            hasCompareValue ? compareValues[0][l] : 0);
+    }
+
+    if (info->dstCount == 2)
+    {
+        for (uint32_t c = 1; c < 4; ++c) {
+            memcpy(results[c], results[0], laneCount * sizeof(uint32_t));
+        }
+        WriteDestination(context, batch, &instruction->operands[0], false, results);
+    }
+}
+
+// The lanes of the innermost loop and of the whole batch that have stopped executing the current block
+static inline uint32_t GetInactiveLanes(const LaneBatch* batch)
+{
+    return batch->retiredMask | batch->breakMask | batch->continueMask;
+}
+
+// Execute the batch until it reaches a group barrier or returns.
+// Returns true at a barrier, and false when the batch has finished.
+static bool ExecuteLaneBatch(const GroupContext* context, LaneBatch* batch)
+{
+    const ShaderProgram* program = context->program;
+
+    while (batch->pc < program->instructionCount)
+    {
+        const DecodedInstruction* instruction = &program->instructions[batch->pc];
+        const OpcodeInfo* info = &instruction->info;
+        ++batch->pc;
+
+        if (info->opcodeClass != OPCODE_CONTROL_FLOW)
+        {
+            // The blocks that no lane executes are only walked through
+            if (batch->activeMask == 0) continue;
+
+            if (info->opcodeClass != OPCODE_MEMORY) {
+                ExecuteALU(context, batch, instruction);
+            }
+            else if (instruction->opcode == OP_LD_STRUCTURED || instruction->opcode == OP_LD_RAW) {
+                ExecuteLoad(context, batch, instruction);
+            }
+            else if (instruction->opcode == OP_STORE_STRUCTURED || instruction->opcode == OP_STORE_RAW) {
+                ExecuteStore(context, batch, instruction);
+            }
+            else if (instruction->opcode == OP_BUFINFO) {
+                ExecuteBufferInfo(context, batch, instruction);
+            }
+            else {
+                ExecuteAtomic(context, batch, instruction);
+            }
+            continue;
+        }
+
+        uint32_t conditionLanes = 0;
+        if (info->srcCount == 1 && batch->activeMask != 0)
+        {
+            LaneValues condition[4];
+            FetchSource(context, batch, &instruction->operands[0], false, 0x1, condition);
+            conditionLanes = TestLanes(program, instruction, condition[0]) & batch->activeMask;
+        }
+
+        switch (instruction->opcode)
+        {
+        case OP_IF:
+        {
+            // A block entered by no lane is skipped as a whole
+            if (batch->activeMask == 0)
+            {
+                batch->pc = instruction->endTarget + 1;
+                break;
+            }
+
+            batch->controlFlow[batch->controlFlowDepth++] = (ControlFlowEntry){
+                .kind = CONTROL_FLOW_IF,
+                .outerMask = batch->activeMask,
+                .elseMask = batch->activeMask & ~conditionLanes
+            };
+            batch->activeMask = conditionLanes;
+            if (batch->activeMask == 0) {
+                batch->pc = instruction->jumpTarget;
+            }
+            break;
+        }
+
+        case OP_ELSE:
+        {
+            const ControlFlowEntry* entry = &batch->controlFlow[batch->controlFlowDepth - 1];
+            batch->activeMask = entry->elseMask & ~GetInactiveLanes(batch);
+            if (batch->activeMask == 0) {
+                batch->pc = instruction->jumpTarget;
+            }
+            break;
+        }
+
+        case OP_ENDIF:
+        {
+            const ControlFlowEntry* entry = &batch->controlFlow[--batch->controlFlowDepth];
+            batch->activeMask = entry->outerMask & ~GetInactiveLanes(batch);
+            break;
+        }
+
+        case OP_LOOP:
+        {
+            if (batch->activeMask == 0)
+            {
+                batch->pc = instruction->jumpTarget + 1;
+                break;
+            }
+
+            batch->controlFlow[batch->controlFlowDepth++] = (ControlFlowEntry){
+                .kind = CONTROL_FLOW_LOOP,
+                .outerMask = batch->activeMask,
+                .savedBreakMask = batch->breakMask,
+                .savedContinueMask = batch->continueMask
+            };
+            batch->breakMask = 0;
+            batch->continueMask = 0;
+            break;
+        }
+
+        case OP_ENDLOOP:
+        {
+            // The lanes that continued rejoin the next iteration, and the loop ends when all the lanes have left it
+            const ControlFlowEntry* entry = &batch->controlFlow[batch->controlFlowDepth - 1];
+            batch->continueMask = 0;
+            batch->activeMask = entry->outerMask & ~batch->breakMask & ~batch->retiredMask;
+            if (batch->activeMask != 0)
+            {
+                batch->pc = instruction->jumpTarget + 1;
+                break;
+            }
+
+            batch->activeMask = entry->outerMask & ~batch->retiredMask;
+            batch->breakMask = entry->savedBreakMask;
+            batch->continueMask = entry->savedContinueMask;
+            --batch->controlFlowDepth;
+            break;
+        }
+
+        case OP_BREAK:
+        case OP_BREAKC:
+        case OP_CONTINUE:
+        case OP_CONTINUEC:
+        {
+            const uint32_t lanes = info->srcCount == 1 ? conditionLanes : batch->activeMask;
+            if (instruction->opcode == OP_BREAK || instruction->opcode == OP_BREAKC) {
+                batch->breakMask |= lanes;
+            }
+            else {
+                batch->continueMask |= lanes;
+            }
+            batch->activeMask &= ~lanes;
+
+            // When no lane of the loop is left, e.g. none waits for an else branch,
+            // the rest of the iteration is skipped up to the endloop of the innermost loop
+            uint32_t loopDepth = batch->controlFlowDepth;
+            while (batch->controlFlow[loopDepth - 1].kind != CONTROL_FLOW_LOOP) {
+                --loopDepth;
+            }
+            if (lanes != 0 && (batch->controlFlow[loopDepth - 1].outerMask & ~GetInactiveLanes(batch)) == 0)
+            {
+                batch->controlFlowDepth = loopDepth;
+                for (uint32_t pc = batch->pc; pc < program->instructionCount; ++pc)
+                {
+                    const DecodedInstruction* candidate = &program->instructions[pc];
+                    if (candidate->opcode == OP_LOOP)
+                    {
+                        pc = candidate->jumpTarget;
+                    }
+                    else if (candidate->opcode == OP_ENDLOOP)
+                    {
+                        batch->pc = pc;
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+
+        case OP_RET:
+        case OP_RETC:
+        {
+            const uint32_t lanes = info->srcCount == 1 ? conditionLanes : batch->activeMask;
+            batch->retiredMask |= lanes;
+            batch->activeMask &= ~lanes;
+            if ((batch->retiredMask & batch->laneMask) == batch->laneMask)
+            {
+                batch->isFinished = true;
+                return false;
+            }
+            break;
+        }
+
+        case OP_SYNC:
+            // The memory fences without a group barrier are implied by the in-order execution
+            if (instruction->syncFlags & SYNC_THREADS_IN_GROUP) return true;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    batch->isFinished = true;
+    return false;
+}
+
+void ExecuteShaderThreadGroup(const ShaderProgram* program, const ShaderBindings* bindings, const uint32_t groupID[3], void* scratch)
+{
+    uint8_t* const scratchBytes = scratch;
+    const GroupContext context = {
+        .program = program,
+        .bindings = bindings,
+        .groupID = { groupID[0], groupID[1], groupID[2] },
+        .groupShared = scratchBytes
+    };
+
+    // The group-shared memory starts zeroed, and the threads are assigned to the lanes in SV_GroupIndex order
+    memset(scratchBytes, 0, program->groupSharedBytes);
+    const uint32_t laneCount = program->laneCount;
+    for (uint32_t b = 0; b < program->batchCount; ++b)
+    {
+        LaneBatch* batch = (LaneBatch*)(scratchBytes + program->batchesOffset + b * program->batchStride);
+        const uint32_t firstThread = b * laneCount;
+        const uint32_t batchLaneCount = program->threadCount - firstThread < laneCount ? program->threadCount - firstThread : laneCount;
+
+        *batch = (LaneBatch){ .laneMask = (uint32_t)((1ULL << batchLaneCount) - 1) };
+        batch->activeMask = batch->laneMask;
+        for (uint32_t l = 0; l < laneCount; ++l)
+        {
+            const uint32_t thread = firstThread + l;
+            batch->threadIndexInGroup[l] = thread;
+            batch->threadIDInGroup[0][l] = thread % program->threadGroupSize[0];
+            batch->threadIDInGroup[1][l] = (thread / program->threadGroupSize[0]) % program->threadGroupSize[1];
+            batch->threadIDInGroup[2][l] = thread / (program->threadGroupSize[0] * program->threadGroupSize[1]);
+        }
+        memset(batch + 1, 0, (size_t)program->tempCount * 4 * laneCount * sizeof(uint32_t));
+    }
+
+    // Every batch runs up to the next group barrier before any of them goes past it
+    for (bool isRunning = true; isRunning; )
+    {
+        isRunning = false;
+        for (uint32_t b = 0; b < program->batchCount; ++b)
+        {
+            LaneBatch* batch = (LaneBatch*)(scratchBytes + program->batchesOffset + b * program->batchStride);
+            if (!batch->isFinished) {
+                isRunning |= ExecuteLaneBatch(&context, batch);
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SHADER_INTERPRETER_H
+#define SHADER_INTERPRETER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The lane counts that one SIMD step of the interpreter can execute
+    SHADER_INTERPRETER_MIN_LANE_COUNT = 4,
+    SHADER_INTERPRETER_MAX_LANE_COUNT = 16,
+
+    // The registers of each class that a dispatch can bind, in register space 0
+    SHADER_INTERPRETER_MAX_CONSTANT_BUFFER_COUNT = 14,
+    SHADER_INTERPRETER_MAX_RESOURCE_COUNT = 16,
+    SHADER_INTERPRETER_MAX_UAV_COUNT = 8
+};
+
+// A Shader Model 5.x compute shader decoded from the SHEX/SHDR part of a DXBC container
+typedef struct ShaderProgram ShaderProgram;
+
+// The memory of a buffer bound to a register. `size` is in bytes, and the accesses beyond it read 0 and write nothing.
+typedef struct ShaderBufferBinding
+{
+    void* data;
+    size_t size;
+} ShaderBufferBinding;
+
+// The buffers of one dispatch, indexed by register. Only the constant buffers and the SRVs are read-only.
+typedef struct ShaderBindings
+{
+    ShaderBufferBinding constantBuffers[SHADER_INTERPRETER_MAX_CONSTANT_BUFFER_COUNT];
+    ShaderBufferBinding resources[SHADER_INTERPRETER_MAX_RESOURCE_COUNT];
+    ShaderBufferBinding uavs[SHADER_INTERPRETER_MAX_UAV_COUNT];
+} ShaderBindings;
+
+// Decode the compute shader of a validated DXBC container, executed `laneCount` (4, 8 or 16) threads at a time.
+// Returns NULL and prints the reason if the shader uses a declaration or an instruction that the interpreter does not support,
+// e.g. a typed resource, a texture or a switch. DXIL containers are not supported.
+extern ShaderProgram* CreateShaderProgram(const void* data, size_t size, uint32_t laneCount);
+
+extern void DestroyShaderProgram(ShaderProgram* program);
+
+// Get [numthreads(x, y, z)] of the program
+extern void GetShaderProgramThreadGroupSize(const ShaderProgram* program, uint32_t threadGroupSize[3]);
+
+// Get the size of the scratch memory that `ExecuteShaderThreadGroup` needs:
+// the registers of all the threads of a group and the group-shared memory
+extern size_t GetShaderProgramScratchSize(const ShaderProgram* program);
+
+// Execute the thread group `groupID` of a dispatch.
+// The threads run `laneCount` at a time in lockstep between the group barriers, with an execution mask for divergent control flow.
+// Different thread groups can be executed concurrently with a scratch memory each.
+extern void ExecuteShaderThreadGroup(const ShaderProgram* program, const ShaderBindings* bindings, const uint32_t groupID[3],
+                                    void* scratch);
+
+#endif // SHADER_INTERPRETER_H
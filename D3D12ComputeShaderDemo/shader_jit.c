@@ -0,0 +1,1975 @@
+// mmap with MAP_ANONYMOUS, which strict C and older POSIX levels do not declare
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SHADER_JIT_X64
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif // _WIN32
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif
+
+#include "shader_jit.h"
+#include "shader_program.h"
+
+#ifdef SHADER_JIT_X64
+enum
+{
+    // The threads of a block, one per 32-bit lane of a YMM register
+    BLOCK_LANE_COUNT = 8,
+    BLOCK_BYTES = BLOCK_LANE_COUNT * sizeof(uint32_t),
+
+    // The machine code, the labels and the jumps that one instruction can need at most
+    MAX_INSTRUCTION_CODE_SIZE = 2048,
+    MAX_INSTRUCTION_LABEL_COUNT = 8,
+    MAX_INSTRUCTION_JUMP_COUNT = 16,
+
+    // The constant vectors and the uniform values that one instruction can add at most
+    MAX_INSTRUCTION_CONSTANT_COUNT = 16,
+    MAX_INSTRUCTION_UNIFORM_COUNT = 16,
+
+    // The two mask slots of each level of control flow
+    FRAME_LEVEL_BYTES = 2 * BLOCK_BYTES,
+
+    // The addresses and the values of the lanes of a store, spilled for the stores one lane after the other
+    SPILL_BYTES = 8 * BLOCK_BYTES,
+
+    // XMM6-XMM15, which the Windows x64 calling convention preserves
+    REGISTER_SAVE_BYTES = 10 * 16,
+
+    SCRATCH_ALIGNMENT = 64
+};
+
+// The general-purpose registers, by encoding
+enum
+{
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R8 = 8,
+    R10 = 10,
+    R14 = 14,
+    R15 = 15,
+
+    // A memory operand without an index register
+    NO_INDEX = 0xff
+};
+
+// The registers of the generated code.
+// r15 holds the scratch memory, r14 the constant pool, and rbx the byte offset of the current block in the lane arrays.
+// ymm0-ymm7 are the sources and the intermediate values of an instruction, ymm8-ymm11 its results by component,
+// ymm12 the execution mask outside of control flow while an outermost if runs, and ymm13-ymm15 hold zero, all the bits set,
+// and the execution mask of the current block.
+enum
+{
+    YMM_RESULT = 8,
+    YMM_OUTER_MASK = 12,
+    YMM_ZERO = 13,
+    YMM_ONES = 14,
+    YMM_MASK = 15
+};
+
+// The condition codes of the jumps
+enum
+{
+    JUMP_ALWAYS = 0,
+    JUMP_IF_CARRY = 0x82,
+    JUMP_IF_NO_CARRY = 0x83,
+    JUMP_IF_ZERO = 0x84,
+    JUMP_IF_NOT_ZERO = 0x85,
+    JUMP_IF_SIGN = 0x88
+};
+
+// The implied prefix and the opcode map of a VEX instruction
+enum
+{
+    PP_NONE = 0,
+    PP_66 = 1,
+    PP_F3 = 2,
+    MAP_0F = 1,
+    MAP_0F38 = 2,
+    MAP_0F3A = 3
+};
+
+#define VEX_OPCODE(pp, map, w, opcode)  ((uint32_t)(pp) | ((uint32_t)(map) << 2) | ((uint32_t)(w) << 4) | ((uint32_t)(opcode) << 8))
+
+// The AVX and AVX2 instructions that the translation emits
+enum
+{
+    VMOVDQU_LOAD = VEX_OPCODE(PP_F3, MAP_0F, 0, 0x6F),
+    VMOVDQU_STORE = VEX_OPCODE(PP_F3, MAP_0F, 0, 0x7F),
+    VMOVDQA = VEX_OPCODE(PP_66, MAP_0F, 0, 0x6F),
+    VMOVD_TO_GPR = VEX_OPCODE(PP_66, MAP_0F, 0, 0x7E),
+    VMOVMSKPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x50),
+    VPBROADCASTD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x58),
+    VPGATHERDD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x90),
+    VPTEST = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x17),
+    VPBLENDVB = VEX_OPCODE(PP_66, MAP_0F3A, 0, 0x4C),
+
+    VPADDD = VEX_OPCODE(PP_66, MAP_0F, 0, 0xFE),
+    VPSUBD = VEX_OPCODE(PP_66, MAP_0F, 0, 0xFA),
+    VPMULLD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x40),
+    VPAND = VEX_OPCODE(PP_66, MAP_0F, 0, 0xDB),
+    VPANDN = VEX_OPCODE(PP_66, MAP_0F, 0, 0xDF),
+    VPOR = VEX_OPCODE(PP_66, MAP_0F, 0, 0xEB),
+    VPXOR = VEX_OPCODE(PP_66, MAP_0F, 0, 0xEF),
+    VPCMPEQD = VEX_OPCODE(PP_66, MAP_0F, 0, 0x76),
+    VPCMPGTD = VEX_OPCODE(PP_66, MAP_0F, 0, 0x66),
+    VPMAXSD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x3D),
+    VPMINSD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x39),
+    VPMAXUD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x3F),
+    VPMINUD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x3B),
+    VPSLLVD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x47),
+    VPSRLVD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x45),
+    VPSRAVD = VEX_OPCODE(PP_66, MAP_0F38, 0, 0x46),
+
+    // The shifts by an immediate, with the operation in the reg field of ModRM
+    VPSHIFTD_IMMEDIATE = VEX_OPCODE(PP_66, MAP_0F, 0, 0x72),
+    SHIFT_RIGHT_LOGICAL = 2,
+    SHIFT_RIGHT_ARITHMETIC = 4,
+    SHIFT_LEFT = 6,
+
+    VADDPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x58),
+    VMULPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x59),
+    VSUBPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x5C),
+    VDIVPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x5E),
+    VMINPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x5D),
+    VMAXPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x5F),
+    VSQRTPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x51),
+    VCMPPS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0xC2),
+    VCVTDQ2PS = VEX_OPCODE(PP_NONE, MAP_0F, 0, 0x5B),
+    VCVTTPS2DQ = VEX_OPCODE(PP_F3, MAP_0F, 0, 0x5B),
+    VROUNDPS = VEX_OPCODE(PP_66, MAP_0F3A, 0, 0x08),
+
+    // The predicates of vcmpps that match the C comparisons, which are false for NaN except !=
+    CMP_EQ_OQ = 0x00,
+    CMP_ORD_Q = 0x07,
+    CMP_NEQ_UQ = 0x04,
+    CMP_LT_OQ = 0x11,
+    CMP_GE_OQ = 0x1D,
+
+    // The rounding modes of vroundps, without the precision exception
+    ROUND_NEAREST = 0x08,
+    ROUND_DOWN = 0x09,
+    ROUND_UP = 0x0A,
+    ROUND_TRUNCATE = 0x0B
+};
+
+// The values that the code reads from the scratch memory, filled for each group
+typedef enum UniformKind
+{
+    UNIFORM_CONSTANT,
+    UNIFORM_GROUP_ID,
+    UNIFORM_THREAD_ID_BASE,
+    UNIFORM_MEMORY_DATA,
+    UNIFORM_MEMORY_LIMIT
+} UniformKind;
+
+typedef struct NativeUniform
+{
+    uint8_t kind;
+
+    // The register of a constant buffer, a resource or a UAV
+    uint8_t operandType;
+    uint32_t registerIndex;
+
+    // CONSTANT: the component of the 16-byte element `element`, GROUP_ID and THREAD_ID_BASE: the component of the group ID.
+    // MEMORY_LIMIT: `element` is the end of the accessed dword in its element, and `stride` the element size.
+    uint32_t component;
+    uint32_t element;
+    uint32_t stride;
+} NativeUniform;
+
+// A memory operand: [base + index * scale + displacement]. The index of a VSIB address is a YMM register.
+typedef struct MemoryOperand
+{
+    uint8_t base;
+    uint8_t index;
+    uint8_t scale;
+    int32_t displacement;
+} MemoryOperand;
+
+typedef struct CodeBuffer
+{
+    uint8_t* bytes;
+    size_t size;
+    size_t capacity;
+
+    // The code offset of each label, and the rel32 fields of the jumps to them
+    uint32_t* labels;
+    uint32_t labelCount;
+    uint32_t labelCapacity;
+    uint32_t* jumpOffsets;
+    uint32_t* jumpLabels;
+    uint32_t jumpCount;
+    uint32_t jumpCapacity;
+
+    bool hasOverflowed;
+} CodeBuffer;
+
+// An open if or loop
+typedef struct ControlBlock
+{
+    uint16_t opcode;
+
+    // if: the outer mask and the lanes of the else branch, loop: the lanes that have left the loop, and the ones that continue it
+    int32_t frameOffset;
+
+    uint32_t elseLabel;
+    uint32_t endLabel;
+    uint32_t loopLabel;
+} ControlBlock;
+
+typedef struct Translation
+{
+    const ShaderProgram* program;
+    uint32_t laneCount;
+    CodeBuffer code;
+
+    // The constant pool: the lane arrays, then vectors of 8 dwords
+    uint32_t* constants;
+    uint32_t constantCount;
+    uint32_t constantCapacity;
+    uint32_t laneArraysEnd;
+
+    NativeUniform* uniforms;
+    uint32_t uniformCount;
+    uint32_t uniformCapacity;
+
+    ControlBlock blocks[MAX_CONTROL_FLOW_DEPTH];
+    uint32_t depth;
+
+    // The temp component (register * 4 + component) that each result register still holds, or -1.
+    // A source that was just written is then moved from its register instead of being loaded again.
+    // It is only kept in straight-line code: the control flow merges paths where the registers hold different values.
+    int32_t resultTemps[4];
+
+    // Whether a thread can return before the end of the program, so that each block keeps the lanes that have returned
+    bool hasReturn;
+
+    // The start and the end of the code of the current block, and the end of the loop over the blocks of the phase
+    uint32_t blockLabel;
+    uint32_t blockEndLabel;
+    uint32_t phaseEndLabel;
+
+    // The offset of the `mov r14, imm64` operand, which is patched with the final address of the constant pool
+    size_t constantPoolPatch;
+
+    // The layout of the scratch memory
+    int32_t tempsOffset;
+    int32_t retiredOffset;
+    int32_t frameOffset;
+    int32_t spillOffset;
+    int32_t registerSaveOffset;
+    int32_t uniformsOffset;
+
+    // The offsets of the lane arrays in the constant pool: SV_GroupThreadID, SV_GroupIndex, the lanes of the threads of the group
+    int32_t threadIDOffsets[3];
+    int32_t threadIndexOffset;
+    int32_t validLanesOffset;
+    int32_t laneIndicesOffset;
+} Translation;
+
+typedef void (*NativeFunction)(void* scratch);
+#endif // SHADER_JIT_X64
+
+struct NativeShader
+{
+#ifdef SHADER_JIT_X64
+    NativeFunction function;
+    void* code;
+    size_t codeSize;
+
+    // The lane arrays and the constant vectors that the code reads
+    uint32_t* constants;
+
+    // The values that are written to the scratch memory for each group
+    NativeUniform* uniforms;
+    uint32_t uniformCount;
+    size_t uniformsOffset;
+
+    uint32_t threadGroupSize[3];
+    uint32_t groupSharedBytes;
+    uint32_t laneCount;
+
+    // The lanes that have returned are cleared at the start of each group
+    bool hasReturn;
+    size_t retiredOffset;
+#endif // SHADER_JIT_X64
+
+    size_t scratchSize;
+};
+
+#ifdef SHADER_JIT_X64
+// ---- Encoding ----
+
+static MemoryOperand Address(uint32_t base, int32_t displacement)
+{
+    return (MemoryOperand){ .base = (uint8_t)base, .index = NO_INDEX, .scale = 1, .displacement = displacement };
+}
+
+static MemoryOperand IndexedAddress(uint32_t base, uint32_t index, uint32_t scale, int32_t displacement)
+{
+    return (MemoryOperand){ .base = (uint8_t)base, .index = (uint8_t)index, .scale = (uint8_t)scale, .displacement = displacement };
+}
+
+static void EmitByte(CodeBuffer* code, uint32_t value)
+{
+    if (code->size >= code->capacity)
+    {
+        code->hasOverflowed = true;
+        return;
+    }
+    code->bytes[code->size++] = (uint8_t)value;
+}
+
+static void EmitUInt32(CodeBuffer* code, uint32_t value)
+{
+    for (uint32_t i = 0; i < 4; ++i) {
+        EmitByte(code, value >> (8 * i));
+    }
+}
+
+static void EmitModRMRegister(CodeBuffer* code, uint32_t reg, uint32_t rm)
+{
+    EmitByte(code, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+// ModRM, then SIB and the displacement if the address needs them
+static void EmitModRMMemory(CodeBuffer* code, uint32_t reg, const MemoryOperand* memory)
+{
+    const uint32_t base = memory->base & 7;
+    const bool hasIndex = memory->index != NO_INDEX;
+    const bool isShortDisplacement = memory->displacement >= -128 && memory->displacement <= 127;
+
+    // rbp and r13 have no form without a displacement
+    const uint32_t mod = memory->displacement == 0 && base != RBP ? 0 : (isShortDisplacement ? 1 : 2);
+    if (!hasIndex && base != RSP) {
+        EmitByte(code, mod << 6 | (reg & 7) << 3 | base);
+    }
+    else
+    {
+        const uint32_t scaleBits = memory->scale == 8 ? 3 : (memory->scale == 4 ? 2 : (memory->scale == 2 ? 1 : 0));
+        EmitByte(code, mod << 6 | (reg & 7) << 3 | RSP);
+        EmitByte(code, scaleBits << 6 | (hasIndex ? (memory->index & 7) : RSP) << 3 | base);
+    }
+
+    if (mod == 1) {
+        EmitByte(code, (uint32_t)memory->displacement);
+    }
+    else if (mod == 2) {
+        EmitUInt32(code, (uint32_t)memory->displacement);
+    }
+}
+
+// The 2-byte VEX prefix when it can encode the instruction, or the 3-byte one, then the opcode.
+// `source` is the extra source register of VEX.vvvv, 0 for the instructions that have none.
+static void EmitVEX(CodeBuffer* code, uint32_t opcode, bool is256, uint32_t reg, uint32_t source, uint32_t index, uint32_t base)
+{
+    const uint32_t pp = opcode & 3, map = (opcode >> 2) & 3, w = (opcode >> 4) & 1;
+    const uint32_t r = (~reg >> 3) & 1, x = (~index >> 3) & 1, b = (~base >> 3) & 1;
+    const uint32_t vvvv = ~source & 15, l = is256 ? 1 : 0;
+    if (map == MAP_0F && w == 0 && x == 1 && b == 1)
+    {
+        EmitByte(code, 0xC5);
+        EmitByte(code, r << 7 | vvvv << 3 | l << 2 | pp);
+    }
+    else
+    {
+        EmitByte(code, 0xC4);
+        EmitByte(code, r << 7 | x << 6 | b << 5 | map);
+        EmitByte(code, w << 7 | vvvv << 3 | l << 2 | pp);
+    }
+    EmitByte(code, opcode >> 8);
+}
+
+static void EmitVexRegister(CodeBuffer* code, uint32_t opcode, bool is256, uint32_t reg, uint32_t source, uint32_t rm)
+{
+    EmitVEX(code, opcode, is256, reg, source, 0, rm);
+    EmitModRMRegister(code, reg, rm);
+}
+
+static void EmitVexMemory(CodeBuffer* code, uint32_t opcode, bool is256, uint32_t reg, uint32_t source, const MemoryOperand* memory)
+{
+    EmitVEX(code, opcode, is256, reg, source, memory->index != NO_INDEX ? memory->index : 0, memory->base);
+    EmitModRMMemory(code, reg, memory);
+}
+
+// dst = op(a, b) on YMM registers
+static void EmitYmm(CodeBuffer* code, uint32_t opcode, uint32_t dst, uint32_t a, uint32_t b)
+{
+    EmitVexRegister(code, opcode, true, dst, a, b);
+}
+
+// dst = op(a, [memory])
+static void EmitYmmMemory(CodeBuffer* code, uint32_t opcode, uint32_t dst, uint32_t a, MemoryOperand memory)
+{
+    EmitVexMemory(code, opcode, true, dst, a, &memory);
+}
+
+static void EmitYmmImmediate(CodeBuffer* code, uint32_t opcode, uint32_t dst, uint32_t a, uint32_t b, uint32_t immediate)
+{
+    EmitYmm(code, opcode, dst, a, b);
+    EmitByte(code, immediate);
+}
+
+static void EmitYmmLoad(CodeBuffer* code, uint32_t dst, MemoryOperand memory)
+{
+    EmitVexMemory(code, VMOVDQU_LOAD, true, dst, 0, &memory);
+}
+
+static void EmitYmmStore(CodeBuffer* code, MemoryOperand memory, uint32_t src)
+{
+    EmitVexMemory(code, VMOVDQU_STORE, true, src, 0, &memory);
+}
+
+// dst = mask ? b : a, by the sign bit of each byte of `mask`
+static void EmitBlend(CodeBuffer* code, uint32_t dst, uint32_t a, uint32_t b, uint32_t mask)
+{
+    EmitYmm(code, VPBLENDVB, dst, a, b);
+    EmitByte(code, mask << 4);
+}
+
+static void EmitShiftImmediate(CodeBuffer* code, uint32_t operation, uint32_t dst, uint32_t src, uint32_t count)
+{
+    EmitVexRegister(code, VPSHIFTD_IMMEDIATE, true, operation, dst, src);
+    EmitByte(code, count);
+}
+
+// ZF is set if a & b is 0, CF if b & ~a is 0
+static void EmitTest(CodeBuffer* code, uint32_t a, uint32_t b)
+{
+    EmitVexRegister(code, VPTEST, true, a, 0, b);
+}
+
+// The REX prefix, if the instruction needs one
+static void EmitREX(CodeBuffer* code, bool isWide, uint32_t reg, uint32_t index, uint32_t base)
+{
+    const uint32_t rex = 0x40 | (isWide ? 8 : 0) | ((reg >> 3) & 1) << 2 | ((index >> 3) & 1) << 1 | ((base >> 3) & 1);
+    if (rex != 0x40) {
+        EmitByte(code, rex);
+    }
+}
+
+// A general-purpose instruction with a memory operand. A 2-byte opcode is given as 0x0Fxx.
+static void EmitGprMemory(CodeBuffer* code, bool isWide, uint32_t opcode, uint32_t reg, MemoryOperand memory)
+{
+    EmitREX(code, isWide, reg, memory.index != NO_INDEX ? memory.index : 0, memory.base);
+    if (opcode > 0xFF) {
+        EmitByte(code, opcode >> 8);
+    }
+    EmitByte(code, opcode & 0xFF);
+    EmitModRMMemory(code, reg, &memory);
+}
+
+static void EmitGprRegister(CodeBuffer* code, bool isWide, uint32_t opcode, uint32_t reg, uint32_t rm)
+{
+    EmitREX(code, isWide, reg, 0, rm);
+    if (opcode > 0xFF) {
+        EmitByte(code, opcode >> 8);
+    }
+    EmitByte(code, opcode & 0xFF);
+    EmitModRMRegister(code, reg, rm);
+}
+
+static void EmitPush(CodeBuffer* code, uint32_t reg)
+{
+    EmitREX(code, false, 0, 0, reg);
+    EmitByte(code, 0x50 + (reg & 7));
+}
+
+static void EmitPop(CodeBuffer* code, uint32_t reg)
+{
+    EmitREX(code, false, 0, 0, reg);
+    EmitByte(code, 0x58 + (reg & 7));
+}
+
+static uint32_t CreateLabel(CodeBuffer* code)
+{
+    if (code->labelCount >= code->labelCapacity)
+    {
+        code->hasOverflowed = true;
+        return 0;
+    }
+    code->labels[code->labelCount] = UINT32_MAX;
+    return code->labelCount++;
+}
+
+static void BindLabel(CodeBuffer* code, uint32_t label)
+{
+    code->labels[label] = (uint32_t)code->size;
+}
+
+// A jump with a 32-bit displacement, which is resolved once all the labels are bound
+static void EmitJump(CodeBuffer* code, uint32_t condition, uint32_t label)
+{
+    if (condition == JUMP_ALWAYS) {
+        EmitByte(code, 0xE9);
+    }
+    else
+    {
+        EmitByte(code, 0x0F);
+        EmitByte(code, condition);
+    }
+
+    if (code->jumpCount >= code->jumpCapacity)
+    {
+        code->hasOverflowed = true;
+        return;
+    }
+    code->jumpOffsets[code->jumpCount] = (uint32_t)code->size;
+    code->jumpLabels[code->jumpCount++] = label;
+    EmitUInt32(code, 0);
+}
+
+static bool ResolveJumps(CodeBuffer* code)
+{
+    if (code->hasOverflowed) return false;
+
+    for (uint32_t i = 0; i < code->jumpCount; ++i)
+    {
+        const uint32_t target = code->labels[code->jumpLabels[i]];
+        if (target == UINT32_MAX) return false;
+
+        const uint32_t displacement = target - (code->jumpOffsets[i] + 4);
+        memcpy(code->bytes + code->jumpOffsets[i], &displacement, sizeof(displacement));
+    }
+    return true;
+}
+
+// ---- Translation ----
+
+// Add a vector of 8 copies of `value` to the constant pool, and return its offset
+static int32_t AddConstantVector(Translation* translation, uint32_t value)
+{
+    for (uint32_t i = translation->laneArraysEnd; i < translation->constantCount; i += BLOCK_LANE_COUNT) {
+        if (translation->constants[i] == value) return (int32_t)(i * sizeof(uint32_t));
+    }
+
+    if (translation->constantCount + BLOCK_LANE_COUNT > translation->constantCapacity)
+    {
+        translation->code.hasOverflowed = true;
+        return 0;
+    }
+
+    const uint32_t index = translation->constantCount;
+    for (uint32_t l = 0; l < BLOCK_LANE_COUNT; ++l) {
+        translation->constants[index + l] = value;
+    }
+    translation->constantCount += BLOCK_LANE_COUNT;
+    return (int32_t)(index * sizeof(uint32_t));
+}
+
+// Add a value that is written to the scratch memory for each group, and return its offset
+static int32_t AddUniform(Translation* translation, NativeUniform uniform)
+{
+    for (uint32_t i = 0; i < translation->uniformCount; ++i)
+    {
+        const NativeUniform* other = &translation->uniforms[i];
+        if (other->kind == uniform.kind && other->operandType == uniform.operandType && other->registerIndex == uniform.registerIndex &&
+            other->component == uniform.component && other->element == uniform.element && other->stride == uniform.stride)
+        {
+            return translation->uniformsOffset + (int32_t)(i * sizeof(uint64_t));
+        }
+    }
+
+    if (translation->uniformCount >= translation->uniformCapacity)
+    {
+        translation->code.hasOverflowed = true;
+        return translation->uniformsOffset;
+    }
+    translation->uniforms[translation->uniformCount] = uniform;
+    return translation->uniformsOffset + (int32_t)(translation->uniformCount++ * sizeof(uint64_t));
+}
+
+static void LoadConstant(Translation* translation, uint32_t value, uint32_t ymm)
+{
+    if (value == 0) {
+        EmitYmm(&translation->code, VPXOR, ymm, ymm, ymm);
+    }
+    else {
+        EmitYmmLoad(&translation->code, ymm, Address(R14, AddConstantVector(translation, value)));
+    }
+}
+
+static void BroadcastUniform(Translation* translation, NativeUniform uniform, uint32_t ymm)
+{
+    EmitYmmMemory(&translation->code, VPBROADCASTD, ymm, 0, Address(R15, AddUniform(translation, uniform)));
+}
+
+// The lanes of the current block of a temp component
+static MemoryOperand TempAddress(const Translation* translation, uint32_t registerIndex, uint32_t component)
+{
+    const size_t laneBytes = (size_t)translation->laneCount * sizeof(uint32_t);
+    return IndexedAddress(R15, RBX, 1, translation->tempsOffset + (int32_t)(((size_t)registerIndex * 4 + component) * laneBytes));
+}
+
+static MemoryOperand LaneArrayAddress(int32_t offset)
+{
+    return IndexedAddress(R14, RBX, 1, offset);
+}
+
+static MemoryOperand FrameAddress(const ControlBlock* block, uint32_t slot)
+{
+    return Address(R15, block->frameOffset + (int32_t)(slot * BLOCK_BYTES));
+}
+
+static void ForgetResultTemps(Translation* translation)
+{
+    for (uint32_t c = 0; c < 4; ++c) {
+        translation->resultTemps[c] = -1;
+    }
+}
+
+// Record the temp component that `ymm` holds, -1 for none, if it is a result register
+static void SetResultTemp(Translation* translation, uint32_t ymm, int32_t temp)
+{
+    if (ymm < YMM_RESULT || ymm >= YMM_RESULT + 4) return;
+
+    if (temp >= 0)
+    {
+        for (uint32_t c = 0; c < 4; ++c) {
+            if (translation->resultTemps[c] == temp) translation->resultTemps[c] = -1;
+        }
+    }
+    translation->resultTemps[ymm - YMM_RESULT] = temp;
+}
+
+// Load the component `component` of a source operand into `ymm`, after the swizzle and the modifier
+static bool LoadSource(Translation* translation, const DecodedOperand* operand, uint32_t component, bool isFloat, uint32_t ymm)
+{
+    const ShaderProgram* program = translation->program;
+    CodeBuffer* code = &translation->code;
+    const uint32_t registerComponent = operand->swizzle[component];
+    const int32_t temp = operand->type == OPERAND_TEMP ? (int32_t)(operand->registerIndex * 4 + registerComponent) : -1;
+    switch (operand->type)
+    {
+    case OPERAND_TEMP:
+    {
+        uint32_t c = 0;
+        while (c < 4 && translation->resultTemps[c] != temp) {
+            ++c;
+        }
+        if (c == 4) {
+            EmitYmmLoad(code, ymm, TempAddress(translation, operand->registerIndex, registerComponent));
+        }
+        else if (YMM_RESULT + c != ymm) {
+            EmitYmm(code, VMOVDQA, ymm, 0, YMM_RESULT + c);
+        }
+        break;
+    }
+
+    case OPERAND_IMMEDIATE32:
+        LoadConstant(translation, operand->immediate[component], ymm);
+        break;
+
+    case OPERAND_CONSTANT_BUFFER:
+        if (operand->hasRelativeIndex || operand->registerIndex >= SHADER_INTERPRETER_MAX_CONSTANT_BUFFER_COUNT) return false;
+
+        BroadcastUniform(translation, (NativeUniform){
+            .kind = UNIFORM_CONSTANT, .operandType = OPERAND_CONSTANT_BUFFER, .registerIndex = operand->registerIndex,
+            .component = registerComponent, .element = operand->elementIndex
+        }, ymm);
+        break;
+
+    case OPERAND_IMMEDIATE_CONSTANT_BUFFER:
+        if (operand->hasRelativeIndex) return false;
+
+        LoadConstant(translation, ReadShaderConstant((const uint8_t*)program->immediateConstants,
+                                                    (size_t)program->immediateConstantCount * sizeof(uint32_t), operand->elementIndex,
+                                                    registerComponent), ymm);
+        break;
+
+    case OPERAND_THREAD_ID:
+        if (registerComponent >= 3)
+        {
+            LoadConstant(translation, 0, ymm);
+            break;
+        }
+        BroadcastUniform(translation, (NativeUniform){ .kind = UNIFORM_THREAD_ID_BASE, .component = registerComponent }, ymm);
+        EmitYmmMemory(code, VPADDD, ymm, ymm, LaneArrayAddress(translation->threadIDOffsets[registerComponent]));
+        break;
+
+    case OPERAND_THREAD_GROUP_ID:
+        if (registerComponent >= 3)
+        {
+            LoadConstant(translation, 0, ymm);
+            break;
+        }
+        BroadcastUniform(translation, (NativeUniform){ .kind = UNIFORM_GROUP_ID, .component = registerComponent }, ymm);
+        break;
+
+    case OPERAND_THREAD_ID_IN_GROUP:
+        if (registerComponent >= 3) {
+            LoadConstant(translation, 0, ymm);
+        }
+        else {
+            EmitYmmLoad(code, ymm, LaneArrayAddress(translation->threadIDOffsets[registerComponent]));
+        }
+        break;
+
+    case OPERAND_THREAD_ID_IN_GROUP_FLATTENED:
+        EmitYmmLoad(code, ymm, LaneArrayAddress(translation->threadIndexOffset));
+        break;
+
+    default:
+        LoadConstant(translation, 0, ymm);
+        break;
+    }
+
+    // A float operation flips the sign bit, and an integer operation negates the two's complement value
+    if (operand->modifier & OPERAND_MODIFIER_ABS) {
+        EmitYmmMemory(code, VPAND, ymm, ymm, Address(R14, AddConstantVector(translation, 0x7fffffffU)));
+    }
+    if (operand->modifier & OPERAND_MODIFIER_NEG)
+    {
+        if (isFloat) {
+            EmitYmmMemory(code, VPXOR, ymm, ymm, Address(R14, AddConstantVector(translation, 0x80000000U)));
+        }
+        else {
+            EmitYmm(code, VPSUBD, ymm, YMM_ZERO, ymm);
+        }
+    }
+    SetResultTemp(translation, ymm, operand->modifier == 0 ? temp : -1);
+    return true;
+}
+
+// Write a component to the lanes of a temp register that are active, and keep the written value in `ymm`.
+// Outside of control flow, all the lanes that are not active have returned or are beyond the group, so the whole block is written.
+static void WriteTemp(Translation* translation, uint32_t registerIndex, uint32_t component, uint32_t ymm)
+{
+    CodeBuffer* code = &translation->code;
+    const MemoryOperand target = TempAddress(translation, registerIndex, component);
+    if (translation->depth > 0)
+    {
+        EmitYmmLoad(code, 4, target);
+        EmitBlend(code, ymm, 4, ymm, YMM_MASK);
+    }
+    EmitYmmStore(code, target, ymm);
+    SetResultTemp(translation, ymm, (int32_t)(registerIndex * 4 + component));
+}
+
+// The active lanes whose component 0 of the condition passes the test of `instruction`
+static bool LoadPassingLanes(Translation* translation, const DecodedInstruction* instruction, uint32_t ymm)
+{
+    CodeBuffer* code = &translation->code;
+    if (!LoadSource(translation, &instruction->operands[0], 0, false, 0)) return false;
+
+    EmitYmm(code, VPCMPEQD, 0, 0, YMM_ZERO);
+    EmitYmm(code, instruction->testNonZero ? VPANDN : VPAND, ymm, 0, YMM_MASK);
+    return true;
+}
+
+// Compute the ALU operation `opcode` of the sources in ymm0-ymm3 into `dst`.
+// `shiftCount` is the immediate shift count of a shift, or -1 if it is in ymm1.
+static bool EmitOperation(Translation* translation, uint32_t opcode, uint32_t dst, int32_t shiftCount)
+{
+    CodeBuffer* code = &translation->code;
+    switch (opcode)
+    {
+    case OP_ADD:        EmitYmm(code, VADDPS, dst, 0, 1); break;
+    case OP_MUL:        EmitYmm(code, VMULPS, dst, 0, 1); break;
+    case OP_DIV:        EmitYmm(code, VDIVPS, dst, 0, 1); break;
+    case OP_EQ:         EmitYmmImmediate(code, VCMPPS, dst, 0, 1, CMP_EQ_OQ); break;
+    case OP_NE:         EmitYmmImmediate(code, VCMPPS, dst, 0, 1, CMP_NEQ_UQ); break;
+    case OP_LT:         EmitYmmImmediate(code, VCMPPS, dst, 0, 1, CMP_LT_OQ); break;
+    case OP_GE:         EmitYmmImmediate(code, VCMPPS, dst, 0, 1, CMP_GE_OQ); break;
+    case OP_ROUND_NE:   EmitYmmImmediate(code, VROUNDPS, dst, 0, 0, ROUND_NEAREST); break;
+    case OP_ROUND_NI:   EmitYmmImmediate(code, VROUNDPS, dst, 0, 0, ROUND_DOWN); break;
+    case OP_ROUND_PI:   EmitYmmImmediate(code, VROUNDPS, dst, 0, 0, ROUND_UP); break;
+    case OP_ROUND_Z:    EmitYmmImmediate(code, VROUNDPS, dst, 0, 0, ROUND_TRUNCATE); break;
+    case OP_SQRT:       EmitYmm(code, VSQRTPS, dst, 0, 0); break;
+    case OP_ITOF:       EmitYmm(code, VCVTDQ2PS, dst, 0, 0); break;
+    case OP_MOV:        EmitYmm(code, VMOVDQA, dst, 0, 0); break;
+    case OP_IADD:       EmitYmm(code, VPADDD, dst, 0, 1); break;
+    case OP_INEG:       EmitYmm(code, VPSUBD, dst, YMM_ZERO, 0); break;
+    case OP_AND:        EmitYmm(code, VPAND, dst, 0, 1); break;
+    case OP_OR:         EmitYmm(code, VPOR, dst, 0, 1); break;
+    case OP_XOR:        EmitYmm(code, VPXOR, dst, 0, 1); break;
+    case OP_NOT:        EmitYmm(code, VPXOR, dst, 0, YMM_ONES); break;
+    case OP_IEQ:        EmitYmm(code, VPCMPEQD, dst, 0, 1); break;
+    case OP_ILT:        EmitYmm(code, VPCMPGTD, dst, 1, 0); break;
+    case OP_IMAX:       EmitYmm(code, VPMAXSD, dst, 0, 1); break;
+    case OP_IMIN:       EmitYmm(code, VPMINSD, dst, 0, 1); break;
+    case OP_UMAX:       EmitYmm(code, VPMAXUD, dst, 0, 1); break;
+    case OP_UMIN:       EmitYmm(code, VPMINUD, dst, 0, 1); break;
+
+    // The low 32 bits of the product are the same for both signednesses
+    case OP_IMUL:
+    case OP_UMUL:
+        EmitYmm(code, VPMULLD, dst, 0, 1);
+        break;
+
+    // The product is rounded before the addition, just as the separate C operations
+    case OP_MAD:
+        EmitYmm(code, VMULPS, dst, 0, 1);
+        EmitYmm(code, VADDPS, dst, dst, 2);
+        break;
+
+    case OP_IMAD:
+    case OP_UMAD:
+        EmitYmm(code, VPMULLD, dst, 0, 1);
+        EmitYmm(code, VPADDD, dst, dst, 2);
+        break;
+
+    case OP_FRC:
+        EmitYmmImmediate(code, VROUNDPS, 4, 0, 0, ROUND_DOWN);
+        EmitYmm(code, VSUBPS, dst, 0, 4);
+        break;
+
+    case OP_RSQ:
+        EmitYmm(code, VSQRTPS, 4, 0, 0);
+        LoadConstant(translation, 0x3f800000U, 5);
+        EmitYmm(code, VDIVPS, dst, 5, 4);
+        break;
+
+    case OP_RCP:
+        LoadConstant(translation, 0x3f800000U, 5);
+        EmitYmm(code, VDIVPS, dst, 5, 0);
+        break;
+
+    // The conversion gives INT32_MIN out of range, which is the result below -2^31 only:
+    // it is INT32_MAX from 2^31, and 0 for NaN
+    case OP_FTOI:
+        EmitYmm(code, VCVTTPS2DQ, dst, 0, 0);
+        LoadConstant(translation, 0x4f000000U, 5);
+        EmitYmmImmediate(code, VCMPPS, 4, 0, 5, CMP_GE_OQ);
+        LoadConstant(translation, (uint32_t)INT32_MAX, 5);
+        EmitBlend(code, dst, dst, 5, 4);
+        EmitYmmImmediate(code, VCMPPS, 4, 0, 0, CMP_ORD_Q);
+        EmitYmm(code, VPAND, dst, dst, 4);
+        break;
+
+    case OP_MOVC:
+        EmitYmm(code, VPCMPEQD, 4, 0, YMM_ZERO);
+        EmitBlend(code, dst, 1, 2, 4);
+        break;
+
+    case OP_INE:
+        EmitYmm(code, VPCMPEQD, dst, 0, 1);
+        EmitYmm(code, VPXOR, dst, dst, YMM_ONES);
+        break;
+
+    case OP_IGE:
+        EmitYmm(code, VPCMPGTD, dst, 1, 0);
+        EmitYmm(code, VPXOR, dst, dst, YMM_ONES);
+        break;
+
+    // a >= b when max(a, b) is a, for the unsigned comparisons that AVX2 does not have
+    case OP_UGE:
+        EmitYmm(code, VPMAXUD, 4, 0, 1);
+        EmitYmm(code, VPCMPEQD, dst, 4, 0);
+        break;
+
+    case OP_ULT:
+        EmitYmm(code, VPMAXUD, 4, 0, 1);
+        EmitYmm(code, VPCMPEQD, dst, 4, 0);
+        EmitYmm(code, VPXOR, dst, dst, YMM_ONES);
+        break;
+
+    case OP_ISHL:
+    case OP_ISHR:
+    case OP_USHR:
+    {
+        const uint32_t operation = opcode == OP_ISHL ? SHIFT_LEFT : (opcode == OP_ISHR ? SHIFT_RIGHT_ARITHMETIC : SHIFT_RIGHT_LOGICAL);
+        if (shiftCount >= 0)
+        {
+            EmitShiftImmediate(code, operation, dst, 0, (uint32_t)shiftCount);
+            break;
+        }
+
+        // The count is masked to 5 bits
+        EmitYmmMemory(code, VPAND, 4, 1, Address(R14, AddConstantVector(translation, 31)));
+        EmitYmm(code, opcode == OP_ISHL ? VPSLLVD : (opcode == OP_ISHR ? VPSRAVD : VPSRLVD), dst, 0, 4);
+        break;
+    }
+
+    default:
+        return false;
+    }
+    return true;
+}
+
+static bool TranslateALU(Translation* translation, const DecodedInstruction* instruction)
+{
+    CodeBuffer* code = &translation->code;
+    const OpcodeInfo* info = &instruction->info;
+    const uint32_t opcode = instruction->opcode;
+
+    // Only the low 32 bits of the products have a translation, not the high ones or the other instructions with two destinations
+    uint32_t firstSource = 1;
+    const DecodedOperand* destination = &instruction->operands[0];
+    if (opcode == OP_IMUL || opcode == OP_UMUL)
+    {
+        if (instruction->operands[0].type != OPERAND_NULL) return false;
+
+        destination = &instruction->operands[1];
+        firstSource = 2;
+    }
+    else if (info->dstCount != 1) {
+        return false;
+    }
+    if (destination->type == OPERAND_NULL) return true;
+    if (destination->type != OPERAND_TEMP || info->srcCount > 3) return false;
+
+    // All the components are computed before any of them is written, since a destination can also be a source
+    const bool isFloat = info->opcodeClass == OPCODE_FLOAT;
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((destination->mask & (1U << c)) == 0) continue;
+
+        for (uint32_t s = 0; s < info->srcCount; ++s) {
+            if (!LoadSource(translation, &instruction->operands[firstSource + s], c, isFloat, s)) return false;
+        }
+
+        const DecodedOperand* shiftOperand = &instruction->operands[firstSource + 1];
+        const int32_t shiftCount = shiftOperand->type == OPERAND_IMMEDIATE32 && shiftOperand->modifier == 0 ? (int32_t)(shiftOperand->immediate[c] & 31) : -1;
+        SetResultTemp(translation, YMM_RESULT + c, -1);
+        if (!EmitOperation(translation, opcode, YMM_RESULT + c, shiftCount)) return false;
+
+        // The NaNs saturate to 0: vmaxps returns its second source if the first one is NaN
+        if (instruction->saturate)
+        {
+            LoadConstant(translation, 0x3f800000U, 5);
+            EmitYmm(code, VMAXPS, YMM_RESULT + c, YMM_RESULT + c, YMM_ZERO);
+            EmitYmm(code, VMINPS, YMM_RESULT + c, YMM_RESULT + c, 5);
+        }
+    }
+
+    for (uint32_t c = 0; c < 4; ++c) {
+        if (destination->mask & (1U << c)) {
+            WriteTemp(translation, destination->registerIndex, c, YMM_RESULT + c);
+        }
+    }
+    return true;
+}
+
+// How a load or a store addresses its memory
+typedef struct MemoryAccess
+{
+    const DecodedOperand* operand;
+
+    // 0 for a raw buffer
+    uint32_t structureStride;
+    uint32_t byteOffset;
+
+    // The group-shared memory has its bounds known at translation
+    bool isGroupShared;
+    uint32_t groupSharedOffset;
+    uint32_t groupSharedSize;
+} MemoryAccess;
+
+static bool GetMemoryAccess(const Translation* translation, const DecodedOperand* operand, const DecodedOperand* byteOffset,
+                            MemoryAccess* access)
+{
+    const ShaderProgram* program = translation->program;
+    *access = (MemoryAccess){ .operand = operand };
+    switch (operand->type)
+    {
+    case OPERAND_TGSM:
+    {
+        if (operand->registerIndex >= MAX_TGSM_COUNT) return false;
+
+        const GroupSharedDeclaration* declaration = &program->groupShared[operand->registerIndex];
+        access->structureStride = declaration->structureStride;
+        access->isGroupShared = true;
+        access->groupSharedOffset = declaration->offset;
+        access->groupSharedSize = declaration->size;
+        break;
+    }
+
+    case OPERAND_RESOURCE:
+        if (operand->registerIndex >= SHADER_INTERPRETER_MAX_RESOURCE_COUNT) return false;
+
+        access->structureStride = program->resources[operand->registerIndex].structureStride;
+        break;
+
+    case OPERAND_UAV:
+        if (operand->registerIndex >= SHADER_INTERPRETER_MAX_UAV_COUNT) return false;
+
+        access->structureStride = program->uavs[operand->registerIndex].structureStride;
+        break;
+
+    default:
+        return false;
+    }
+
+    // The element offsets are in dwords, so a structured member must be aligned, and its offset known at translation
+    if (byteOffset != NULL && access->structureStride != 0)
+    {
+        if (byteOffset->type != OPERAND_IMMEDIATE32 || byteOffset->modifier != 0) return false;
+        access->byteOffset = byteOffset->immediate[0];
+    }
+    return access->structureStride % 4 == 0 && access->byteOffset % 4 == 0;
+}
+
+// Load the address of the first byte of the memory into `gpr`
+static void LoadMemoryBase(Translation* translation, const MemoryAccess* access, uint32_t gpr)
+{
+    CodeBuffer* code = &translation->code;
+    if (access->isGroupShared)
+    {
+        EmitGprMemory(code, true, 0x8D, gpr, Address(R15, (int32_t)access->groupSharedOffset));
+        return;
+    }
+
+    const int32_t offset = AddUniform(translation, (NativeUniform){
+        .kind = UNIFORM_MEMORY_DATA, .operandType = access->operand->type, .registerIndex = access->operand->registerIndex
+    });
+    EmitGprMemory(code, true, 0x8B, gpr, Address(R15, offset));
+}
+
+// Load the address operand into ymm0, as an element index or the dword index of a raw address,
+// and into ymm1 with the sign bit flipped for the unsigned bound checks
+static bool LoadMemoryAddress(Translation* translation, const MemoryAccess* access, const DecodedOperand* address)
+{
+    CodeBuffer* code = &translation->code;
+    if (!LoadSource(translation, address, 0, false, 0)) return false;
+
+    if (access->structureStride == 0) {
+        EmitShiftImmediate(code, SHIFT_RIGHT_LOGICAL, 0, 0, 2);
+    }
+    EmitYmmMemory(code, VPXOR, 1, 0, Address(R14, AddConstantVector(translation, 0x80000000U)));
+    return true;
+}
+
+// Compute the dword indices of the component `component` into `indices`, and the lanes where it lies in the memory into `inBounds`.
+// Returns false if the component is never in bounds: a structured member beyond the end of its element.
+static bool EmitElementIndices(Translation* translation, const MemoryAccess* access, uint32_t component, uint32_t indices, uint32_t inBounds)
+{
+    CodeBuffer* code = &translation->code;
+    const uint32_t stride = access->structureStride;
+    const uint32_t elementSize = stride != 0 ? stride : sizeof(uint32_t);
+    const uint64_t end = (stride != 0 ? access->byteOffset : 0) + (uint64_t)component * sizeof(uint32_t) + sizeof(uint32_t);
+    if (stride != 0 && end > stride) return false;
+
+    // In bounds when the index is less than the number of the elements that hold the dword.
+    // The limits are below 2^31 with the memory under 8 GB, so they are compared as signed values with the sign bits flipped.
+    if (access->isGroupShared)
+    {
+        const uint32_t limit = access->groupSharedSize >= end ? (uint32_t)((access->groupSharedSize - end) / elementSize + 1) : 0;
+        LoadConstant(translation, limit ^ 0x80000000U, inBounds);
+    }
+    else
+    {
+        BroadcastUniform(translation, (NativeUniform){
+            .kind = UNIFORM_MEMORY_LIMIT, .operandType = access->operand->type, .registerIndex = access->operand->registerIndex,
+            .element = (uint32_t)end, .stride = elementSize
+        }, inBounds);
+    }
+    EmitYmm(code, VPCMPGTD, inBounds, inBounds, 1);
+
+    // The dword of the member in its element
+    const uint32_t dwordStride = stride / sizeof(uint32_t);
+    const uint32_t dwordOffset = (stride != 0 ? access->byteOffset / (uint32_t)sizeof(uint32_t) : 0) + component;
+    if (stride == 0 || dwordStride == 1) {
+        EmitYmm(code, VMOVDQA, indices, 0, 0);
+    }
+    else if ((dwordStride & (dwordStride - 1)) == 0)
+    {
+        uint32_t shift = 0;
+        while ((1U << shift) < dwordStride) {
+            ++shift;
+        }
+        EmitShiftImmediate(code, SHIFT_LEFT, indices, 0, shift);
+    }
+    else {
+        EmitYmmMemory(code, VPMULLD, indices, 0, Address(R14, AddConstantVector(translation, dwordStride)));
+    }
+    if (dwordOffset != 0) {
+        EmitYmmMemory(code, VPADDD, indices, indices, Address(R14, AddConstantVector(translation, dwordOffset)));
+    }
+    return true;
+}
+
+// Jump to `label` unless the lanes of `lanes` are all set and `indices` are consecutive, and load the first index into rcx
+static void EmitContiguityTest(Translation* translation, uint32_t indices, uint32_t lanes, uint32_t label)
+{
+    CodeBuffer* code = &translation->code;
+    EmitVexRegister(code, VMOVD_TO_GPR, false, indices, 0, RCX);
+    EmitVexRegister(code, VPBROADCASTD, true, 4, 0, indices);
+    EmitYmmMemory(code, VPADDD, 4, 4, Address(R14, translation->laneIndicesOffset));
+    EmitYmm(code, VPCMPEQD, 4, 4, indices);
+    EmitYmm(code, VPAND, 4, 4, lanes);
+    EmitTest(code, 4, YMM_ONES);
+    EmitJump(code, JUMP_IF_NO_CARRY, label);
+}
+
+// The lanes of a block access consecutive dwords with a single vector load or store when they are all active and in bounds,
+// and gather or store one lane after the other otherwise
+static bool TranslateLoad(Translation* translation, const DecodedInstruction* instruction)
+{
+    CodeBuffer* code = &translation->code;
+    const bool isStructured = instruction->opcode == OP_LD_STRUCTURED;
+    const DecodedOperand* destination = &instruction->operands[0];
+    const DecodedOperand* memoryOperand = &instruction->operands[isStructured ? 3 : 2];
+    if (destination->type == OPERAND_NULL) return true;
+    if (destination->type != OPERAND_TEMP) return false;
+
+    MemoryAccess access;
+    if (!GetMemoryAccess(translation, memoryOperand, isStructured ? &instruction->operands[2] : NULL, &access)) return false;
+    if (!LoadMemoryAddress(translation, &access, &instruction->operands[1])) return false;
+
+    LoadMemoryBase(translation, &access, RAX);
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if ((destination->mask & (1U << c)) == 0) continue;
+
+        // The swizzle of the memory operand selects the loaded components, and the lanes out of bounds read 0
+        const uint32_t result = YMM_RESULT + c;
+        SetResultTemp(translation, result, -1);
+        if (!EmitElementIndices(translation, &access, memoryOperand->swizzle[c], 2, 3))
+        {
+            LoadConstant(translation, 0, result);
+            continue;
+        }
+        EmitYmm(code, VPAND, 3, 3, YMM_MASK);
+
+        const uint32_t gatherLabel = CreateLabel(code), endLabel = CreateLabel(code);
+        EmitContiguityTest(translation, 2, 3, gatherLabel);
+        EmitYmmLoad(code, result, IndexedAddress(RAX, RCX, 4, 0));
+        EmitJump(code, JUMP_ALWAYS, endLabel);
+
+        BindLabel(code, gatherLabel);
+        EmitYmm(code, VPXOR, result, result, result);
+        EmitYmmMemory(code, VPGATHERDD, result, 3, IndexedAddress(RAX, 2, 4, 0));
+        BindLabel(code, endLabel);
+    }
+
+    for (uint32_t c = 0; c < 4; ++c) {
+        if (destination->mask & (1U << c)) {
+            WriteTemp(translation, destination->registerIndex, c, YMM_RESULT + c);
+        }
+    }
+    return true;
+}
+
+// Spill the indices of a component, with the lanes out of bounds set to -1, and its values
+static void SpillStoreLanes(Translation* translation, uint32_t component, uint32_t indices, uint32_t inBounds, uint32_t values)
+{
+    CodeBuffer* code = &translation->code;
+    EmitYmm(code, VPANDN, 4, inBounds, YMM_ONES);
+    EmitYmm(code, VPOR, indices, indices, 4);
+    EmitYmmStore(code, Address(R15, translation->spillOffset + (int32_t)(component * BLOCK_BYTES)), indices);
+    EmitYmmStore(code, Address(R15, translation->spillOffset + (int32_t)((4 + component) * BLOCK_BYTES)), values);
+}
+
+static bool TranslateStore(Translation* translation, const DecodedInstruction* instruction)
+{
+    CodeBuffer* code = &translation->code;
+    const bool isStructured = instruction->opcode == OP_STORE_STRUCTURED;
+    const DecodedOperand* memoryOperand = &instruction->operands[0];
+    const DecodedOperand* value = &instruction->operands[isStructured ? 3 : 2];
+
+    MemoryAccess access;
+    if (!GetMemoryAccess(translation, memoryOperand, isStructured ? &instruction->operands[2] : NULL, &access)) return false;
+    if (!LoadMemoryAddress(translation, &access, &instruction->operands[1])) return false;
+
+    LoadMemoryBase(translation, &access, R10);
+    const uint32_t laneLabel = CreateLabel(code), endLabel = CreateLabel(code);
+    uint32_t componentCount = 0, lastComponent = 0;
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if (memoryOperand->mask & (1U << c))
+        {
+            ++componentCount;
+            lastComponent = c;
+        }
+    }
+
+    // Each component of the mask is written to the next dword
+    bool isStored[4] = { false };
+    if (componentCount == 1)
+    {
+        const uint32_t c = lastComponent;
+        if (!EmitElementIndices(translation, &access, c, 2, 3)) return true;
+        if (!LoadSource(translation, value, c, false, YMM_RESULT)) return false;
+
+        const uint32_t scalarLabel = CreateLabel(code);
+        EmitYmm(code, VPAND, 5, 3, YMM_MASK);
+        EmitContiguityTest(translation, 2, 5, scalarLabel);
+        EmitYmmStore(code, IndexedAddress(R10, RCX, 4, 0), YMM_RESULT);
+        EmitJump(code, JUMP_ALWAYS, endLabel);
+
+        BindLabel(code, scalarLabel);
+        SpillStoreLanes(translation, c, 2, 3, YMM_RESULT);
+        isStored[c] = true;
+    }
+    else
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if ((memoryOperand->mask & (1U << c)) == 0 || !EmitElementIndices(translation, &access, c, 2, 3)) continue;
+            if (!LoadSource(translation, value, c, false, YMM_RESULT)) return false;
+
+            SpillStoreLanes(translation, c, 2, 3, YMM_RESULT);
+            isStored[c] = true;
+        }
+    }
+
+    // The active lanes store in order, and each of them all its components
+    EmitVexRegister(code, VMOVMSKPS, true, RAX, 0, YMM_MASK);
+    EmitGprRegister(code, false, 0x85, RAX, RAX);
+    EmitJump(code, JUMP_IF_ZERO, endLabel);
+
+    BindLabel(code, laneLabel);
+    EmitGprRegister(code, false, 0x0FBC, RCX, RAX);
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        if (!isStored[c]) continue;
+
+        const uint32_t skipLabel = CreateLabel(code);
+        EmitGprMemory(code, false, 0x8B, RDX, IndexedAddress(R15, RCX, 4, translation->spillOffset + (int32_t)(c * BLOCK_BYTES)));
+        EmitGprRegister(code, false, 0x85, RDX, RDX);
+        EmitJump(code, JUMP_IF_SIGN, skipLabel);
+        EmitGprMemory(code, false, 0x8B, R8, IndexedAddress(R15, RCX, 4, translation->spillOffset + (int32_t)((4 + c) * BLOCK_BYTES)));
+        EmitGprMemory(code, false, 0x89, R8, IndexedAddress(R10, RDX, 4, 0));
+        BindLabel(code, skipLabel);
+    }
+
+    // Clear the lowest lane: eax &= eax - 1
+    EmitGprRegister(code, false, 0x89, RAX, RDX);
+    EmitGprRegister(code, false, 0x83, 5, RDX);
+    EmitByte(code, 1);
+    EmitGprRegister(code, false, 0x21, RDX, RAX);
+    EmitJump(code, JUMP_IF_NOT_ZERO, laneLabel);
+
+    BindLabel(code, endLabel);
+    return true;
+}
+
+// The innermost open loop, or NULL
+static const ControlBlock* FindInnermostLoop(const Translation* translation)
+{
+    for (uint32_t i = translation->depth; i > 0; --i) {
+        if (translation->blocks[i - 1].opcode == OP_LOOP) return &translation->blocks[i - 1];
+    }
+    return NULL;
+}
+
+static MemoryOperand RetiredLanesAddress(const Translation* translation)
+{
+    return IndexedAddress(R15, RBX, 1, translation->retiredOffset);
+}
+
+// Move the lanes of `lanes` out of the execution mask into the mask at `target`
+static void StopLanes(Translation* translation, uint32_t lanes, MemoryOperand target)
+{
+    CodeBuffer* code = &translation->code;
+    EmitYmmMemory(code, VPOR, 4, lanes, target);
+    EmitYmmStore(code, target, 4);
+    EmitYmm(code, VPANDN, YMM_MASK, lanes, YMM_MASK);
+}
+
+// Whether an instruction reads any component of the temp `registerIndex`, as a source or a relative index
+static bool ReadsTemp(const DecodedInstruction* instruction, uint32_t registerIndex)
+{
+    for (uint32_t i = 0; i < instruction->operandCount; ++i)
+    {
+        const DecodedOperand* operand = &instruction->operands[i];
+        if (operand->hasRelativeIndex && operand->relativeRegister == registerIndex) return true;
+        if (i >= instruction->info.dstCount && operand->type == OPERAND_TEMP && operand->registerIndex == registerIndex) return true;
+    }
+    return false;
+}
+
+// Whether the component of a temp that the instruction `pc` writes is read again before it is rewritten by all the threads
+static bool IsTempReadLater(const ShaderProgram* program, uint32_t pc, uint32_t registerIndex, uint32_t component)
+{
+    uint32_t depth = 0;
+    for (++pc; pc < program->instructionCount; ++pc)
+    {
+        const DecodedInstruction* instruction = &program->instructions[pc];
+        if (ReadsTemp(instruction, registerIndex)) return true;
+
+        const uint32_t opcode = instruction->opcode;
+        depth += opcode == OP_IF || opcode == OP_LOOP;
+        depth -= (opcode == OP_ENDIF || opcode == OP_ENDLOOP) && depth > 0;
+
+        const DecodedOperand* destination = &instruction->operands[0];
+        if (depth == 0 && instruction->info.dstCount == 1 && destination->type == OPERAND_TEMP &&
+            destination->registerIndex == registerIndex && (destination->mask & (1U << component))) return false;
+    }
+    return false;
+}
+
+// Whether the operand is SV_GroupIndex, or SV_GroupThreadID.x of a one-dimensional group, which grow with the lanes
+static bool IsLaneIndex(const ShaderProgram* program, const DecodedOperand* operand)
+{
+    if (operand->modifier != 0) return false;
+    if (operand->type == OPERAND_THREAD_ID_IN_GROUP_FLATTENED) return true;
+
+    return operand->type == OPERAND_THREAD_ID_IN_GROUP && operand->swizzle[0] == 0 &&
+           program->threadGroupSize[1] == 1 && program->threadGroupSize[2] == 1;
+}
+
+// Whether the `if` at `pc` is a phase of the form `if (SV_GroupIndex < n) { ... } GroupMemoryBarrierWithGroupSync();`,
+// e.g. a level of a reduction tree. Since the lane indices grow with the blocks, once a block has no thread in the branch,
+// none of the next blocks has any, so the rest of the phase is skipped.
+// This needs the comparison to start the phase, the endif to end it, and the compared value to be dead after it,
+// since the skipped blocks do not write it.
+static bool IsPhasePrefixIf(const ShaderProgram* program, uint32_t pc)
+{
+    if (pc == 0) return false;
+
+    const DecodedInstruction* instruction = &program->instructions[pc];
+    const DecodedInstruction* comparison = &program->instructions[pc - 1];
+    const DecodedOperand* condition = &instruction->operands[0];
+    const DecodedOperand* destination = &comparison->operands[0];
+    const bool isPhaseStart = pc == 1 || (program->instructions[pc - 2].opcode == OP_SYNC &&
+                                          (program->instructions[pc - 2].syncFlags & SYNC_THREADS_IN_GROUP));
+    if (!isPhaseStart || condition->type != OPERAND_TEMP || condition->modifier != 0) return false;
+
+    // The branch is taken below n: ult and ilt with if_nz, uge and ige with if_z
+    const uint32_t opcode = comparison->opcode;
+    const bool isLess = opcode == OP_ULT || opcode == OP_ILT;
+    if ((!isLess && opcode != OP_UGE && opcode != OP_IGE) || instruction->testNonZero != isLess) return false;
+    if (destination->type != OPERAND_TEMP || destination->mask != (1U << condition->swizzle[0]) ||
+        destination->registerIndex != condition->registerIndex) return false;
+
+    const DecodedOperand* bound = &comparison->operands[2];
+    const bool isUniformBound = bound->modifier == 0 && !bound->hasRelativeIndex && (bound->type == OPERAND_IMMEDIATE32 ||
+                                bound->type == OPERAND_CONSTANT_BUFFER || bound->type == OPERAND_IMMEDIATE_CONSTANT_BUFFER);
+    if (!IsLaneIndex(program, &comparison->operands[1]) || !isUniformBound) return false;
+
+    // No else branch, and the group barrier or the end of the program right after the endif
+    const uint32_t endPC = instruction->jumpTarget;
+    if (program->instructions[endPC].opcode != OP_ENDIF) return false;
+    if (endPC + 1 < program->instructionCount)
+    {
+        const DecodedInstruction* next = &program->instructions[endPC + 1];
+        const bool isPhaseEnd = (next->opcode == OP_SYNC && (next->syncFlags & SYNC_THREADS_IN_GROUP)) ||
+                                (next->opcode == OP_RET && endPC + 2 == program->instructionCount);
+        if (!isPhaseEnd) return false;
+    }
+
+    return !IsTempReadLater(program, endPC, condition->registerIndex, condition->swizzle[0]);
+}
+
+static bool TranslateControlFlow(Translation* translation, const DecodedInstruction* instruction)
+{
+    const ShaderProgram* program = translation->program;
+    CodeBuffer* code = &translation->code;
+    const bool isConditional = instruction->info.srcCount > 0 || instruction->opcode == OP_BREAKC ||
+                                instruction->opcode == OP_CONTINUEC || instruction->opcode == OP_RETC;
+    ForgetResultTemps(translation);
+    switch (instruction->opcode)
+    {
+    case OP_IF:
+    case OP_LOOP:
+    {
+        if (translation->depth >= MAX_CONTROL_FLOW_DEPTH) return false;
+
+        ControlBlock* block = &translation->blocks[translation->depth];
+        *block = (ControlBlock){
+            .opcode = instruction->opcode,
+            .frameOffset = translation->frameOffset + (int32_t)(translation->depth * FRAME_LEVEL_BYTES),
+            .elseLabel = CreateLabel(code),
+            .endLabel = CreateLabel(code),
+            .loopLabel = CreateLabel(code)
+        };
+        ++translation->depth;
+
+        if (instruction->opcode == OP_LOOP)
+        {
+            // No lane has left the loop or continued it yet
+            EmitYmmStore(code, FrameAddress(block, 0), YMM_ZERO);
+            EmitYmmStore(code, FrameAddress(block, 1), YMM_ZERO);
+            EmitTest(code, YMM_MASK, YMM_MASK);
+            EmitJump(code, JUMP_IF_ZERO, block->endLabel);
+            BindLabel(code, block->loopLabel);
+            return true;
+        }
+
+        // The lanes are split between the branches, and a branch that no lane takes is skipped
+        const bool hasElse = program->instructions[instruction->jumpTarget].opcode == OP_ELSE;
+        if (!LoadSource(translation, &instruction->operands[0], 0, false, 0)) return false;
+
+        EmitYmm(code, VPCMPEQD, 0, 0, YMM_ZERO);
+        if (translation->depth == 1 && IsPhasePrefixIf(program, (uint32_t)(instruction - program->instructions)))
+        {
+            // No lane of the block is below the bound: all the lanes of the comparison are 1 for if_z, and 0 for if_nz
+            EmitTest(code, 0, instruction->testNonZero ? YMM_ONES : 0);
+            EmitJump(code, instruction->testNonZero ? JUMP_IF_CARRY : JUMP_IF_ZERO, translation->phaseEndLabel);
+        }
+        if (translation->depth == 1) {
+            EmitYmm(code, VMOVDQA, YMM_OUTER_MASK, 0, YMM_MASK);
+        }
+        else {
+            EmitYmmStore(code, FrameAddress(block, 0), YMM_MASK);
+        }
+        if (hasElse)
+        {
+            EmitYmm(code, instruction->testNonZero ? VPAND : VPANDN, 1, 0, YMM_MASK);
+            EmitYmmStore(code, FrameAddress(block, 1), 1);
+        }
+        EmitYmm(code, instruction->testNonZero ? VPANDN : VPAND, YMM_MASK, 0, YMM_MASK);
+        EmitTest(code, YMM_MASK, YMM_MASK);
+        EmitJump(code, JUMP_IF_ZERO, hasElse ? block->elseLabel : block->endLabel);
+        return true;
+    }
+
+    case OP_ELSE:
+    {
+        if (translation->depth == 0) return false;
+
+        const ControlBlock* block = &translation->blocks[translation->depth - 1];
+        BindLabel(code, block->elseLabel);
+        EmitYmmLoad(code, YMM_MASK, FrameAddress(block, 1));
+        EmitTest(code, YMM_MASK, YMM_MASK);
+        EmitJump(code, JUMP_IF_ZERO, block->endLabel);
+        return true;
+    }
+
+    case OP_ENDIF:
+    {
+        if (translation->depth == 0) return false;
+
+        // The lanes that entered the block, except the ones that have left the loop, continued it or returned in it
+        const ControlBlock* block = &translation->blocks[--translation->depth];
+        BindLabel(code, block->endLabel);
+        if (translation->depth == 0) {
+            EmitYmm(code, VMOVDQA, YMM_MASK, 0, YMM_OUTER_MASK);
+        }
+        else {
+            EmitYmmLoad(code, YMM_MASK, FrameAddress(block, 0));
+        }
+        const ControlBlock* loop = FindInnermostLoop(translation);
+        if (loop != NULL)
+        {
+            EmitYmmLoad(code, 4, FrameAddress(loop, 0));
+            EmitYmm(code, VPANDN, YMM_MASK, 4, YMM_MASK);
+            EmitYmmLoad(code, 4, FrameAddress(loop, 1));
+            EmitYmm(code, VPANDN, YMM_MASK, 4, YMM_MASK);
+        }
+        if (translation->hasReturn)
+        {
+            EmitYmmLoad(code, 4, RetiredLanesAddress(translation));
+            EmitYmm(code, VPANDN, YMM_MASK, 4, YMM_MASK);
+        }
+        return true;
+    }
+
+    case OP_ENDLOOP:
+    {
+        if (translation->depth == 0) return false;
+
+        // The lanes that continued the loop run the next iteration with the ones that reached its end,
+        // and the loop ends when none is left. Then the lanes that left it run on.
+        const ControlBlock* block = &translation->blocks[--translation->depth];
+        EmitYmmMemory(code, VPOR, YMM_MASK, YMM_MASK, FrameAddress(block, 1));
+        EmitYmmStore(code, FrameAddress(block, 1), YMM_ZERO);
+        EmitTest(code, YMM_MASK, YMM_MASK);
+        EmitJump(code, JUMP_IF_NOT_ZERO, block->loopLabel);
+        BindLabel(code, block->endLabel);
+        EmitYmmLoad(code, YMM_MASK, FrameAddress(block, 0));
+        return true;
+    }
+
+    case OP_BREAK:
+    case OP_BREAKC:
+    case OP_CONTINUE:
+    case OP_CONTINUEC:
+    {
+        const ControlBlock* loop = FindInnermostLoop(translation);
+        if (loop == NULL) return false;
+
+        if (isConditional) {
+            if (!LoadPassingLanes(translation, instruction, 1)) return false;
+        }
+        else {
+            EmitYmm(code, VMOVDQA, 1, 0, YMM_MASK);
+        }
+        const bool isBreak = instruction->opcode == OP_BREAK || instruction->opcode == OP_BREAKC;
+        StopLanes(translation, 1, FrameAddress(loop, isBreak ? 0 : 1));
+        return true;
+    }
+
+    case OP_RET:
+    case OP_RETC:
+        // A return of all the threads ends the block
+        if (!isConditional && translation->depth == 0)
+        {
+            if (translation->hasReturn) {
+                StopLanes(translation, YMM_MASK, RetiredLanesAddress(translation));
+            }
+            EmitJump(code, JUMP_ALWAYS, translation->blockEndLabel);
+            return true;
+        }
+
+        if (isConditional) {
+            if (!LoadPassingLanes(translation, instruction, 1)) return false;
+        }
+        else {
+            EmitYmm(code, VMOVDQA, 1, 0, YMM_MASK);
+        }
+        StopLanes(translation, 1, RetiredLanesAddress(translation));
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// Start the loop over the blocks of a phase. A block that has no thread left to run is skipped.
+static void BeginPhase(Translation* translation)
+{
+    CodeBuffer* code = &translation->code;
+    translation->blockLabel = CreateLabel(code);
+    translation->blockEndLabel = CreateLabel(code);
+    translation->phaseEndLabel = CreateLabel(code);
+    ForgetResultTemps(translation);
+
+    EmitGprRegister(code, false, 0x31, RBX, RBX);
+    BindLabel(code, translation->blockLabel);
+    EmitYmmLoad(code, YMM_MASK, LaneArrayAddress(translation->validLanesOffset));
+    if (translation->hasReturn)
+    {
+        EmitYmmLoad(code, 4, RetiredLanesAddress(translation));
+        EmitYmm(code, VPANDN, YMM_MASK, 4, YMM_MASK);
+    }
+    EmitTest(code, YMM_MASK, YMM_MASK);
+    EmitJump(code, JUMP_IF_ZERO, translation->blockEndLabel);
+}
+
+static void EndPhase(Translation* translation)
+{
+    CodeBuffer* code = &translation->code;
+    BindLabel(code, translation->blockEndLabel);
+    EmitGprRegister(code, true, 0x81, 0, RBX);
+    EmitUInt32(code, BLOCK_BYTES);
+    EmitGprRegister(code, true, 0x81, 7, RBX);
+    EmitUInt32(code, translation->laneCount * (uint32_t)sizeof(uint32_t));
+    EmitJump(code, JUMP_IF_CARRY, translation->blockLabel);
+    BindLabel(code, translation->phaseEndLabel);
+}
+
+// Whether a thread can return before the end of the program: a conditional return, a return in control flow,
+// or a return with a group barrier after it
+static bool CanReturnEarly(const ShaderProgram* program)
+{
+    uint32_t depth = 0;
+    bool hasReturned = false;
+    for (uint32_t pc = 0; pc < program->instructionCount; ++pc)
+    {
+        const DecodedInstruction* instruction = &program->instructions[pc];
+        switch (instruction->opcode)
+        {
+        case OP_IF:
+        case OP_LOOP:
+            ++depth;
+            break;
+        case OP_ENDIF:
+        case OP_ENDLOOP:
+            depth -= depth > 0 ? 1 : 0;
+            break;
+        case OP_RETC:
+            return true;
+        case OP_RET:
+            if (depth > 0) return true;
+            hasReturned = true;
+            break;
+        case OP_SYNC:
+            if (hasReturned && (instruction->syncFlags & SYNC_THREADS_IN_GROUP)) return true;
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+static bool TranslateInstruction(Translation* translation, const DecodedInstruction* instruction)
+{
+    switch (instruction->opcode)
+    {
+    case OP_NOP:
+        return true;
+
+    case OP_SYNC:
+        // The blocks run one after the other, so only a group barrier has to be translated, into the end of a phase
+        if ((instruction->syncFlags & SYNC_THREADS_IN_GROUP) == 0) return true;
+        if (translation->depth > 0) return false;
+
+        EndPhase(translation);
+        BeginPhase(translation);
+        return true;
+
+    case OP_LD_RAW:
+    case OP_LD_STRUCTURED:
+        return TranslateLoad(translation, instruction);
+
+    case OP_STORE_RAW:
+    case OP_STORE_STRUCTURED:
+        return TranslateStore(translation, instruction);
+
+    case OP_IF:
+    case OP_ELSE:
+    case OP_ENDIF:
+    case OP_LOOP:
+    case OP_ENDLOOP:
+    case OP_BREAK:
+    case OP_BREAKC:
+    case OP_CONTINUE:
+    case OP_CONTINUEC:
+    case OP_RET:
+    case OP_RETC:
+        return TranslateControlFlow(translation, instruction);
+
+    default:
+        if (instruction->info.opcodeClass != OPCODE_INT && instruction->info.opcodeClass != OPCODE_FLOAT) return false;
+        return TranslateALU(translation, instruction);
+    }
+}
+
+static bool TranslateProgram(Translation* translation)
+{
+    CodeBuffer* code = &translation->code;
+
+    // The callee-saved registers, then the scratch memory from the first argument, and the constant pool
+    EmitPush(code, RBX);
+    EmitPush(code, R14);
+    EmitPush(code, R15);
+#ifdef _WIN32
+    EmitGprRegister(code, true, 0x89, RCX, R15);
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        const MemoryOperand target = Address(R15, translation->registerSaveOffset + (int32_t)(i * 16));
+        EmitVexMemory(code, VMOVDQU_STORE, false, 6 + i, 0, &target);
+    }
+#else
+    EmitGprRegister(code, true, 0x89, RDI, R15);
+#endif // _WIN32
+    EmitByte(code, 0x49);
+    EmitByte(code, 0xB8 + (R14 & 7));
+    translation->constantPoolPatch = code->size;
+    EmitUInt32(code, 0);
+    EmitUInt32(code, 0);
+
+    EmitYmm(code, VPCMPEQD, YMM_ONES, YMM_ONES, YMM_ONES);
+    EmitYmm(code, VPXOR, YMM_ZERO, YMM_ZERO, YMM_ZERO);
+
+    BeginPhase(translation);
+    for (uint32_t pc = 0; pc < translation->program->instructionCount; ++pc)
+    {
+        if (!TranslateInstruction(translation, &translation->program->instructions[pc])) return false;
+        if (code->hasOverflowed) return false;
+    }
+    if (translation->depth != 0) return false;
+    EndPhase(translation);
+
+#ifdef _WIN32
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        const MemoryOperand source = Address(R15, translation->registerSaveOffset + (int32_t)(i * 16));
+        EmitVexMemory(code, VMOVDQU_LOAD, false, 6 + i, 0, &source);
+    }
+#endif // _WIN32
+
+    // vzeroupper, so that the SSE code of the caller does not pay for the upper halves of the registers
+    EmitByte(code, 0xC5);
+    EmitByte(code, 0xF8);
+    EmitByte(code, 0x77);
+    EmitPop(code, R15);
+    EmitPop(code, R14);
+    EmitPop(code, RBX);
+    EmitByte(code, 0xC3);
+
+    return ResolveJumps(code);
+}
+
+// ---- Platform ----
+
+static bool HasAVX2(void)
+{
+#ifdef _MSC_VER
+    // The OS must also save the YMM registers on context switches
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+    if (maxLeaf < 7 || !hasOSXSave) return false;
+
+    const uint64_t xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+#else
+    // It also checks the OS support of the registers
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif // _MSC_VER
+}
+
+// Copy the code to pages that are made executable, and no longer writable
+static void* CreateExecutableCode(const uint8_t* bytes, size_t size)
+{
+#ifdef _WIN32
+    void* code = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (code == NULL) return NULL;
+
+    memcpy(code, bytes, size);
+    DWORD oldProtection;
+    if (!VirtualProtect(code, size, PAGE_EXECUTE_READ, &oldProtection))
+    {
+        VirtualFree(code, 0, MEM_RELEASE);
+        return NULL;
+    }
+    FlushInstructionCache(GetCurrentProcess(), code, size);
+    return code;
+#else
+    void* code = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) return NULL;
+
+    memcpy(code, bytes, size);
+    if (mprotect(code, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(code, size);
+        return NULL;
+    }
+    return code;
+#endif // _WIN32
+}
+
+static void DestroyExecutableCode(void* code, size_t size)
+{
+    if (code == NULL) return;
+
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(code, 0, MEM_RELEASE);
+#else
+    munmap(code, size);
+#endif // _WIN32
+}
+#endif // SHADER_JIT_X64
+
+// ---- Shaders ----
+
+NativeShader* CreateNativeShader(const ShaderProgram* program, uint32_t laneCount)
+{
+#ifdef SHADER_JIT_X64
+    if (laneCount % BLOCK_LANE_COUNT != 0 || !HasAVX2()) return NULL;
+
+    NativeShader* shader = calloc(1, sizeof(*shader));
+    Translation translation = { .program = program, .laneCount = laneCount, .hasReturn = CanReturnEarly(program) };
+    CodeBuffer* code = &translation.code;
+    bool succeeded = false;
+    do
+    {
+        if (shader == NULL) break;
+
+        // The scratch memory: the group-shared memory, the temp registers as [tempCount][4 components][laneCount],
+        // the lanes that have returned, the masks of the open blocks, the spilled lanes of a store, the saved registers,
+        // then the values filled for each group
+        const size_t laneBytes = (size_t)laneCount * sizeof(uint32_t);
+        const size_t alignment = SCRATCH_ALIGNMENT;
+        const size_t tempsOffset = ((size_t)program->groupSharedBytes + alignment - 1) & ~(alignment - 1);
+        const size_t retiredOffset = tempsOffset + (size_t)program->tempCount * 4 * laneBytes;
+        const size_t frameOffset = retiredOffset + laneBytes;
+        const size_t spillOffset = frameOffset + (size_t)MAX_CONTROL_FLOW_DEPTH * FRAME_LEVEL_BYTES;
+        const size_t registerSaveOffset = spillOffset + SPILL_BYTES;
+        const size_t uniformsOffset = registerSaveOffset + REGISTER_SAVE_BYTES;
+        const size_t instructionCount = (size_t)program->instructionCount + 1;
+        if (uniformsOffset + instructionCount * MAX_INSTRUCTION_UNIFORM_COUNT * sizeof(uint64_t) > INT32_MAX) break;
+
+        translation.tempsOffset = (int32_t)tempsOffset;
+        translation.retiredOffset = (int32_t)retiredOffset;
+        translation.frameOffset = (int32_t)frameOffset;
+        translation.spillOffset = (int32_t)spillOffset;
+        translation.registerSaveOffset = (int32_t)registerSaveOffset;
+        translation.uniformsOffset = (int32_t)uniformsOffset;
+
+        code->capacity = instructionCount * MAX_INSTRUCTION_CODE_SIZE + 4096;
+        code->labelCapacity = (uint32_t)(instructionCount * MAX_INSTRUCTION_LABEL_COUNT + 16);
+        code->jumpCapacity = (uint32_t)(instructionCount * MAX_INSTRUCTION_JUMP_COUNT + 16);
+        code->bytes = malloc(code->capacity);
+        code->labels = malloc(code->labelCapacity * sizeof(uint32_t));
+        code->jumpOffsets = malloc(code->jumpCapacity * sizeof(uint32_t));
+        code->jumpLabels = malloc(code->jumpCapacity * sizeof(uint32_t));
+
+        // The lane arrays: SV_GroupThreadID, SV_GroupIndex, the lanes of the threads of the group, and the lane indices of a block
+        translation.laneArraysEnd = 6 * laneCount + BLOCK_LANE_COUNT;
+        translation.constantCapacity = translation.laneArraysEnd + (uint32_t)(instructionCount * MAX_INSTRUCTION_CONSTANT_COUNT * BLOCK_LANE_COUNT);
+        translation.constants = calloc(translation.constantCapacity, sizeof(uint32_t));
+        translation.uniformCapacity = (uint32_t)(instructionCount * MAX_INSTRUCTION_UNIFORM_COUNT);
+        translation.uniforms = calloc(translation.uniformCapacity, sizeof(NativeUniform));
+        if (code->bytes == NULL || code->labels == NULL || code->jumpOffsets == NULL || code->jumpLabels == NULL ||
+            translation.constants == NULL || translation.uniforms == NULL) break;
+
+        uint32_t* constants = translation.constants;
+        for (uint32_t thread = 0; thread < laneCount; ++thread)
+        {
+            const bool isValid = thread < program->threadCount;
+            constants[thread] = isValid ? thread % program->threadGroupSize[0] : 0;
+            constants[laneCount + thread] = isValid ? (thread / program->threadGroupSize[0]) % program->threadGroupSize[1] : 0;
+            constants[2 * laneCount + thread] = isValid ? thread / (program->threadGroupSize[0] * program->threadGroupSize[1]) : 0;
+            constants[3 * laneCount + thread] = isValid ? thread : 0;
+            constants[4 * laneCount + thread] = isValid ? UINT32_MAX : 0;
+        }
+        for (uint32_t l = 0; l < BLOCK_LANE_COUNT; ++l) {
+            constants[6 * laneCount + l] = l;
+        }
+        for (uint32_t i = 0; i < 3; ++i) {
+            translation.threadIDOffsets[i] = (int32_t)(i * laneBytes);
+        }
+        translation.threadIndexOffset = (int32_t)(3 * laneBytes);
+        translation.validLanesOffset = (int32_t)(4 * laneBytes);
+        translation.laneIndicesOffset = (int32_t)(6 * laneBytes);
+        translation.constantCount = translation.laneArraysEnd;
+
+        if (!TranslateProgram(&translation)) break;
+
+        // The code addresses the constant pool from r14, which is loaded with its final address
+        shader->constants = malloc(translation.constantCount * sizeof(uint32_t));
+        if (shader->constants == NULL) break;
+        memcpy(shader->constants, translation.constants, translation.constantCount * sizeof(uint32_t));
+        const uint64_t constantsAddress = (uint64_t)(uintptr_t)shader->constants;
+        memcpy(code->bytes + translation.constantPoolPatch, &constantsAddress, sizeof(constantsAddress));
+
+        shader->code = CreateExecutableCode(code->bytes, code->size);
+        if (shader->code == NULL) break;
+        shader->codeSize = code->size;
+        shader->function = (NativeFunction)(uintptr_t)shader->code;
+
+        shader->uniforms = translation.uniforms;
+        shader->uniformCount = translation.uniformCount;
+        translation.uniforms = NULL;
+        shader->uniformsOffset = uniformsOffset;
+        shader->scratchSize = (uniformsOffset + shader->uniformCount * sizeof(uint64_t) + alignment - 1) & ~(alignment - 1);
+
+        GetShaderProgramThreadGroupSize(program, shader->threadGroupSize);
+        shader->groupSharedBytes = program->groupSharedBytes;
+        shader->laneCount = laneCount;
+        shader->hasReturn = translation.hasReturn;
+        shader->retiredOffset = retiredOffset;
+        succeeded = true;
+    }
+    while (false);
+
+    free(code->bytes);
+    free(code->labels);
+    free(code->jumpOffsets);
+    free(code->jumpLabels);
+    free(translation.constants);
+    free(translation.uniforms);
+    if (!succeeded)
+    {
+        DestroyNativeShader(shader);
+        return NULL;
+    }
+
+    return shader;
+#else
+    (void)program;
+    (void)laneCount;
+    return NULL;
+#endif // SHADER_JIT_X64
+}
+
+void DestroyNativeShader(NativeShader* shader)
+{
+    if (shader == NULL) return;
+
+#ifdef SHADER_JIT_X64
+    DestroyExecutableCode(shader->code, shader->codeSize);
+    free(shader->constants);
+    free(shader->uniforms);
+#endif // SHADER_JIT_X64
+    free(shader);
+}
+
+size_t GetNativeShaderScratchSize(const NativeShader* shader)
+{
+    return shader->scratchSize;
+}
+
+bool ExecuteNativeThreadGroup(const NativeShader* shader, const ShaderBindings* bindings, const uint32_t groupID[3], void* scratch)
+{
+#ifdef SHADER_JIT_X64
+    // The element indices of the gathers are signed 32-bit dword indices
+    const uint64_t maxBufferSize = (uint64_t)1 << 33;
+
+    uint8_t* const scratchBytes = scratch;
+    uint64_t* const uniforms = (uint64_t*)(scratchBytes + shader->uniformsOffset);
+    for (uint32_t i = 0; i < shader->uniformCount; ++i)
+    {
+        const NativeUniform* uniform = &shader->uniforms[i];
+        const ShaderBufferBinding* binding = NULL;
+        if (uniform->operandType == OPERAND_CONSTANT_BUFFER) {
+            binding = &bindings->constantBuffers[uniform->registerIndex];
+        }
+        else if (uniform->operandType == OPERAND_RESOURCE) {
+            binding = &bindings->resources[uniform->registerIndex];
+        }
+        else if (uniform->operandType == OPERAND_UAV) {
+            binding = &bindings->uavs[uniform->registerIndex];
+        }
+        const uint64_t size = binding != NULL && binding->data != NULL ? (uint64_t)binding->size : 0;
+
+        switch (uniform->kind)
+        {
+        case UNIFORM_CONSTANT:
+            uniforms[i] = ReadShaderConstant(binding->data, binding->size, uniform->element, uniform->component);
+            break;
+
+        case UNIFORM_GROUP_ID:
+            uniforms[i] = groupID[uniform->component];
+            break;
+
+        case UNIFORM_THREAD_ID_BASE:
+            uniforms[i] = groupID[uniform->component] * shader->threadGroupSize[uniform->component];
+            break;
+
+        case UNIFORM_MEMORY_DATA:
+            if (size >= maxBufferSize) return false;
+            uniforms[i] = (uint64_t)(uintptr_t)binding->data;
+            break;
+
+        // The number of the elements that hold the accessed dword, with the sign bit flipped
+        case UNIFORM_MEMORY_LIMIT:
+        {
+            if (size >= maxBufferSize) return false;
+            const uint64_t limit = size >= uniform->element ? (size - uniform->element) / uniform->stride + 1 : 0;
+            uniforms[i] = (uint32_t)limit ^ 0x80000000U;
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    // The group-shared memory starts zeroed, and no thread has returned. The temp registers are not cleared.
+    memset(scratchBytes, 0, shader->groupSharedBytes);
+    if (shader->hasReturn) {
+        memset(scratchBytes + shader->retiredOffset, 0, (size_t)shader->laneCount * sizeof(uint32_t));
+    }
+
+    shader->function(scratch);
+    return true;
+#else
+    (void)shader;
+    (void)bindings;
+    (void)groupID;
+    (void)scratch;
+    return false;
+#endif // SHADER_JIT_X64
+}
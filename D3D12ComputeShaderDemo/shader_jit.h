@@ -0,0 +1,36 @@
+#ifndef SHADER_JIT_H
+#define SHADER_JIT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "shader_interpreter.h"
+
+// The machine code of a compute shader for the execution of whole thread groups on the CPU.
+// Each thread of the group is one 32-bit lane of an AVX2 register. The code runs a block of 8 threads from one group barrier
+// to the next, then the next block, so the group barriers split the program into phases that all the threads finish
+// before any of them starts the next one. Divergent control flow is executed with lane masks.
+// Only x86-64 processors with AVX2 are targeted. The other processors keep the lane loops of the shader compiler.
+typedef struct NativeShader NativeShader;
+
+// Translate a decoded program into machine code, with the thread group padded to `laneCount` lanes, a multiple of 8.
+// Returns NULL if the processor is not supported, or the program uses an instruction that has no translation:
+// the atomic operations, bufinfo, the dot products, the float min and max, the unsigned divisions and conversions,
+// the bit operations, the high halves of the products and the other instructions with two destinations,
+// relative constant indices, and the group barriers inside control flow.
+extern NativeShader* CreateNativeShader(const ShaderProgram* program, uint32_t laneCount);
+
+extern void DestroyNativeShader(NativeShader* shader);
+
+// Get the size of the scratch memory that `ExecuteNativeThreadGroup` needs:
+// the group-shared memory, the registers of all the threads of a group, and the masks of the blocks
+extern size_t GetNativeShaderScratchSize(const NativeShader* shader);
+
+// Execute the thread group `groupID` of a dispatch.
+// The gathers index the buffers with signed 32-bit dword indices, so nothing is executed, and false is returned,
+// if a buffer of `bindings` that the shader accesses is 8 GB or larger.
+extern bool ExecuteNativeThreadGroup(const NativeShader* shader, const ShaderBindings* bindings, const uint32_t groupID[3],
+                                    void* scratch);
+
+#endif // SHADER_JIT_H
@@ -0,0 +1,320 @@
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "shader_interpreter.h"
+
+// The decoded form of a compute shader, shared by the bytecode interpreter and the shader compiler
+
+enum
+{
+    // The opcodes of the SM5 token stream that the interpreter knows (D3D10_SB_OPCODE_TYPE and D3D11_SB_OPCODE_TYPE)
+    OP_ADD = 0,
+    OP_AND = 1,
+    OP_BREAK = 2,
+    OP_BREAKC = 3,
+    OP_CONTINUE = 7,
+    OP_CONTINUEC = 8,
+    OP_DIV = 14,
+    OP_DP2 = 15,
+    OP_DP3 = 16,
+    OP_DP4 = 17,
+    OP_ELSE = 18,
+    OP_ENDIF = 21,
+    OP_ENDLOOP = 22,
+    OP_EQ = 24,
+    OP_FRC = 26,
+    OP_FTOI = 27,
+    OP_FTOU = 28,
+    OP_GE = 29,
+    OP_IADD = 30,
+    OP_IF = 31,
+    OP_IEQ = 32,
+    OP_IGE = 33,
+    OP_ILT = 34,
+    OP_IMAD = 35,
+    OP_IMAX = 36,
+    OP_IMIN = 37,
+    OP_IMUL = 38,
+    OP_INE = 39,
+    OP_INEG = 40,
+    OP_ISHL = 41,
+    OP_ISHR = 42,
+    OP_ITOF = 43,
+    OP_LOOP = 48,
+    OP_LT = 49,
+    OP_MAD = 50,
+    OP_MIN = 51,
+    OP_MAX = 52,
+    OP_CUSTOMDATA = 53,
+    OP_MOV = 54,
+    OP_MOVC = 55,
+    OP_MUL = 56,
+    OP_NE = 57,
+    OP_NOP = 58,
+    OP_NOT = 59,
+    OP_OR = 60,
+    OP_RET = 62,
+    OP_RETC = 63,
+    OP_ROUND_NE = 64,
+    OP_ROUND_NI = 65,
+    OP_ROUND_PI = 66,
+    OP_ROUND_Z = 67,
+    OP_RSQ = 68,
+    OP_SQRT = 75,
+    OP_UDIV = 78,
+    OP_ULT = 79,
+    OP_UGE = 80,
+    OP_UMUL = 81,
+    OP_UMAD = 82,
+    OP_UMAX = 83,
+    OP_UMIN = 84,
+    OP_USHR = 85,
+    OP_UTOF = 86,
+    OP_XOR = 87,
+    OP_DCL_CONSTANT_BUFFER = 89,
+    OP_DCL_INPUT = 95,
+    OP_DCL_TEMPS = 104,
+    OP_DCL_GLOBAL_FLAGS = 106,
+    OP_BUFINFO = 121,
+    OP_RCP = 129,
+    OP_COUNTBITS = 134,
+    OP_FIRSTBIT_HI = 135,
+    OP_FIRSTBIT_LO = 136,
+    OP_FIRSTBIT_SHI = 137,
+    OP_UBFE = 138,
+    OP_IBFE = 139,
+    OP_BFI = 140,
+    OP_BFREV = 141,
+    OP_DCL_THREAD_GROUP = 155,
+    OP_DCL_UAV_RAW = 157,
+    OP_DCL_UAV_STRUCTURED = 158,
+    OP_DCL_TGSM_RAW = 159,
+    OP_DCL_TGSM_STRUCTURED = 160,
+    OP_DCL_RESOURCE_RAW = 161,
+    OP_DCL_RESOURCE_STRUCTURED = 162,
+    OP_LD_RAW = 165,
+    OP_STORE_RAW = 166,
+    OP_LD_STRUCTURED = 167,
+    OP_STORE_STRUCTURED = 168,
+    OP_ATOMIC_AND = 169,
+    OP_ATOMIC_OR = 170,
+    OP_ATOMIC_XOR = 171,
+    OP_ATOMIC_CMP_STORE = 172,
+    OP_ATOMIC_IADD = 173,
+    OP_ATOMIC_IMAX = 174,
+    OP_ATOMIC_IMIN = 175,
+    OP_ATOMIC_UMAX = 176,
+    OP_ATOMIC_UMIN = 177,
+    OP_IMM_ATOMIC_IADD = 180,
+    OP_IMM_ATOMIC_AND = 181,
+    OP_IMM_ATOMIC_OR = 182,
+    OP_IMM_ATOMIC_XOR = 183,
+    OP_IMM_ATOMIC_EXCH = 184,
+    OP_IMM_ATOMIC_CMP_EXCH = 185,
+    OP_IMM_ATOMIC_IMAX = 186,
+    OP_IMM_ATOMIC_IMIN = 187,
+    OP_IMM_ATOMIC_UMAX = 188,
+    OP_IMM_ATOMIC_UMIN = 189,
+    OP_SYNC = 190,
+    OP_COUNT
+};
+
+enum
+{
+    // D3D10_SB_OPERAND_TYPE and D3D11_SB_OPERAND_TYPE
+    OPERAND_TEMP = 0,
+    OPERAND_IMMEDIATE32 = 4,
+    OPERAND_RESOURCE = 7,
+    OPERAND_CONSTANT_BUFFER = 8,
+    OPERAND_IMMEDIATE_CONSTANT_BUFFER = 9,
+    OPERAND_NULL = 13,
+    OPERAND_UAV = 30,
+    OPERAND_TGSM = 31,
+    OPERAND_THREAD_ID = 32,
+    OPERAND_THREAD_GROUP_ID = 33,
+    OPERAND_THREAD_ID_IN_GROUP = 34,
+    OPERAND_THREAD_ID_IN_GROUP_FLATTENED = 36,
+
+    // D3D10_SB_OPERAND_MODIFIER
+    OPERAND_MODIFIER_NEG = 1,
+    OPERAND_MODIFIER_ABS = 2,
+
+    // The sync flags of the `sync` opcode token
+    SYNC_THREADS_IN_GROUP = 1,
+
+    // The SM5 instruction with the most operands is bfi and imm_atomic_cmp_exch
+    MAX_INSTRUCTION_OPERAND_COUNT = 5,
+
+    MAX_TGSM_COUNT = 8,
+    MAX_CONTROL_FLOW_DEPTH = 32,
+
+    // The thread group limit of D3D12 (D3D12_CS_THREAD_GROUP_MAX_THREADS_PER_GROUP)
+    MAX_THREAD_GROUP_THREAD_COUNT = 1024
+};
+
+// How an opcode uses its operands
+typedef enum OpcodeClass
+{
+    OPCODE_UNSUPPORTED,
+    OPCODE_INT,
+    OPCODE_FLOAT,
+    OPCODE_CONTROL_FLOW,
+    OPCODE_MEMORY
+} OpcodeClass;
+
+typedef struct OpcodeInfo
+{
+    uint8_t opcodeClass;
+    uint8_t dstCount;
+    uint8_t srcCount;
+} OpcodeInfo;
+
+// One operand, with its register and element indices resolved to the register space 0 bindings
+typedef struct DecodedOperand
+{
+    uint8_t type;
+    uint8_t modifier;
+
+    // The components written by a destination
+    uint8_t mask;
+
+    // The component of the register read for each component of a source
+    uint8_t swizzle[4];
+
+    // The temp, constant buffer, SRV, UAV or group-shared memory register
+    uint32_t registerIndex;
+
+    // The 16-byte element of a constant buffer or of the immediate constant buffer
+    uint32_t elementIndex;
+
+    // The element index is offset by the component `relativeComponent` of the temp `relativeRegister`
+    bool hasRelativeIndex;
+    uint8_t relativeComponent;
+    uint32_t relativeRegister;
+
+    // The values of an immediate, already replicated to all the components of a scalar
+    uint32_t immediate[4];
+} DecodedOperand;
+
+typedef struct DecodedInstruction
+{
+    uint16_t opcode;
+
+    // `_nz` of the conditional instructions, `_z` otherwise
+    bool testNonZero;
+    bool saturate;
+    uint8_t syncFlags;
+    uint8_t operandCount;
+
+    // if: the matching else or endif, else: the matching endif, loop: the matching endloop, endloop: the matching loop
+    uint32_t jumpTarget;
+
+    // if: the matching endif
+    uint32_t endTarget;
+
+    OpcodeInfo info;
+    DecodedOperand operands[MAX_INSTRUCTION_OPERAND_COUNT];
+} DecodedInstruction;
+
+// A raw or structured buffer declared by the shader
+typedef struct BufferDeclaration
+{
+    bool isDeclared;
+
+    // 0 for a raw buffer
+    uint32_t structureStride;
+} BufferDeclaration;
+
+// The declaration of a group-shared memory register
+typedef struct GroupSharedDeclaration
+{
+    bool isDeclared;
+    uint32_t offset;
+    uint32_t size;
+
+    // 0 for a raw region
+    uint32_t structureStride;
+} GroupSharedDeclaration;
+
+struct ShaderProgram
+{
+    uint32_t laneCount;
+    uint32_t threadGroupSize[3];
+    uint32_t threadCount;
+    uint32_t batchCount;
+
+    // Shader Model 5.1 uses range IDs for the resources and the constant buffers
+    bool isModel51;
+
+    uint32_t tempCount;
+
+    bool constantBuffers[SHADER_INTERPRETER_MAX_CONSTANT_BUFFER_COUNT];
+    BufferDeclaration resources[SHADER_INTERPRETER_MAX_RESOURCE_COUNT];
+    BufferDeclaration uavs[SHADER_INTERPRETER_MAX_UAV_COUNT];
+
+    GroupSharedDeclaration groupShared[MAX_TGSM_COUNT];
+    uint32_t groupSharedBytes;
+
+    uint32_t* immediateConstants;
+    uint32_t immediateConstantCount;
+
+    DecodedInstruction* instructions;
+    uint32_t instructionCount;
+
+    // The size of each lane batch in the scratch memory, including its registers
+    size_t batchStride;
+    size_t batchesOffset;
+    size_t scratchSize;
+};
+
+// A view of the memory that a load, a store or an atomic operation addresses
+typedef struct MemoryView
+{
+    uint8_t* data;
+    size_t size;
+    uint32_t structureStride;
+} MemoryView;
+
+// Compute the component results of the ALU instruction `instruction` for the lanes [begin, end).
+// `sources` are the lanes of the source operands, after the swizzle and the modifiers, and `result2` is the second destination
+// of imul, umul and udiv. The dot products are not supported.
+extern void ComputeShaderLanes(const DecodedInstruction* instruction, uint32_t begin, uint32_t end, const uint32_t* const sources[4],
+                                uint32_t* result, uint32_t* result2);
+
+// Compute the float dot product of the first `componentCount` components of `a` and `b` for the lanes [begin, end)
+extern void ComputeShaderDotProductLanes(uint32_t componentCount, uint32_t begin, uint32_t end, const uint32_t* const a[4],
+                                        const uint32_t* const b[4], uint32_t* result);
+
+// Clamp the float lanes [begin, end) of `values` to [0, 1] for the `_sat` modifier
+extern void SaturateShaderLanes(uint32_t* values, uint32_t begin, uint32_t end);
+
+// Read the component `component` of the 16-byte element `element` of constant memory, or 0 beyond its end
+extern uint32_t ReadShaderConstant(const uint8_t* data, size_t size, uint64_t element, uint32_t component);
+
+// Get the memory of a resource, UAV or group-shared memory operand
+extern MemoryView GetShaderMemoryView(const ShaderProgram* program, const ShaderBindings* bindings, uint8_t* groupShared,
+                                    const DecodedOperand* operand);
+
+// The byte offset of the component `component` of a structured element member or of a raw address in `memory`,
+// or SIZE_MAX if it is out of bounds
+extern size_t GetShaderMemoryOffset(const MemoryView* memory, uint32_t address, uint32_t byteOffset, uint32_t component);
+
+// Load the component `component` of the lanes [begin, end) from `memory`. `byteOffsets` is NULL for a raw buffer.
+extern void LoadShaderMemoryLanes(const MemoryView* memory, uint32_t begin, uint32_t end, const uint32_t* addresses,
+                                const uint32_t* byteOffsets, uint32_t component, uint32_t* result);
+
+// Store the components `componentMask` of the lanes [begin, end) whose `activeLanes` entry is not 0 (all of them if it is NULL)
+// to `memory`, one lane after the other. `byteOffsets` is NULL for a raw buffer.
+extern void StoreShaderMemoryLanes(const MemoryView* memory, uint32_t begin, uint32_t end, const uint8_t* activeLanes,
+                                    const uint32_t* addresses, const uint32_t* byteOffsets, uint32_t componentMask,
+                                    const uint32_t* const values[4]);
+
+// Apply an atomic operation to one dword, and return the original value. `isShared` is true for the memory
+// that the thread groups running on the other workers can access.
+extern uint32_t ApplyShaderAtomicOperation(uint32_t opcode, uint32_t* target, bool isShared, uint32_t operand, uint32_t compareValue);
+
+#endif // SHADER_PROGRAM_H
@@ -0,0 +1,456 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "shader_asset.h"
+#include "shader_reflection.h"
+
+enum
+{
+    // The RDEF header up to the creator string offset, followed by the "RD11" block from Shader Model 5.0 on
+    RDEF_HEADER_SIZE = 28,
+    RDEF_RD11_MAGIC = 0x25441313,
+
+    RDEF_CONSTANT_BUFFER_SIZE = 24,
+
+    // The binding and variable descriptions of Shader Model 4.x. Shader Model 5.x reports its own sizes in the RD11 block.
+    RDEF_SM4_BINDING_SIZE = 32,
+    RDEF_SM4_VARIABLE_SIZE = 24,
+
+    // The binding descriptions of Shader Model 5.1 and later, which have the register space
+    RDEF_SM51_BINDING_SIZE = 40,
+
+    // D3D_SHADER_VARIABLE_FLAGS
+    SHADER_VARIABLE_FLAG_USED = 2,
+
+    // D3D_CT_CBUFFER
+    CONSTANT_BUFFER_TYPE_CBUFFER = 0,
+
+    // The opcodes of the SHEX/SHDR tokens that the reflection reads
+    SHADER_OPCODE_CUSTOMDATA = 0x35,
+    SHADER_OPCODE_DCL_THREAD_GROUP = 0x9b,
+    SHADER_OPCODE_DCL_TGSM_RAW = 0x9f,
+    SHADER_OPCODE_DCL_TGSM_STRUCTURED = 0xa0,
+
+    // An ISGN/OSGN element, and an ISG1/OSG1 element that also has the stream index and the min precision
+    SIGNATURE_ELEMENT_SIZE = 24,
+    SIGNATURE1_ELEMENT_SIZE = 32,
+
+    // The PSVRuntimeInfo2 layout of the PSV0 part, which is the first one with the thread group size
+    PSV_RUNTIME_INFO1_SHADER_STAGE_OFFSET = 24,
+    PSV_RUNTIME_INFO2_NUM_THREADS_OFFSET = 36,
+    PSV_RUNTIME_INFO2_SIZE = 48,
+    PSV_RESOURCE_BIND_INFO0_SIZE = 16
+};
+
+// D3D_SHADER_INPUT_TYPE
+typedef enum ShaderInputType
+{
+    SHADER_INPUT_CBUFFER,
+    SHADER_INPUT_TBUFFER,
+    SHADER_INPUT_TEXTURE,
+    SHADER_INPUT_SAMPLER,
+    SHADER_INPUT_UAV_RWTYPED,
+    SHADER_INPUT_STRUCTURED,
+    SHADER_INPUT_UAV_RWSTRUCTURED,
+    SHADER_INPUT_BYTEADDRESS,
+    SHADER_INPUT_UAV_RWBYTEADDRESS,
+    SHADER_INPUT_UAV_APPEND_STRUCTURED,
+    SHADER_INPUT_UAV_CONSUME_STRUCTURED,
+    SHADER_INPUT_UAV_RWSTRUCTURED_WITH_COUNTER,
+    SHADER_INPUT_RTACCELERATIONSTRUCTURE,
+    SHADER_INPUT_UAV_FEEDBACKTEXTURE,
+    SHADER_INPUT_TYPE_COUNT
+} ShaderInputType;
+
+// PSVResourceType of the pipeline state validation part
+typedef enum PSVResourceType
+{
+    PSV_RESOURCE_INVALID,
+    PSV_RESOURCE_SAMPLER,
+    PSV_RESOURCE_CBV,
+    PSV_RESOURCE_SRV_TYPED,
+    PSV_RESOURCE_SRV_RAW,
+    PSV_RESOURCE_SRV_STRUCTURED,
+    PSV_RESOURCE_UAV_TYPED,
+    PSV_RESOURCE_UAV_RAW,
+    PSV_RESOURCE_UAV_STRUCTURED,
+    PSV_RESOURCE_UAV_STRUCTURED_WITH_COUNTER,
+    PSV_RESOURCE_TYPE_COUNT
+} PSVResourceType;
+
+// A bounds-checked view of one part of the container
+typedef struct PartReader
+{
+    const uint8_t* data;
+    size_t size;
+} PartReader;
+
+static bool ReadPartUInt32(const PartReader* part, size_t offset, uint32_t* pValue)
+{
+    if (offset > part->size || part->size - offset < sizeof(uint32_t)) return false;
+
+    const uint8_t* bytes = part->data + offset;
+    *pValue = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    return true;
+}
+
+// Copy the null-terminated string at `offset` of the part, truncated to the name length
+static bool ReadPartString(const PartReader* part, size_t offset, char name[SHADER_REFLECTION_MAX_NAME_LENGTH])
+{
+    if (offset >= part->size) return false;
+
+    const size_t maxLength = part->size - offset;
+    const char* str = (const char*)part->data + offset;
+    size_t length = 0;
+    while (length < maxLength && str[length] != '\0') {
+        ++length;
+    }
+    if (length == maxLength) return false;
+
+    if (length >= SHADER_REFLECTION_MAX_NAME_LENGTH) {
+        length = SHADER_REFLECTION_MAX_NAME_LENGTH - 1;
+    }
+    memcpy(name, str, length);
+    name[length] = '\0';
+    return true;
+}
+
+static bool FindPart(const void* data, size_t size, const char fourCC[4], PartReader* pPart)
+{
+    const void* partData = NULL;
+    size_t partSize = 0;
+    if (!FindShaderContainerPart(data, size, fourCC, &partData, &partSize)) return false;
+
+    pPart->data = partData;
+    pPart->size = partSize;
+    return true;
+}
+
+// Fill the register class and the root descriptor eligibility of a binding from its D3D_SHADER_INPUT_TYPE
+static bool ClassifyInputType(uint32_t inputType, ShaderBinding* binding)
+{
+    binding->inputType = inputType;
+    binding->isBuffer = false;
+
+    switch ((ShaderInputType)inputType)
+    {
+    case SHADER_INPUT_CBUFFER:
+        binding->type = SHADER_BINDING_CBV;
+        binding->isBuffer = true;
+        break;
+
+    case SHADER_INPUT_STRUCTURED:
+    case SHADER_INPUT_BYTEADDRESS:
+        binding->type = SHADER_BINDING_SRV;
+        binding->isBuffer = true;
+        break;
+
+    case SHADER_INPUT_TBUFFER:
+    case SHADER_INPUT_TEXTURE:
+    case SHADER_INPUT_RTACCELERATIONSTRUCTURE:
+        binding->type = SHADER_BINDING_SRV;
+        break;
+
+    case SHADER_INPUT_UAV_RWSTRUCTURED:
+    case SHADER_INPUT_UAV_RWBYTEADDRESS:
+        binding->type = SHADER_BINDING_UAV;
+        binding->isBuffer = true;
+        break;
+
+    // The hidden counter of the append, consume and counter buffers needs a descriptor
+    case SHADER_INPUT_UAV_RWTYPED:
+    case SHADER_INPUT_UAV_APPEND_STRUCTURED:
+    case SHADER_INPUT_UAV_CONSUME_STRUCTURED:
+    case SHADER_INPUT_UAV_RWSTRUCTURED_WITH_COUNTER:
+    case SHADER_INPUT_UAV_FEEDBACKTEXTURE:
+        binding->type = SHADER_BINDING_UAV;
+        break;
+
+    case SHADER_INPUT_SAMPLER:
+        binding->type = SHADER_BINDING_SAMPLER;
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+static bool ReflectResourceDefinitions(const PartReader* rdef, ShaderReflection* reflection)
+{
+    uint32_t constantBufferCount, constantBufferOffset, bindingCount, bindingOffset, version;
+    if (!ReadPartUInt32(rdef, 0, &constantBufferCount) || !ReadPartUInt32(rdef, 4, &constantBufferOffset) ||
+        !ReadPartUInt32(rdef, 8, &bindingCount) || !ReadPartUInt32(rdef, 12, &bindingOffset) ||
+        !ReadPartUInt32(rdef, 16, &version)) return false;
+
+    // The minor version is in the lowest byte and the major version in the next one
+    const uint32_t majorVersion = (version >> 8) & 0xff;
+    uint32_t bindingSize = RDEF_SM4_BINDING_SIZE;
+    uint32_t variableSize = RDEF_SM4_VARIABLE_SIZE;
+    uint32_t magic = 0;
+    if (majorVersion >= 5 && ReadPartUInt32(rdef, RDEF_HEADER_SIZE, &magic) && magic == RDEF_RD11_MAGIC)
+    {
+        if (!ReadPartUInt32(rdef, RDEF_HEADER_SIZE + 12, &bindingSize) || !ReadPartUInt32(rdef, RDEF_HEADER_SIZE + 16, &variableSize)) return false;
+        if (bindingSize < RDEF_SM4_BINDING_SIZE || variableSize < RDEF_SM4_VARIABLE_SIZE) return false;
+    }
+
+    if (bindingCount > SHADER_REFLECTION_MAX_BINDING_COUNT || constantBufferCount > SHADER_REFLECTION_MAX_CONSTANT_BUFFER_COUNT) return false;
+
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        const size_t offset = (size_t)bindingOffset + (size_t)i * bindingSize;
+        ShaderBinding* binding = &reflection->bindings[i];
+        uint32_t nameOffset, inputType, numSamples;
+        if (!ReadPartUInt32(rdef, offset, &nameOffset) || !ReadPartUInt32(rdef, offset + 4, &inputType) ||
+            !ReadPartUInt32(rdef, offset + 16, &numSamples) || !ReadPartUInt32(rdef, offset + 20, &binding->registerIndex) ||
+            !ReadPartUInt32(rdef, offset + 24, &binding->bindCount)) return false;
+        if (!ReadPartString(rdef, nameOffset, binding->name) || !ClassifyInputType(inputType, binding)) return false;
+
+        if (bindingSize >= RDEF_SM51_BINDING_SIZE && !ReadPartUInt32(rdef, offset + 32, &binding->registerSpace)) return false;
+
+        // The sample count field holds the element size of a structured buffer
+        if (inputType == SHADER_INPUT_STRUCTURED || inputType == SHADER_INPUT_UAV_RWSTRUCTURED ||
+            inputType == SHADER_INPUT_UAV_APPEND_STRUCTURED || inputType == SHADER_INPUT_UAV_CONSUME_STRUCTURED ||
+            inputType == SHADER_INPUT_UAV_RWSTRUCTURED_WITH_COUNTER) {
+            binding->structureStride = numSamples;
+        }
+    }
+    reflection->bindingCount = bindingCount;
+
+    // The structured buffers also have a constant buffer entry describing their element type, which is skipped
+    for (uint32_t i = 0; i < constantBufferCount; ++i)
+    {
+        const size_t offset = (size_t)constantBufferOffset + (size_t)i * RDEF_CONSTANT_BUFFER_SIZE;
+        uint32_t nameOffset, variableCount, variableOffset, size, type;
+        if (!ReadPartUInt32(rdef, offset, &nameOffset) || !ReadPartUInt32(rdef, offset + 4, &variableCount) ||
+            !ReadPartUInt32(rdef, offset + 8, &variableOffset) || !ReadPartUInt32(rdef, offset + 12, &size) ||
+            !ReadPartUInt32(rdef, offset + 20, &type)) return false;
+        if (type != CONSTANT_BUFFER_TYPE_CBUFFER) continue;
+
+        if (variableCount > SHADER_REFLECTION_MAX_VARIABLE_COUNT - reflection->variableCount) return false;
+
+        ShaderConstantBuffer* constantBuffer = &reflection->constantBuffers[reflection->constantBufferCount];
+        if (!ReadPartString(rdef, nameOffset, constantBuffer->name)) return false;
+        constantBuffer->size = size;
+        constantBuffer->firstVariable = reflection->variableCount;
+        constantBuffer->variableCount = variableCount;
+
+        for (uint32_t v = 0; v < variableCount; ++v)
+        {
+            const size_t varOffset = (size_t)variableOffset + (size_t)v * variableSize;
+            ShaderVariable* variable = &reflection->variables[reflection->variableCount + v];
+            uint32_t varNameOffset, flags;
+            if (!ReadPartUInt32(rdef, varOffset, &varNameOffset) || !ReadPartUInt32(rdef, varOffset + 4, &variable->offset) ||
+                !ReadPartUInt32(rdef, varOffset + 8, &variable->size) || !ReadPartUInt32(rdef, varOffset + 12, &flags)) return false;
+            if (!ReadPartString(rdef, varNameOffset, variable->name)) return false;
+
+            variable->isUsed = (flags & SHADER_VARIABLE_FLAG_USED) != 0;
+        }
+
+        reflection->variableCount += variableCount;
+        ++reflection->constantBufferCount;
+    }
+
+    return true;
+}
+
+// Read the version and the declarations of the SHEX/SHDR token stream
+static bool ReflectShaderCode(const PartReader* code, ShaderReflection* reflection)
+{
+    uint32_t versionToken, tokenCount;
+    if (!ReadPartUInt32(code, 0, &versionToken) || !ReadPartUInt32(code, 4, &tokenCount)) return false;
+    if (tokenCount < 2 || tokenCount > code->size / sizeof(uint32_t)) return false;
+
+    reflection->programType = versionToken >> 16;
+    reflection->majorVersion = (versionToken >> 4) & 0xf;
+    reflection->minorVersion = versionToken & 0xf;
+
+    for (uint32_t index = 2; index < tokenCount; )
+    {
+        uint32_t token;
+        if (!ReadPartUInt32(code, (size_t)index * sizeof(uint32_t), &token)) return false;
+
+        const uint32_t opcode = token & 0x7ff;
+        uint32_t length = (token >> 24) & 0x7f;
+
+        // The custom data blocks have their length in the next token
+        if (opcode == SHADER_OPCODE_CUSTOMDATA && !ReadPartUInt32(code, ((size_t)index + 1) * sizeof(uint32_t), &length)) return false;
+        if (length == 0 || length > tokenCount - index) return false;
+
+        const size_t operands = ((size_t)index + 1) * sizeof(uint32_t);
+        const size_t last = ((size_t)index + length - 1) * sizeof(uint32_t);
+        switch (opcode)
+        {
+        case SHADER_OPCODE_DCL_THREAD_GROUP:
+            if (length < 4) return false;
+            ReadPartUInt32(code, operands, &reflection->threadGroupSize[0]);
+            ReadPartUInt32(code, operands + 4, &reflection->threadGroupSize[1]);
+            ReadPartUInt32(code, operands + 8, &reflection->threadGroupSize[2]);
+            break;
+
+        // dcl_tgsm_raw g#, byteCount
+        case SHADER_OPCODE_DCL_TGSM_RAW:
+        {
+            uint32_t byteCount = 0;
+            ReadPartUInt32(code, last, &byteCount);
+            reflection->groupSharedBytes += byteCount;
+            break;
+        }
+
+        // dcl_tgsm_structured g#, stride, count
+        case SHADER_OPCODE_DCL_TGSM_STRUCTURED:
+        {
+            uint32_t stride = 0, count = 0;
+            if (length < 4) return false;
+            ReadPartUInt32(code, last - sizeof(uint32_t), &stride);
+            ReadPartUInt32(code, last, &count);
+            reflection->groupSharedBytes += stride * count;
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        index += length;
+    }
+
+    return true;
+}
+
+static bool ReflectSignature(const PartReader* signature, uint32_t elementSize, ShaderSignatureElement elements[], uint32_t* pCount)
+{
+    uint32_t count, elementOffset;
+    if (!ReadPartUInt32(signature, 0, &count) || !ReadPartUInt32(signature, 4, &elementOffset)) return false;
+    if (count > SHADER_REFLECTION_MAX_SIGNATURE_ELEMENT_COUNT) return false;
+
+    // The ISG1/OSG1 elements start with the stream index
+    const size_t fieldsOffset = elementSize == SIGNATURE1_ELEMENT_SIZE ? 4 : 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const size_t offset = (size_t)elementOffset + (size_t)i * elementSize + fieldsOffset;
+        ShaderSignatureElement* element = &elements[i];
+        uint32_t nameOffset, mask;
+        if (!ReadPartUInt32(signature, offset, &nameOffset) || !ReadPartUInt32(signature, offset + 4, &element->semanticIndex) ||
+            !ReadPartUInt32(signature, offset + 8, &element->systemValue) || !ReadPartUInt32(signature, offset + 12, &element->componentType) ||
+            !ReadPartUInt32(signature, offset + 16, &element->registerIndex) || !ReadPartUInt32(signature, offset + 20, &mask)) return false;
+        if (!ReadPartString(signature, nameOffset, element->semanticName)) return false;
+
+        element->mask = (uint8_t)(mask & 0xff);
+    }
+
+    *pCount = count;
+    return true;
+}
+
+// Reflect one signature from its Shader Model 5.1 part if the container has it, or else from its older part
+static bool ReflectSignatureParts(const void* data, size_t size, const char fourCC1[4], const char fourCC[4],
+                                ShaderSignatureElement elements[], uint32_t* pCount)
+{
+    PartReader signature;
+    if (FindPart(data, size, fourCC1, &signature)) return ReflectSignature(&signature, SIGNATURE1_ELEMENT_SIZE, elements, pCount);
+    if (FindPart(data, size, fourCC, &signature)) return ReflectSignature(&signature, SIGNATURE_ELEMENT_SIZE, elements, pCount);
+
+    *pCount = 0;
+    return true;
+}
+
+// Read the bindings and the thread group size of a DXIL container from its pipeline state validation part
+static bool ReflectPipelineStateValidation(const PartReader* psv, ShaderReflection* reflection)
+{
+    uint32_t runtimeInfoSize;
+    if (!ReadPartUInt32(psv, 0, &runtimeInfoSize)) return false;
+
+    const size_t runtimeInfo = sizeof(uint32_t);
+    if (runtimeInfoSize >= PSV_RUNTIME_INFO2_SIZE)
+    {
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            if (!ReadPartUInt32(psv, runtimeInfo + PSV_RUNTIME_INFO2_NUM_THREADS_OFFSET + i * sizeof(uint32_t), &reflection->threadGroupSize[i])) return false;
+        }
+    }
+
+    uint32_t resourceCount;
+    const size_t resources = runtimeInfo + runtimeInfoSize;
+    if (!ReadPartUInt32(psv, resources, &resourceCount)) return false;
+    if (resourceCount > SHADER_REFLECTION_MAX_BINDING_COUNT) return false;
+    if (resourceCount == 0) return true;
+
+    uint32_t bindInfoSize;
+    if (!ReadPartUInt32(psv, resources + 4, &bindInfoSize) || bindInfoSize < PSV_RESOURCE_BIND_INFO0_SIZE) return false;
+
+    static const uint32_t inputTypes[PSV_RESOURCE_TYPE_COUNT] = {
+        [PSV_RESOURCE_INVALID] = SHADER_INPUT_TYPE_COUNT,
+        [PSV_RESOURCE_SAMPLER] = SHADER_INPUT_SAMPLER,
+        [PSV_RESOURCE_CBV] = SHADER_INPUT_CBUFFER,
+        [PSV_RESOURCE_SRV_TYPED] = SHADER_INPUT_TEXTURE,
+        [PSV_RESOURCE_SRV_RAW] = SHADER_INPUT_BYTEADDRESS,
+        [PSV_RESOURCE_SRV_STRUCTURED] = SHADER_INPUT_STRUCTURED,
+        [PSV_RESOURCE_UAV_TYPED] = SHADER_INPUT_UAV_RWTYPED,
+        [PSV_RESOURCE_UAV_RAW] = SHADER_INPUT_UAV_RWBYTEADDRESS,
+        [PSV_RESOURCE_UAV_STRUCTURED] = SHADER_INPUT_UAV_RWSTRUCTURED,
+        [PSV_RESOURCE_UAV_STRUCTURED_WITH_COUNTER] = SHADER_INPUT_UAV_RWSTRUCTURED_WITH_COUNTER
+    };
+
+    for (uint32_t i = 0; i < resourceCount; ++i)
+    {
+        const size_t offset = resources + 8 + (size_t)i * bindInfoSize;
+        ShaderBinding* binding = &reflection->bindings[i];
+        uint32_t resourceType, lowerBound, upperBound;
+        if (!ReadPartUInt32(psv, offset, &resourceType) || !ReadPartUInt32(psv, offset + 4, &binding->registerSpace) ||
+            !ReadPartUInt32(psv, offset + 8, &lowerBound) || !ReadPartUInt32(psv, offset + 12, &upperBound)) return false;
+        if (resourceType >= PSV_RESOURCE_TYPE_COUNT || !ClassifyInputType(inputTypes[resourceType], binding)) return false;
+
+        // An unbounded array has an upper bound of UINT32_MAX
+        binding->registerIndex = lowerBound;
+        binding->bindCount = upperBound == UINT32_MAX ? 0 : upperBound - lowerBound + 1;
+    }
+    reflection->bindingCount = resourceCount;
+
+    return true;
+}
+
+bool ReflectShader(const void* data, size_t size, ShaderReflection* pReflection)
+{
+    memset(pReflection, 0, sizeof(*pReflection));
+
+    PartReader part;
+    if (FindPart(data, size, "DXIL", &part))
+    {
+        // The DXIL program header starts with the same version token as SHEX
+        uint32_t versionToken;
+        if (!ReadPartUInt32(&part, 0, &versionToken)) return false;
+
+        pReflection->isDXIL = true;
+        pReflection->programType = versionToken >> 16;
+        pReflection->majorVersion = (versionToken >> 4) & 0xf;
+        pReflection->minorVersion = versionToken & 0xf;
+
+        return FindPart(data, size, "PSV0", &part) && ReflectPipelineStateValidation(&part, pReflection);
+    }
+
+    if (!FindPart(data, size, "RDEF", &part) || !ReflectResourceDefinitions(&part, pReflection)) return false;
+
+    if (!FindPart(data, size, "SHEX", &part) && !FindPart(data, size, "SHDR", &part)) return false;
+    if (!ReflectShaderCode(&part, pReflection)) return false;
+
+    return ReflectSignatureParts(data, size, "ISG1", "ISGN", pReflection->inputs, &pReflection->inputCount) &&
+            ReflectSignatureParts(data, size, "OSG1", "OSGN", pReflection->outputs, &pReflection->outputCount);
+}
+
+const ShaderBinding* FindShaderBinding(const ShaderReflection* reflection, ShaderBindingType type,
+                                    uint32_t registerIndex, uint32_t registerSpace)
+{
+    for (uint32_t i = 0; i < reflection->bindingCount; ++i)
+    {
+        const ShaderBinding* binding = &reflection->bindings[i];
+        if (binding->type != type || binding->registerSpace != registerSpace || registerIndex < binding->registerIndex) continue;
+
+        if (binding->bindCount == 0 || registerIndex - binding->registerIndex < binding->bindCount) return binding;
+    }
+
+    return NULL;
+}
+
@@ -0,0 +1,140 @@
+#ifndef SHADER_REFLECTION_H
+#define SHADER_REFLECTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    // The max length of the names kept by the reflection, including the terminating null character.
+    // Longer names are truncated.
+    SHADER_REFLECTION_MAX_NAME_LENGTH = 32,
+
+    SHADER_REFLECTION_MAX_BINDING_COUNT = 32,
+    SHADER_REFLECTION_MAX_CONSTANT_BUFFER_COUNT = 8,
+    SHADER_REFLECTION_MAX_VARIABLE_COUNT = 64,
+    SHADER_REFLECTION_MAX_SIGNATURE_ELEMENT_COUNT = 16
+};
+
+// The register class of a binding
+typedef enum ShaderBindingType
+{
+    // b#
+    SHADER_BINDING_CBV,
+
+    // t#
+    SHADER_BINDING_SRV,
+
+    // u#
+    SHADER_BINDING_UAV,
+
+    // s#
+    SHADER_BINDING_SAMPLER,
+
+    SHADER_BINDING_TYPE_COUNT
+} ShaderBindingType;
+
+// One resource bound by the shader
+typedef struct ShaderBinding
+{
+    char name[SHADER_REFLECTION_MAX_NAME_LENGTH];
+    ShaderBindingType type;
+
+    // The D3D_SHADER_INPUT_TYPE of the resource, e.g. 5 for a StructuredBuffer
+    uint32_t inputType;
+
+    uint32_t registerIndex;
+    uint32_t registerSpace;
+
+    // The number of consecutive registers, e.g. 4 for `Texture2D t[4]`. It is 0 for an unbounded array.
+    uint32_t bindCount;
+
+    // The element size of a structured buffer, 0 for the other resources
+    uint32_t structureStride;
+
+    // A structured or raw buffer, which can be bound as a root descriptor
+    bool isBuffer;
+} ShaderBinding;
+
+// One member of a constant buffer
+typedef struct ShaderVariable
+{
+    char name[SHADER_REFLECTION_MAX_NAME_LENGTH];
+    uint32_t offset;
+    uint32_t size;
+
+    // Whether the shader reads the variable at all
+    bool isUsed;
+} ShaderVariable;
+
+typedef struct ShaderConstantBuffer
+{
+    char name[SHADER_REFLECTION_MAX_NAME_LENGTH];
+    uint32_t size;
+
+    // The variables of the buffer are variables[firstVariable, firstVariable + variableCount) of the reflection
+    uint32_t firstVariable;
+    uint32_t variableCount;
+} ShaderConstantBuffer;
+
+// One element of an input or output signature
+typedef struct ShaderSignatureElement
+{
+    char semanticName[SHADER_REFLECTION_MAX_NAME_LENGTH];
+    uint32_t semanticIndex;
+    uint32_t registerIndex;
+
+    // The D3D_NAME of a system value, 0 for a user semantic
+    uint32_t systemValue;
+
+    // The D3D_REGISTER_COMPONENT_TYPE
+    uint32_t componentType;
+    uint8_t mask;
+} ShaderSignatureElement;
+
+// What the host needs to know about a compiled shader to bind and dispatch it
+typedef struct ShaderReflection
+{
+    // The D3D12_SHADER_VERSION_TYPE, e.g. 5 for a compute shader, and the shader model
+    uint32_t programType;
+    uint32_t majorVersion;
+    uint32_t minorVersion;
+
+    // Whether the bytecode is DXIL, in which case the bindings come from the pipeline state validation part
+    // and the constant buffer layouts are not known
+    bool isDXIL;
+
+    // [numthreads(x, y, z)] of a compute shader, all 0 if it is not known
+    uint32_t threadGroupSize[3];
+
+    // The bytes of group-shared memory declared by a DXBC compute shader
+    uint32_t groupSharedBytes;
+
+    uint32_t bindingCount;
+    ShaderBinding bindings[SHADER_REFLECTION_MAX_BINDING_COUNT];
+
+    uint32_t constantBufferCount;
+    ShaderConstantBuffer constantBuffers[SHADER_REFLECTION_MAX_CONSTANT_BUFFER_COUNT];
+
+    uint32_t variableCount;
+    ShaderVariable variables[SHADER_REFLECTION_MAX_VARIABLE_COUNT];
+
+    uint32_t inputCount;
+    ShaderSignatureElement inputs[SHADER_REFLECTION_MAX_SIGNATURE_ELEMENT_COUNT];
+
+    uint32_t outputCount;
+    ShaderSignatureElement outputs[SHADER_REFLECTION_MAX_SIGNATURE_ELEMENT_COUNT];
+} ShaderReflection;
+
+// Reflect a validated shader container.
+// A DXBC container is described by its RDEF, SHEX/SHDR and ISGN/ISG1/OSGN/OSG1 parts,
+// and a DXIL container by its PSV0 part. Returns false if a required part is missing or malformed.
+extern bool ReflectShader(const void* data, size_t size, ShaderReflection* pReflection);
+
+// Find the binding that covers register `registerIndex` of `type` in `registerSpace`, or return NULL
+extern const ShaderBinding* FindShaderBinding(const ShaderReflection* reflection, ShaderBindingType type,
+                                            uint32_t registerIndex, uint32_t registerSpace);
+
+#endif // SHADER_REFLECTION_H
+
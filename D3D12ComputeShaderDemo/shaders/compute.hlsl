@@ -1,36 +1,64 @@
-cbuffer cbCS : register(b0)
-{
-    int g_constant;
-    uint g_minWaveLanes;
-};
-
-groupshared int sharedBuffer[1024];
-
-StructuredBuffer<int> srcBuffer: register(t0);      // Shader Resource View (SRV) buffer
-RWStructuredBuffer<int> dstBuffer: register(u0);    // Unordered Access View (UAV) buffer
-RWStructuredBuffer<int> rwBuffer: register(u1);     // Unordered Access View (UAV) buffer
-
-[numthreads(1024, 1, 1)]
-void CSMain(uint3 groupID : SV_GroupID, uint3 tid : SV_DispatchThreadID, uint3 localTID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
-{
-    const uint globalIndex = tid.x;
-    dstBuffer[globalIndex] = srcBuffer[globalIndex] + g_constant;
-
-    // Do the second calculation...
-
-    // Firstly, put the data into the group-shared memory
-    sharedBuffer[groupIndex] = rwBuffer[globalIndex];
-
-    GroupMemoryBarrierWithGroupSync();
-
-    // Use the first g_minWaveLanes threads of each group to calculate the sum
-    if (groupIndex < g_minWaveLanes)
-    {
-        int sum = 0;
-        for(uint i = 0; i < 1024; i++)
-            sum += sharedBuffer[i];
-
-        rwBuffer[groupID.x] = sum;
-    }
-}
-
+cbuffer cbCS : register(b0)
+{
+    int g_constant;
+    uint g_minWaveLanes;
+
+    // The reduction input of the current pass is rwBuffer[g_inputOffset, g_inputOffset + g_elementCount),
+    // and the group sums are written to rwBuffer[g_outputOffset, g_outputOffset + g_groupCount).
+    uint g_elementCount;
+    uint g_inputOffset;
+    uint g_outputOffset;
+    uint g_groupCount;
+
+    // The dispatch grid may be 2D or 3D when the group count exceeds 65535
+    uint g_groupsPerRow;
+    uint g_groupsPerSlice;
+
+    // The element-wise addition is only executed by the first pass
+    uint g_passIndex;
+};
+
+groupshared int sharedBuffer[1024];
+
+StructuredBuffer<int> srcBuffer: register(t0);      // Shader Resource View (SRV) buffer
+RWStructuredBuffer<int> dstBuffer: register(u0);    // Unordered Access View (UAV) buffer
+RWStructuredBuffer<int> rwBuffer: register(u1);     // Unordered Access View (UAV) buffer
+
+[numthreads(1024, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint3 localTID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+    // Flatten the 3D group ID. The groups beyond g_groupCount only exist to fill up the last row or slice.
+    const uint linearGroupID = groupID.x + groupID.y * g_groupsPerRow + groupID.z * g_groupsPerSlice;
+    const bool groupActive = linearGroupID < g_groupCount;
+    const uint globalIndex = linearGroupID * 1024 + groupIndex;
+    const bool elementActive = groupActive && globalIndex < g_elementCount;
+
+    if (g_passIndex == 0 && elementActive) {
+        dstBuffer[globalIndex] = srcBuffer[globalIndex] + g_constant;
+    }
+
+    // Do the second calculation...
+
+    // Firstly, put the data into the group-shared memory. The elements beyond the input contribute nothing.
+    sharedBuffer[groupIndex] = elementActive ? rwBuffer[g_inputOffset + globalIndex] : 0;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // Reduce the group-shared memory with a log-step tree.
+    // In each step, the lower half of the active threads accumulates the upper half.
+    [unroll]
+    for (uint stride = 512; stride > 0; stride >>= 1)
+    {
+        if (groupIndex < stride) {
+            sharedBuffer[groupIndex] += sharedBuffer[groupIndex + stride];
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // Only the first thread of each group writes the sum
+    if (groupIndex == 0 && groupActive) {
+        rwBuffer[g_outputOffset + linearGroupID] = sharedBuffer[0];
+    }
+}
+
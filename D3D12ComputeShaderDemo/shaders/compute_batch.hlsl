@@ -0,0 +1,88 @@
+// A batch of independent jobs in a single dispatch. Each job adds its own constant to its segment of the packed inputs,
+// and reduces the segment into its own group sums with the tree reduction of compute.hlsl.
+struct BatchJob
+{
+    uint inputOffset;
+    uint elementCount;
+    int constantValue;
+    uint firstGroup;
+};
+
+cbuffer cbBatch : register(b0)
+{
+    uint g_jobCount;
+    uint g_groupCount;
+
+    // The dispatch grid may be 2D or 3D when the group count exceeds 65535
+    uint g_groupsPerRow;
+    uint g_groupsPerSlice;
+
+    // The group sums of all the jobs are written to rwBuffer[g_outputOffset, g_outputOffset + g_groupCount)
+    uint g_outputOffset;
+};
+
+groupshared int sharedBuffer[1024];
+
+StructuredBuffer<int> srcBuffer: register(t0);          // Shader Resource View (SRV) buffer
+StructuredBuffer<BatchJob> jobBuffer: register(t1);     // The job descriptor table, ordered by the first group of each job
+RWStructuredBuffer<int> dstBuffer: register(u0);        // Unordered Access View (UAV) buffer
+RWStructuredBuffer<int> rwBuffer: register(u1);         // Unordered Access View (UAV) buffer
+
+// Find the job of a group: the last job whose first group is not after it. The empty jobs own no group, so they are never found.
+uint FindJob(uint linearGroupID)
+{
+    uint first = 0;
+    uint count = g_jobCount;
+    while (count > 1)
+    {
+        const uint step = count / 2;
+        if (jobBuffer[first + step].firstGroup <= linearGroupID)
+        {
+            first += step;
+            count -= step;
+        }
+        else {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+[numthreads(1024, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint3 localTID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+    // Flatten the 3D group ID. The groups beyond g_groupCount only exist to fill up the last row or slice.
+    const uint linearGroupID = groupID.x + groupID.y * g_groupsPerRow + groupID.z * g_groupsPerSlice;
+    const bool groupActive = linearGroupID < g_groupCount;
+
+    // All the threads of the group search the same job, so the loads of the job table are uniform
+    const BatchJob job = jobBuffer[FindJob(groupActive ? linearGroupID : 0)];
+    const uint jobElementIndex = (linearGroupID - job.firstGroup) * 1024 + groupIndex;
+    const bool elementActive = groupActive && jobElementIndex < job.elementCount;
+    const uint globalIndex = job.inputOffset + jobElementIndex;
+
+    if (elementActive) {
+        dstBuffer[globalIndex] = srcBuffer[globalIndex] + job.constantValue;
+    }
+
+    // Put the input of the job into the group-shared memory. The elements beyond the job contribute nothing.
+    sharedBuffer[groupIndex] = elementActive ? rwBuffer[globalIndex] : 0;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for (uint stride = 512; stride > 0; stride >>= 1)
+    {
+        if (groupIndex < stride) {
+            sharedBuffer[groupIndex] += sharedBuffer[groupIndex + stride];
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // Only the first thread of each group writes the sum
+    if (groupIndex == 0 && groupActive) {
+        rwBuffer[g_outputOffset + linearGroupID] = sharedBuffer[0];
+    }
+}
@@ -0,0 +1,75 @@
+// The bindless variant of compute_wave.hlsl. It requires Shader Model 6.6.
+// The buffers are not bound to registers: their descriptors are fetched from ResourceDescriptorHeap with the indices
+// in the root constants, so all the bindless kernels share one root signature.
+cbuffer cbCS : register(b0)
+{
+    int g_constant;
+    uint g_minWaveLanes;
+
+    // The reduction input of the current pass is rwBuffer[g_inputOffset, g_inputOffset + g_elementCount),
+    // and the group sums are written to rwBuffer[g_outputOffset, g_outputOffset + g_groupCount).
+    uint g_elementCount;
+    uint g_inputOffset;
+    uint g_outputOffset;
+    uint g_groupCount;
+
+    // The dispatch grid may be 2D or 3D when the group count exceeds 65535
+    uint g_groupsPerRow;
+    uint g_groupsPerSlice;
+
+    // The element-wise addition is only executed by the first pass
+    uint g_passIndex;
+};
+
+// The descriptor heap indices of the buffers, which are root constants
+cbuffer cbIndices : register(b1)
+{
+    uint g_srcIndex;
+    uint g_dstIndex;
+    uint g_rwIndex;
+};
+
+// The sum of the whole group accumulated by the first lane of each wave
+groupshared int groupSum;
+
+[numthreads(1024, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint3 localTID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+    StructuredBuffer<int> srcBuffer = ResourceDescriptorHeap[g_srcIndex];
+    RWStructuredBuffer<int> dstBuffer = ResourceDescriptorHeap[g_dstIndex];
+    RWStructuredBuffer<int> rwBuffer = ResourceDescriptorHeap[g_rwIndex];
+
+    // Flatten the 3D group ID. The groups beyond g_groupCount only exist to fill up the last row or slice.
+    const uint linearGroupID = groupID.x + groupID.y * g_groupsPerRow + groupID.z * g_groupsPerSlice;
+    const bool groupActive = linearGroupID < g_groupCount;
+    const uint globalIndex = linearGroupID * 1024 + groupIndex;
+    const bool elementActive = groupActive && globalIndex < g_elementCount;
+
+    if (g_passIndex == 0 && elementActive) {
+        dstBuffer[globalIndex] = srcBuffer[globalIndex] + g_constant;
+    }
+
+    // Do the second calculation...
+
+    if (groupIndex == 0) {
+        groupSum = 0;
+    }
+
+    // Sum the elements of the current wave in registers. The elements beyond the input contribute nothing.
+    const int waveSum = WaveActiveSum(elementActive ? rwBuffer[g_inputOffset + globalIndex] : 0);
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // Accumulate the wave sums across the waves of the group.
+    // The mapping of threads to waves is not specified, so each wave adds its own sum instead of owning a slot.
+    if (WaveIsFirstLane()) {
+        InterlockedAdd(groupSum, waveSum);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // Only the first thread of each group writes the sum
+    if (groupIndex == 0 && groupActive) {
+        rwBuffer[g_outputOffset + linearGroupID] = groupSum;
+    }
+}
@@ -0,0 +1,97 @@
+// The raw-buffer variant of compute.hlsl. Each thread accesses four consecutive elements with one 128-bit load or store.
+cbuffer cbCS : register(b0)
+{
+    int g_constant;
+    uint g_minWaveLanes;
+
+    // The reduction input of the current pass is rwBuffer[g_inputOffset, g_inputOffset + g_elementCount),
+    // and the group sums are written to rwBuffer[g_outputOffset, g_outputOffset + g_groupCount).
+    uint g_elementCount;
+    uint g_inputOffset;
+    uint g_outputOffset;
+    uint g_groupCount;
+
+    // The dispatch grid may be 2D or 3D when the group count exceeds 65535
+    uint g_groupsPerRow;
+    uint g_groupsPerSlice;
+
+    // The element-wise addition is only executed by the first pass
+    uint g_passIndex;
+};
+
+// Each group of 256 threads covers the 1024 elements of one group of the pass
+#define THREAD_COUNT            256
+#define ELEMENTS_PER_THREAD     4
+
+groupshared int sharedBuffer[THREAD_COUNT];
+
+// The buffers are addressed in bytes. Load4 and Store4 need 16-byte aligned addresses,
+// which holds for the first pass and for every g_inputOffset that is a multiple of 4.
+ByteAddressBuffer srcBuffer: register(t0);          // Shader Resource View (SRV) buffer
+RWByteAddressBuffer dstBuffer: register(u0);        // Unordered Access View (UAV) buffer
+RWByteAddressBuffer rwBuffer: register(u1);         // Unordered Access View (UAV) buffer
+
+[numthreads(THREAD_COUNT, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint3 localTID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+    // Flatten the 3D group ID. The groups beyond g_groupCount only exist to fill up the last row or slice.
+    const uint linearGroupID = groupID.x + groupID.y * g_groupsPerRow + groupID.z * g_groupsPerSlice;
+    const bool groupActive = linearGroupID < g_groupCount;
+    const uint globalIndex = linearGroupID * 1024 + groupIndex * ELEMENTS_PER_THREAD;
+    const uint inputIndex = g_inputOffset + globalIndex;
+
+    int threadSum = 0;
+    if (groupActive && globalIndex + ELEMENTS_PER_THREAD <= g_elementCount)
+    {
+        if (g_passIndex == 0) {
+            dstBuffer.Store4(globalIndex * 4, srcBuffer.Load4(globalIndex * 4) + (uint)g_constant);
+        }
+
+        // The partial sums of the later passes start at any offset, so only the aligned ones are loaded at once
+        if ((inputIndex & 3) == 0)
+        {
+            const int4 values = asint(rwBuffer.Load4(inputIndex * 4));
+            threadSum = values.x + values.y + values.z + values.w;
+        }
+        else
+        {
+            [unroll]
+            for (uint i = 0; i < ELEMENTS_PER_THREAD; ++i) {
+                threadSum += asint(rwBuffer.Load((inputIndex + i) * 4));
+            }
+        }
+    }
+    else if (groupActive)
+    {
+        // The tail of the input is accessed one element at a time
+        for (uint i = 0; i < ELEMENTS_PER_THREAD && globalIndex + i < g_elementCount; ++i)
+        {
+            if (g_passIndex == 0) {
+                dstBuffer.Store((globalIndex + i) * 4, srcBuffer.Load((globalIndex + i) * 4) + (uint)g_constant);
+            }
+            threadSum += asint(rwBuffer.Load((inputIndex + i) * 4));
+        }
+    }
+
+    // Do the second calculation...
+
+    // Put the sums of the threads into the group-shared memory, and reduce it with a log-step tree
+    sharedBuffer[groupIndex] = threadSum;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for (uint stride = THREAD_COUNT / 2; stride > 0; stride >>= 1)
+    {
+        if (groupIndex < stride) {
+            sharedBuffer[groupIndex] += sharedBuffer[groupIndex + stride];
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // Only the first thread of each group writes the sum
+    if (groupIndex == 0 && groupActive) {
+        rwBuffer.Store((g_outputOffset + linearGroupID) * 4, asuint(sharedBuffer[0]));
+    }
+}
@@ -0,0 +1,78 @@
+// The grid-stride variant of compute.hlsl. A fixed number of resident groups, sized to the adapter, loop over the
+// 1024-element groups of the pass, so the dispatch does not grow with the element count.
+// Each thread folds its elements of a group in registers, and only the partial sums of the threads go through the group-shared memory.
+cbuffer cbCS : register(b0)
+{
+    int g_constant;
+    uint g_minWaveLanes;
+
+    // The reduction input of the current pass is rwBuffer[g_inputOffset, g_inputOffset + g_elementCount),
+    // and the group sums are written to rwBuffer[g_outputOffset, g_outputOffset + g_groupCount).
+    uint g_elementCount;
+    uint g_inputOffset;
+    uint g_outputOffset;
+    uint g_groupCount;
+
+    // The grid of the resident groups is 1D, so g_groupsPerRow is the number of resident groups, i.e. the stride of the loop
+    uint g_groupsPerRow;
+    uint g_groupsPerSlice;
+
+    // The element-wise addition is only executed by the first pass
+    uint g_passIndex;
+};
+
+#define THREAD_COUNT 256
+#define ELEMENTS_PER_THREAD (1024 / THREAD_COUNT)
+
+groupshared int sharedBuffer[THREAD_COUNT];
+
+StructuredBuffer<int> srcBuffer: register(t0);      // Shader Resource View (SRV) buffer
+RWStructuredBuffer<int> dstBuffer: register(u0);    // Unordered Access View (UAV) buffer
+RWStructuredBuffer<int> rwBuffer: register(u1);     // Unordered Access View (UAV) buffer
+
+[numthreads(THREAD_COUNT, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint3 localTID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+    // The loop condition is the same for all the threads of the group, so the barriers inside stay uniform
+    for (uint linearGroupID = groupID.x; linearGroupID < g_groupCount; linearGroupID += g_groupsPerRow)
+    {
+        // Fold the elements of the thread in registers. In each step, consecutive threads access consecutive elements,
+        // and the loads of all the steps are issued before any of them is consumed.
+        int threadSum = 0;
+
+        [unroll]
+        for (uint i = 0; i < ELEMENTS_PER_THREAD; ++i)
+        {
+            const uint globalIndex = linearGroupID * 1024 + i * THREAD_COUNT + groupIndex;
+            if (globalIndex < g_elementCount)
+            {
+                if (g_passIndex == 0) {
+                    dstBuffer[globalIndex] = srcBuffer[globalIndex] + g_constant;
+                }
+                threadSum += rwBuffer[g_inputOffset + globalIndex];
+            }
+        }
+
+        sharedBuffer[groupIndex] = threadSum;
+
+        GroupMemoryBarrierWithGroupSync();
+
+        // Reduce the partial sums of the threads with a log-step tree
+        [unroll]
+        for (uint stride = THREAD_COUNT / 2; stride > 0; stride >>= 1)
+        {
+            if (groupIndex < stride) {
+                sharedBuffer[groupIndex] += sharedBuffer[groupIndex + stride];
+            }
+
+            GroupMemoryBarrierWithGroupSync();
+        }
+
+        // Only the first thread of each group writes the sum
+        if (groupIndex == 0) {
+            rwBuffer[g_outputOffset + linearGroupID] = sharedBuffer[0];
+        }
+
+        // The next group of the loop needs no barrier first: sharedBuffer[0] is only read and rewritten by the first thread
+    }
+}
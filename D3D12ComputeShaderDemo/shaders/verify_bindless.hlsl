@@ -0,0 +1,115 @@
+// The bindless variant of verify.hlsl: the on-device verification of the results of compute_bindless.hlsl.
+// It requires Shader Model 6.6, and fetches the buffers from ResourceDescriptorHeap like compute_bindless.hlsl.
+// It runs after all the reduction passes, once per pass with the constants and the grid of the pass,
+// and accumulates the summary records that follow the partial sums of the last pass in rwBuffer:
+// record 0 checks dstBuffer[i] == srcBuffer[i] + g_constant, and record 1 + p checks the group sums written by pass p.
+// Each record is { checkedCount, mismatchCount, firstMismatch, checksum } (VerificationSummary in compute_reference.h),
+// initialized to { 0, 0, 0xFFFFFFFF, 0 } by the host.
+cbuffer cbCS : register(b0)
+{
+    // The members up to g_passIndex are the ones of compute.hlsl
+    int g_constant;
+    uint g_minWaveLanes;
+    uint g_elementCount;
+    uint g_inputOffset;
+    uint g_outputOffset;
+    uint g_groupCount;
+    uint g_groupsPerRow;
+    uint g_groupsPerSlice;
+    uint g_passIndex;
+
+    // The element index of the first summary record in rwBuffer
+    uint g_summaryOffset;
+};
+
+// The descriptor heap indices of the buffers, which are root constants
+cbuffer cbIndices : register(b1)
+{
+    uint g_srcIndex;
+    uint g_dstIndex;
+    uint g_rwIndex;
+};
+
+// The totals of the group, which are folded into the summary records by the first thread
+groupshared uint groupMismatchCount;
+groupshared uint groupFirstMismatch;
+groupshared uint groupChecksum;
+groupshared uint groupSum;
+
+// The finalizer of MurmurHash3 over the value mixed with the scaled index (ReferenceVerificationHash)
+uint VerificationHash(uint index, uint value)
+{
+    uint hash = value ^ (index * 0x9E3779B9u);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// Fold the check of one element into the summary record that starts at `record`
+void AccumulateSummary(RWStructuredBuffer<uint> rwBuffer, uint record, uint checkedCount, uint mismatchCount, uint firstMismatch,
+                    uint checksum)
+{
+    InterlockedAdd(rwBuffer[record], checkedCount);
+    if (mismatchCount > 0)
+    {
+        InterlockedAdd(rwBuffer[record + 1], mismatchCount);
+        InterlockedMin(rwBuffer[record + 2], firstMismatch);
+    }
+    InterlockedXor(rwBuffer[record + 3], checksum);
+}
+
+[numthreads(1024, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    StructuredBuffer<int> srcBuffer = ResourceDescriptorHeap[g_srcIndex];
+    RWStructuredBuffer<int> dstBuffer = ResourceDescriptorHeap[g_dstIndex];
+    RWStructuredBuffer<uint> rwBuffer = ResourceDescriptorHeap[g_rwIndex];
+
+    const uint linearGroupID = groupID.x + groupID.y * g_groupsPerRow + groupID.z * g_groupsPerSlice;
+    const bool groupActive = linearGroupID < g_groupCount;
+    const uint globalIndex = linearGroupID * 1024 + groupIndex;
+    const bool elementActive = groupActive && globalIndex < g_elementCount;
+
+    if (groupIndex == 0)
+    {
+        groupMismatchCount = 0;
+        groupFirstMismatch = 0xFFFFFFFF;
+        groupChecksum = 0;
+        groupSum = 0;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // The destination buffer is only checked by the dispatch of the first pass
+    if (g_passIndex == 0 && elementActive)
+    {
+        const uint actual = asuint(dstBuffer[globalIndex]);
+        if (actual != asuint(srcBuffer[globalIndex] + g_constant))
+        {
+            InterlockedAdd(groupMismatchCount, 1);
+            InterlockedMin(groupFirstMismatch, globalIndex);
+        }
+        InterlockedXor(groupChecksum, VerificationHash(globalIndex, actual));
+    }
+
+    // Sum the inputs of the group again. The additions wrap around, so their order does not matter.
+    if (elementActive) {
+        InterlockedAdd(groupSum, rwBuffer[g_inputOffset + globalIndex]);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (groupIndex == 0 && groupActive)
+    {
+        if (g_passIndex == 0) {
+            AccumulateSummary(rwBuffer, g_summaryOffset, min(g_elementCount - linearGroupID * 1024, 1024), groupMismatchCount, groupFirstMismatch, groupChecksum);
+        }
+
+        const uint actualSum = rwBuffer[g_outputOffset + linearGroupID];
+        AccumulateSummary(rwBuffer, g_summaryOffset + (1 + g_passIndex) * 4, 1, actualSum != groupSum ? 1 : 0, linearGroupID,
+                        VerificationHash(linearGroupID, actualSum));
+    }
+}
@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_check.h"
+#include "../adapter_selector.h"
+
+enum
+{
+    CHECK_GB = 1024 * 1024 * 1024
+};
+
+static void CheckParsing(void)
+{
+    AdapterSelection selection;
+    CHECK(ParseAdapterSelection("best", &selection) && selection.mode == ADAPTER_SELECT_BEST);
+    CHECK(ParseAdapterSelection("BEST", &selection) && selection.mode == ADAPTER_SELECT_BEST);
+
+    // A bare number is an index, just as "index:<n>"
+    CHECK(ParseAdapterSelection("1", &selection) && selection.mode == ADAPTER_SELECT_INDEX && selection.index == 1);
+    CHECK(ParseAdapterSelection("index:1", &selection) && selection.mode == ADAPTER_SELECT_INDEX && selection.index == 1);
+    CHECK(ParseAdapterSelection("index:0x10", &selection) && selection.mode == ADAPTER_SELECT_INDEX && selection.index == 16);
+
+    CHECK(ParseAdapterSelection("luid:0x1234abcd", &selection) && selection.mode == ADAPTER_SELECT_LUID && selection.luid == 0x1234abcd);
+    CHECK(ParseAdapterSelection("luid:0x1:0x2", &selection) && selection.mode == ADAPTER_SELECT_LUID &&
+        selection.luid == ((UINT64_C(1) << 32) | 2));
+    CHECK(ParseAdapterSelection("luid:7:42", &selection) && selection.luid == ((UINT64_C(7) << 32) | 42));
+
+    CHECK(ParseAdapterSelection("vendor:NVIDIA", &selection) && selection.mode == ADAPTER_SELECT_VENDOR &&
+        selection.vendorId == ADAPTER_VENDOR_ID_NVIDIA);
+    CHECK(ParseAdapterSelection("vendor:amd", &selection) && selection.vendorId == ADAPTER_VENDOR_ID_AMD);
+    CHECK(ParseAdapterSelection("vendor:0x8086", &selection) && selection.vendorId == ADAPTER_VENDOR_ID_INTEL);
+
+    // A failed parse leaves the selection unchanged
+    selection = (AdapterSelection){ .mode = ADAPTER_SELECT_INDEX, .index = 5 };
+    static const char* const invalidTexts[] = {
+        "", "index:", "index:-1", "index:0x100000000", "1x", " 1", "luid:", "luid:1:", "luid:0x100000000:0",
+        "vendor:", "vendor:unknown", "gpu:0"
+    };
+    for (uint32_t i = 0; i < sizeof(invalidTexts) / sizeof(invalidTexts[0]); ++i) {
+        CHECK(!ParseAdapterSelection(invalidTexts[i], &selection));
+    }
+    CHECK(!ParseAdapterSelection(NULL, &selection));
+    CHECK(selection.mode == ADAPTER_SELECT_INDEX && selection.index == 5);
+
+    // Only the selections that score the adapters need their capabilities
+    CHECK(ParseAdapterSelection("best", &selection) && AdapterSelectionNeedsCapabilities(&selection));
+    CHECK(ParseAdapterSelection("vendor:intel", &selection) && AdapterSelectionNeedsCapabilities(&selection));
+    CHECK(ParseAdapterSelection("2", &selection) && !AdapterSelectionNeedsCapabilities(&selection));
+    CHECK(ParseAdapterSelection("luid:3", &selection) && !AdapterSelectionNeedsCapabilities(&selection));
+}
+
+static void CheckScoring(void)
+{
+    const AdapterInfo discrete = {
+        .vendorId = ADAPTER_VENDOR_ID_AMD, .dedicatedVideoMemory = 16ULL * CHECK_GB,
+        .isSupported = true, .featureLevel = 0xc100, .shaderModel = 0x60
+    };
+    AdapterInfo waveOps = discrete;
+    waveOps.dedicatedVideoMemory = 2ULL * CHECK_GB;
+    waveOps.supportsWaveOps = true;
+    AdapterInfo software = discrete;
+    software.isSoftware = true;
+    AdapterInfo unsupported = discrete;
+    unsupported.isSupported = false;
+
+    // The software and unsupported adapters are never picked automatically
+    CHECK(ScoreAdapter(&software) == -1);
+    CHECK(ScoreAdapter(&unsupported) == -1);
+    CHECK(ScoreAdapter(&discrete) > 0);
+
+    // The wave operations outrank any amount of memory
+    CHECK(ScoreAdapter(&waveOps) > ScoreAdapter(&discrete));
+    AdapterInfo hugeMemory = discrete;
+    hugeMemory.dedicatedVideoMemory = UINT64_MAX;
+    CHECK(ScoreAdapter(&waveOps) > ScoreAdapter(&hugeMemory));
+
+    // The dedicated video memory weighs more than the same amount of shared system memory
+    AdapterInfo integrated = discrete;
+    integrated.dedicatedVideoMemory = 0;
+    integrated.sharedSystemMemory = 16ULL * CHECK_GB;
+    CHECK(ScoreAdapter(&discrete) > ScoreAdapter(&integrated));
+
+    // The shader model and then the feature level break the ties
+    AdapterInfo newerModel = discrete;
+    newerModel.shaderModel = 0x66;
+    newerModel.featureLevel = 0xb000;
+    CHECK(ScoreAdapter(&newerModel) > ScoreAdapter(&discrete));
+    AdapterInfo newerLevel = discrete;
+    newerLevel.featureLevel = 0xc200;
+    CHECK(ScoreAdapter(&newerLevel) > ScoreAdapter(&discrete));
+}
+
+static void CheckSelection(void)
+{
+    AdapterInfo adapters[4] = {
+        { .vendorId = ADAPTER_VENDOR_ID_INTEL, .luid = 0x100, .sharedSystemMemory = 8ULL * CHECK_GB,
+            .isSupported = true, .featureLevel = 0xc100, .shaderModel = 0x60, .supportsWaveOps = true },
+        { .vendorId = ADAPTER_VENDOR_ID_NVIDIA, .luid = 0x200, .dedicatedVideoMemory = 24ULL * CHECK_GB,
+            .isSupported = true, .featureLevel = 0xc100, .shaderModel = 0x60 },
+        { .vendorId = ADAPTER_VENDOR_ID_NVIDIA, .luid = 0x300, .dedicatedVideoMemory = 8ULL * CHECK_GB,
+            .isSupported = true, .featureLevel = 0xc100, .shaderModel = 0x60, .supportsWaveOps = true },
+        { .vendorId = 0x1414, .luid = (UINT64_C(1) << 32) | 0x400, .isSoftware = true, .isSupported = true }
+    };
+    AdapterSelection selection;
+
+    // The wave operations come first, and then the memory
+    CHECK(ParseAdapterSelection("best", &selection) && SelectAdapter(adapters, 4, &selection) == 2);
+    CHECK(ParseAdapterSelection("vendor:intel", &selection) && SelectAdapter(adapters, 4, &selection) == 0);
+    CHECK(ParseAdapterSelection("vendor:0x1002", &selection) && SelectAdapter(adapters, 4, &selection) == -1);
+
+    // A software adapter is only picked explicitly
+    CHECK(ParseAdapterSelection("vendor:0x1414", &selection) && SelectAdapter(adapters, 4, &selection) == -1);
+    CHECK(ParseAdapterSelection("index:3", &selection) && SelectAdapter(adapters, 4, &selection) == 3);
+    CHECK(ParseAdapterSelection("luid:1:0x400", &selection) && SelectAdapter(adapters, 4, &selection) == 3);
+    CHECK(ParseAdapterSelection("4", &selection) && SelectAdapter(adapters, 4, &selection) == -1);
+    CHECK(ParseAdapterSelection("luid:0x400", &selection) && SelectAdapter(adapters, 4, &selection) == -1);
+
+    // Equal scores resolve to the lowest index
+    adapters[1] = adapters[2];
+    CHECK(ParseAdapterSelection("best", &selection) && SelectAdapter(adapters, 4, &selection) == 1);
+    CHECK(SelectAdapter(adapters, 0, &selection) == -1);
+}
+
+int main(void)
+{
+    CheckParsing();
+    CheckScoring();
+    CheckSelection();
+    return FinishChecks("adapter_selector");
+}
@@ -0,0 +1,148 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_check.h"
+#include "../heap_allocator.h"
+
+enum
+{
+    CHECK_CAPACITY = 1 << 20,
+    CHECK_MIN_BLOCK_SIZE = 1 << 12
+};
+
+static void CheckAllocationSizes(void)
+{
+    BuddyAllocator* allocator = CreateBuddyAllocator(CHECK_CAPACITY, CHECK_MIN_BLOCK_SIZE);
+    CHECK(allocator != NULL);
+    if (allocator == NULL) return;
+
+    // The sizes are rounded up to the blocks, and a larger alignment takes a larger block
+    CHECK(BuddyGetBlockSize(allocator, 1, 0) == CHECK_MIN_BLOCK_SIZE);
+    CHECK(BuddyGetBlockSize(allocator, CHECK_MIN_BLOCK_SIZE + 1, 0) == 2 * CHECK_MIN_BLOCK_SIZE);
+    CHECK(BuddyGetBlockSize(allocator, 100, 1 << 16) == 1 << 16);
+    CHECK(BuddyGetBlockSize(allocator, CHECK_CAPACITY + 1, 0) == 0);
+
+    uint64_t offset;
+    CHECK(!BuddyAllocate(allocator, 0, 0, &offset));
+    CHECK(!BuddyAllocate(allocator, 16, 3, &offset));
+    CHECK(!BuddyAllocate(allocator, CHECK_CAPACITY + 1, 0, &offset));
+
+    // The whole range is a single block, and nothing else fits beside it
+    CHECK(BuddyAllocate(allocator, CHECK_CAPACITY, 0, &offset) && offset == 0);
+    CHECK(!BuddyAllocate(allocator, 1, 0, &offset));
+    BuddyFree(allocator, 0);
+
+    DestroyBuddyAllocator(allocator);
+    CHECK(CreateBuddyAllocator(3 << 12, CHECK_MIN_BLOCK_SIZE) == NULL);
+    CHECK(CreateBuddyAllocator(CHECK_MIN_BLOCK_SIZE, CHECK_CAPACITY) == NULL);
+}
+
+// Allocate blocks of mixed orders and alignments, free them out of order,
+// and check that the buddies merge back into one free block of the whole range
+static void CheckMergeOnFree(void)
+{
+    static const struct { uint64_t size; uint64_t alignment; } requests[] = {
+        { 4096, 0 }, { 65536, 0 }, { 100, 0 }, { 8192, 65536 }, { 12288, 0 }, { 4096, 4096 }, { 262144, 0 }, { 1, 16384 }
+    };
+    enum { REQUEST_COUNT = sizeof(requests) / sizeof(requests[0]) };
+
+    BuddyAllocator* allocator = CreateBuddyAllocator(CHECK_CAPACITY, CHECK_MIN_BLOCK_SIZE);
+    CHECK(allocator != NULL);
+    if (allocator == NULL) return;
+
+    uint64_t offsets[REQUEST_COUNT];
+    uint64_t usedBytes = 0;
+    for (uint32_t i = 0; i < REQUEST_COUNT; ++i)
+    {
+        const uint64_t blockSize = BuddyGetBlockSize(allocator, requests[i].size, requests[i].alignment);
+        CHECK(BuddyAllocate(allocator, requests[i].size, requests[i].alignment, &offsets[i]));
+
+        // Each block is aligned to its own size, and does not overlap any other block
+        CHECK(offsets[i] % blockSize == 0);
+        if (requests[i].alignment != 0) {
+            CHECK(offsets[i] % requests[i].alignment == 0);
+        }
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            const uint64_t otherSize = BuddyGetBlockSize(allocator, requests[j].size, requests[j].alignment);
+            CHECK(offsets[i] + blockSize <= offsets[j] || offsets[j] + otherSize <= offsets[i]);
+        }
+        usedBytes += blockSize;
+    }
+
+    BuddyAllocatorStats stats;
+    BuddyGetStats(allocator, &stats);
+    CHECK(stats.capacity == CHECK_CAPACITY);
+    CHECK(stats.usedBytes == usedBytes);
+    CHECK(stats.allocationCount == REQUEST_COUNT);
+    CHECK(stats.largestFreeBlock < CHECK_CAPACITY - usedBytes);
+    CHECK(stats.fragmentation > 0.0 && stats.fragmentation < 1.0);
+
+    // Free every other allocation first, then the rest backwards
+    for (uint32_t i = 0; i < REQUEST_COUNT; i += 2) {
+        BuddyFree(allocator, offsets[i]);
+    }
+    for (uint32_t i = REQUEST_COUNT; i-- > 0; )
+    {
+        if (i % 2 == 1) {
+            BuddyFree(allocator, offsets[i]);
+        }
+    }
+
+    BuddyGetStats(allocator, &stats);
+    CHECK(stats.usedBytes == 0);
+    CHECK(stats.allocationCount == 0);
+    CHECK(stats.largestFreeBlock == CHECK_CAPACITY);
+    CHECK(stats.fragmentation == 0.0);
+
+    // A freed offset is not freed twice
+    BuddyFree(allocator, offsets[0]);
+    BuddyGetStats(allocator, &stats);
+    CHECK(stats.allocationCount == 0 && stats.usedBytes == 0);
+
+    DestroyBuddyAllocator(allocator);
+}
+
+// Fill the range with minimum blocks, and free every other one:
+// half of the bytes are free, but no block larger than the minimum one is
+static void CheckFragmentation(void)
+{
+    enum { BLOCK_COUNT = CHECK_CAPACITY / CHECK_MIN_BLOCK_SIZE };
+
+    BuddyAllocator* allocator = CreateBuddyAllocator(CHECK_CAPACITY, CHECK_MIN_BLOCK_SIZE);
+    CHECK(allocator != NULL);
+    if (allocator == NULL) return;
+
+    uint64_t offset;
+    for (uint32_t i = 0; i < BLOCK_COUNT; ++i) {
+        CHECK(BuddyAllocate(allocator, CHECK_MIN_BLOCK_SIZE, 0, &offset));
+    }
+    CHECK(!BuddyAllocate(allocator, 1, 0, &offset));
+
+    for (uint32_t i = 0; i < BLOCK_COUNT; i += 2) {
+        BuddyFree(allocator, (uint64_t)i * CHECK_MIN_BLOCK_SIZE);
+    }
+
+    BuddyAllocatorStats stats;
+    BuddyGetStats(allocator, &stats);
+    CHECK(stats.usedBytes == CHECK_CAPACITY / 2);
+    CHECK(stats.largestFreeBlock == CHECK_MIN_BLOCK_SIZE);
+    CHECK(stats.fragmentation == 1.0 - 2.0 / BLOCK_COUNT);
+    CHECK(!BuddyAllocate(allocator, 2 * CHECK_MIN_BLOCK_SIZE, 0, &offset));
+
+    // Freeing the buddy of a free block merges them
+    BuddyFree(allocator, CHECK_MIN_BLOCK_SIZE);
+    BuddyGetStats(allocator, &stats);
+    CHECK(stats.largestFreeBlock == 2 * CHECK_MIN_BLOCK_SIZE);
+    CHECK(BuddyAllocate(allocator, 2 * CHECK_MIN_BLOCK_SIZE, 0, &offset) && offset == 0);
+
+    DestroyBuddyAllocator(allocator);
+}
+
+int main(void)
+{
+    CheckAllocationSizes();
+    CheckMergeOnFree();
+    CheckFragmentation();
+    return FinishChecks("heap_allocator");
+}
@@ -0,0 +1,31 @@
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// The host checks exercise the device-independent modules of the demo without a GPU.
+// Each check program counts its failed conditions, prints them, and exits with EXIT_FAILURE if there is any.
+
+static unsigned s_checkCount;
+static unsigned s_failedCheckCount;
+
+#define CHECK(condition) \
+    do { \
+        ++s_checkCount; \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed!\n", __FILE__, __LINE__, #condition); \
+            ++s_failedCheckCount; \
+        } \
+    } while (false)
+
+// Print the summary of the checks of `name`, and get the exit code of the check program
+static inline int FinishChecks(const char* name)
+{
+    printf("%s: %u of %u checks passed\n", name, s_checkCount - s_failedCheckCount, s_checkCount);
+    return s_failedCheckCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif // HOST_CHECK_H
@@ -0,0 +1,195 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_check.h"
+#include "../queue_scheduler.h"
+
+enum
+{
+    MAX_RECORDED_OPERATION_COUNT = 64
+};
+
+typedef enum RecordedOperationType
+{
+    RECORDED_EXECUTE,
+    RECORDED_SIGNAL,
+    RECORDED_WAIT
+} RecordedOperationType;
+
+// One queue operation issued by the scheduler. `value` is the slot of an execution.
+typedef struct RecordedOperation
+{
+    RecordedOperationType type;
+    ComputeQueueType queue;
+    ComputeQueueType fenceQueue;
+    uint64_t value;
+} RecordedOperation;
+
+// The stand-in of the device queues, which records the operations in their issue order
+typedef struct OperationRecorder
+{
+    uint32_t operationCount;
+    RecordedOperation operations[MAX_RECORDED_OPERATION_COUNT];
+
+    // The execution of this queue fails, or COMPUTE_QUEUE_TYPE_COUNT
+    ComputeQueueType failingQueue;
+} OperationRecorder;
+
+static bool Record(OperationRecorder* recorder, RecordedOperation operation)
+{
+    if (recorder->operationCount == MAX_RECORDED_OPERATION_COUNT) return false;
+
+    recorder->operations[recorder->operationCount++] = operation;
+    return true;
+}
+
+static bool RecordExecute(void* userData, ComputeQueueType queue, uint32_t slot)
+{
+    OperationRecorder* recorder = userData;
+    if (queue == recorder->failingQueue) return false;
+
+    return Record(recorder, (RecordedOperation){ .type = RECORDED_EXECUTE, .queue = queue, .value = slot });
+}
+
+static bool RecordSignal(void* userData, ComputeQueueType queue, uint64_t value)
+{
+    return Record(userData, (RecordedOperation){ .type = RECORDED_SIGNAL, .queue = queue, .value = value });
+}
+
+static bool RecordWait(void* userData, ComputeQueueType queue, ComputeQueueType fenceQueue, uint64_t value)
+{
+    return Record(userData, (RecordedOperation){ .type = RECORDED_WAIT, .queue = queue, .fenceQueue = fenceQueue, .value = value });
+}
+
+static void InitRecordingScheduler(QueueScheduler* scheduler, OperationRecorder* recorder, uint32_t slotCount)
+{
+    *recorder = (OperationRecorder){ .failingQueue = COMPUTE_QUEUE_TYPE_COUNT };
+    const QueueSchedulerOps ops = {
+        .userData = recorder,
+        .Execute = RecordExecute,
+        .Signal = RecordSignal,
+        .Wait = RecordWait
+    };
+    CHECK(InitQueueScheduler(scheduler, &ops, slotCount));
+}
+
+// Check that the operations recorded since `*pCursor` are `expected`, and move the cursor past them
+static void CheckRecorded(const OperationRecorder* recorder, uint32_t* pCursor, const RecordedOperation expected[], uint32_t count)
+{
+    CHECK(recorder->operationCount == *pCursor + count);
+    for (uint32_t i = 0; i < count && *pCursor + i < recorder->operationCount; ++i)
+    {
+        const RecordedOperation* operation = &recorder->operations[*pCursor + i];
+        CHECK(operation->type == expected[i].type);
+        CHECK(operation->queue == expected[i].queue);
+        CHECK(operation->value == expected[i].value);
+        if (expected[i].type == RECORDED_WAIT) {
+            CHECK(operation->fenceQueue == expected[i].fenceQueue);
+        }
+    }
+    *pCursor = recorder->operationCount;
+}
+
+#define EXECUTE(queue, slot) { RECORDED_EXECUTE, queue, 0, slot }
+#define SIGNAL(queue, value) { RECORDED_SIGNAL, queue, 0, value }
+#define WAIT(queue, fenceQueue, value) { RECORDED_WAIT, queue, fenceQueue, value }
+#define COUNT_OF(array) (uint32_t)(sizeof(array) / sizeof(array[0]))
+
+static void CheckJobChain(void)
+{
+    QueueScheduler scheduler;
+    OperationRecorder recorder;
+    InitRecordingScheduler(&scheduler, &recorder, 2);
+    uint32_t cursor = 0;
+
+    // The first job of a slot waits for nothing before its uploads,
+    // and then chains upload -> compute -> read-back with cross-queue waits
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 0) == 1);
+    CHECK(QueueSchedulerSubmitJob(&scheduler, 0) == 1);
+    const RecordedOperation firstJob[] = {
+        EXECUTE(COMPUTE_QUEUE_UPLOAD, 0), SIGNAL(COMPUTE_QUEUE_UPLOAD, 1),
+        WAIT(COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_UPLOAD, 1), EXECUTE(COMPUTE_QUEUE_COMPUTE, 0), SIGNAL(COMPUTE_QUEUE_COMPUTE, 1),
+        WAIT(COMPUTE_QUEUE_READBACK, COMPUTE_QUEUE_COMPUTE, 1), EXECUTE(COMPUTE_QUEUE_READBACK, 0), SIGNAL(COMPUTE_QUEUE_READBACK, 1)
+    };
+    CheckRecorded(&recorder, &cursor, firstJob, COUNT_OF(firstJob));
+    CHECK(scheduler.slots[0].fenceValues[COMPUTE_QUEUE_UPLOAD] == 1);
+    CHECK(scheduler.slots[0].fenceValues[COMPUTE_QUEUE_COMPUTE] == 1);
+    CHECK(scheduler.slots[0].fenceValues[COMPUTE_QUEUE_READBACK] == 1);
+
+    // The job of the other slot does not wait for the first one before its uploads
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 1) == 2);
+    CHECK(QueueSchedulerSubmitJob(&scheduler, 1) == 2);
+    const RecordedOperation secondJob[] = {
+        EXECUTE(COMPUTE_QUEUE_UPLOAD, 1), SIGNAL(COMPUTE_QUEUE_UPLOAD, 2),
+        WAIT(COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_UPLOAD, 2), EXECUTE(COMPUTE_QUEUE_COMPUTE, 1), SIGNAL(COMPUTE_QUEUE_COMPUTE, 2),
+        WAIT(COMPUTE_QUEUE_READBACK, COMPUTE_QUEUE_COMPUTE, 2), EXECUTE(COMPUTE_QUEUE_READBACK, 1), SIGNAL(COMPUTE_QUEUE_READBACK, 2)
+    };
+    CheckRecorded(&recorder, &cursor, secondJob, COUNT_OF(secondJob));
+
+    // The next job of slot 0 overwrites its buffers, so the uploads wait for the previous compute and read-back of the slot.
+    // The kernels wait for the read-back of the slot too, which the compute queue has not waited for yet.
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 0) == 3);
+    const RecordedOperation thirdUploads[] = {
+        WAIT(COMPUTE_QUEUE_UPLOAD, COMPUTE_QUEUE_COMPUTE, 1), WAIT(COMPUTE_QUEUE_UPLOAD, COMPUTE_QUEUE_READBACK, 1),
+        EXECUTE(COMPUTE_QUEUE_UPLOAD, 0), SIGNAL(COMPUTE_QUEUE_UPLOAD, 3)
+    };
+    CheckRecorded(&recorder, &cursor, thirdUploads, COUNT_OF(thirdUploads));
+
+    // A split upload of the same job repeats the same waits, which are redundant and skipped
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 0) == 4);
+    const RecordedOperation splitUploads[] = { EXECUTE(COMPUTE_QUEUE_UPLOAD, 0), SIGNAL(COMPUTE_QUEUE_UPLOAD, 4) };
+    CheckRecorded(&recorder, &cursor, splitUploads, COUNT_OF(splitUploads));
+    CHECK(scheduler.waitedValues[COMPUTE_QUEUE_UPLOAD][COMPUTE_QUEUE_COMPUTE] == 1);
+    CHECK(scheduler.waitedValues[COMPUTE_QUEUE_UPLOAD][COMPUTE_QUEUE_READBACK] == 1);
+
+    // The kernels wait for the last of the split uploads
+    CHECK(QueueSchedulerSubmitJob(&scheduler, 0) == 3);
+    const RecordedOperation thirdJob[] = {
+        WAIT(COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_UPLOAD, 4), WAIT(COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_READBACK, 1),
+        EXECUTE(COMPUTE_QUEUE_COMPUTE, 0), SIGNAL(COMPUTE_QUEUE_COMPUTE, 3),
+        WAIT(COMPUTE_QUEUE_READBACK, COMPUTE_QUEUE_COMPUTE, 3), EXECUTE(COMPUTE_QUEUE_READBACK, 0), SIGNAL(COMPUTE_QUEUE_READBACK, 3)
+    };
+    CheckRecorded(&recorder, &cursor, thirdJob, COUNT_OF(thirdJob));
+
+    // The next job of slot 1 waits for the values of its own slot, which are later than the ones waited for so far
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 1) == 5);
+    CHECK(QueueSchedulerSubmitJob(&scheduler, 1) == 4);
+    const RecordedOperation fourthJob[] = {
+        WAIT(COMPUTE_QUEUE_UPLOAD, COMPUTE_QUEUE_COMPUTE, 2), WAIT(COMPUTE_QUEUE_UPLOAD, COMPUTE_QUEUE_READBACK, 2),
+        EXECUTE(COMPUTE_QUEUE_UPLOAD, 1), SIGNAL(COMPUTE_QUEUE_UPLOAD, 5),
+        WAIT(COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_UPLOAD, 5), WAIT(COMPUTE_QUEUE_COMPUTE, COMPUTE_QUEUE_READBACK, 2),
+        EXECUTE(COMPUTE_QUEUE_COMPUTE, 1), SIGNAL(COMPUTE_QUEUE_COMPUTE, 4),
+        WAIT(COMPUTE_QUEUE_READBACK, COMPUTE_QUEUE_COMPUTE, 4), EXECUTE(COMPUTE_QUEUE_READBACK, 1), SIGNAL(COMPUTE_QUEUE_READBACK, 4)
+    };
+    CheckRecorded(&recorder, &cursor, fourthJob, COUNT_OF(fourthJob));
+}
+
+static void CheckFailures(void)
+{
+    QueueScheduler scheduler;
+    OperationRecorder recorder;
+    const QueueSchedulerOps ops = { .userData = &recorder, .Execute = RecordExecute, .Signal = RecordSignal, .Wait = RecordWait };
+    CHECK(!InitQueueScheduler(&scheduler, &ops, 0));
+    CHECK(!InitQueueScheduler(&scheduler, &ops, QUEUE_SCHEDULER_MAX_SLOT_COUNT + 1));
+
+    InitRecordingScheduler(&scheduler, &recorder, 1);
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 1) == 0);
+    CHECK(QueueSchedulerSubmitJob(&scheduler, 1) == 0);
+    CHECK(recorder.operationCount == 0);
+
+    // A failed submission signals nothing, so the fence values of the slot stay unchanged
+    CHECK(QueueSchedulerSubmitUploads(&scheduler, 0) == 1);
+    recorder.failingQueue = COMPUTE_QUEUE_COMPUTE;
+    CHECK(QueueSchedulerSubmitJob(&scheduler, 0) == 0);
+    CHECK(scheduler.fenceValues[COMPUTE_QUEUE_COMPUTE] == 0);
+    CHECK(scheduler.slots[0].fenceValues[COMPUTE_QUEUE_COMPUTE] == 0);
+    CHECK(recorder.operations[recorder.operationCount - 1].type == RECORDED_WAIT);
+}
+
+int main(void)
+{
+    CheckJobChain();
+    CheckFailures();
+    return FinishChecks("queue_scheduler");
+}
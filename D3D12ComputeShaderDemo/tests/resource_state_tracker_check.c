@@ -0,0 +1,155 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_check.h"
+#include "../resource_state_tracker.h"
+
+// The opaque handles of the buffers, as the ID3D12Resource pointers of the D3D12 backend
+static const int s_srcBuffer, s_dstBuffer, s_rwBuffer, s_readbackBuffer;
+
+// Take the barriers of the next dependency point, and check that there are `expectedCount` of them
+static const ResourceBarrierDesc* TakeBarriers(ResourceStateTracker* tracker, uint32_t expectedCount)
+{
+    const ResourceBarrierDesc* barriers = NULL;
+    const uint32_t barrierCount = TakeResourceBarriers(tracker, &barriers);
+    CHECK(barrierCount == expectedCount);
+    return barrierCount == expectedCount ? barriers : NULL;
+}
+
+static void CheckTransition(const ResourceBarrierDesc* barrier, const void* resource, uint32_t stateBefore, uint32_t stateAfter,
+                            ResourceBarrierSplit split)
+{
+    CHECK(barrier != NULL);
+    if (barrier == NULL) return;
+
+    CHECK(barrier->type == RESOURCE_BARRIER_TRANSITION);
+    CHECK(barrier->split == split);
+    CHECK(barrier->resource == resource);
+    CHECK(barrier->stateBefore == stateBefore && barrier->stateAfter == stateAfter);
+}
+
+// The first use of every buffer in a command list is promoted from the common state,
+// and a buffer promoted to read states is promoted again to the other read states
+static void CheckCommonPromotion(ResourceStateTracker* tracker)
+{
+    ResetResourceStateTracker(tracker);
+    CHECK(TrackResourceUse(tracker, &s_srcBuffer, RESOURCE_STATE_SHADER_RESOURCE));
+    CHECK(TrackResourceUse(tracker, &s_dstBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_COPY_DEST));
+    TakeBarriers(tracker, 0);
+
+    CHECK(TrackResourceUse(tracker, &s_srcBuffer, RESOURCE_STATE_COPY_SOURCE));
+    CHECK(TrackResourceUse(tracker, &s_srcBuffer, RESOURCE_STATE_SHADER_RESOURCE));
+    CHECK(TrackResourceUse(tracker, &s_dstBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    TakeBarriers(tracker, 0);
+
+    // A buffer that is not used as a UAV needs no UAV barrier
+    CHECK(TrackUnorderedAccessDependency(tracker, &s_srcBuffer));
+    CHECK(TrackUnorderedAccessDependency(tracker, &s_readbackBuffer));
+    TakeBarriers(tracker, 0);
+
+    // Nothing is left over for the next command list
+    ResetResourceStateTracker(tracker);
+    CHECK(TrackResourceUse(tracker, &s_dstBuffer, RESOURCE_STATE_COPY_SOURCE));
+    TakeBarriers(tracker, 0);
+}
+
+// The passes of the reduction read the partial sums that the previous pass wrote to u1,
+// then the read-back copies them out of the buffer
+static void CheckUnorderedAccesses(ResourceStateTracker* tracker)
+{
+    ResetResourceStateTracker(tracker);
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    TakeBarriers(tracker, 0);
+
+    for (int pass = 1; pass < 3; ++pass)
+    {
+        // The barrier of the first dependency already orders the accesses, so a second one needs none
+        CHECK(TrackUnorderedAccessDependency(tracker, &s_rwBuffer));
+        CHECK(TrackUnorderedAccessDependency(tracker, &s_rwBuffer));
+        CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+        const ResourceBarrierDesc* barriers = TakeBarriers(tracker, 1);
+        CHECK(barriers != NULL && barriers[0].type == RESOURCE_BARRIER_UAV && barriers[0].resource == &s_rwBuffer);
+    }
+
+    // The transition out of the promoted write state also orders the unordered accesses before it
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_COPY_SOURCE));
+    CHECK(TrackUnorderedAccessDependency(tracker, &s_rwBuffer));
+    const ResourceBarrierDesc* barriers = TakeBarriers(tracker, 1);
+    CheckTransition(barriers, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE, RESOURCE_BARRIER_SPLIT_NONE);
+
+    // The read states reached by a transition cannot be promoted to a write state
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_COPY_SOURCE));
+    TakeBarriers(tracker, 0);
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    barriers = TakeBarriers(tracker, 1);
+    CheckTransition(barriers, &s_rwBuffer, RESOURCE_STATE_COPY_SOURCE, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_BARRIER_SPLIT_NONE);
+}
+
+// The transition of the destination buffer to the copy source begins after the last dispatch that writes it,
+// and ends at the copy to the read-back buffer
+static void CheckSplitTransitions(ResourceStateTracker* tracker)
+{
+    ResetResourceStateTracker(tracker);
+
+    // A buffer that is still in the common state is promoted at its use instead
+    CHECK(BeginResourceTransition(tracker, &s_dstBuffer, RESOURCE_STATE_COPY_SOURCE));
+    TakeBarriers(tracker, 0);
+
+    CHECK(TrackResourceUse(tracker, &s_dstBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    CHECK(BeginResourceTransition(tracker, &s_dstBuffer, RESOURCE_STATE_COPY_SOURCE));
+    const ResourceBarrierDesc* barriers = TakeBarriers(tracker, 1);
+    CheckTransition(barriers, &s_dstBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE, RESOURCE_BARRIER_SPLIT_BEGIN_ONLY);
+
+    // The transition is left alone by a second begin and by the commands that do not use the buffer
+    CHECK(BeginResourceTransition(tracker, &s_dstBuffer, RESOURCE_STATE_COPY_SOURCE));
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    TakeBarriers(tracker, 0);
+
+    CHECK(TrackResourceUse(tracker, &s_dstBuffer, RESOURCE_STATE_COPY_SOURCE));
+    CHECK(TrackResourceUse(tracker, &s_readbackBuffer, RESOURCE_STATE_COPY_DEST));
+    barriers = TakeBarriers(tracker, 1);
+    CheckTransition(barriers, &s_dstBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE, RESOURCE_BARRIER_SPLIT_END_ONLY);
+
+    // A use in another state ends the transition, then moves on from its target state
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    CHECK(BeginResourceTransition(tracker, &s_rwBuffer, RESOURCE_STATE_COPY_SOURCE));
+    TakeBarriers(tracker, 1);
+    CHECK(TrackResourceUse(tracker, &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS));
+    barriers = TakeBarriers(tracker, 2);
+    if (barriers != NULL)
+    {
+        CheckTransition(&barriers[0], &s_rwBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE, RESOURCE_BARRIER_SPLIT_END_ONLY);
+        CheckTransition(&barriers[1], &s_rwBuffer, RESOURCE_STATE_COPY_SOURCE, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_BARRIER_SPLIT_NONE);
+    }
+}
+
+static void CheckCapacity(ResourceStateTracker* tracker)
+{
+    static char buffers[RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT + 1];
+
+    ResetResourceStateTracker(tracker);
+    for (int i = 0; i < RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT; ++i) {
+        CHECK(TrackResourceUse(tracker, &buffers[i], RESOURCE_STATE_UNORDERED_ACCESS));
+    }
+    CHECK(!TrackResourceUse(tracker, &buffers[RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT], RESOURCE_STATE_UNORDERED_ACCESS));
+    CHECK(!TrackUnorderedAccessDependency(tracker, &buffers[RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT]));
+
+    // Every tracked buffer can take a transition and a UAV barrier at one dependency point
+    for (int i = 0; i < RESOURCE_STATE_TRACKER_MAX_RESOURCE_COUNT; ++i)
+    {
+        CHECK(TrackUnorderedAccessDependency(tracker, &buffers[i]));
+        CHECK(TrackResourceUse(tracker, &buffers[i], RESOURCE_STATE_COPY_SOURCE));
+    }
+    TakeBarriers(tracker, RESOURCE_STATE_TRACKER_MAX_BARRIER_COUNT);
+}
+
+int main(void)
+{
+    ResourceStateTracker tracker;
+    CheckCommonPromotion(&tracker);
+    CheckUnorderedAccesses(&tracker);
+    CheckSplitTransitions(&tracker);
+    CheckCapacity(&tracker);
+    return FinishChecks("resource_state_tracker");
+}
@@ -0,0 +1,162 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_check.h"
+#include "../shader_asset.h"
+#include "../shader_reflection.h"
+#include "../root_signature_layout.h"
+#include "../reduction_layout.h"
+
+// The compiled tree reduction kernel, relative to the directory of the checks
+#define COMPUTE_SHADER_PATH     "../shaders/compute.cso"
+
+enum
+{
+    // The D3D_SHADER_INPUT_TYPE of the structured buffers
+    CHECK_SIT_STRUCTURED = 5,
+    CHECK_SIT_UAV_RWSTRUCTURED = 6,
+
+    PASS_CONSTANTS_DWORD_COUNT = sizeof(ReductionPassConstants) / sizeof(uint32_t)
+};
+
+// Reflect shaders/compute.cso, and check the resources that the D3D12 backend binds
+static void CheckComputeShaderReflection(ShaderReflection* reflection)
+{
+    ShaderAssetFile* file = OpenShaderAssetFile(COMPUTE_SHADER_PATH);
+    ShaderBytecode bytecode = { 0 };
+    CHECK(file != NULL && GetShaderObject(file, &bytecode));
+    CHECK(bytecode.data != NULL && ReflectShader(bytecode.data, bytecode.size, reflection));
+    CloseShaderAssetFile(file);
+
+    // cs_5_1 with [numthreads(1024, 1, 1)] and the 1024 ints of sharedBuffer
+    CHECK(reflection->programType == 5 && reflection->majorVersion == 5 && reflection->minorVersion == 1);
+    CHECK(!reflection->isDXIL);
+    CHECK(reflection->threadGroupSize[0] == 1024 && reflection->threadGroupSize[1] == 1 && reflection->threadGroupSize[2] == 1);
+    CHECK(reflection->groupSharedBytes == 1024 * sizeof(int));
+    CHECK(reflection->inputCount == 0 && reflection->outputCount == 0);
+
+    CHECK(reflection->bindingCount == 4);
+    const ShaderBinding* constants = FindShaderBinding(reflection, SHADER_BINDING_CBV, 0, 0);
+    const ShaderBinding* source = FindShaderBinding(reflection, SHADER_BINDING_SRV, 0, 0);
+    const ShaderBinding* destination = FindShaderBinding(reflection, SHADER_BINDING_UAV, 0, 0);
+    const ShaderBinding* destination2 = FindShaderBinding(reflection, SHADER_BINDING_UAV, 1, 0);
+    CHECK(constants != NULL && strcmp(constants->name, "cbCS") == 0 && constants->bindCount == 1);
+    CHECK(source != NULL && strcmp(source->name, "srcBuffer") == 0 && source->inputType == CHECK_SIT_STRUCTURED &&
+        source->structureStride == sizeof(int) && source->isBuffer);
+    CHECK(destination != NULL && strcmp(destination->name, "dstBuffer") == 0 && destination->inputType == CHECK_SIT_UAV_RWSTRUCTURED &&
+        destination->structureStride == sizeof(int) && destination->isBuffer);
+    CHECK(destination2 != NULL && strcmp(destination2->name, "rwBuffer") == 0 && destination2->inputType == CHECK_SIT_UAV_RWSTRUCTURED &&
+        destination2->structureStride == sizeof(int) && destination2->isBuffer);
+    CHECK(FindShaderBinding(reflection, SHADER_BINDING_UAV, 2, 0) == NULL);
+    CHECK(FindShaderBinding(reflection, SHADER_BINDING_CBV, 0, 1) == NULL);
+
+    // b0 is the 48-byte cbCS of the 9 pass constants that the kernel declares, at the offsets of ReductionPassConstants
+    const ShaderConstantBuffer* constantBuffer = NULL;
+    for (uint32_t i = 0; i < reflection->constantBufferCount; ++i)
+    {
+        if (strcmp(reflection->constantBuffers[i].name, "cbCS") == 0) {
+            constantBuffer = &reflection->constantBuffers[i];
+        }
+    }
+    CHECK(constantBuffer != NULL);
+    if (constantBuffer != NULL)
+    {
+        CHECK(constantBuffer->size == 48);
+        CHECK(constantBuffer->variableCount == 9);
+        const ShaderVariable* variables = &reflection->variables[constantBuffer->firstVariable];
+        CHECK(strcmp(variables[0].name, "g_constant") == 0 && variables[0].offset == offsetof(ReductionPassConstants, constantValue));
+        CHECK(strcmp(variables[4].name, "g_outputOffset") == 0 && variables[4].offset == offsetof(ReductionPassConstants, outputOffset));
+        CHECK(strcmp(variables[8].name, "g_passIndex") == 0 && variables[8].offset == offsetof(ReductionPassConstants, passIndex));
+
+        // The tree reduction does not read the wave size
+        CHECK(!variables[1].isUsed && variables[2].isUsed);
+    }
+    CHECK(CheckReductionPassConstantsLayout(reflection));
+}
+
+// The single structured buffers and the constant buffer of compute.cso all become root descriptors,
+// and the constant buffer is then inlined as the root constants of ReductionPassConstants
+static void CheckComputeRootSignature(const ShaderReflection* reflection)
+{
+    RootSignatureLayout layout;
+    CHECK(BuildRootSignatureLayout(reflection, &layout));
+    CHECK(layout.parameterCount == 4 && layout.rangeCount == 0);
+    CHECK(layout.dwordCount == 4 * ROOT_DESCRIPTOR_DWORD_COUNT);
+    CHECK(!layout.isDescriptorHeapIndexed);
+
+    CHECK(layout.parameters[0].type == ROOT_PARAMETER_CBV && layout.parameters[0].shaderRegister == 0);
+    CHECK(layout.parameters[1].type == ROOT_PARAMETER_SRV && layout.parameters[1].shaderRegister == 0);
+    CHECK(layout.parameters[2].type == ROOT_PARAMETER_UAV && layout.parameters[2].shaderRegister == 0);
+    CHECK(layout.parameters[3].type == ROOT_PARAMETER_UAV && layout.parameters[3].shaderRegister == 1);
+
+    uint32_t parameterIndex = 0, tableOffset = 0;
+    CHECK(FindRootSignatureBinding(&layout, SHADER_BINDING_UAV, 1, 0, &parameterIndex, &tableOffset) && parameterIndex == 3 && tableOffset == 0);
+    CHECK(!FindRootSignatureBinding(&layout, SHADER_BINDING_SRV, 1, 0, &parameterIndex, &tableOffset));
+
+    CHECK(!InlineRootConstants(&layout, 1, 0, PASS_CONSTANTS_DWORD_COUNT));
+    CHECK(!InlineRootConstants(&layout, 0, 0, ROOT_CONSTANTS_MAX_DWORD_COUNT + 1));
+    CHECK(InlineRootConstants(&layout, 0, 0, PASS_CONSTANTS_DWORD_COUNT));
+    CHECK(layout.parameters[0].type == ROOT_PARAMETER_CONSTANTS && layout.parameters[0].constantCount == PASS_CONSTANTS_DWORD_COUNT);
+    CHECK(layout.dwordCount == PASS_CONSTANTS_DWORD_COUNT + 3 * ROOT_DESCRIPTOR_DWORD_COUNT);
+    CHECK(FindRootSignatureBinding(&layout, SHADER_BINDING_CBV, 0, 0, &parameterIndex, &tableOffset) && parameterIndex == 0);
+}
+
+static ShaderBinding MakeBinding(ShaderBindingType type, uint32_t registerIndex, uint32_t bindCount, bool isBuffer)
+{
+    return (ShaderBinding){ .type = type, .registerIndex = registerIndex, .bindCount = bindCount, .isBuffer = isBuffer };
+}
+
+// The bindings that cannot be root descriptors go into the resource and sampler tables,
+// and every unbounded array into a table of its own
+static void CheckDescriptorTables(void)
+{
+    ShaderReflection reflection = { .programType = 5, .majorVersion = 5, .minorVersion = 1 };
+    const ShaderBinding bindings[] = {
+        MakeBinding(SHADER_BINDING_UAV, 2, 0, false),
+        MakeBinding(SHADER_BINDING_SAMPLER, 0, 1, false),
+        MakeBinding(SHADER_BINDING_UAV, 1, 4, false),
+        MakeBinding(SHADER_BINDING_SRV, 1, 1, false),
+        MakeBinding(SHADER_BINDING_UAV, 0, 1, true),
+        MakeBinding(SHADER_BINDING_SRV, 0, 1, true),
+        MakeBinding(SHADER_BINDING_CBV, 0, 1, true)
+    };
+    reflection.bindingCount = sizeof(bindings) / sizeof(bindings[0]);
+    memcpy(reflection.bindings, bindings, sizeof(bindings));
+
+    RootSignatureLayout layout;
+    CHECK(BuildRootSignatureLayout(&reflection, &layout));
+    CHECK(layout.parameterCount == 6);
+    CHECK(layout.dwordCount == 3 * ROOT_DESCRIPTOR_DWORD_COUNT + 3 * ROOT_DESCRIPTOR_TABLE_DWORD_COUNT);
+    CHECK(layout.parameters[0].type == ROOT_PARAMETER_CBV);
+    CHECK(layout.parameters[1].type == ROOT_PARAMETER_SRV && layout.parameters[1].shaderRegister == 0);
+    CHECK(layout.parameters[2].type == ROOT_PARAMETER_UAV && layout.parameters[2].shaderRegister == 0);
+
+    // The resource table holds t1 and then the 4 descriptors of u1
+    const RootParameterLayout* resourceTable = &layout.parameters[3];
+    CHECK(resourceTable->type == ROOT_PARAMETER_DESCRIPTOR_TABLE && resourceTable->rangeCount == 2 && resourceTable->descriptorCount == 5);
+    CHECK(layout.ranges[resourceTable->firstRange].type == SHADER_BINDING_SRV && layout.ranges[resourceTable->firstRange].baseRegister == 1);
+    CHECK(layout.ranges[resourceTable->firstRange + 1].type == SHADER_BINDING_UAV && layout.ranges[resourceTable->firstRange + 1].tableOffset == 1);
+
+    const RootParameterLayout* samplerTable = &layout.parameters[4];
+    CHECK(samplerTable->type == ROOT_PARAMETER_DESCRIPTOR_TABLE && samplerTable->descriptorCount == 1);
+    CHECK(layout.ranges[samplerTable->firstRange].type == SHADER_BINDING_SAMPLER);
+
+    const RootParameterLayout* unboundedTable = &layout.parameters[5];
+    CHECK(unboundedTable->type == ROOT_PARAMETER_DESCRIPTOR_TABLE && unboundedTable->rangeCount == 1);
+    CHECK(layout.ranges[unboundedTable->firstRange].descriptorCount == 0);
+
+    uint32_t parameterIndex = 0, tableOffset = 0;
+    CHECK(FindRootSignatureBinding(&layout, SHADER_BINDING_UAV, 3, 0, &parameterIndex, &tableOffset) && parameterIndex == 3 && tableOffset == 3);
+    CHECK(!FindRootSignatureBinding(&layout, SHADER_BINDING_UAV, 5, 1, &parameterIndex, &tableOffset));
+    CHECK(FindRootSignatureBinding(&layout, SHADER_BINDING_UAV, 100, 0, &parameterIndex, &tableOffset) && parameterIndex == 5 && tableOffset == 98);
+}
+
+int main(void)
+{
+    ShaderReflection reflection;
+    CheckComputeShaderReflection(&reflection);
+    CheckComputeRootSignature(&reflection);
+    CheckDescriptorTables();
+    return FinishChecks("shader_reflection");
+}
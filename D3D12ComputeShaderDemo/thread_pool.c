@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "thread_pool.h"
+
+enum
+{
+    // Scratch memory of each worker is aligned to the cache line size to avoid false sharing
+    SCRATCH_ALIGNMENT = 64
+};
+
+#ifdef _WIN32
+typedef HANDLE ThreadHandle;
+typedef SRWLOCK MutexType;
+typedef CONDITION_VARIABLE CondType;
+
+#define MutexInit(m)            InitializeSRWLock(m)
+#define MutexDestroy(m)         ((void)(m))
+#define MutexLock(m)            AcquireSRWLockExclusive(m)
+#define MutexUnlock(m)          ReleaseSRWLockExclusive(m)
+#define CondInit(c)             InitializeConditionVariable(c)
+#define CondDestroy(c)          ((void)(c))
+#define CondWait(c, m)          SleepConditionVariableSRW((c), (m), INFINITE, 0)
+#define CondBroadcast(c)        WakeAllConditionVariable(c)
+#define CondSignal(c)           WakeConditionVariable(c)
+#ifdef _WIN64
+#define AtomicFetchAddSize(p, v)    ((size_t)InterlockedExchangeAdd64((volatile LONG64*)(p), (LONG64)(v)))
+#else
+#define AtomicFetchAddSize(p, v)    ((size_t)InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v)))
+#endif // _WIN64
+#else
+typedef pthread_t ThreadHandle;
+typedef pthread_mutex_t MutexType;
+typedef pthread_cond_t CondType;
+
+#define MutexInit(m)            pthread_mutex_init((m), NULL)
+#define MutexDestroy(m)         pthread_mutex_destroy(m)
+#define MutexLock(m)            pthread_mutex_lock(m)
+#define MutexUnlock(m)          pthread_mutex_unlock(m)
+#define CondInit(c)             pthread_cond_init((c), NULL)
+#define CondDestroy(c)          pthread_cond_destroy(c)
+#define CondWait(c, m)          pthread_cond_wait((c), (m))
+#define CondBroadcast(c)        pthread_cond_broadcast(c)
+#define CondSignal(c)           pthread_cond_signal(c)
+#define AtomicFetchAddSize(p, v)    __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#endif // _WIN32
+
+struct ThreadPool
+{
+    unsigned workerCount;
+    size_t scratchStride;
+    void* scratchMemory;
+    uint8_t* scratchBase;
+
+    // Spawned threads. The worker 0 is the thread calling `ThreadPoolRun`.
+    ThreadHandle* threads;
+    unsigned spawnedCount;
+
+    MutexType mutex;
+    CondType wakeCond;
+    CondType doneCond;
+
+    // Increased by every `ThreadPoolRun` call to wake the workers up
+    uint64_t generation;
+    unsigned activeWorkers;
+    bool quit;
+
+    // The current job
+    ThreadPoolTask task;
+    void* userData;
+    size_t taskCount;
+    volatile size_t nextTaskIndex;
+};
+
+typedef struct WorkerStartInfo
+{
+    ThreadPool* pool;
+    unsigned workerIndex;
+} WorkerStartInfo;
+
+unsigned GetHardwareThreadCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    return sysInfo.dwNumberOfProcessors > 0 ? (unsigned)sysInfo.dwNumberOfProcessors : 1U;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned)count : 1U;
+#endif // _WIN32
+}
+
+static void RunTasks(ThreadPool* pool, unsigned workerIndex)
+{
+    void* const scratch = pool->scratchBase + (size_t)workerIndex * pool->scratchStride;
+    const ThreadPoolTask task = pool->task;
+    void* const userData = pool->userData;
+    const size_t taskCount = pool->taskCount;
+
+    for (size_t taskIndex = AtomicFetchAddSize(&pool->nextTaskIndex, 1U); taskIndex < taskCount;
+        taskIndex = AtomicFetchAddSize(&pool->nextTaskIndex, 1U))
+    {
+        task(userData, taskIndex, workerIndex, scratch);
+    }
+}
+
+static void WorkerLoop(ThreadPool* pool, unsigned workerIndex)
+{
+    uint64_t seenGeneration = 0;
+
+    while (true)
+    {
+        MutexLock(&pool->mutex);
+        while (pool->generation == seenGeneration && !pool->quit) {
+            CondWait(&pool->wakeCond, &pool->mutex);
+        }
+        if (pool->quit)
+        {
+            MutexUnlock(&pool->mutex);
+            break;
+        }
+        seenGeneration = pool->generation;
+        MutexUnlock(&pool->mutex);
+
+        RunTasks(pool, workerIndex);
+
+        MutexLock(&pool->mutex);
+        if (--pool->activeWorkers == 0) {
+            CondSignal(&pool->doneCond);
+        }
+        MutexUnlock(&pool->mutex);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerThreadProc(LPVOID param)
+#else
+static void* WorkerThreadProc(void* param)
+#endif // _WIN32
+{
+    WorkerStartInfo* startInfo = param;
+    ThreadPool* const pool = startInfo->pool;
+    const unsigned workerIndex = startInfo->workerIndex;
+    free(startInfo);
+
+    WorkerLoop(pool, workerIndex);
+
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif // _WIN32
+}
+
+ThreadPool* CreateThreadPool(unsigned workerCount, size_t scratchSizePerWorker)
+{
+    if (workerCount == 0) {
+        workerCount = GetHardwareThreadCount();
+    }
+
+    ThreadPool* pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) return NULL;
+
+    pool->workerCount = workerCount;
+    pool->scratchStride = (scratchSizePerWorker + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+
+    pool->scratchMemory = malloc(pool->scratchStride * workerCount + SCRATCH_ALIGNMENT);
+    pool->threads = calloc(workerCount, sizeof(*pool->threads));
+    if (pool->scratchMemory == NULL || pool->threads == NULL)
+    {
+        fprintf(stderr, "Lack of system memory to create the thread pool!\n");
+        free(pool->scratchMemory);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    pool->scratchBase = (uint8_t*)(((uintptr_t)pool->scratchMemory + SCRATCH_ALIGNMENT - 1) & ~(uintptr_t)(SCRATCH_ALIGNMENT - 1));
+
+    MutexInit(&pool->mutex);
+    CondInit(&pool->wakeCond);
+    CondInit(&pool->doneCond);
+
+    // Worker 0 is the calling thread of `ThreadPoolRun`
+    for (unsigned i = 1; i < workerCount; ++i)
+    {
+        WorkerStartInfo* startInfo = malloc(sizeof(*startInfo));
+        if (startInfo == NULL) break;
+
+        startInfo->pool = pool;
+        startInfo->workerIndex = i;
+
+#ifdef _WIN32
+        HANDLE hThread = CreateThread(NULL, 0, WorkerThreadProc, startInfo, 0, NULL);
+        if (hThread == NULL)
+#else
+        pthread_t hThread;
+        if (pthread_create(&hThread, NULL, WorkerThreadProc, startInfo) != 0)
+#endif // _WIN32
+        {
+            fprintf(stderr, "WARNING: Failed to create worker thread %u\n", i);
+            free(startInfo);
+            break;
+        }
+        pool->threads[pool->spawnedCount++] = hThread;
+    }
+
+    // Only the successfully spawned workers will participate
+    pool->workerCount = pool->spawnedCount + 1U;
+
+    return pool;
+}
+
+void ThreadPoolRun(ThreadPool* pool, ThreadPoolTask task, void* userData, size_t taskCount)
+{
+    if (pool == NULL || task == NULL || taskCount == 0) return;
+
+    if (pool->spawnedCount == 0 || taskCount == 1)
+    {
+        // Nothing to distribute
+        void* const scratch = pool->scratchBase;
+        for (size_t i = 0; i < taskCount; ++i) {
+            task(userData, i, 0, scratch);
+        }
+        return;
+    }
+
+    MutexLock(&pool->mutex);
+    pool->task = task;
+    pool->userData = userData;
+    pool->taskCount = taskCount;
+    pool->nextTaskIndex = 0;
+    pool->activeWorkers = pool->spawnedCount;
+    pool->generation++;
+    CondBroadcast(&pool->wakeCond);
+    MutexUnlock(&pool->mutex);
+
+    RunTasks(pool, 0);
+
+    MutexLock(&pool->mutex);
+    while (pool->activeWorkers > 0) {
+        CondWait(&pool->doneCond, &pool->mutex);
+    }
+    MutexUnlock(&pool->mutex);
+}
+
+unsigned ThreadPoolGetWorkerCount(const ThreadPool* pool)
+{
+    return pool != NULL ? pool->workerCount : 0U;
+}
+
+void DestroyThreadPool(ThreadPool* pool)
+{
+    if (pool == NULL) return;
+
+    MutexLock(&pool->mutex);
+    pool->quit = true;
+    CondBroadcast(&pool->wakeCond);
+    MutexUnlock(&pool->mutex);
+
+    for (unsigned i = 0; i < pool->spawnedCount; ++i)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif // _WIN32
+    }
+
+    CondDestroy(&pool->doneCond);
+    CondDestroy(&pool->wakeCond);
+    MutexDestroy(&pool->mutex);
+
+    free(pool->threads);
+    free(pool->scratchMemory);
+    free(pool);
+}
+
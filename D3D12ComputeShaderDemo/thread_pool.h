@@ -0,0 +1,34 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct ThreadPool ThreadPool;
+
+// The task routine executed by the worker threads.
+// `taskIndex` is in the range [0, taskCount) and every index is executed exactly once.
+// `workerIndex` identifies the executing worker, and `workerScratch` is the private scratch memory of that worker
+// (e.g. the emulated group-shared memory of a thread group).
+typedef void (*ThreadPoolTask)(void* userData, size_t taskIndex, unsigned workerIndex, void* workerScratch);
+
+// Get the number of logical processors of the current platform
+extern unsigned GetHardwareThreadCount(void);
+
+// Create a thread pool with `workerCount` workers (0 means one worker per logical processor).
+// The calling thread of `ThreadPoolRun` acts as worker 0, so `workerCount - 1` threads are spawned.
+// Each worker owns `scratchSizePerWorker` bytes of scratch memory.
+extern ThreadPool* CreateThreadPool(unsigned workerCount, size_t scratchSizePerWorker);
+
+// Execute `taskCount` tasks across all the workers and block until all of them are completed
+extern void ThreadPoolRun(ThreadPool* pool, ThreadPoolTask task, void* userData, size_t taskCount);
+
+// Get the number of workers (including the calling thread)
+extern unsigned ThreadPoolGetWorkerCount(const ThreadPool* pool);
+
+// Stop all the worker threads and release the thread pool
+extern void DestroyThreadPool(ThreadPool* pool);
+
+#endif // THREAD_POOL_H
+